@@ -0,0 +1,398 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Benchmark for the prediction code in predict-tools.c.
+ *
+ * Usage: bench-predict file.tle [file.tle ...]
+ *
+ * Each file is benchmarked as a catalog, followed by a synthetic catalog of
+ * low earth orbits created around the first near-earth satellite. The
+ * results are written to stdout as CSV, using the same columns as the
+ * propagator benchmark in sgpsdp/bench-001.c:
+ *
+ *   benchmark,catalog,sats,value,unit
+ *
+ * The prediction settings are read from the gpredict configuration. Point
+ * XDG_CONFIG_HOME to an empty directory to use the defaults.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib.h>
+#include <stdio.h>
+
+#include "gtk-sat-data.h"
+#include "orbit-tools.h"
+#include "predict-tools.h"
+#include "qth-data.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+#define BENCH_SATS   20         /* satellites in the synthetic catalog */
+#define BENCH_TIME   500000     /* duration of the predict_calc benchmark in usec */
+#define BENCH_EVENTS 20         /* AOS/LOS searches per satellite */
+#define BENCH_ORBITS 3          /* orbits in a ground track */
+#define BENCH_CHUNK  64         /* ground track points calculated at once */
+
+
+/** Read all TLE sets in a file into an array of sat_t. */
+static GArray  *read_catalog(const gchar * fname, qth_t * qth)
+{
+    GArray         *sats;
+    FILE           *fp;
+    char            tle_str[3][80];
+    sat_t           sat;
+
+    sats = g_array_new(FALSE, TRUE, sizeof(sat_t));
+
+    fp = fopen(fname, "r");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "Could not open %s\n", fname);
+        return sats;
+    }
+
+    while (fgets(tle_str[0], 80, fp) != NULL &&
+           fgets(tle_str[1], 80, fp) != NULL &&
+           fgets(tle_str[2], 80, fp) != NULL)
+    {
+        memset(&sat, 0, sizeof(sat_t));
+        if (Get_Next_Tle_Set(tle_str, &sat.tle) != 1)
+            continue;
+
+        sat.name = g_strstrip(g_strdup(sat.tle.sat_name));
+        sat.nickname = g_strdup(sat.name);
+        select_ephemeris(&sat);
+        gtk_sat_data_init_sat(&sat, qth);
+        g_array_append_val(sats, sat);
+    }
+    fclose(fp);
+
+    return sats;
+}
+
+/** Create a catalog of low earth orbits visible from mid latitudes. */
+static GArray  *synthetic_catalog(sat_t * seed, qth_t * qth)
+{
+    GArray         *sats;
+    sat_t           sat;
+    gint            i;
+
+    sats = g_array_new(FALSE, TRUE, sizeof(sat_t));
+
+    for (i = 0; i < BENCH_SATS; i++)
+    {
+        memset(&sat, 0, sizeof(sat_t));
+
+        /* select_ephemeris() converts the elements in place, so all the
+           converted ones are set again in TLE units */
+        sat.tle = seed->tle;
+        sat.tle.xno = 14.0 + 2.0 * i / BENCH_SATS;
+        sat.tle.eo = 0.0005 + 0.01 * (i % 4) / 4.0;
+        sat.tle.xincl = 50.0 + 50.0 * i / BENCH_SATS;
+        sat.tle.xnodeo = fmod(i * 37.0, 360.0);
+        sat.tle.omegao = fmod(i * 53.0, 360.0);
+        sat.tle.xmo = fmod(i * 71.0, 360.0);
+        sat.tle.xndt2o = 0.0;
+        sat.tle.xndd6o = 0.0;
+        sat.tle.bstar = 1.0E-4;
+        sat.tle.catnr = 90000 + i;
+
+        sat.name = g_strdup_printf("SYNTH-%02d", i);
+        sat.nickname = g_strdup(sat.name);
+        select_ephemeris(&sat);
+        gtk_sat_data_init_sat(&sat, qth);
+        g_array_append_val(sats, sat);
+    }
+
+    return sats;
+}
+
+static void free_catalog(GArray * sats)
+{
+    guint           i;
+
+    for (i = 0; i < sats->len; i++)
+    {
+        g_free(g_array_index(sats, sat_t, i).name);
+        g_free(g_array_index(sats, sat_t, i).nickname);
+    }
+    g_array_free(sats, TRUE);
+}
+
+/**
+ * Calculate a ground track.
+ *
+ * This uses the same time steps as ground_track_create() but leaves out
+ * the map specific parts.
+ */
+static guint ground_track(sat_t * sat, qth_t * qth, gdouble start)
+{
+    pass_detail_t   details[BENCH_CHUNK];
+    glong           this_orbit;
+    glong           max_orbit;
+    glong           orbit;
+    gdouble         t;
+    guint           points = 0;
+    guint           i;
+    gboolean        done = FALSE;
+
+    predict_calc(sat, qth, start);
+    this_orbit = sat->orbit;
+    max_orbit = this_orbit - 1 + BENCH_ORBITS;
+
+    t = start;
+    while (!done && ((t + 1.0) > start))
+    {
+        predict_calc_series(sat, qth, t, -0.0007, BENCH_CHUNK, details);
+        for (i = 0; i < BENCH_CHUNK && ((t + 1.0) > start); i++)
+        {
+            t = details[i].time - 0.0007;
+            if (details[i].orbit != this_orbit)
+            {
+                done = TRUE;
+                break;
+            }
+        }
+    }
+
+    t += 2 * 0.0007;
+    predict_calc(sat, qth, t);
+
+    orbit = sat->orbit;
+    done = !((orbit <= max_orbit) && (orbit >= this_orbit) && !decayed(sat));
+    while (!done)
+    {
+        predict_calc_series(sat, qth, t + 0.00035, 0.00035, BENCH_CHUNK,
+                            details);
+        for (i = 0; i < BENCH_CHUNK; i++)
+        {
+            t = details[i].time;
+            orbit = details[i].orbit;
+            points++;
+
+            sat->jul_utc = t;
+            if ((orbit > max_orbit) || (orbit < this_orbit) || decayed(sat))
+            {
+                done = TRUE;
+                break;
+            }
+        }
+    }
+
+    return points;
+}
+
+static void bench_catalog(const gchar * name, GArray * sats, qth_t * qth)
+{
+    static const guint num_passes[] = { 1, 10, 100 };
+    GArray         *visible;
+    sat_t          *sat;
+    GSList         *passes;
+    pass_timeline_t *timeline;
+    gint64          t0, dt;
+    gdouble         tsince = 0.0;
+    gdouble         tol;
+    glong           calls = 0;
+    guint           events0, calls0, events1, calls1;
+    guint           i, j, n;
+
+    /* predict_calc() rate */
+    t0 = g_get_monotonic_time();
+    do
+    {
+        for (i = 0; i < sats->len; i++)
+        {
+            sat = &g_array_index(sats, sat_t, i);
+            predict_calc(sat, qth, sat->jul_epoch + tsince);
+            calls++;
+        }
+        tsince += 1.0 / xmnpda;
+        dt = g_get_monotonic_time() - t0;
+    }
+    while (dt < BENCH_TIME);
+
+    printf("predict_calc,%s,%u,%.0f,calls/s\n", name, sats->len,
+           calls * 1.0E6 / dt);
+
+    /* the event benchmarks only make sense for satellites with passes */
+    visible = g_array_new(FALSE, FALSE, sizeof(sat_t *));
+    for (i = 0; i < sats->len; i++)
+    {
+        sat = &g_array_index(sats, sat_t, i);
+        if (has_aos(sat, qth) && !decayed(sat))
+            g_array_append_val(visible, sat);
+    }
+
+    if (visible->len == 0)
+    {
+        g_array_free(visible, TRUE);
+        fflush(stdout);
+        return;
+    }
+
+    /* find_aos() and find_los() latency */
+    tol = predict_event_tol();
+    for (n = 0; n < 2; n++)
+    {
+        predict_event_stats(&events0, &calls0);
+        t0 = g_get_monotonic_time();
+        for (i = 0; i < visible->len; i++)
+        {
+            sat = g_array_index(visible, sat_t *, i);
+            for (j = 0; j < BENCH_EVENTS; j++)
+            {
+                if (n == 0)
+                    find_aos(sat, qth, sat->jul_epoch + 0.25 * j, 3.0, tol);
+                else
+                    find_los(sat, qth, sat->jul_epoch + 0.25 * j, 3.0, tol);
+            }
+        }
+        dt = g_get_monotonic_time() - t0;
+        predict_event_stats(&events1, &calls1);
+
+        printf("%s,%s,%u,%.1f,usec\n", n ? "find_los" : "find_aos", name,
+               visible->len, (gdouble) dt / (visible->len * BENCH_EVENTS));
+        if (events1 > events0)
+            printf("%s_calls,%s,%u,%.1f,calls/event\n",
+                   n ? "find_los" : "find_aos", name, visible->len,
+                   (gdouble) (calls1 - calls0) / (events1 - events0));
+    }
+
+    /* get_passes() wall time, first with an empty pass cache, then with
+       the passes from the previous run in the cache */
+    for (n = 0; n < G_N_ELEMENTS(num_passes); n++)
+    {
+        predict_cache_clear();
+        for (j = 0; j < 2; j++)
+        {
+            t0 = g_get_monotonic_time();
+            for (i = 0; i < visible->len; i++)
+            {
+                sat = g_array_index(visible, sat_t *, i);
+                passes = get_passes(sat, qth, sat->jul_epoch, 0.0,
+                                    num_passes[n]);
+                free_passes(passes);
+            }
+            dt = g_get_monotonic_time() - t0;
+
+            printf("get_passes_%u%s,%s,%u,%.3f,ms\n", num_passes[n],
+                   j ? "_cached" : "", name, visible->len,
+                   dt / 1000.0 / visible->len);
+        }
+    }
+
+    /* get_pass_timeline() wall time for all visible satellites at once,
+       as used by sky at a glance */
+    predict_cache_clear();
+    t0 = g_get_monotonic_time();
+    timeline = get_pass_timeline((sat_t **) visible->data, visible->len, qth,
+                                 g_array_index(visible, sat_t *, 0)->jul_epoch,
+                                 1.0, 10);
+    dt = g_get_monotonic_time() - t0;
+
+    printf("get_pass_timeline,%s,%u,%.3f,ms\n", name, visible->len,
+           dt / 1000.0);
+    free_pass_timeline(timeline);
+
+    /* ground track */
+    n = 0;
+    t0 = g_get_monotonic_time();
+    for (i = 0; i < visible->len; i++)
+    {
+        sat = g_array_index(visible, sat_t *, i);
+        n += ground_track(sat, qth, sat->jul_epoch);
+    }
+    dt = g_get_monotonic_time() - t0;
+
+    printf("ground_track,%s,%u,%.3f,ms\n", name, visible->len,
+           dt / 1000.0 / visible->len);
+    printf("ground_track_points,%s,%u,%.0f,points\n", name, visible->len,
+           (gdouble) n / visible->len);
+
+    g_array_free(visible, TRUE);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    GArray         *sats;
+    GArray         *synth = NULL;
+    qth_t          *qth;
+    gchar          *name;
+    guint           j;
+    gint            i;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s file.tle [file.tle ...]\n", argv[0]);
+        return 1;
+    }
+
+    /* only errors; the prediction functions log every call at INFO */
+    sat_log_set_level(SAT_LOG_LEVEL_ERROR);
+    sat_cfg_load();
+
+    /* a mid latitude observer */
+    qth = g_new0(qth_t, 1);
+    qth_init(qth);
+    qth->lat = 55.7;
+    qth->lon = 12.6;
+    qth->alt = 20;
+
+    printf("benchmark,catalog,sats,value,unit\n");
+
+    for (i = 1; i < argc; i++)
+    {
+        sats = read_catalog(argv[i], qth);
+
+        for (j = 0; (synth == NULL) && (j < sats->len); j++)
+            if (!(g_array_index(sats, sat_t, j).flags & DEEP_SPACE_EPHEM_FLAG))
+                synth = synthetic_catalog(&g_array_index(sats, sat_t, j),
+                                          qth);
+
+        if (sats->len > 0)
+        {
+            name = g_path_get_basename(argv[i]);
+            bench_catalog(name, sats, qth);
+            g_free(name);
+        }
+        free_catalog(sats);
+    }
+
+    if (synth != NULL)
+    {
+        bench_catalog("synthetic-leo", synth, qth);
+        free_catalog(synth);
+    }
+
+    sat_cfg_close();
+    qth_data_free(qth);
+
+    return 0;
+}
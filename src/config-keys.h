@@ -68,6 +68,8 @@
 #define MOD_CFG_QTH_FILE_KEY    "QTHFILE"
 #define MOD_CFG_SATS_KEY        "SATELLITES"
 #define MOD_CFG_TIMEOUT_KEY     "TIMEOUT"
+#define MOD_CFG_THREADS_KEY     "UPDATE_THREADS"
+#define MOD_CFG_EPHEM_KEY       "EPHEM_CACHE"
 #define MOD_CFG_WARP_KEY        "WARP"
 #define MOD_CFG_LAYOUT          "LAYOUT"      /* Old layout before v1.2 */
 #define MOD_CFG_VIEW_1          "VIEW_1"      /* Old layout before v1.2 */
@@ -0,0 +1,284 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include "event-heap.h"
+#include "gtk-sat-data.h"
+
+
+#define EVENT_TIME(heap, p) ((heap)->events[(heap)->heap[p]].time)
+
+/** \brief Swap two heap positions and keep the slot positions in sync. */
+static void event_heap_swap(event_heap_t * heap, guint a, guint b)
+{
+    guint           slot = heap->heap[a];
+
+    heap->heap[a] = heap->heap[b];
+    heap->heap[b] = slot;
+    heap->pos[heap->heap[a]] = a;
+    heap->pos[heap->heap[b]] = b;
+}
+
+/** \brief Move the slot at heap position p towards the root. */
+static void event_heap_sift_up(event_heap_t * heap, guint p)
+{
+    guint           parent;
+
+    while (p > 0)
+    {
+        parent = (p - 1) / 2;
+        if (EVENT_TIME(heap, parent) <= EVENT_TIME(heap, p))
+            break;
+
+        event_heap_swap(heap, p, parent);
+        p = parent;
+    }
+}
+
+/** \brief Move the slot at heap position p towards the leaves. */
+static void event_heap_sift_down(event_heap_t * heap, guint p)
+{
+    guint           child;
+
+    for (;;)
+    {
+        child = 2 * p + 1;
+        if (child >= heap->len)
+            break;
+
+        if (child + 1 < heap->len &&
+            EVENT_TIME(heap, child + 1) < EVENT_TIME(heap, child))
+            child++;
+
+        if (EVENT_TIME(heap, p) <= EVENT_TIME(heap, child))
+            break;
+
+        event_heap_swap(heap, p, child);
+        p = child;
+    }
+}
+
+/**
+ * \brief Set the time of a slot, queueing or removing it as needed.
+ * \param heap The event heap.
+ * \param slot The slot.
+ * \param time The new event time or 0.0 if there is no event.
+ */
+static void event_heap_set_time(event_heap_t * heap, guint slot,
+                                gdouble time)
+{
+    guint           p = heap->pos[slot];
+    gdouble         old = heap->events[slot].time;
+
+    if (time > 0.0)
+    {
+        heap->events[slot].time = time;
+
+        if (p == G_MAXUINT)
+        {
+            p = heap->len++;
+            heap->heap[p] = slot;
+            heap->pos[slot] = p;
+            event_heap_sift_up(heap, p);
+        }
+        else if (time < old)
+        {
+            event_heap_sift_up(heap, p);
+        }
+        else if (time > old)
+        {
+            event_heap_sift_down(heap, p);
+        }
+    }
+    else if (p != G_MAXUINT)
+    {
+        /* move the last slot into the hole */
+        heap->len--;
+        heap->pos[slot] = G_MAXUINT;
+        heap->events[slot].time = 0.0;
+
+        if (p < heap->len)
+        {
+            heap->heap[p] = heap->heap[heap->len];
+            heap->pos[heap->heap[p]] = p;
+
+            if (EVENT_TIME(heap, p) < old)
+                event_heap_sift_up(heap, p);
+            else
+                event_heap_sift_down(heap, p);
+        }
+    }
+}
+
+/** \brief Create an empty event heap. */
+event_heap_t   *event_heap_new(void)
+{
+    return g_new0(event_heap_t, 1);
+}
+
+/** \brief Free an event heap created by event_heap_new(). */
+void event_heap_free(event_heap_t * heap)
+{
+    if (heap == NULL)
+        return;
+
+    event_heap_set_sats(heap, NULL);
+    g_free(heap);
+}
+
+/**
+ * \brief Replace the satellites in the heap.
+ * \param heap The event heap.
+ * \param sats Array of sat_t pointers or NULL to empty the heap.
+ *
+ * The satellites are referred to by their index in sats from now on. Their
+ * current AOS and LOS are queued.
+ */
+void event_heap_set_sats(event_heap_t * heap, GPtrArray * sats)
+{
+    guint           i;
+
+    g_free(heap->events);
+    g_free(heap->heap);
+    g_free(heap->pos);
+    g_free(heap->scratch);
+
+    heap->nsats = sats ? sats->len : 0;
+    heap->len = 0;
+    heap->events = g_new0(sat_event_t, 2 * heap->nsats);
+    heap->heap = g_new(guint, 2 * heap->nsats);
+    heap->pos = g_new(guint, 2 * heap->nsats);
+    heap->scratch = g_new(guint, 2 * heap->nsats);
+
+    for (i = 0; i < heap->nsats; i++)
+    {
+        heap->events[2 * i].sat = SAT(g_ptr_array_index(sats, i));
+        heap->events[2 * i].type = SAT_EVENT_AOS;
+        heap->events[2 * i + 1].sat = SAT(g_ptr_array_index(sats, i));
+        heap->events[2 * i + 1].type = SAT_EVENT_LOS;
+        heap->pos[2 * i] = G_MAXUINT;
+        heap->pos[2 * i + 1] = G_MAXUINT;
+
+        event_heap_update(heap, i);
+    }
+}
+
+/**
+ * \brief Update the events of a satellite.
+ * \param heap The event heap.
+ * \param i The index of the satellite in the array given to
+ *          event_heap_set_sats().
+ *
+ * This takes the new times from sat->aos and sat->los. Nothing is done for
+ * events that did not change, so this is cheap to call for every satellite
+ * after each update cycle.
+ */
+void event_heap_update(event_heap_t * heap, guint i)
+{
+    sat_t          *sat;
+
+    g_return_if_fail(i < heap->nsats);
+
+    sat = heap->events[2 * i].sat;
+
+    if (sat->aos != heap->events[2 * i].time)
+        event_heap_set_time(heap, 2 * i, sat->aos);
+
+    if (sat->los != heap->events[2 * i + 1].time)
+        event_heap_set_time(heap, 2 * i + 1, sat->los);
+}
+
+/**
+ * \brief Get the next events after a given time.
+ * \param heap The event heap.
+ * \param t The time in "jul_utc"; only events after t are returned.
+ * \param types Mask of the sat_event_type_t to return.
+ * \param events Array to store the events in.
+ * \param n The size of events.
+ * \return The number of events stored, at most n.
+ *
+ * The events are returned in order of time. The heap is walked from the root
+ * with a second heap of candidate positions, so this costs O(n log n) plus
+ * the events that are skipped because of their type or time.
+ */
+guint event_heap_next(event_heap_t * heap, gdouble t, guint types,
+                      sat_event_t * events, guint n)
+{
+    guint          *cand = heap->scratch;
+    guint           ncand = 0;
+    guint           found = 0;
+    guint           p, c, i, child;
+
+    if (heap->len == 0)
+        return 0;
+
+    cand[ncand++] = 0;
+
+    while (found < n && ncand > 0)
+    {
+        /* pop the earliest candidate */
+        p = cand[0];
+        cand[0] = cand[--ncand];
+        for (i = 0; 2 * i + 1 < ncand; i = child)
+        {
+            child = 2 * i + 1;
+            if (child + 1 < ncand &&
+                EVENT_TIME(heap, cand[child + 1]) <
+                EVENT_TIME(heap, cand[child]))
+                child++;
+
+            if (EVENT_TIME(heap, cand[i]) <= EVENT_TIME(heap, cand[child]))
+                break;
+
+            c = cand[i];
+            cand[i] = cand[child];
+            cand[child] = c;
+        }
+
+        if (EVENT_TIME(heap, p) > t &&
+            (heap->events[heap->heap[p]].type & types))
+            events[found++] = heap->events[heap->heap[p]];
+
+        /* its children are the next candidates */
+        for (child = 2 * p + 1; child <= 2 * p + 2 && child < heap->len;
+             child++)
+        {
+            i = ncand++;
+            cand[i] = child;
+            while (i > 0 && EVENT_TIME(heap, cand[(i - 1) / 2]) >
+                   EVENT_TIME(heap, cand[i]))
+            {
+                c = cand[i];
+                cand[i] = cand[(i - 1) / 2];
+                cand[(i - 1) / 2] = c;
+                i = (i - 1) / 2;
+            }
+        }
+    }
+
+    return found;
+}
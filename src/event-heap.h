@@ -0,0 +1,69 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef EVENT_HEAP_H
+#define EVENT_HEAP_H 1
+
+#include <glib.h>
+#include "sgpsdp/sgp4sdp4.h"
+
+
+/** \brief Event types; used as a mask in event_heap_next(). */
+typedef enum {
+    SAT_EVENT_AOS = 1 << 0,     /*!< Acquisition of signal */
+    SAT_EVENT_LOS = 1 << 1,     /*!< Loss of signal */
+    SAT_EVENT_ANY = SAT_EVENT_AOS | SAT_EVENT_LOS
+} sat_event_type_t;
+
+/** \brief An upcoming AOS or LOS of a satellite. */
+typedef struct {
+    sat_t          *sat;        /*!< The satellite */
+    gdouble         time;       /*!< Time of the event in "jul_utc" */
+    sat_event_type_t type;      /*!< SAT_EVENT_AOS or SAT_EVENT_LOS */
+} sat_event_t;
+
+/**
+ * \brief Index of the next AOS and LOS of a set of satellites.
+ *
+ * Each satellite has two slots, 2i for its AOS and 2i+1 for its LOS. A slot
+ * is queued in a binary min-heap ordered by time while the satellite has
+ * such an event, i.e. while sat->aos or sat->los is greater than 0.
+ */
+typedef struct {
+    guint           nsats;      /*!< Number of satellites */
+    sat_event_t    *events;     /*!< The 2 * nsats slots */
+    guint          *heap;       /*!< Queued slots in heap order */
+    guint          *pos;        /*!< Heap position of each slot or G_MAXUINT */
+    guint          *scratch;    /*!< Work space for event_heap_next() */
+    guint           len;        /*!< Number of queued slots */
+} event_heap_t;
+
+event_heap_t   *event_heap_new(void);
+void            event_heap_free(event_heap_t * heap);
+void            event_heap_set_sats(event_heap_t * heap, GPtrArray * sats);
+void            event_heap_update(event_heap_t * heap, guint i);
+guint           event_heap_next(event_heap_t * heap, gdouble t, guint types,
+                                sat_event_t * events, guint n);
+
+#endif
@@ -202,7 +202,7 @@ static void calculate_graph_points(GtkAzelPlot *azel)
     pass_detail_t *detail;
     gdouble dx, dy;
 
-    n = g_slist_length(azel->pass->details);
+    n = azel->pass->num_details;
     azel->num_points = n;
 
     g_free(azel->az_points);
@@ -213,7 +213,7 @@ static void calculate_graph_points(GtkAzelPlot *azel)
 
     for (i = 0; i < n; i++)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(azel->pass->details, i));
+        detail = &azel->pass->details[i];
         az_to_xy(azel, detail->time, detail->az, &dx, &dy);
         azel->az_points[2 * i] = dx;
         azel->az_points[2 * i + 1] = dy;
@@ -514,10 +514,10 @@ GtkWidget *gtk_azel_plot_new(qth_t * qth, pass_t * pass)
     g_value_unset(&font_value);
 
     /* check maximum Az */
-    n = g_slist_length(pass->details);
+    n = pass->num_details;
     for (i = 0; i < n; i++)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(pass->details, i));
+        detail = &pass->details[i];
 
         if (detail->az > azel->maxaz)
         {
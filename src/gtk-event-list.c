@@ -100,7 +100,8 @@ static gboolean event_list_update_sats(GtkTreeModel * model,
                                        GtkTreeIter * iter, gpointer data);
 
 /* cell rendering related functions */
-static void     check_and_set_cell_renderer(GtkTreeViewColumn * column,
+static void     check_and_set_cell_renderer(GtkEventList * evlist,
+                                            GtkTreeViewColumn * column,
                                             GtkCellRenderer * renderer,
                                             gint i);
 static void     evtype_cell_data_function(GtkTreeViewColumn * col,
@@ -110,7 +111,7 @@ static void     evtype_cell_data_function(GtkTreeViewColumn * col,
 static void     time_cell_data_function(GtkTreeViewColumn * col,
                                         GtkCellRenderer * renderer,
                                         GtkTreeModel * model,
-                                        GtkTreeIter * iter, gpointer column);
+                                        GtkTreeIter * iter, gpointer data);
 static void     degree_cell_data_function(GtkTreeViewColumn * col,
                                           GtkCellRenderer * renderer,
                                           GtkTreeModel * model,
@@ -271,7 +272,7 @@ GtkWidget      *gtk_event_list_new(GKeyFile * cfgdata, GHashTable * sats,
                                     column, -1);
         gtk_tree_view_column_set_alignment(column, EVENT_LIST_HEAD_XALIGN[i]);
         gtk_tree_view_column_set_sort_column_id(column, i);
-        check_and_set_cell_renderer(column, renderer, i);
+        check_and_set_cell_renderer(evlist, column, renderer, i);
 
         /* hide columns that have not been specified */
         if (!(evlist->flags & (1 << i)))
@@ -365,7 +366,7 @@ static void event_list_add_satellites(gpointer key, gpointer value,
                        EVENT_LIST_COL_AZ, sat->az,
                        EVENT_LIST_COL_EL, sat->el,
                        EVENT_LIST_COL_EVT, (sat->el >= 0) ? TRUE : FALSE,
-                       EVENT_LIST_COL_TIME, 0.0,
+                       EVENT_LIST_COL_TIME, -1.0,
                        EVENT_LIST_COL_DECAY, !decayed(sat), -1);
 }
 
@@ -430,7 +431,7 @@ static gboolean event_list_update_sats(GtkTreeModel * model,
     GtkEventList   *evlist = GTK_EVENT_LIST(data);
     guint          *catnum;
     sat_t          *sat;
-    gdouble         number, now;
+    gdouble         number;
 
     (void)path;
 
@@ -455,14 +456,13 @@ static gboolean event_list_update_sats(GtkTreeModel * model,
     }
     else
     {
-        /* update data */
-        now = evlist->tstamp;
-
+        /* the time of the event is stored rather than the countdown so
+           that the rows only move when the next event changes */
         if (sat->el > 0.0)
         {
             if (sat->los > 0.0)
             {
-                number = sat->los - now;
+                number = sat->los;
             }
             else
             {
@@ -473,7 +473,7 @@ static gboolean event_list_update_sats(GtkTreeModel * model,
         {
             if (sat->aos > 0.0)
             {
-                number = sat->aos - now;
+                number = sat->aos;
             }
             else
             {
@@ -503,7 +503,8 @@ static gboolean event_list_update_sats(GtkTreeModel * model,
 }
 
 /** Set cell renderer function. */
-static void check_and_set_cell_renderer(GtkTreeViewColumn * column,
+static void check_and_set_cell_renderer(GtkEventList * evlist,
+                                        GtkTreeViewColumn * column,
                                         GtkCellRenderer * renderer, gint i)
 {
     switch (i)
@@ -530,7 +531,7 @@ static void check_and_set_cell_renderer(GtkTreeViewColumn * column,
         gtk_tree_view_column_set_cell_data_func(column,
                                                 renderer,
                                                 time_cell_data_function,
-                                                GUINT_TO_POINTER(i), NULL);
+                                                evlist, NULL);
         break;
 
     default:
@@ -572,22 +573,22 @@ static void evtype_cell_data_function(GtkTreeViewColumn * col,
     g_free(buff);
 }
 
-/* AOS/LOS; convert julian date to string */
+/* AOS/LOS; convert julian date to countdown string */
 static void time_cell_data_function(GtkTreeViewColumn * col,
                                     GtkCellRenderer * renderer,
                                     GtkTreeModel * model,
-                                    GtkTreeIter * iter, gpointer column)
+                                    GtkTreeIter * iter, gpointer data)
 {
     (void)col;
 
+    GtkEventList   *evlist = GTK_EVENT_LIST(data);
     gdouble         number;
     gchar          *buff;
-    guint           coli = GPOINTER_TO_UINT(column);
 
     guint           h, m, s;
 
     /* get cell data */
-    gtk_tree_model_get(model, iter, coli, &number, -1);
+    gtk_tree_model_get(model, iter, EVENT_LIST_COL_TIME, &number, -1);
 
     /* format the time code */
     if (number < 0.0)
@@ -597,6 +598,7 @@ static void time_cell_data_function(GtkTreeViewColumn * col,
     else
     {
         /* convert julian date to seconds */
+        number = MAX(number - evlist->tstamp, 0.0);
         s = (guint) (number * 86400);
 
         /* extract hours */
@@ -261,7 +261,7 @@ static void create_track(GtkPolarPlot * pv)
     guint           tres, ttidx;
 
     /* create points */
-    num = g_slist_length(pv->pass->details);
+    num = pv->pass->num_details;
 
     g_free(pv->track_points);
     pv->track_points = g_new(gdouble, num * 2);
@@ -284,7 +284,7 @@ static void create_track(GtkPolarPlot * pv)
 
     for (i = 1; i < num - 1; i++)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(pv->pass->details, i));
+        detail = &pv->pass->details[i];
         if (detail->el >= 0.0)
             azel_to_xy(pv, detail->az, detail->el, &x, &y);
         pv->track_points[2 * i] = (gdouble)x;
@@ -393,7 +393,7 @@ static void update_track(GtkPolarPlot * pv)
         return;
 
     /* create points */
-    num = g_slist_length(pv->pass->details);
+    num = pv->pass->num_details;
 
     g_free(pv->track_points);
     pv->track_points = g_new(gdouble, num * 2);
@@ -414,7 +414,7 @@ static void update_track(GtkPolarPlot * pv)
 
     for (i = 1; i < num - 1; i++)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(pv->pass->details, i));
+        detail = &pv->pass->details[i];
         if (detail->el >= 0.0)
             azel_to_xy(pv, detail->az, detail->el, &x, &y);
         pv->track_points[2 * i] = (gdouble)x;
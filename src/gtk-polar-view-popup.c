@@ -189,6 +189,8 @@ static void track_toggled(GtkCheckMenuItem * item, gpointer data)
         /* delete sky track */
         gtk_polar_view_delete_track(pv, obj, sat);
     }
+
+    gtk_widget_queue_draw(pv->canvas);
 }
 
 #if 0
@@ -45,6 +45,13 @@
 /* extra size for line outside 0 deg circle (inside margin) */
 #define POLV_LINE_EXTRA 5
 
+/* Number of frames between repainted pixel reports */
+#define POLV_STAT_FRAMES 500
+
+/* Corners of the view for the info texts, see info_area() */
+#define INFO_RIGHT  1
+#define INFO_BOTTOM 2
+
 static void     update_sat(gpointer key, gpointer value, gpointer data);
 
 static GtkBoxClass *parent_class = NULL;
@@ -115,6 +122,24 @@ static void gtk_polar_view_destroy(GtkWidget * widget)
     g_free(polv->font);
     polv->font = NULL;
 
+    if (polv->layout)
+    {
+        g_object_unref(polv->layout);
+        polv->layout = NULL;
+    }
+
+    if (polv->font_desc)
+    {
+        pango_font_description_free(polv->font_desc);
+        polv->font_desc = NULL;
+    }
+
+    if (polv->dirty)
+    {
+        cairo_region_destroy(polv->dirty);
+        polv->dirty = NULL;
+    }
+
     if (polv->obj)
     {
         g_hash_table_destroy(polv->obj);
@@ -156,8 +181,7 @@ static void gtk_polar_view_init(GtkPolarView * polview,
     polview->sats = NULL;
     polview->qth = NULL;
     polview->obj = NULL;
-    polview->naos = 0.0;
-    polview->ncat = 0;
+    polview->events = NULL;
     polview->size = 0;
     polview->r = 0;
     polview->cx = 0;
@@ -176,6 +200,13 @@ static void gtk_polar_view_init(GtkPolarView * polview,
     polview->next_text = NULL;
     polview->sel_text = NULL;
     polview->font = NULL;
+    polview->layout = NULL;
+    polview->font_desc = NULL;
+    polview->dirty = NULL;
+    polview->dirty_all = TRUE;
+    polview->stat_pixels = 0;
+    polview->stat_frames = 0;
+    polview->stat_start = g_get_monotonic_time();
 }
 
 GType gtk_polar_view_get_type()
@@ -366,6 +397,153 @@ correct_pole_coor(GtkPolarView * polv, polar_view_pole_t pole,
     }
 }
 
+/** Get the layout used for all text, creating it if necessary */
+static PangoLayout *get_layout(GtkPolarView * polv)
+{
+    if (polv->layout == NULL)
+    {
+        polv->layout = gtk_widget_create_pango_layout(polv->canvas, NULL);
+        polv->font_desc = pango_font_description_from_string(polv->font ? polv->font : "Sans 9");
+        pango_layout_set_font_description(polv->layout, polv->font_desc);
+    }
+
+    return polv->layout;
+}
+
+/**
+ * Get the area of an info text.
+ *
+ * The text is left in the layout, ready to be drawn at the top left corner
+ * of the area. Texts on the right side are right aligned.
+ *
+ * @param polv The GtkPolarView widget.
+ * @param text The text.
+ * @param corner The corner of the view where the text is shown, a combination
+ *               of INFO_RIGHT and INFO_BOTTOM.
+ * @param rect Where the area is stored.
+ */
+static void info_area(GtkPolarView * polv, const gchar * text, gint corner,
+                      GdkRectangle * rect)
+{
+    PangoLayout    *layout = get_layout(polv);
+
+    pango_layout_set_alignment(layout, (corner & INFO_RIGHT) ?
+                               PANGO_ALIGN_RIGHT : PANGO_ALIGN_LEFT);
+    pango_layout_set_text(layout, text, -1);
+    pango_layout_get_pixel_size(layout, &rect->width, &rect->height);
+
+    if (corner & INFO_RIGHT)
+        rect->x = polv->cx + polv->r + 2 * POLV_LINE_EXTRA - rect->width;
+    else
+        rect->x = polv->cx - polv->r - 2 * POLV_LINE_EXTRA;
+
+    if (corner & INFO_BOTTOM)
+        rect->y = polv->cy + polv->r + POLV_LINE_EXTRA;
+    else
+        rect->y = polv->cy - polv->r - POLV_LINE_EXTRA - rect->height;
+}
+
+/** Mark a rectangle of the canvas as changed */
+static void invalidate_rect(GtkPolarView * polv, const GdkRectangle * rect)
+{
+    if (polv->dirty_all || rect->width <= 0 || rect->height <= 0)
+        return;
+
+    if (polv->dirty == NULL)
+        polv->dirty = cairo_region_create();
+    cairo_region_union_rectangle(polv->dirty, rect);
+}
+
+/** Mark the area of an info text as changed, see info_area() */
+static void invalidate_info(GtkPolarView * polv, const gchar * text,
+                            gint corner)
+{
+    GdkRectangle    rect;
+
+    if (text == NULL)
+        return;
+
+    info_area(polv, text, corner, &rect);
+    pango_layout_set_alignment(polv->layout, PANGO_ALIGN_LEFT);
+    invalidate_rect(polv, &rect);
+}
+
+/**
+ * Mark the marker and the label of a satellite as changed.
+ *
+ * Call it both before and after the satellite is moved. The sky track does
+ * not move with the satellite; whoever changes it marks the whole canvas.
+ */
+static void invalidate_sat(GtkPolarView * polv, sat_obj_t * obj)
+{
+    PangoLayout    *layout;
+    GdkRectangle    rect, label;
+
+    rect.x = (gint)floor(obj->x) - MARKER_SIZE_HALF - 1;
+    rect.y = (gint)floor(obj->y) - MARKER_SIZE_HALF - 1;
+    rect.width = 2 * MARKER_SIZE_HALF + 3;
+    rect.height = 2 * MARKER_SIZE_HALF + 3;
+
+    if (polv->satname && obj->nickname)
+    {
+        layout = get_layout(polv);
+        pango_layout_set_text(layout, obj->nickname, -1);
+        pango_layout_get_pixel_size(layout, &label.width, &label.height);
+        label.x = (gint)floor(obj->x - label.width / 2) - 1;
+        label.y = (gint)floor(obj->y) + 1;
+        label.width += 3;
+        label.height += 3;
+        gdk_rectangle_union(&rect, &label, &rect);
+    }
+
+    invalidate_rect(polv, &rect);
+}
+
+/** Queue the changed parts of the canvas for drawing */
+static void queue_dirty(GtkPolarView * polv)
+{
+    if (polv->dirty_all)
+        gtk_widget_queue_draw(polv->canvas);
+    else if (polv->dirty)
+        gtk_widget_queue_draw_region(polv->canvas, polv->dirty);
+
+    if (polv->dirty)
+    {
+        cairo_region_destroy(polv->dirty);
+        polv->dirty = NULL;
+    }
+    polv->dirty_all = FALSE;
+}
+
+/** Count the pixels drawn in a frame and log them every POLV_STAT_FRAMES frames */
+static void count_pixels(GtkPolarView * polv, cairo_t * cr)
+{
+    cairo_rectangle_list_t *clip;
+    gint64          now;
+    gint            i;
+
+    clip = cairo_copy_clip_rectangle_list(cr);
+    if (clip->status == CAIRO_STATUS_SUCCESS)
+        for (i = 0; i < clip->num_rectangles; i++)
+            polv->stat_pixels += (guint64)(clip->rectangles[i].width *
+                                           clip->rectangles[i].height);
+    cairo_rectangle_list_destroy(clip);
+
+    if (++polv->stat_frames < POLV_STAT_FRAMES)
+        return;
+
+    now = g_get_monotonic_time();
+    if (now > polv->stat_start)
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: %u frames, %.0f pixels/s"), __func__,
+                    polv->stat_frames,
+                    1.0e6 * polv->stat_pixels / (now - polv->stat_start));
+
+    polv->stat_pixels = 0;
+    polv->stat_frames = 0;
+    polv->stat_start = now;
+}
+
 static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
 {
     GtkPolarView   *polv = GTK_POLAR_VIEW(data);
@@ -373,7 +551,6 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
     gfloat          x, y;
     gboolean        anchor_south, anchor_east;
     PangoLayout    *layout;
-    PangoFontDescription *font_desc;
     gint            tw, th;
     GHashTableIter  iter;
     gpointer        key, value;
@@ -381,18 +558,20 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
     GSList         *node;
     gdouble        *point;
     guint           i;
+    GdkRectangle    rect;
 
     (void)widget;
 
+    count_pixels(polv, cr);
+
     /* Background */
     rgba_to_cairo(polv->col_bgd, &r, &g, &b, &a);
     cairo_set_source_rgba(cr, r, g, b, a);
     cairo_paint(cr);
 
     /* Set up font */
-    layout = pango_cairo_create_layout(cr);
-    font_desc = pango_font_description_from_string(polv->font ? polv->font : "Sans 9");
-    pango_layout_set_font_description(layout, font_desc);
+    layout = get_layout(polv);
+    pango_cairo_update_layout(cr, layout);
 
     /* Axis color for circles and lines */
     rgba_to_cairo(polv->col_axis, &r, &g, &b, &a);
@@ -474,9 +653,8 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
     {
         rgba_to_cairo(polv->col_info, &r, &g, &b, &a);
         cairo_set_source_rgba(cr, r, g, b, a);
-        pango_layout_set_text(layout, polv->curs_text, -1);
-        cairo_move_to(cr, polv->cx - polv->r - 2 * POLV_LINE_EXTRA,
-                      polv->cy + polv->r + POLV_LINE_EXTRA);
+        info_area(polv, polv->curs_text, INFO_BOTTOM, &rect);
+        cairo_move_to(cr, rect.x, rect.y);
         pango_cairo_show_layout(cr, layout);
     }
 
@@ -485,11 +663,8 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
     {
         rgba_to_cairo(polv->col_info, &r, &g, &b, &a);
         cairo_set_source_rgba(cr, r, g, b, a);
-        pango_layout_set_alignment(layout, PANGO_ALIGN_RIGHT);
-        pango_layout_set_text(layout, polv->next_text, -1);
-        pango_layout_get_pixel_size(layout, &tw, &th);
-        cairo_move_to(cr, polv->cx + polv->r + 2 * POLV_LINE_EXTRA - tw,
-                      polv->cy - polv->r - POLV_LINE_EXTRA - th);
+        info_area(polv, polv->next_text, INFO_RIGHT, &rect);
+        cairo_move_to(cr, rect.x, rect.y);
         pango_cairo_show_layout(cr, layout);
         pango_layout_set_alignment(layout, PANGO_ALIGN_LEFT);
     }
@@ -499,11 +674,8 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
     {
         rgba_to_cairo(polv->col_info, &r, &g, &b, &a);
         cairo_set_source_rgba(cr, r, g, b, a);
-        pango_layout_set_alignment(layout, PANGO_ALIGN_RIGHT);
-        pango_layout_set_text(layout, polv->sel_text, -1);
-        pango_layout_get_pixel_size(layout, &tw, &th);
-        cairo_move_to(cr, polv->cx + polv->r + 2 * POLV_LINE_EXTRA - tw,
-                      polv->cy + polv->r + POLV_LINE_EXTRA);
+        info_area(polv, polv->sel_text, INFO_RIGHT | INFO_BOTTOM, &rect);
+        cairo_move_to(cr, rect.x, rect.y);
         pango_cairo_show_layout(cr, layout);
         pango_layout_set_alignment(layout, PANGO_ALIGN_LEFT);
     }
@@ -590,9 +762,6 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
         }
     }
 
-    pango_font_description_free(font_desc);
-    g_object_unref(layout);
-
     return FALSE;
 }
 
@@ -730,6 +899,7 @@ static gboolean on_motion_notify(GtkWidget *widget, GdkEventMotion *event, gpoin
     if (polv->cursinfo)
     {
         xy_to_azel(polv, event->x, event->y, &az, &el);
+        invalidate_info(polv, polv->curs_text, INFO_BOTTOM);
 
         if (el > 0.0)
         {
@@ -742,7 +912,8 @@ static gboolean on_motion_notify(GtkWidget *widget, GdkEventMotion *event, gpoin
             polv->curs_text = NULL;
         }
 
-        gtk_widget_queue_draw(polv->canvas);
+        invalidate_info(polv, polv->curs_text, INFO_BOTTOM);
+        queue_dirty(polv);
     }
 
     return TRUE;
@@ -764,7 +935,8 @@ static void on_canvas_realized(GtkWidget * canvas, gpointer data)
     size_allocate_cb(canvas, &aloc, data);
 }
 
-GtkWidget *gtk_polar_view_new(GKeyFile * cfgdata, GHashTable * sats, qth_t * qth)
+GtkWidget *gtk_polar_view_new(GKeyFile * cfgdata, GHashTable * sats,
+                              qth_t * qth, event_heap_t * events)
 {
     GtkPolarView   *polv;
     GValue          font_value = G_VALUE_INIT;
@@ -774,6 +946,7 @@ GtkWidget *gtk_polar_view_new(GKeyFile * cfgdata, GHashTable * sats, qth_t * qth
     polv->cfgdata = cfgdata;
     polv->sats = sats;
     polv->qth = qth;
+    polv->events = events;
 
     polv->obj = g_hash_table_new_full(g_int_hash, g_int_equal, g_free, free_sat_obj);
     polv->showtracks_on = g_hash_table_new_full(g_int_hash, g_int_equal, g_free, NULL);
@@ -880,6 +1053,7 @@ static void update_polv_size(GtkPolarView * polv)
         polv->r = (polv->size / 2) - POLV_DEFAULT_MARGIN;
         polv->cx = allocation.width / 2;
         polv->cy = allocation.height / 2;
+        polv->dirty_all = TRUE;
 
         /* Update satellite positions */
         g_hash_table_foreach(polv->sats, update_sat, polv);
@@ -918,11 +1092,11 @@ static gchar *los_time_to_str(GtkPolarView * polv, sat_t * sat)
 void gtk_polar_view_update(GtkWidget * widget)
 {
     GtkPolarView   *polv = GTK_POLAR_VIEW(widget);
-    gdouble         number, now;
+    gdouble         number;
     gchar          *buff;
     guint           h, m, s;
     sat_t          *sat = NULL;
-    gint           *catnr;
+    sat_event_t     next;
 
     if (polv->resize)
     {
@@ -940,8 +1114,6 @@ void gtk_polar_view_update(GtkWidget * widget)
     {
         /* reset data */
         polv->counter = 1;
-        polv->naos = 0.0;
-        polv->ncat = 0;
 
         /* update sats */
         g_hash_table_foreach(polv->sats, update_sat, polv);
@@ -949,46 +1121,37 @@ void gtk_polar_view_update(GtkWidget * widget)
         /* update countdown to NEXT AOS label */
         if (polv->eventinfo)
         {
-            if (polv->ncat > 0)
-            {
-                catnr = g_try_new0(gint, 1);
-                *catnr = polv->ncat;
-                sat = SAT(g_hash_table_lookup(polv->sats, catnr));
-                g_free(catnr);
+            invalidate_info(polv, polv->next_text, INFO_RIGHT);
 
-                if (sat != NULL)
-                {
-                    now = polv->tstamp;
-                    number = polv->naos - now;
-
-                    s = (guint) (number * 86400);
-                    h = (guint) floor(s / 3600);
-                    s -= 3600 * h;
-                    m = (guint) floor(s / 60);
-                    s -= 60 * m;
-
-                    if (h > 0)
-                        buff = g_strdup_printf(_("Next: %s\nin %02d:%02d:%02d"),
-                                               sat->nickname, h, m, s);
-                    else
-                        buff = g_strdup_printf(_("Next: %s\nin %02d:%02d"),
-                                               sat->nickname, m, s);
-
-                    g_free(polv->next_text);
-                    polv->next_text = buff;
-                }
+            if (event_heap_next(polv->events, polv->tstamp, SAT_EVENT_AOS,
+                                &next, 1) > 0)
+            {
+                sat = next.sat;
+                number = next.time - polv->tstamp;
+
+                s = (guint) (number * 86400);
+                h = (guint) floor(s / 3600);
+                s -= 3600 * h;
+                m = (guint) floor(s / 60);
+                s -= 60 * m;
+
+                if (h > 0)
+                    buff = g_strdup_printf(_("Next: %s\nin %02d:%02d:%02d"),
+                                           sat->nickname, h, m, s);
                 else
-                {
-                    sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Can not find NEXT satellite."), __func__);
-                    g_free(polv->next_text);
-                    polv->next_text = g_strdup(_("Next: ERR"));
-                }
+                    buff = g_strdup_printf(_("Next: %s\nin %02d:%02d"),
+                                           sat->nickname, m, s);
+
+                g_free(polv->next_text);
+                polv->next_text = buff;
             }
             else
             {
                 g_free(polv->next_text);
                 polv->next_text = g_strdup(_("Next: N/A"));
             }
+
+            invalidate_info(polv, polv->next_text, INFO_RIGHT);
         }
         else
         {
@@ -996,7 +1159,7 @@ void gtk_polar_view_update(GtkWidget * widget)
             polv->next_text = NULL;
         }
 
-        gtk_widget_queue_draw(polv->canvas);
+        queue_dirty(polv);
     }
 }
 
@@ -1022,16 +1185,6 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
 
     now = polv->tstamp;
 
-    /* update next AOS */
-    if (sat->aos > now)
-    {
-        if ((sat->aos < polv->naos) || (polv->naos == 0.0))
-        {
-            polv->naos = sat->aos;
-            polv->ncat = sat->tle.catnr;
-        }
-    }
-
     /* if sat is out of range */
     if ((sat->el < 0.00) || decayed(sat))
     {
@@ -1044,10 +1197,16 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
              */
             if (obj->selected)
             {
+                invalidate_info(polv, polv->sel_text, INFO_RIGHT | INFO_BOTTOM);
                 g_free(polv->sel_text);
                 polv->sel_text = NULL;
             }
 
+            if (obj->showtrack && obj->track_points)
+                polv->dirty_all = TRUE;
+            else
+                invalidate_sat(polv, obj);
+
             /* remove sat object from hash table (this will free it) */
             g_hash_table_remove(polv->obj, catnum);
         }
@@ -1063,6 +1222,8 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         if (obj != NULL)
         {
             /* update existing satellite */
+            invalidate_sat(polv, obj);
+
             obj->x = x;
             obj->y = y;
 
@@ -1070,6 +1231,8 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
             g_free(obj->nickname);
             obj->nickname = g_strdup(sat->nickname);
 
+            invalidate_sat(polv, obj);
+
             /* update LOS count down */
             if (sat->los > 0.0)
                 losstr = los_time_to_str(polv, sat);
@@ -1084,8 +1247,10 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
             /* update selection info */
             if (obj->selected)
             {
+                invalidate_info(polv, polv->sel_text, INFO_RIGHT | INFO_BOTTOM);
                 g_free(polv->sel_text);
                 polv->sel_text = g_strdup_printf("%s\n%s", sat->nickname, losstr);
+                invalidate_info(polv, polv->sel_text, INFO_RIGHT | INFO_BOTTOM);
             }
 
             /* Check if pass needs update */
@@ -1113,6 +1278,8 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
                     /* Recreate track if needed */
                     if (obj->showtrack && obj->pass)
                         gtk_polar_view_create_track(polv, obj, sat);
+
+                    polv->dirty_all = TRUE;
                 }
             }
 
@@ -1154,7 +1321,14 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
 
                 /* create the sky track if necessary */
                 if (obj->showtrack)
+                {
                     gtk_polar_view_create_track(polv, obj, sat);
+                    polv->dirty_all = TRUE;
+                }
+                else
+                {
+                    invalidate_sat(polv, obj);
+                }
             }
             else
             {
@@ -1195,7 +1369,7 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj, sat_t * sat
     obj->track_points = NULL;
 
     /* Create points */
-    num = g_slist_length(obj->pass->details);
+    num = obj->pass->num_details;
     if (num == 0)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s:%d: Pass had no points in it."), __FILE__, __LINE__);
@@ -1210,7 +1384,7 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj, sat_t * sat
     point = g_new(gdouble, 2);
     point[0] = x;
     point[1] = y;
-    obj->track_points = g_slist_append(obj->track_points, point);
+    obj->track_points = g_slist_prepend(obj->track_points, point);
 
     /* first time tick */
     obj->trtick[0].x = x;
@@ -1221,14 +1395,14 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj, sat_t * sat
 
     for (i = 1; i < num - 1; i++)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(obj->pass->details, i));
+        detail = &obj->pass->details[i];
         if (detail->el >= 0.0)
             azel_to_xy(pv, detail->az, detail->el, &x, &y);
 
         point = g_new(gdouble, 2);
         point[0] = x;
         point[1] = y;
-        obj->track_points = g_slist_append(obj->track_points, point);
+        obj->track_points = g_slist_prepend(obj->track_points, point);
 
         if (tres != 0 && !(i % tres))
         {
@@ -1253,7 +1427,10 @@ void gtk_polar_view_create_track(GtkPolarView * pv, sat_obj_t * obj, sat_t * sat
     point = g_new(gdouble, 2);
     point[0] = x;
     point[1] = y;
-    obj->track_points = g_slist_append(obj->track_points, point);
+    obj->track_points = g_slist_prepend(obj->track_points, point);
+
+    /* the points were prepended */
+    obj->track_points = g_slist_reverse(obj->track_points);
 }
 
 void gtk_polar_view_delete_track(GtkPolarView * pv, sat_obj_t * obj, sat_t * sat)
@@ -1274,8 +1451,6 @@ void gtk_polar_view_delete_track(GtkPolarView * pv, sat_obj_t * obj, sat_t * sat
 void gtk_polar_view_reload_sats(GtkWidget * polv, GHashTable * sats)
 {
     GTK_POLAR_VIEW(polv)->sats = sats;
-    GTK_POLAR_VIEW(polv)->naos = 0.0;
-    GTK_POLAR_VIEW(polv)->ncat = 0;
 }
 
 void gtk_polar_view_select_sat(GtkWidget * widget, gint catnum)
@@ -6,6 +6,7 @@
 #include <gdk/gdk.h>
 #include <gtk/gtk.h>
 
+#include "event-heap.h"
 #include "gtk-sat-data.h"
 #include "predict-tools.h"
 
@@ -94,14 +95,12 @@ struct _GtkPolarView {
     GHashTable     *showtracks_on;
     GHashTable     *showtracks_off;
 
-    gdouble         naos;       /*!< Next event time */
-    gint            ncat;       /*!< Next event catnum */
-
     gdouble         tstamp;     /*!< Time stamp for calculations; set by GtkSatModule */
 
     GKeyFile       *cfgdata;    /*!< module configuration data */
     GHashTable     *sats;       /*!< Satellites. */
     qth_t          *qth;        /*!< Pointer to current location. */
+    event_heap_t   *events;     /*!< Upcoming events (owned by parent GtkSatModule). */
 
     GHashTable     *obj;        /*!< Satellite objects (sat_obj_t) for each visible satellite */
 
@@ -125,6 +124,16 @@ struct _GtkPolarView {
     gboolean        resize;     /*!< Flag indicating that the view has been resized. */
 
     gchar          *font;       /*!< Default font name */
+    PangoLayout    *layout;     /*!< Layout for all text, created when first needed */
+    PangoFontDescription *font_desc;    /*!< Font of the layout */
+
+    /* Parts of the canvas that need to be drawn again */
+    cairo_region_t *dirty;      /*!< Changed areas, or NULL */
+    gboolean        dirty_all;  /*!< The whole canvas has changed */
+
+    guint64         stat_pixels;        /*!< Number of pixels drawn */
+    guint           stat_frames;        /*!< Number of frames drawn */
+    gint64          stat_start; /*!< Start of the statistics [usec] */
 };
 
 struct _GtkPolarViewClass {
@@ -135,7 +144,8 @@ struct _GtkPolarViewClass {
 GType           gtk_polar_view_get_type(void);
 
 GtkWidget      *gtk_polar_view_new(GKeyFile * cfgdata,
-                                   GHashTable * sats, qth_t * qth);
+                                   GHashTable * sats, qth_t * qth,
+                                   event_heap_t * events);
 void            gtk_polar_view_update(GtkWidget * widget);
 void            gtk_polar_view_reconf(GtkWidget * widget, GKeyFile * cfgdat);
 void            gtk_polar_view_reload_sats(GtkWidget * polv,
@@ -215,7 +215,7 @@ static gboolean is_flipped_pass(pass_t * pass, rot_az_type_t type,
     pass_detail_t  *detail;
     gboolean        retval = FALSE;
 
-    num = g_slist_length(pass->details);
+    num = pass->num_details;
     if (type == ROT_AZ_TYPE_360)
     {
         min_az = 0;
@@ -249,7 +249,7 @@ static gboolean is_flipped_pass(pass_t * pass, rot_az_type_t type,
     {
         for (i = 1; i < num - 1; i++)
         {
-            detail = PASS_DETAIL(g_slist_nth_data(pass->details, i));
+            detail = &pass->details[i];
             caz = detail->az;
 
             while (caz > max_az)
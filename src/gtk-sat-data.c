@@ -28,6 +28,7 @@
 
 #include <glib.h>
 #include <glib/gi18n.h>
+#include <string.h>
 #include "sgpsdp/sgp4sdp4.h"
 #include "gtk-sat-data.h"
 #include "sat-log.h"
@@ -334,6 +335,32 @@ void gtk_sat_data_copy_sat(const sat_t * source, sat_t * dest, qth_t * qth)
     gtk_sat_data_init_sat(dest, qth);
 }
 
+/**
+ * Duplicate satellite data.
+ *
+ * @param source Pointer to the satellite to duplicate.
+ * @return A new satellite that must be freed with gtk_sat_data_free_sat().
+ *
+ * Unlike gtk_sat_data_copy_sat(), this does not start over from the TLE but
+ * copies the whole structure, including the converted elements, the
+ * propagator state and the current position. Only the strings are
+ * duplicated. The copy therefore propagates exactly like the source, e.g.
+ * when it is handed to a worker thread.
+ */
+sat_t          *gtk_sat_data_dup_sat(const sat_t * source)
+{
+    sat_t          *dest;
+
+    g_return_val_if_fail(source != NULL, NULL);
+
+    dest = memcpy(g_new(sat_t, 1), source, sizeof(sat_t));
+    dest->name = g_strdup(source->name);
+    dest->nickname = g_strdup(source->nickname);
+    dest->website = g_strdup(source->website);
+
+    return dest;
+}
+
 /**
  * Free satellite data
  *
@@ -28,6 +28,8 @@
  * @note The ground track functions should only be called from gtk-sat-map.c
  *       and gtk-sat-map-popup.c.
  *
+ * The ground tracks are calculated in a worker thread on a copy of the
+ * satellite, and are swapped in when they are ready.
  */
 #ifdef HAVE_CONFIG_H
 #include <build-config.h>
@@ -35,8 +37,10 @@
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
 #include <math.h>
+#include <string.h>
 
 #include "config-keys.h"
+#include "gtk-sat-data.h"
 #include "gtk-sat-map.h"
 #include "gtk-sat-map-ground-track.h"
 #include "mod-cfg-get-param.h"
@@ -46,17 +50,61 @@
 #include "sat-log.h"
 #include "sgpsdp/sgp4sdp4.h"
 
+/* Number of ground track points calculated at once */
+#define TRACK_CHUNK 64
 
-/** Structure to hold line segment data */
+/* Time step between ground track points (30 sec) */
+#define TRACK_STEP  0.00035
+
+/** Map geometry, copied so that the polylines can be created in a worker. */
+typedef struct {
+    gdouble         x0;
+    gdouble         y0;
+    gdouble         width;
+    gdouble         height;
+    gdouble         left_side_lon;
+} track_geom_t;
+
+/** State of a ground track calculation, see ground_track_start(). */
 typedef struct {
-    gdouble        *points;     /*!< Array of x,y coordinate pairs */
-    gint            count;      /*!< Number of points in this segment */
-} line_segment_t;
-
-static void     create_polylines(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
-                                 sat_map_obj_t * obj);
-static gboolean ssp_wrap_detected(GtkSatMap * satmap, gdouble x1, gdouble x2);
-static void     free_ssp(gpointer ssp, gpointer data);
+    GtkSatMap      *satmap;
+    sat_map_obj_t  *obj;
+    sat_t          *sat;        /* private copy of the satellite */
+    qth_t           qth;        /* copy of the QTH position */
+    track_geom_t    geom;       /* map geometry for the polylines */
+    gdouble         tstamp;     /* time of the map */
+    guint           num_orbits; /* number of orbits in the ground track */
+    long            orbit;      /* orbit to add, or 0 to create the track */
+    gdouble         start;      /* start time of the orbit to add */
+} track_job_t;
+
+static void     ground_track_start(GtkSatMap * satmap, sat_t * sat,
+                                   qth_t * qth, sat_map_obj_t * obj,
+                                   long orbit);
+static void     ground_track_thread(GTask * task, gpointer source,
+                                    gpointer data,
+                                    GCancellable * cancellable);
+static void     ground_track_ready(GObject * source, GAsyncResult * result,
+                                   gpointer data);
+static void     track_job_free(gpointer data);
+static gboolean track_calc(track_job_t * job, ground_track_t * track,
+                           GCancellable * cancellable);
+static gboolean orbit_calc(sat_t * sat, qth_t * qth,
+                           ground_track_orbit_t * orb, long orbit,
+                           gdouble start, gdouble * end);
+static void     orbit_free(ground_track_orbit_t * orb, gboolean clear_ssp);
+static void     orbit_dirty(sat_map_obj_t * obj,
+                            const ground_track_orbit_t * orb);
+static void     track_free(gpointer track);
+static void     track_geom_init(track_geom_t * geom, GtkSatMap * satmap);
+static gboolean track_geom_equal(const track_geom_t * a,
+                                 const track_geom_t * b);
+static void     create_polylines(const track_geom_t * geom,
+                                 ground_track_orbit_t * orb);
+static void     add_line_segment(ground_track_orbit_t * orb,
+                                 const gdouble * points, guint num);
+static gboolean ssp_wrap_detected(const track_geom_t * geom, gdouble x1,
+                                  gdouble x2);
 static void     free_line_segment(gpointer data);
 
 
@@ -72,109 +120,389 @@ static void     free_line_segment(gpointer data);
  * ahead. Therefore, the resulting ground track may cross the map boundaries many
  * times, and using one single polyline for the whole ground track would look very
  * silly. To avoid this, the points will be split into several polylines.
+ *
+ * The ground track is calculated in a worker thread, and replaces the
+ * current one of obj, if any, when it is ready.
  */
 void ground_track_create(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
                          sat_map_obj_t * obj)
 {
-    long            this_orbit; /* current orbit number */
-    long            max_orbit;  /* target orbit number, ie. this + num - 1 */
-    double          t0;         /* time when this_orbit starts */
-    double          t;
-    ssp_t          *this_ssp;
-
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
                 _("%s: Creating ground track for %s"),
                 __func__, sat->nickname);
 
-    /* just to be safe... if empty GSList is not NULL => segfault */
-    obj->track_data.latlon = NULL;
+    ground_track_start(satmap, sat, qth, obj, 0);
+}
+
+/**
+ * Start the calculation of a ground track in a worker thread.
+ *
+ * @param satmap The satellite map widget.
+ * @param sat Pointer to the satellite object.
+ * @param qth Pointer to the QTH data.
+ * @param obj the satellite object.
+ * @param orbit The orbit to add to the ground track, or 0 to calculate all.
+ *
+ * The satellite and the QTH position are copied, so the worker does not
+ * touch the live data. A pending calculation for obj is cancelled.
+ */
+static void ground_track_start(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
+                               sat_map_obj_t * obj, long orbit)
+{
+    GTask          *task;
+    track_job_t    *job;
+
+    if (obj->track_job != NULL)
+    {
+        g_cancellable_cancel(obj->track_job);
+        g_clear_object(&obj->track_job);
+    }
+
+    job = g_new0(track_job_t, 1);
+    job->satmap = satmap;
+    job->obj = obj;
+    job->qth.lat = qth->lat;
+    job->qth.lon = qth->lon;
+    job->qth.alt = qth->alt;
+    job->sat = gtk_sat_data_dup_sat(sat);
+    track_geom_init(&job->geom, satmap);
+    job->tstamp = satmap->tstamp;
+    job->num_orbits = MAX(1, mod_cfg_get_int(satmap->cfgdata,
+                                             MOD_CFG_MAP_SECTION,
+                                             MOD_CFG_MAP_TRACK_NUM,
+                                             SAT_CFG_INT_MAP_TRACK_NUM));
+    job->orbit = orbit;
+    job->start = obj->track_data.t_end;
+
+    obj->track_job = g_cancellable_new();
+
+    task = g_task_new(NULL, obj->track_job, ground_track_ready, NULL);
+    g_task_set_source_tag(task, ground_track_start);
+    g_task_set_task_data(task, job, track_job_free);
+    g_task_run_in_thread(task, ground_track_thread);
+    g_object_unref(task);
+}
+
+static void track_job_free(gpointer data)
+{
+    track_job_t    *job = data;
+
+    gtk_sat_data_free_sat(job->sat);
+    g_free(job);
+}
+
+/**
+ * Worker thread of ground_track_start().
+ *
+ * Returns a ground_track_t with either the whole ground track, or the
+ * orbit to add, including its polylines. NULL is returned if the ground
+ * track could not be calculated.
+ */
+static void ground_track_thread(GTask * task, gpointer source, gpointer data,
+                                GCancellable * cancellable)
+{
+    track_job_t    *job = data;
+    ground_track_t *track;
+    gboolean        ok;
+    guint           i;
+
+    (void)source;
+
+    track = g_new0(ground_track_t, 1);
+
+    if (job->orbit == 0)
+    {
+        ok = track_calc(job, track, cancellable);
+    }
+    else
+    {
+        track->orbits = g_new0(ground_track_orbit_t, 1);
+        track->size = 1;
+        ok = orbit_calc(job->sat, &job->qth, &track->orbits[0], job->orbit,
+                        job->start, &track->t_end);
+        track->count = 1;
+    }
+
+    if (!ok)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Problem computing ground track for %s"),
+                    __func__, job->sat->nickname);
+        track_free(track);
+        g_task_return_pointer(task, NULL, NULL);
+        return;
+    }
+
+    if (g_task_return_error_if_cancelled(task))
+    {
+        track_free(track);
+        return;
+    }
+
+    /* split points into polylines */
+    for (i = 0; i < track->count; i++)
+        create_polylines(&job->geom, &track->orbits[i]);
+
+    g_task_return_pointer(task, track, track_free);
+}
+
+/**
+ * Swap in a ground track calculated by ground_track_thread().
+ *
+ * This runs in the main loop. If the calculation has been cancelled, obj
+ * may have been freed, so nothing is done. The polylines are created
+ * again if the map has been resized in the meantime.
+ */
+static void ground_track_ready(GObject * source, GAsyncResult * result,
+                               gpointer data)
+{
+    track_job_t    *job = g_task_get_task_data(G_TASK(result));
+    sat_map_obj_t  *obj;
+    ground_track_t *track;
+    ground_track_orbit_t *orb;
+    track_geom_t    geom;
+    GError         *error = NULL;
+    guint           i;
+
+    (void)source;
+    (void)data;
+
+    track = g_task_propagate_pointer(G_TASK(result), &error);
+    if (error != NULL)
+    {
+        g_clear_error(&error);
+        return;
+    }
+
+    obj = job->obj;
+    g_clear_object(&obj->track_job);
+
+    if (track == NULL)
+    {
+        /* try again at the next update */
+        ground_track_delete(job->satmap, job->sat, NULL, obj, TRUE);
+        return;
+    }
+
+    track_geom_init(&geom, job->satmap);
+    if (!track_geom_equal(&geom, &job->geom))
+    {
+        for (i = 0; i < track->count; i++)
+        {
+            orbit_free(&track->orbits[i], FALSE);
+            create_polylines(&geom, &track->orbits[i]);
+        }
+    }
+
+    if (job->orbit == 0)
+    {
+        /* replace the whole ground track */
+        ground_track_delete(job->satmap, job->sat, NULL, obj, TRUE);
+        obj->track_data = *track;
+        obj->track_orbit = track->orbits[0].orbit;
+        g_free(track);
+        for (i = 0; i < obj->track_data.count; i++)
+            orbit_dirty(obj, &obj->track_data.orbits[i]);
+    }
+    else if ((obj->track_data.count == obj->track_data.size) &&
+             (obj->track_data.orbits[obj->track_data.first].orbit +
+              obj->track_data.size == job->orbit))
+    {
+        /* the oldest orbit becomes the newest */
+        orb = &obj->track_data.orbits[obj->track_data.first];
+        orbit_dirty(obj, orb);
+        orbit_free(orb, TRUE);
+        *orb = track->orbits[0];
+        orbit_dirty(obj, orb);
+        obj->track_data.first =
+            (obj->track_data.first + 1) % obj->track_data.size;
+        obj->track_data.t_end = track->t_end;
+        obj->track_orbit = job->orbit - obj->track_data.size + 1;
+        g_free(track->orbits);
+        g_free(track);
+    }
+    else
+    {
+        /* the ground track has changed; create it at the next update */
+        track_free(track);
+        obj->track_orbit = 0;
+    }
+
+    /* redraw the changed segments */
+    if (job->satmap->canvas)
+    {
+        gtk_sat_map_queue_sat(job->satmap, obj);
+    }
+}
 
-    /* get configuration parameters */
+/**
+ * Calculate all orbits of a ground track.
+ *
+ * @param job The ground track job.
+ * @param track The ground track to fill; must be empty.
+ * @param cancellable The cancellable of the job.
+ * @return TRUE if the ground track has been calculated.
+ */
+static gboolean track_calc(track_job_t * job, ground_track_t * track,
+                           GCancellable * cancellable)
+{
+    sat_t          *sat = job->sat;
+    long            this_orbit; /* current orbit number */
+    double          t0;         /* time when this_orbit starts */
+    double          t;
+    pass_detail_t   points[TRACK_CHUNK];
+    guint           i;
+    gboolean        done;
+
+    track->orbits = g_new0(ground_track_orbit_t, job->num_orbits);
+    track->size = job->num_orbits;
+
+    predict_calc(sat, &job->qth, job->tstamp);
     this_orbit = sat->orbit;
-    max_orbit = sat->orbit - 1 + mod_cfg_get_int(satmap->cfgdata,
-                                                 MOD_CFG_MAP_SECTION,
-                                                 MOD_CFG_MAP_TRACK_NUM,
-                                                 SAT_CFG_INT_MAP_TRACK_NUM);
 
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
                 _("%s: Start orbit: %d"), __func__, this_orbit);
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                _("%s: End orbit %d"), __func__, max_orbit);
+                _("%s: End orbit %d"), __func__,
+                this_orbit + job->num_orbits - 1);
 
     /* find the time when the current orbit started */
 
     /* Iterate backwards in time until we reach sat->orbit < this_orbit.
-       Use predict_calc from predict-tools.c as SGP/SDP driver.
+       The times are calculated TRACK_CHUNK at a time with
+       predict_calc_series from predict-tools.c.
        As a built-in safety, we stop iteration if the orbit crossing is
        more than 24 hours back in time.
      */
-    t0 = satmap->tstamp;        //get_current_daynum ();
+    t0 = job->tstamp;
+    t = t0;
+    done = FALSE;
     /* use == instead of >= as it is more robust */
-    for (t = t0; (sat->orbit == this_orbit) && ((t + 1.0) > t0); t -= 0.0007)
-        predict_calc(sat, qth, t);
+    while (!done && ((t + 1.0) > t0))
+    {
+        predict_calc_series(sat, &job->qth, t, -0.0007, TRACK_CHUNK, points);
+        for (i = 0; i < TRACK_CHUNK && ((t + 1.0) > t0); i++)
+        {
+            t = points[i].time - 0.0007;
+            if (points[i].orbit != this_orbit)
+            {
+                done = TRUE;
+                break;
+            }
+        }
+    }
 
     /* set it so that we are in the same orbit as this_orbit
        and not a different one */
     t += 2 * 0.0007;
     t0 = t;
-    predict_calc(sat, qth, t0);
 
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                _("%s: T0: %f (%d)"), __func__, t0, sat->orbit);
+                _("%s: T0: %f"), __func__, t0);
 
-    /* calculate (lat,lon) for the required orbits */
-    while ((sat->orbit <= max_orbit) &&
-           (sat->orbit >= this_orbit) && (!decayed(sat)))
+    /* calculate (lat,lon) for the required orbits; each one starts
+       where the previous one ended */
+    for (i = 0; i < track->size; i++)
     {
-        /* We use 30 sec time steps. If resolution is too fine, the
-           line drawing routine will filter out unnecessary points
-         */
-        t += 0.00035;
-        predict_calc(sat, qth, t);
+        if (g_cancellable_is_cancelled(cancellable))
+            return TRUE;
 
-        /* store this SSP */
+        if (!orbit_calc(sat, &job->qth, &track->orbits[i], this_orbit + i,
+                        t, &t))
+            return FALSE;
+
+        track->count++;
+    }
+    track->t_end = t;
 
-        /* Note: g_slist_append() has to traverse the entire list to find the end, which
-           is inefficient when adding multiple elements. Therefore, we use g_slist_prepend()
-           and reverse the entire list when we are done.
-         */
-        this_ssp = g_try_new(ssp_t, 1);
+    return TRUE;
+}
+
+/**
+ * Calculate the ground track of one orbit.
+ *
+ * @param sat Pointer to the satellite object.
+ * @param qth Pointer to the QTH data.
+ * @param orb The orbit to fill; must be empty.
+ * @param orbit The orbit number.
+ * @param start The time of the first SSP, which must be in the orbit.
+ * @param end Set to the time of the last SSP.
+ * @return TRUE if the orbit has been calculated, FALSE if the satellite
+ *         decayed or left the orbit in the wrong direction.
+ *
+ * The SSPs are calculated in steps of TRACK_STEP until and including the
+ * first SSP of the next orbit, which is where the next orbit starts.
+ */
+static gboolean orbit_calc(sat_t * sat, qth_t * qth,
+                           ground_track_orbit_t * orb, long orbit,
+                           gdouble start, gdouble * end)
+{
+    pass_detail_t   points[TRACK_CHUNK];
+    GArray         *ssps;
+    ssp_t           ssp;
+    long            last = orbit;
+    guint           i;
+    gboolean        done = FALSE;
 
-        if (this_ssp == NULL)
+    ssps = g_array_sized_new(FALSE, FALSE, sizeof(ssp_t), 256);
+
+    while (!done)
+    {
+        predict_calc_series(sat, qth, start + ssps->len * TRACK_STEP,
+                            TRACK_STEP, TRACK_CHUNK, points);
+
+        for (i = 0; i < TRACK_CHUNK && !done; i++)
         {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: MAYDAY: Insufficient memory for ground track!"),
-                        __func__);
-            return;
+            ssp.lat = points[i].lat;
+            ssp.lon = points[i].lon;
+            g_array_append_val(ssps, ssp);
+
+            /* decayed() looks at the time in sat */
+            sat->jul_utc = points[i].time;
+            last = points[i].orbit;
+            done = (last != orbit) || decayed(sat);
         }
+    }
 
-        this_ssp->lat = sat->ssplat;
-        this_ssp->lon = sat->ssplon;
-        obj->track_data.latlon =
-            g_slist_prepend(obj->track_data.latlon, this_ssp);
+    orb->orbit = orbit;
+    orb->num = ssps->len;
+    orb->ssp = (ssp_t *) g_array_free(ssps, FALSE);
+    orb->lines = NULL;
+    *end = sat->jul_utc;
 
-    }
-    /* log if there is a problem with the orbit calculation */
-    if (sat->orbit != (max_orbit + 1))
+    return (last == orbit + 1);
+}
+
+/**
+ * Free the data of one orbit.
+ *
+ * @param orb The orbit.
+ * @param clear_ssp Flag indicating whether the SSPs should be freed as well.
+ */
+static void orbit_free(ground_track_orbit_t * orb, gboolean clear_ssp)
+{
+    g_slist_free_full(orb->lines, free_line_segment);
+    orb->lines = NULL;
+
+    if (clear_ssp == TRUE)
     {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Problem computing ground track for %s"),
-                    __func__, sat->nickname);
-        return;
+        g_free(orb->ssp);
+        orb->ssp = NULL;
+        orb->num = 0;
     }
+}
 
-    /* Reset satellite structure to eliminate glitches in single sat 
-       view and other places when new ground track is laid out */
-    predict_calc(sat, qth, satmap->tstamp);
-
-    /* reverse GSList */
-    obj->track_data.latlon = g_slist_reverse(obj->track_data.latlon);
+/** Free a ground_track_t returned by ground_track_thread() */
+static void track_free(gpointer track)
+{
+    ground_track_t *t = track;
+    guint           i;
 
-    /* split points into polylines */
-    create_polylines(satmap, sat, qth, obj);
+    for (i = 0; i < t->size; i++)
+        orbit_free(&t->orbits[i], TRUE);
 
-    /* misc book-keeping */
-    obj->track_orbit = this_orbit;
+    g_free(t->orbits);
+    g_free(t);
 }
 
 /**
@@ -187,19 +515,26 @@ void ground_track_create(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
  * @param recalc Flag indicating whether ground track should be recalculated.
  *
  *    If (recalc=TRUE)
- *       call ground_track_delete (clear_ssp=TRUE)
- *       call ground_track_create
+ *       if the satellite has entered the next orbit
+ *          calculate the orbit after the last one in the background
+ *       else
+ *          calculate the whole ground track in the background
  *    Else
  *       call ground_track_delete (clear_ssp=FALSE)
- *       call create_polylines
+ *       call create_polylines for each orbit
  *
  *
  * The purpose with the recalc flag is to allow updates of ground track look without having
- * to recalculate the whole ground track (recalc=FALSE). 
+ * to recalculate the whole ground track (recalc=FALSE). While a calculation
+ * is pending, the current ground track is kept and recalc=TRUE does nothing.
  */
 void ground_track_update(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
                          sat_map_obj_t * obj, gboolean recalc)
 {
+    ground_track_t *track = &obj->track_data;
+    track_geom_t    geom;
+    guint           i;
+
     sat_log_log(SAT_LOG_LEVEL_DEBUG,
                 _("%s: Updating ground track for %s"),
                 __func__, sat->nickname);
@@ -212,13 +547,76 @@ void ground_track_update(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
 
     if (recalc == TRUE)
     {
-        ground_track_delete(satmap, sat, qth, obj, TRUE);
-        ground_track_create(satmap, sat, qth, obj);
+        if (obj->track_job != NULL)
+            return;
+
+        if ((track->orbits != NULL) && (track->count == track->size) &&
+            (sat->orbit == obj->track_orbit + 1))
+        {
+            sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                        _("%s: Extending ground track for %s"),
+                        __func__, sat->nickname);
+            ground_track_start(satmap, sat, qth, obj,
+                               track->orbits[track->first].orbit +
+                               track->size);
+        }
+        else
+        {
+            ground_track_create(satmap, sat, qth, obj);
+        }
     }
     else
     {
         ground_track_delete(satmap, sat, qth, obj, FALSE);
-        create_polylines(satmap, sat, qth, obj);
+        track_geom_init(&geom, satmap);
+        for (i = 0; i < track->count; i++)
+        {
+            create_polylines(&geom, &track->orbits[i]);
+            orbit_dirty(obj, &track->orbits[i]);
+        }
+    }
+}
+
+/**
+ * Add the area of the line segments of an orbit to obj->track_dirty.
+ *
+ * The area includes one more pixel on each side for the line width, like
+ * the footprint in invalidate_sat().
+ */
+static void orbit_dirty(sat_map_obj_t * obj, const ground_track_orbit_t * orb)
+{
+    GdkRectangle    area;
+    line_segment_t *seg;
+    GSList         *node;
+    gdouble         xmin, xmax, ymin, ymax;
+    gint            i;
+
+    for (node = orb->lines; node != NULL; node = node->next)
+    {
+        seg = (line_segment_t *) node->data;
+        if (seg->count < 1)
+            continue;
+
+        xmin = xmax = seg->points[0];
+        ymin = ymax = seg->points[1];
+        for (i = 1; i < seg->count; i++)
+        {
+            xmin = MIN(xmin, seg->points[2 * i]);
+            xmax = MAX(xmax, seg->points[2 * i]);
+            ymin = MIN(ymin, seg->points[2 * i + 1]);
+            ymax = MAX(ymax, seg->points[2 * i + 1]);
+        }
+
+        area.x = (gint)floor(xmin) - 1;
+        area.y = (gint)floor(ymin) - 1;
+        area.width = (gint)ceil(xmax) + 2 - area.x;
+        area.height = (gint)ceil(ymax) + 2 - area.y;
+
+        /* gdk_rectangle_union() does not skip empty rectangles */
+        if (obj->track_dirty.width > 0 && obj->track_dirty.height > 0)
+            gdk_rectangle_union(&obj->track_dirty, &area, &obj->track_dirty);
+        else
+            obj->track_dirty = area;
     }
 }
 
@@ -241,10 +639,15 @@ static void free_line_segment(gpointer data)
  * @param qth Pointer to the QTH data.
  * @param obj the satellite object.
  * @param clear_ssp Flag indicating whether SSP data should be cleared as well (TRUE=yes);
+ *
+ * With clear_ssp=TRUE, a pending calculation is cancelled as well.
  */
 void ground_track_delete(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
                          sat_map_obj_t * obj, gboolean clear_ssp)
 {
+    ground_track_t *track = &obj->track_data;
+    guint           i;
+
     (void)satmap;
     (void)sat;
     (void)qth;
@@ -253,190 +656,143 @@ void ground_track_delete(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
                 _("%s: Deleting ground track for %s"),
                 __func__, sat->nickname);
 
-    /* Free line segments */
-    if (obj->track_data.lines != NULL)
+    /* Free line segments, and SSPs too? */
+    for (i = 0; i < track->count; i++)
     {
-        g_slist_free_full(obj->track_data.lines, free_line_segment);
-        obj->track_data.lines = NULL;
+        orbit_dirty(obj, &track->orbits[i]);
+        orbit_free(&track->orbits[i], clear_ssp);
     }
 
-    /* clear SSP too? */
     if (clear_ssp == TRUE)
     {
-        if (obj->track_data.latlon != NULL)
-        {
-            /* free allocated ssp_t */
-            g_slist_foreach(obj->track_data.latlon, free_ssp, NULL);
+        g_free(track->orbits);
+        track->orbits = NULL;
+        track->size = 0;
+        track->first = 0;
+        track->count = 0;
 
-            /* free the SList itself */
-            g_slist_free(obj->track_data.latlon);
-            obj->track_data.latlon = NULL;
+        obj->track_orbit = 0;
 
+        if (obj->track_job != NULL)
+        {
+            g_cancellable_cancel(obj->track_job);
+            g_clear_object(&obj->track_job);
         }
-
-        obj->track_orbit = 0;
     }
 
-    /* Request redraw */
+    /* redraw the removed segments */
     if (satmap && satmap->canvas)
     {
-        gtk_widget_queue_draw(satmap->canvas);
+        gtk_sat_map_queue_sat(satmap, obj);
     }
 }
 
-/**
- * Free an ssp_t structure.
- *
- * The ssp_t items in the obj->track_data.latlon GSList are dunamically allocated
- * hence they need to be freed when the cround track is deleted. This function
- * is intended to be called from a g_slist_foreach() iterator.
- */
-static void free_ssp(gpointer ssp, gpointer data)
+/** Copy the geometry of the map */
+static void track_geom_init(track_geom_t * geom, GtkSatMap * satmap)
 {
-    (void)data;
-    g_free(ssp);
+    geom->x0 = satmap->x0;
+    geom->y0 = satmap->y0;
+    geom->width = satmap->width;
+    geom->height = satmap->height;
+    geom->left_side_lon = satmap->left_side_lon;
 }
 
-/** Create polylines (line segments) for Cairo drawing. */
-static void create_polylines(GtkSatMap * satmap, sat_t * sat, qth_t * qth,
-                             sat_map_obj_t * obj)
+static gboolean track_geom_equal(const track_geom_t * a,
+                                 const track_geom_t * b)
 {
-    ssp_t          *ssp, *buff; /* map coordinates */
-    double          lastx, lasty;
-    GSList         *points = NULL;
-    guint           start;
-    guint           i, j, n, num_points;
-    line_segment_t *segment;
+    return (a->x0 == b->x0) && (a->y0 == b->y0) &&
+        (a->width == b->width) && (a->height == b->height) &&
+        (a->left_side_lon == b->left_side_lon);
+}
 
-    (void)sat;
-    (void)qth;
+/**
+ * Create polylines (line segments) of one orbit for Cairo drawing.
+ *
+ * This may run in a worker thread, so the map is only accessed through
+ * the copy of its geometry. The points are converted like in
+ * gtk_sat_map_lonlat_to_xy().
+ */
+static void create_polylines(const track_geom_t * geom,
+                             ground_track_orbit_t * orb)
+{
+    gdouble        *points;     /* map coordinates of the current line */
+    gdouble         x, y;
+    gdouble         lastx, lasty;
+    guint           i, n;
 
     /* initialise parameters */
     lastx = -50.0;
     lasty = -50.0;
-    start = 0;
-    num_points = 0;
-    n = g_slist_length(obj->track_data.latlon);
+    n = 0;
+    points = g_new(gdouble, 2 * orb->num);
 
     /* loop over each SSP */
-    for (i = 0; i < n; i++)
+    for (i = 0; i < orb->num; i++)
     {
-        buff = (ssp_t *) g_slist_nth_data(obj->track_data.latlon, i);
-        ssp = g_try_new(ssp_t, 1);
-        gtk_sat_map_lonlat_to_xy(satmap, buff->lon, buff->lat, &ssp->lon,
-                                 &ssp->lat);
-
-        /* if this is the first point, just add it to the list */
-        if (i == start)
-        {
-            points = g_slist_prepend(points, ssp);
-            lastx = ssp->lon;
-            lasty = ssp->lat;
-        }
-        else
+        x = geom->x0 + (orb->ssp[i].lon - geom->left_side_lon) *
+            geom->width / 360.0;
+        y = geom->y0 + (90.0 - orb->ssp[i].lat) * geom->height / 180.0;
+        while (x < 0)
+            x += geom->width;
+        while (x > geom->width)
+            x -= geom->width;
+
+        /* if this is the first point, just add it to the line */
+        if (n > 0)
         {
-            /* if SSP is on the other side of the map */
-            if (ssp_wrap_detected(satmap, lastx, ssp->lon))
+            /* if SSP is on the other side of the map, create the line
+               and continue with a new one */
+            if (ssp_wrap_detected(geom, lastx, x))
             {
-                points = g_slist_reverse(points);
-                num_points = g_slist_length(points);
-
-                /* we need at least 2 points to draw a line */
-                if (num_points > 1)
-                {
-                    /* Create a line segment with points array */
-                    segment = g_try_new(line_segment_t, 1);
-                    if (segment)
-                    {
-                        segment->count = num_points;
-                        segment->points = g_new(gdouble, num_points * 2);
-
-                        for (j = 0; j < num_points; j++)
-                        {
-                            buff = (ssp_t *)g_slist_nth_data(points, j);
-                            segment->points[2 * j] = buff->lon;
-                            segment->points[2 * j + 1] = buff->lat;
-                        }
-
-                        /* Store segment in sat object */
-                        obj->track_data.lines =
-                            g_slist_append(obj->track_data.lines, segment);
-                    }
-                }
-
-                /* reset parameters and continue with a new set */
-                g_slist_foreach(points, free_ssp, NULL);
-                g_slist_free(points);
-                points = NULL;
-                start = i;
-                lastx = ssp->lon;
-                lasty = ssp->lat;
-                num_points = 0;
-
-                /* Add current SSP to the new list */
-                points = g_slist_prepend(points, ssp);
-                lastx = ssp->lon;
-                lasty = ssp->lat;
+                add_line_segment(orb, points, n);
+                n = 0;
             }
 
-            /* else if this SSP is separable from the previous */
-            else if ((fabs(lastx - ssp->lon) > 1.0) ||
-                     (fabs(lasty - ssp->lat) > 1.0))
+            /* else if this SSP is not separable from the previous */
+            else if ((fabs(lastx - x) <= 1.0) && (fabs(lasty - y) <= 1.0))
             {
-
-                /* add SSP to list */
-                points = g_slist_prepend(points, ssp);
-                lastx = ssp->lon;
-                lasty = ssp->lon;
+                continue;
             }
-            /* else do nothing */
-            else g_free(ssp);
         }
-    }
 
-    /* create (last) line if we have at least two points */
-    points = g_slist_reverse(points);
-    num_points = g_slist_length(points);
+        points[2 * n] = x;
+        points[2 * n + 1] = y;
+        n++;
+        lastx = x;
+        lasty = y;
+    }
 
-    if (num_points > 1)
-    {
-        /* Create a line segment with points array */
-        segment = g_try_new(line_segment_t, 1);
-        if (segment)
-        {
-            segment->count = num_points;
-            segment->points = g_new(gdouble, num_points * 2);
+    /* create (last) line */
+    add_line_segment(orb, points, n);
+    g_free(points);
+}
 
-            for (j = 0; j < num_points; j++)
-            {
-                buff = (ssp_t *)g_slist_nth_data(points, j);
-                segment->points[2 * j] = buff->lon;
-                segment->points[2 * j + 1] = buff->lat;
-            }
+/** Add a line segment to an orbit if it has at least two points */
+static void add_line_segment(ground_track_orbit_t * orb,
+                             const gdouble * points, guint num)
+{
+    line_segment_t *segment;
 
-            /* Store segment in sat object */
-            obj->track_data.lines =
-                g_slist_append(obj->track_data.lines, segment);
-        }
+    /* we need at least 2 points to draw a line */
+    if (num < 2)
+        return;
 
-        /* reset parameters and continue with a new set */
-        g_slist_foreach(points, free_ssp, NULL);
-        g_slist_free(points);
-    }
+    segment = g_new(line_segment_t, 1);
+    segment->count = num;
+    segment->points = g_new(gdouble, num * 2);
+    memcpy(segment->points, points, num * 2 * sizeof(gdouble));
 
-    /* Request redraw */
-    if (satmap && satmap->canvas)
-    {
-        gtk_widget_queue_draw(satmap->canvas);
-    }
+    /* Store segment in orbit */
+    orb->lines = g_slist_append(orb->lines, segment);
 }
 
 /** Check whether ground track wraps around map borders */
-static gboolean ssp_wrap_detected(GtkSatMap * satmap, gdouble x1, gdouble x2)
+static gboolean ssp_wrap_detected(const track_geom_t * geom, gdouble x1,
+                                  gdouble x2)
 {
     gboolean        retval = FALSE;
 
-    if (fabs(x1 - x2) > satmap->width / 2.0)
+    if (fabs(x1 - x2) > geom->width / 2.0)
         retval = TRUE;
 
     return retval;
@@ -260,6 +260,8 @@ static void track_toggled(GtkCheckMenuItem * item, gpointer data)
         /* remove it from the storage structure */
         g_hash_table_remove(satmap->showtracks, &(sat->tle.catnr));
     }
+
+    gtk_widget_queue_draw(satmap->canvas);
 }
 
 #if 0
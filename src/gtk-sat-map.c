@@ -47,9 +47,32 @@
 
 #define MARKER_SIZE_HALF    1
 
+/* Footprint rings are cached per footprint size and sub-satellite latitude
+   bucket, see footprint_ring() */
+#define FOOTPRINT_POINTS     180        /* points on one half of a ring */
+#define FOOTPRINT_LAT_STEP   0.1        /* latitude bucket in degrees */
+#define FOOTPRINT_SIZE_STEP  1.0        /* footprint diameter bucket in km */
+#define FOOTPRINT_CACHE_SIZE 2048       /* max number of cached rings */
+
 /* Update terminator every 30 seconds */
 #define TERMINATOR_UPDATE_INTERVAL (15.0/86400.0)
 
+/* Number of frames between draw time reports */
+#define MAP_STAT_FRAMES 500
+
+/* The smallest map in satmap->mipmaps is at least this wide */
+#define MIPMAP_MIN_WIDTH 256
+
+/* Corners of the canvas for the info texts, see info_area() */
+#define INFO_RIGHT  1
+#define INFO_BOTTOM 2
+
+/** Footprint ring of a satellite above longitude 0. */
+typedef struct {
+    gdouble         lat[FOOTPRINT_POINTS];      /*!< Latitude in degrees */
+    gdouble         lon[FOOTPRINT_POINTS];      /*!< Longitude in degrees */
+} footprint_ring_t;
+
 static void     gtk_sat_map_class_init(GtkSatMapClass * class,
                                        gpointer class_data);
 static void     gtk_sat_map_init(GtkSatMap * polview,
@@ -63,6 +86,8 @@ static void     plot_sat(gpointer key, gpointer value, gpointer data);
 static void     free_sat_obj(gpointer key, gpointer value, gpointer data);
 static void     lonlat_to_xy(GtkSatMap * m, gdouble lon, gdouble lat,
                              gfloat * x, gfloat * y);
+static void     lonlat_to_map(GtkSatMap * m, gdouble lon, gdouble lat,
+                              gdouble * u, gdouble * v);
 static void     xy_to_lonlat(GtkSatMap * m, gfloat x, gfloat y, gfloat * lon,
                              gfloat * lat);
 static gboolean on_motion_notify(GtkWidget * widget, GdkEventMotion * event,
@@ -74,21 +99,31 @@ static gboolean on_button_release(GtkWidget * widget, GdkEventButton * event,
 static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data);
 static void     clear_selection(gpointer key, gpointer val, gpointer data);
 static void     load_map_file(GtkSatMap * satmap, float clon);
+static void     create_mipmaps(GtkSatMap * satmap);
+static GdkPixbuf *scale_map(GtkSatMap * satmap, gint width, gint height);
+static void     invalidate_layer(GtkSatMap * satmap);
+static PangoLayout *get_layout(GtkSatMap * satmap);
+static void     invalidate_rect(GtkSatMap * satmap, const GdkRectangle * rect);
+static void     invalidate_info(GtkSatMap * satmap, const gchar * markup,
+                                gint corner);
+static void     invalidate_sat(GtkSatMap * satmap, sat_map_obj_t * obj);
+static void     queue_dirty(GtkSatMap * satmap);
 static gdouble  arccos(gdouble, gdouble);
 static gboolean pole_is_covered(sat_t * sat);
 static gboolean north_pole_is_covered(sat_t * sat);
 static gboolean south_pole_is_covered(sat_t * sat);
 static gboolean mirror_lon(sat_t * sat, gdouble rangelon, gdouble * mlon,
                            gdouble mapbreak);
+static const footprint_ring_t *footprint_ring(sat_t * sat);
 static guint    calculate_footprint(GtkSatMap * satmap, sat_t * sat,
                                     sat_map_obj_t * obj);
-static void     split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx,
+static void     footprint_path(GtkSatMap * satmap, cairo_t * cr,
+                               const gdouble * points, gint num);
+static void     split_points(sat_t * sat, gdouble sspx,
                              gdouble * points1, gint * n1,
                              gdouble * points2, gint * n2);
-static void     sort_points_x(GtkSatMap * satmap, sat_t * sat,
-                              gdouble * points, gint num);
-static void     sort_points_y(GtkSatMap * satmap, sat_t * sat,
-                              gdouble * points, gint num);
+static void     sort_points_x(sat_t * sat, gdouble * points, gint num);
+static void     sort_points_y(sat_t * sat, gdouble * points, gint num);
 static gint     compare_coordinates_x(gconstpointer a, gconstpointer b,
                                       gpointer data);
 static gint     compare_coordinates_y(gconstpointer a, gconstpointer b,
@@ -106,9 +141,8 @@ static sat_map_obj_t *find_sat_at_pos(GtkSatMap * satmap, gfloat mx, gfloat my);
 
 static GtkBoxClass *parent_class = NULL;
 
-/* Temporary arrays for footprint calculation */
-static gdouble *temp_points1 = NULL;
-static gdouble *temp_points2 = NULL;
+/* Footprint ring cache: bucket key -> footprint_ring_t, shared by all maps */
+static GHashTable *footprint_cache = NULL;
 
 /** Convert rgba color to cairo-friendly format */
 static void rgba_to_cairo(guint32 rgba, gdouble * r, gdouble * g,
@@ -171,8 +205,7 @@ static void gtk_sat_map_init(GtkSatMap * satmap,
                                                NULL, NULL);
     satmap->hidecovs = g_hash_table_new_full(g_int_hash, g_int_equal,
                                              NULL, NULL);
-    satmap->naos = 0.0;
-    satmap->ncat = 0;
+    satmap->events = NULL;
     satmap->tstamp = 2458849.5;
     satmap->x0 = 0;
     satmap->y0 = 0;
@@ -198,7 +231,19 @@ static void gtk_sat_map_init(GtkSatMap * satmap,
     satmap->terminator_count = 0;
     satmap->font = NULL;
     satmap->map = NULL;
-    satmap->grid_lines_valid = FALSE;
+    satmap->mipmaps = NULL;
+    satmap->layer = NULL;
+    satmap->layer_nsew = FALSE;
+    satmap->layout = NULL;
+    satmap->font_desc = NULL;
+    satmap->stat_draw = 0;
+    satmap->stat_draw_max = 0;
+    satmap->stat_frames = 0;
+    satmap->stat_layers = 0;
+    satmap->stat_pixels = 0;
+    satmap->stat_start = g_get_monotonic_time();
+    satmap->dirty = NULL;
+    satmap->dirty_all = TRUE;
 }
 
 static void gtk_sat_map_destroy(GtkWidget * widget)
@@ -224,6 +269,13 @@ static void gtk_sat_map_destroy(GtkWidget * widget)
             satmap->origmap = NULL;
         }
 
+        /* free the reduced maps */
+        if (satmap->mipmaps)
+        {
+            g_ptr_array_free(satmap->mipmaps, TRUE);
+            satmap->mipmaps = NULL;
+        }
+
         /* free the scaled map pixbuf */
         if (satmap->map)
         {
@@ -231,6 +283,24 @@ static void gtk_sat_map_destroy(GtkWidget * widget)
             satmap->map = NULL;
         }
 
+        /* free the cached static layer and text layout */
+        invalidate_layer(satmap);
+        if (satmap->layout)
+        {
+            g_object_unref(satmap->layout);
+            satmap->layout = NULL;
+        }
+        if (satmap->font_desc)
+        {
+            pango_font_description_free(satmap->font_desc);
+            satmap->font_desc = NULL;
+        }
+        if (satmap->dirty)
+        {
+            cairo_region_destroy(satmap->dirty);
+            satmap->dirty = NULL;
+        }
+
         g_hash_table_destroy(satmap->showtracks);
         satmap->showtracks = NULL;
         g_hash_table_destroy(satmap->hidecovs);
@@ -254,18 +324,12 @@ static void gtk_sat_map_destroy(GtkWidget * widget)
         g_free(satmap->terminator_points);
         satmap->terminator_points = NULL;
         satmap->terminator_count = 0;
-
-        /* free temporary point arrays */
-        g_free(temp_points1);
-        temp_points1 = NULL;
-        g_free(temp_points2);
-        temp_points2 = NULL;
     }
     (*GTK_WIDGET_CLASS(parent_class)->destroy) (widget);
 }
 
 GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
-                                qth_t * qth)
+                                qth_t * qth, event_heap_t * events)
 {
     GtkSatMap      *satmap;
     guint32         col;
@@ -276,6 +340,7 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
     satmap->cfgdata = cfgdata;
     satmap->sats = sats;
     satmap->qth = qth;
+    satmap->events = events;
 
     satmap->obj = g_hash_table_new_full(g_int_hash, g_int_equal, g_free, g_free);
 
@@ -393,10 +458,6 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
     satmap->x0 = 0;
     satmap->y0 = 0;
 
-    /* Allocate temporary point arrays for footprint calculation */
-    temp_points1 = g_new0(gdouble, 720);
-    temp_points2 = g_new0(gdouble, 720);
-
     /* Connect signals */
     gtk_widget_add_events(satmap->canvas, GDK_POINTER_MOTION_MASK |
                           GDK_BUTTON_PRESS_MASK | GDK_BUTTON_RELEASE_MASK);
@@ -438,29 +499,27 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
     return GTK_WIDGET(satmap);
 }
 
-/** Draw callback for the canvas */
-static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
+/**
+ * Draw the static layer of the map.
+ *
+ * The static layer contains the map, the grid with its labels and the
+ * terminator. It is cached in satmap->layer by on_draw() and only drawn
+ * again when one of them changes, see invalidate_layer().
+ */
+static void draw_static_layer(GtkSatMap * satmap, cairo_t * cr,
+                              gboolean nsew)
 {
-    GtkSatMap      *satmap = GTK_SAT_MAP(data);
+    PangoLayout    *layout = satmap->layout;
     gdouble         r, g, b, a;
-    PangoLayout    *layout;
-    PangoFontDescription *font_desc;
     gint            tw, th;
-    GHashTableIter  iter;
-    gpointer        key, value;
-    sat_map_obj_t  *obj;
-    gfloat          x, y;
     gdouble         xstep, ystep;
     guint           i;
     gfloat          lon, lat;
     gchar          *buf;
     gchar           hmf = ' ';
     guint32         globe_shadow_col;
-    GSList         *line_node;
-    gdouble        *line_points;
-    guint           num_points;
 
-    (void)widget;
+    pango_cairo_update_layout(cr, layout);
 
     /* Draw background map */
     if (satmap->map)
@@ -469,11 +528,6 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
         cairo_paint(cr);
     }
 
-    /* Set up font */
-    layout = pango_cairo_create_layout(cr);
-    font_desc = pango_font_description_from_string(satmap->font ? satmap->font : "Sans 9");
-    pango_layout_set_font_description(layout, font_desc);
-
     /* Draw grid lines if enabled */
     if (satmap->showgrid && satmap->width > 0 && satmap->height > 0)
     {
@@ -497,7 +551,7 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
             xy_to_lonlat(satmap, satmap->x0, satmap->y0 + (i + 1) * ystep,
                          &lon, &lat);
             hmf = ' ';
-            if (sat_cfg_get_bool(SAT_CFG_BOOL_USE_NSEW))
+            if (nsew)
             {
                 if (lat < 0.00)
                 {
@@ -531,7 +585,7 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
             xy_to_lonlat(satmap, satmap->x0 + (i + 1) * xstep, satmap->y0,
                          &lon, &lat);
             hmf = ' ';
-            if (sat_cfg_get_bool(SAT_CFG_BOOL_USE_NSEW))
+            if (nsew)
             {
                 if (lon < 0.00)
                 {
@@ -580,6 +634,312 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
         cairo_set_line_width(cr, 1.0);
         cairo_stroke(cr);
     }
+}
+
+/**
+ * Drop the cached static layer so that it is drawn again.
+ *
+ * Everything on the canvas is drawn on top of the static layer, so the whole
+ * canvas is marked as changed.
+ */
+static void invalidate_layer(GtkSatMap * satmap)
+{
+    if (satmap->layer)
+    {
+        cairo_surface_destroy(satmap->layer);
+        satmap->layer = NULL;
+    }
+    satmap->dirty_all = TRUE;
+}
+
+/** Get the layout used for all text, creating it if necessary */
+static PangoLayout *get_layout(GtkSatMap * satmap)
+{
+    if (satmap->layout == NULL)
+    {
+        satmap->layout = gtk_widget_create_pango_layout(satmap->canvas, NULL);
+        satmap->font_desc = pango_font_description_from_string(
+            satmap->font ? satmap->font : "Sans 9");
+        pango_layout_set_font_description(satmap->layout, satmap->font_desc);
+    }
+
+    return satmap->layout;
+}
+
+/**
+ * Get the area of an info text.
+ *
+ * The text is left in the layout, ready to be drawn at the top left corner
+ * of the area.
+ *
+ * @param satmap The GtkSatMap widget.
+ * @param markup The text.
+ * @param corner The corner of the map where the text is shown, a combination
+ *               of INFO_RIGHT and INFO_BOTTOM.
+ * @param rect Where the area is stored.
+ */
+static void info_area(GtkSatMap * satmap, const gchar * markup, gint corner,
+                      GdkRectangle * rect)
+{
+    PangoLayout    *layout = get_layout(satmap);
+
+    pango_layout_set_markup(layout, markup, -1);
+    pango_layout_get_pixel_size(layout, &rect->width, &rect->height);
+
+    if (corner & INFO_RIGHT)
+        rect->x = satmap->x0 + satmap->width - 2 - rect->width;
+    else
+        rect->x = satmap->x0 + 2;
+
+    if (corner & INFO_BOTTOM)
+        rect->y = satmap->y0 + satmap->height - 1 - rect->height;
+    else
+        rect->y = satmap->y0 + 1;
+}
+
+/**
+ * Get the position of a satellite label.
+ *
+ * The label is placed below the marker, unless the marker is too close to
+ * one of the map edges.
+ */
+static void label_pos(GtkSatMap * satmap, sat_map_obj_t * obj, gint tw,
+                      gint th, gdouble * x, gdouble * y)
+{
+    if (obj->x < 50)
+    {
+        *x = obj->x + 3;
+        *y = obj->y;
+    }
+    else if ((satmap->width - obj->x) < 50)
+    {
+        *x = obj->x - 3 - tw;
+        *y = obj->y;
+    }
+    else if ((satmap->height - obj->y) < 25)
+    {
+        *x = obj->x - tw / 2;
+        *y = obj->y - 2 - th;
+    }
+    else
+    {
+        *x = obj->x - tw / 2;
+        *y = obj->y + 2;
+    }
+}
+
+/** Add the bounding box of one part of a footprint to rect */
+static void footprint_area(GtkSatMap * satmap, const gdouble * points,
+                           gint num, GdkRectangle * rect)
+{
+    GdkRectangle    area;
+    gdouble         umin, umax, vmin, vmax;
+    gint            i;
+
+    if (points == NULL || num < 3)
+        return;
+
+    umin = umax = points[0];
+    vmin = vmax = points[1];
+    for (i = 1; i < num; i++)
+    {
+        umin = MIN(umin, points[2 * i]);
+        umax = MAX(umax, points[2 * i]);
+        vmin = MIN(vmin, points[2 * i + 1]);
+        vmax = MAX(vmax, points[2 * i + 1]);
+    }
+
+    /* one more pixel on each side for the outline */
+    area.x = (gint)floor(satmap->x0 + umin * satmap->width / 360.0) - 1;
+    area.y = (gint)floor(satmap->y0 + vmin * satmap->height / 180.0) - 1;
+    area.width = (gint)ceil(satmap->x0 + umax * satmap->width / 360.0) + 2 -
+        area.x;
+    area.height = (gint)ceil(satmap->y0 + vmax * satmap->height / 180.0) + 2 -
+        area.y;
+
+    gdk_rectangle_union(rect, &area, rect);
+}
+
+/**
+ * Mark the area covered by a satellite as changed.
+ *
+ * This is the marker, the label and the footprint as drawn by on_draw(),
+ * including their shadows, and the ground track segments that have been
+ * added or removed since the last call. Call it both before and after the
+ * satellite is changed.
+ */
+static void invalidate_sat(GtkSatMap * satmap, sat_map_obj_t * obj)
+{
+    PangoLayout    *layout;
+    GdkRectangle    rect, label;
+    gdouble         x, y;
+    gboolean        show_fp = satmap->satfp || obj->selected;
+    gboolean        show_label = satmap->satname || obj->selected;
+
+    /* marker and its shadow */
+    rect.x = (gint)floor(obj->x) - MARKER_SIZE_HALF - 1;
+    rect.y = (gint)floor(obj->y) - MARKER_SIZE_HALF - 1;
+    rect.width = 2 * MARKER_SIZE_HALF + 3;
+    rect.height = 2 * MARKER_SIZE_HALF + 3;
+
+    if (show_label && obj->nickname)
+    {
+        layout = get_layout(satmap);
+        pango_layout_set_text(layout, obj->nickname, -1);
+        pango_layout_get_pixel_size(layout, &label.width, &label.height);
+        label_pos(satmap, obj, label.width, label.height, &x, &y);
+        label.x = (gint)floor(x) - 1;
+        label.y = (gint)floor(y) - 1;
+        label.width += 3;
+        label.height += 3;
+        gdk_rectangle_union(&rect, &label, &rect);
+    }
+
+    if (show_fp && obj->showcov)
+    {
+        footprint_area(satmap, obj->range1_points, obj->range1_count, &rect);
+        footprint_area(satmap, obj->range2_points, obj->range2_count, &rect);
+    }
+
+    if (obj->track_dirty.width > 0 && obj->track_dirty.height > 0)
+    {
+        gdk_rectangle_union(&rect, &obj->track_dirty, &rect);
+        obj->track_dirty.width = 0;
+        obj->track_dirty.height = 0;
+    }
+
+    invalidate_rect(satmap, &rect);
+}
+
+/** Mark a rectangle of the canvas as changed */
+static void invalidate_rect(GtkSatMap * satmap, const GdkRectangle * rect)
+{
+    if (satmap->dirty_all || rect->width <= 0 || rect->height <= 0)
+        return;
+
+    if (satmap->dirty == NULL)
+        satmap->dirty = cairo_region_create();
+    cairo_region_union_rectangle(satmap->dirty, rect);
+}
+
+/** Mark the area of an info text as changed, see info_area() */
+static void invalidate_info(GtkSatMap * satmap, const gchar * markup,
+                            gint corner)
+{
+    GdkRectangle    rect;
+
+    if (markup == NULL)
+        return;
+
+    info_area(satmap, markup, corner, &rect);
+    invalidate_rect(satmap, &rect);
+}
+
+/** Queue the changed parts of the canvas for drawing */
+static void queue_dirty(GtkSatMap * satmap)
+{
+    if (satmap->dirty_all)
+        gtk_widget_queue_draw(satmap->canvas);
+    else if (satmap->dirty)
+        gtk_widget_queue_draw_region(satmap->canvas, satmap->dirty);
+
+    if (satmap->dirty)
+    {
+        cairo_region_destroy(satmap->dirty);
+        satmap->dirty = NULL;
+    }
+    satmap->dirty_all = FALSE;
+}
+
+/** Log and reset the drawing statistics */
+static void log_draw_timing(GtkSatMap * satmap)
+{
+    gint64          now = g_get_monotonic_time();
+
+    if (satmap->stat_frames > 0 && now > satmap->stat_start)
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: %u frames, average %" G_GINT64_FORMAT
+                      " usec, max %" G_GINT64_FORMAT " usec, "
+                      "%.0f pixels/s; static layer drawn %u times"),
+                    __func__, satmap->stat_frames,
+                    satmap->stat_draw / satmap->stat_frames,
+                    satmap->stat_draw_max,
+                    1.0e6 * satmap->stat_pixels / (now - satmap->stat_start),
+                    satmap->stat_layers);
+
+    satmap->stat_draw = 0;
+    satmap->stat_draw_max = 0;
+    satmap->stat_frames = 0;
+    satmap->stat_layers = 0;
+    satmap->stat_pixels = 0;
+    satmap->stat_start = now;
+}
+
+/**
+ * Draw callback for the canvas
+ *
+ * Only the satellites, the QTH and the info texts are drawn in each frame;
+ * the rest comes from the cached static layer.
+ */
+static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
+{
+    GtkSatMap      *satmap = GTK_SAT_MAP(data);
+    gdouble         r, g, b, a;
+    PangoLayout    *layout;
+    gint            tw, th;
+    GHashTableIter  iter;
+    gpointer        key, value;
+    sat_map_obj_t  *obj;
+    gfloat          x, y;
+    guint           i;
+    GSList         *line_node;
+    line_segment_t *segment;
+    guint           j;
+    cairo_t        *lcr;
+    cairo_rectangle_list_t *clip;
+    GdkRectangle    rect;
+    gdouble         lx, ly;
+    gboolean        nsew;
+    gint64          t0, dt;
+
+    t0 = g_get_monotonic_time();
+
+    /* Count the pixels that are drawn */
+    clip = cairo_copy_clip_rectangle_list(cr);
+    if (clip->status == CAIRO_STATUS_SUCCESS)
+        for (i = 0; i < (guint)clip->num_rectangles; i++)
+            satmap->stat_pixels += (guint64)(clip->rectangles[i].width *
+                                             clip->rectangles[i].height);
+    cairo_rectangle_list_destroy(clip);
+
+    layout = get_layout(satmap);
+
+    /* Draw the static layer if it has changed */
+    nsew = sat_cfg_get_bool(SAT_CFG_BOOL_USE_NSEW);
+    if (nsew != satmap->layer_nsew)
+    {
+        /* only a part of the canvas may be drawn now */
+        invalidate_layer(satmap);
+        gtk_widget_queue_draw(widget);
+    }
+
+    if (satmap->layer == NULL)
+    {
+        satmap->layer = cairo_surface_create_similar(
+            cairo_get_target(cr), CAIRO_CONTENT_COLOR_ALPHA,
+            gtk_widget_get_allocated_width(widget),
+            gtk_widget_get_allocated_height(widget));
+        lcr = cairo_create(satmap->layer);
+        draw_static_layer(satmap, lcr, nsew);
+        cairo_destroy(lcr);
+        satmap->layer_nsew = nsew;
+        satmap->stat_layers++;
+    }
+
+    cairo_set_source_surface(cr, satmap->layer, 0, 0);
+    cairo_paint(cr);
+
+    pango_cairo_update_layout(cr, layout);
 
     /* Draw QTH marker */
     lonlat_to_xy(satmap, satmap->qth->lon, satmap->qth->lat, &x, &y);
@@ -604,31 +964,28 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
             obj = SAT_MAP_OBJ(value);
 
             /* Draw ground track if enabled */
-            if (obj->showtrack && obj->track_data.lines)
+            if (obj->showtrack && obj->track_data.orbits)
             {
                 rgba_to_cairo(satmap->col_track, &r, &g, &b, &a);
                 cairo_set_source_rgba(cr, r, g, b, a);
                 cairo_set_line_width(cr, 1.0);
 
-                line_node = obj->track_data.lines;
-                while (line_node)
+                for (j = 0; j < obj->track_data.count; j++)
                 {
-                    line_points = (gdouble *)line_node->data;
-                    if (line_points)
+                    line_node = obj->track_data.orbits[j].lines;
+                    while (line_node)
                     {
-                        num_points = (guint)line_points[0];
-                        if (num_points > 1)
+                        segment = (line_segment_t *)line_node->data;
+                        cairo_move_to(cr, segment->points[0],
+                                      segment->points[1]);
+                        for (i = 1; i < (guint)segment->count; i++)
                         {
-                            cairo_move_to(cr, line_points[1], line_points[2]);
-                            for (i = 1; i < num_points; i++)
-                            {
-                                cairo_line_to(cr, line_points[2 * i + 1],
-                                              line_points[2 * i + 2]);
-                            }
-                            cairo_stroke(cr);
+                            cairo_line_to(cr, segment->points[2 * i],
+                                          segment->points[2 * i + 1]);
                         }
+                        cairo_stroke(cr);
+                        line_node = line_node->next;
                     }
-                    line_node = line_node->next;
                 }
             }
 
@@ -651,14 +1008,8 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
                     rgba_to_cairo(covcol, &r, &g, &b, &a);
                     cairo_set_source_rgba(cr, r, g, b, a);
 
-                    cairo_move_to(cr, obj->range1_points[0],
-                                  obj->range1_points[1]);
-                    for (i = 1; i < (guint)obj->range1_count; i++)
-                    {
-                        cairo_line_to(cr, obj->range1_points[2 * i],
-                                      obj->range1_points[2 * i + 1]);
-                    }
-                    cairo_close_path(cr);
+                    footprint_path(satmap, cr, obj->range1_points,
+                                   obj->range1_count);
                     cairo_fill_preserve(cr);
 
                     if (obj->selected)
@@ -676,14 +1027,8 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
                     rgba_to_cairo(covcol, &r, &g, &b, &a);
                     cairo_set_source_rgba(cr, r, g, b, a);
 
-                    cairo_move_to(cr, obj->range2_points[0],
-                                  obj->range2_points[1]);
-                    for (i = 1; i < (guint)obj->range2_count; i++)
-                    {
-                        cairo_line_to(cr, obj->range2_points[2 * i],
-                                      obj->range2_points[2 * i + 1]);
-                    }
-                    cairo_close_path(cr);
+                    footprint_path(satmap, cr, obj->range2_points,
+                                   obj->range2_count);
                     cairo_fill_preserve(cr);
 
                     if (obj->selected)
@@ -728,15 +1073,8 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
                 cairo_set_source_rgba(cr, 0, 0, 0, a);
                 pango_layout_set_text(layout, obj->nickname, -1);
                 pango_layout_get_pixel_size(layout, &tw, &th);
-
-                if (obj->x < 50)
-                    cairo_move_to(cr, obj->x + 3 + 1, obj->y + 1);
-                else if ((satmap->width - obj->x) < 50)
-                    cairo_move_to(cr, obj->x - 3 - tw + 1, obj->y + 1);
-                else if ((satmap->height - obj->y) < 25)
-                    cairo_move_to(cr, obj->x - tw / 2 + 1, obj->y - 2 - th + 1);
-                else
-                    cairo_move_to(cr, obj->x - tw / 2 + 1, obj->y + 2 + 1);
+                label_pos(satmap, obj, tw, th, &lx, &ly);
+                cairo_move_to(cr, lx + 1, ly + 1);
                 pango_cairo_show_layout(cr, layout);
             }
 
@@ -750,15 +1088,8 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
                 cairo_set_source_rgba(cr, r, g, b, a);
                 pango_layout_set_text(layout, obj->nickname, -1);
                 pango_layout_get_pixel_size(layout, &tw, &th);
-
-                if (obj->x < 50)
-                    cairo_move_to(cr, obj->x + 3, obj->y);
-                else if ((satmap->width - obj->x) < 50)
-                    cairo_move_to(cr, obj->x - 3 - tw, obj->y);
-                else if ((satmap->height - obj->y) < 25)
-                    cairo_move_to(cr, obj->x - tw / 2, obj->y - 2 - th);
-                else
-                    cairo_move_to(cr, obj->x - tw / 2, obj->y + 2);
+                label_pos(satmap, obj, tw, th, &lx, &ly);
+                cairo_move_to(cr, lx, ly);
                 pango_cairo_show_layout(cr, layout);
             }
         }
@@ -771,43 +1102,40 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
     /* QTH info (top-left) */
     if (satmap->qthinfo && satmap->locnam_text)
     {
-        pango_layout_set_markup(layout, satmap->locnam_text, -1);
-        cairo_move_to(cr, (gdouble)satmap->x0 + 2, (gdouble)satmap->y0 + 1);
+        info_area(satmap, satmap->locnam_text, 0, &rect);
+        cairo_move_to(cr, rect.x, rect.y);
         pango_cairo_show_layout(cr, layout);
     }
 
     /* Next event (top-right) */
     if (satmap->eventinfo && satmap->next_text)
     {
-        pango_layout_set_markup(layout, satmap->next_text, -1);
-        pango_layout_get_pixel_size(layout, &tw, &th);
-        cairo_move_to(cr, (gdouble)(satmap->x0 + satmap->width - 2 - tw),
-                      (gdouble)satmap->y0 + 1);
+        info_area(satmap, satmap->next_text, INFO_RIGHT, &rect);
+        cairo_move_to(cr, rect.x, rect.y);
         pango_cairo_show_layout(cr, layout);
     }
 
     /* Cursor tracking (bottom-left) */
     if (satmap->cursinfo && satmap->curs_text)
     {
-        pango_layout_set_markup(layout, satmap->curs_text, -1);
-        pango_layout_get_pixel_size(layout, &tw, &th);
-        cairo_move_to(cr, (gdouble)satmap->x0 + 2,
-                      (gdouble)(satmap->y0 + satmap->height - 1 - th));
+        info_area(satmap, satmap->curs_text, INFO_BOTTOM, &rect);
+        cairo_move_to(cr, rect.x, rect.y);
         pango_cairo_show_layout(cr, layout);
     }
 
     /* Selected satellite info (bottom-right) */
     if (satmap->sel_text)
     {
-        pango_layout_set_markup(layout, satmap->sel_text, -1);
-        pango_layout_get_pixel_size(layout, &tw, &th);
-        cairo_move_to(cr, (gdouble)(satmap->x0 + satmap->width - 2 - tw),
-                      (gdouble)(satmap->y0 + satmap->height - 1 - th));
+        info_area(satmap, satmap->sel_text, INFO_RIGHT | INFO_BOTTOM, &rect);
+        cairo_move_to(cr, rect.x, rect.y);
         pango_cairo_show_layout(cr, layout);
     }
 
-    pango_font_description_free(font_desc);
-    g_object_unref(layout);
+    dt = g_get_monotonic_time() - t0;
+    satmap->stat_draw += dt;
+    satmap->stat_draw_max = MAX(satmap->stat_draw_max, dt);
+    if (++satmap->stat_frames >= MAP_STAT_FRAMES)
+        log_draw_timing(satmap);
 
     return FALSE;
 }
@@ -842,6 +1170,7 @@ static void size_allocate_cb(GtkWidget * widget, GtkAllocation * allocation,
     (void)widget;
     (void)allocation;
     GTK_SAT_MAP(data)->resize = TRUE;
+    invalidate_layer(GTK_SAT_MAP(data));
 }
 
 static void update_map_size(GtkSatMap * satmap)
@@ -867,10 +1196,7 @@ static void update_map_size(GtkSatMap * satmap)
             satmap->x0 = (allocation.width - satmap->width) / 2;
             satmap->y0 = (allocation.height - satmap->height) / 2;
 
-            pbuf = gdk_pixbuf_scale_simple(satmap->origmap,
-                                           satmap->width,
-                                           satmap->height,
-                                           GDK_INTERP_BILINEAR);
+            pbuf = scale_map(satmap, satmap->width, satmap->height);
         }
         else
         {
@@ -879,15 +1205,13 @@ static void update_map_size(GtkSatMap * satmap)
             satmap->width = allocation.width;
             satmap->height = allocation.height;
 
-            pbuf = gdk_pixbuf_scale_simple(satmap->origmap,
-                                           satmap->width,
-                                           satmap->height,
-                                           GDK_INTERP_BILINEAR);
+            pbuf = scale_map(satmap, satmap->width, satmap->height);
         }
 
         if (satmap->map)
             g_object_unref(satmap->map);
         satmap->map = pbuf;
+        invalidate_layer(satmap);
 
         if (satmap->show_terminator)
             redraw_terminator(satmap);
@@ -895,7 +1219,7 @@ static void update_map_size(GtkSatMap * satmap)
         g_hash_table_foreach(satmap->sats, update_sat, satmap);
         satmap->resize = FALSE;
 
-        gtk_widget_queue_draw(satmap->canvas);
+        queue_dirty(satmap);
     }
 }
 
@@ -903,9 +1227,9 @@ void gtk_sat_map_update(GtkWidget * widget)
 {
     GtkSatMap      *satmap = GTK_SAT_MAP(widget);
     sat_t          *sat = NULL;
-    gdouble         number, now;
+    sat_event_t     next;
+    gdouble         number;
     gchar          *buff;
-    gint           *catnr;
     guint           h, m, s;
     gchar          *ch, *cm, *cs;
 
@@ -923,8 +1247,6 @@ void gtk_sat_map_update(GtkWidget * widget)
     {
         /* reset data */
         satmap->counter = 1;
-        satmap->naos = 0.0;
-        satmap->ncat = 0;
 
         g_hash_table_foreach(satmap->sats, update_sat, satmap);
 
@@ -939,82 +1261,70 @@ void gtk_sat_map_update(GtkWidget * widget)
 
         if (satmap->eventinfo)
         {
-            if (satmap->ncat > 0)
+            invalidate_info(satmap, satmap->next_text, INFO_RIGHT);
+
+            if (event_heap_next(satmap->events, satmap->tstamp, SAT_EVENT_AOS,
+                                &next, 1) > 0)
             {
-                catnr = g_try_new0(gint, 1);
-                *catnr = satmap->ncat;
-                sat = SAT(g_hash_table_lookup(satmap->sats, catnr));
-                g_free(catnr);
+                sat = next.sat;
+                number = next.time - satmap->tstamp;
 
-                /* last desperate sanity check */
-                if (sat != NULL)
-                {
-                    now = satmap->tstamp;       //get_current_daynum ();
-                    number = satmap->naos - now;
+                /* convert julian date to seconds */
+                s = (guint)(number * 86400);
 
-                    /* convert julian date to seconds */
-                    s = (guint)(number * 86400);
+                /* extract hours */
+                h = (guint)floor(s / 3600);
+                s -= 3600 * h;
 
-                    /* extract hours */
-                    h = (guint)floor(s / 3600);
-                    s -= 3600 * h;
+                /* leading zero */
+                if ((h > 0) && (h < 10))
+                    ch = g_strdup("0");
+                else
+                    ch = g_strdup("");
 
-                    /* leading zero */
-                    if ((h > 0) && (h < 10))
-                        ch = g_strdup("0");
-                    else
-                        ch = g_strdup("");
+                /* extract minutes */
+                m = (guint)floor(s / 60);
+                s -= 60 * m;
 
-                    /* extract minutes */
-                    m = (guint)floor(s / 60);
-                    s -= 60 * m;
+                /* leading zero */
+                if (m < 10)
+                    cm = g_strdup("0");
+                else
+                    cm = g_strdup("");
 
-                    /* leading zero */
-                    if (m < 10)
-                        cm = g_strdup("0");
-                    else
-                        cm = g_strdup("");
+                /* leading zero */
+                if (s < 10)
+                    cs = g_strdup(":0");
+                else
+                    cs = g_strdup(":");
 
-                    /* leading zero */
-                    if (s < 10)
-                        cs = g_strdup(":0");
-                    else
-                        cs = g_strdup(":");
-
-                    g_free(satmap->next_text);
-                    if (h > 0)
-                        buff = g_markup_printf_escaped(
-                            _("<span background=\"#%s\"> "
-                              "Next: %s in %s%d:%s%d%s%d </span>"),
-                            satmap->infobgd,
-                            sat->nickname, ch, h, cm, m, cs, s);
-                    else
-                        buff = g_markup_printf_escaped(
-                            _("<span background=\"#%s\"> "
-                              "Next: %s in %s%d%s%d </span>"),
-                            satmap->infobgd,
-                            sat->nickname, cm, m, cs, s);
+                g_free(satmap->next_text);
+                if (h > 0)
+                    buff = g_markup_printf_escaped(
+                        _("<span background=\"#%s\"> "
+                          "Next: %s in %s%d:%s%d%s%d </span>"),
+                        satmap->infobgd,
+                        sat->nickname, ch, h, cm, m, cs, s);
+                else
+                    buff = g_markup_printf_escaped(
+                        _("<span background=\"#%s\"> "
+                          "Next: %s in %s%d%s%d </span>"),
+                        satmap->infobgd,
+                        sat->nickname, cm, m, cs, s);
 
-                    satmap->next_text = buff;
+                satmap->next_text = buff;
 
-                    g_free(ch);
-                    g_free(cm);
-                    g_free(cs);
-                }
-                else
-                {
-                    sat_log_log(SAT_LOG_LEVEL_ERROR,
-                                _("%s: Can not find NEXT satellite."),
-                                __func__);
-                    g_free(satmap->next_text);
-                    satmap->next_text = g_strdup(_("Next: ERR"));
-                }
+                g_free(ch);
+                g_free(cm);
+                g_free(cs);
             }
             else
             {
                 g_free(satmap->next_text);
                 satmap->next_text = g_strdup(_("Next: N/A"));
             }
+
+            invalidate_info(satmap, satmap->next_text, INFO_RIGHT);
         }
         else
         {
@@ -1022,7 +1332,7 @@ void gtk_sat_map_update(GtkWidget * widget)
             satmap->next_text = NULL;
         }
 
-        gtk_widget_queue_draw(satmap->canvas);
+        queue_dirty(satmap);
     }
 }
 
@@ -1037,6 +1347,24 @@ static void lonlat_to_xy(GtkSatMap * p, gdouble lon, gdouble lat, gfloat * x,
         *x -= p->width;
 }
 
+/**
+ * Convert lon/lat to map coordinates.
+ *
+ * Map coordinates are the screen coordinates of a 360 x 180 map at (0, 0).
+ * They do not depend on the size of the map and are converted to screen
+ * coordinates with a translation and a scaling.
+ */
+static void lonlat_to_map(GtkSatMap * p, gdouble lon, gdouble lat,
+                          gdouble * u, gdouble * v)
+{
+    *u = lon - p->left_side_lon;
+    *v = 90.0 - lat;
+    while (*u < 0)
+        *u += 360.0;
+    while (*u > 360.0)
+        *u -= 360.0;
+}
+
 static void xy_to_lonlat(GtkSatMap * p, gfloat x, gfloat y, gfloat * lon,
                          gfloat * lat)
 {
@@ -1060,13 +1388,15 @@ static gboolean on_motion_notify(GtkWidget * widget, GdkEventMotion * event,
     {
         xy_to_lonlat(satmap, event->x, event->y, &lon, &lat);
 
+        invalidate_info(satmap, satmap->curs_text, INFO_BOTTOM);
         g_free(satmap->curs_text);
         satmap->curs_text = g_strdup_printf(
             "<span background=\"#%s\"> "
             "LON:%.0f\302\260 LAT:%.0f\302\260 </span>",
             satmap->infobgd, lon, lat);
+        invalidate_info(satmap, satmap->curs_text, INFO_BOTTOM);
 
-        gtk_widget_queue_draw(satmap->canvas);
+        queue_dirty(satmap);
     }
 
     return TRUE;
@@ -1200,6 +1530,21 @@ void gtk_sat_map_select_sat(GtkWidget * satmap, gint catnum)
     g_free(catpoint);
 }
 
+/**
+ * Redraw the area of a satellite.
+ *
+ * @param satmap The GtkSatMap widget.
+ * @param obj The satellite object.
+ *
+ * This is for changes made outside gtk_sat_map_update(), e.g. when a
+ * ground track has been calculated in the background; see invalidate_sat().
+ */
+void gtk_sat_map_queue_sat(GtkSatMap * satmap, sat_map_obj_t * obj)
+{
+    invalidate_sat(satmap, obj);
+    queue_dirty(satmap);
+}
+
 void gtk_sat_map_reconf(GtkWidget * widget, GKeyFile * cfgdat)
 {
     (void)widget;
@@ -1272,6 +1617,8 @@ static void load_map_file(GtkSatMap * satmap, float clon)
     g_object_unref(tmpbuf);
     g_free(mapfile);
 
+    create_mipmaps(satmap);
+
     satmap->left_side_lon = -180.0;
     if (clon > 0.0)
         satmap->left_side_lon += clon;
@@ -1279,6 +1626,56 @@ static void load_map_file(GtkSatMap * satmap, float clon)
         satmap->left_side_lon = 180.0 + clon;
 }
 
+/**
+ * Create the reduced maps used by scale_map().
+ *
+ * Each map in satmap->mipmaps is half the size of the previous one, the
+ * first being half the size of satmap->origmap.
+ */
+static void create_mipmaps(GtkSatMap * satmap)
+{
+    GdkPixbuf      *level = satmap->origmap;
+    gint            w = gdk_pixbuf_get_width(level);
+    gint            h = gdk_pixbuf_get_height(level);
+
+    if (satmap->mipmaps)
+        g_ptr_array_free(satmap->mipmaps, TRUE);
+    satmap->mipmaps = g_ptr_array_new_with_free_func(g_object_unref);
+
+    while (w / 2 >= MIPMAP_MIN_WIDTH && h / 2 > 0)
+    {
+        w /= 2;
+        h /= 2;
+        level = gdk_pixbuf_scale_simple(level, w, h, GDK_INTERP_BILINEAR);
+        g_ptr_array_add(satmap->mipmaps, level);
+    }
+}
+
+/**
+ * Scale the map to the given size.
+ *
+ * The map is scaled from the smallest of the reduced maps that is not
+ * smaller than the requested size, so that a small window does not pay for
+ * filtering the full resolution map on every resize.
+ */
+static GdkPixbuf *scale_map(GtkSatMap * satmap, gint width, gint height)
+{
+    GdkPixbuf      *src = satmap->origmap;
+    GdkPixbuf      *level;
+    guint           i;
+
+    for (i = 0; satmap->mipmaps && i < satmap->mipmaps->len; i++)
+    {
+        level = g_ptr_array_index(satmap->mipmaps, i);
+        if (gdk_pixbuf_get_width(level) < width ||
+            gdk_pixbuf_get_height(level) < height)
+            break;
+        src = level;
+    }
+
+    return gdk_pixbuf_scale_simple(src, width, height, GDK_INTERP_BILINEAR);
+}
+
 static gdouble arccos(gdouble x, gdouble y)
 {
     if (x && y)
@@ -1380,22 +1777,51 @@ static gboolean mirror_lon(sat_t * sat, gdouble rangelon, gdouble * mlon,
     return warped;
 }
 
-static guint calculate_footprint(GtkSatMap * satmap, sat_t * sat,
-                                 sat_map_obj_t * obj)
+/**
+ * Get the footprint ring of a satellite.
+ *
+ * The ring is the first half of the footprint, from azimuth 0 to 179,
+ * around a sub-satellite point at longitude 0. It only depends on the
+ * footprint and the latitude of the satellite, so the rings are
+ * calculated for buckets of FOOTPRINT_SIZE_STEP and FOOTPRINT_LAT_STEP
+ * and cached. Whether the ring goes around the north pole is taken from
+ * north_pole_is_covered() for the satellite itself and is part of the
+ * key, so the ring always agrees with pole_is_covered(). The second half
+ * is the mirror image of the first one.
+ */
+static const footprint_ring_t *footprint_ring(sat_t * sat)
 {
+    footprint_ring_t *ring;
+    gpointer        key;
+    gint            lat_bucket, size_bucket;
     guint           azi;
-    gfloat          sx, sy, msx, msy, ssx, ssy;
-    gdouble         ssplat, ssplon, beta, azimuth, num, dem;
-    gdouble         rangelon, rangelat, mlon;
-    gboolean        warped = FALSE;
-    guint           numrc = 1;
-    gint            n1, n2;
+    gdouble         ssplat, beta, azimuth, num, dem;
+    gdouble         rangelon, rangelat;
+    gboolean        north;
+
+    lat_bucket = (gint) floor(sat->ssplat / FOOTPRINT_LAT_STEP + 0.5);
+    size_bucket = (gint) floor(CLAMP(sat->footprint, 0.0, pi * xkmper) /
+                               FOOTPRINT_SIZE_STEP + 0.5);
+    north = north_pole_is_covered(sat);
+    key = GINT_TO_POINTER((size_bucket << 12) | (north << 11) |
+                          (lat_bucket + 1024));
+
+    if (footprint_cache == NULL)
+        footprint_cache = g_hash_table_new_full(g_direct_hash,
+                                                g_direct_equal, NULL, g_free);
 
-    ssplat = sat->ssplat * de2ra;
-    ssplon = sat->ssplon * de2ra;
-    beta = (0.5 * sat->footprint) / xkmper;
+    ring = g_hash_table_lookup(footprint_cache, key);
+    if (ring != NULL)
+        return ring;
 
-    for (azi = 0; azi < 180; azi++)
+    if (g_hash_table_size(footprint_cache) >= FOOTPRINT_CACHE_SIZE)
+        g_hash_table_remove_all(footprint_cache);
+
+    ssplat = lat_bucket * FOOTPRINT_LAT_STEP * de2ra;
+    beta = (0.5 * size_bucket * FOOTPRINT_SIZE_STEP) / xkmper;
+
+    ring = g_new(footprint_ring_t, 1);
+    for (azi = 0; azi < FOOTPRINT_POINTS; azi++)
     {
         azimuth = de2ra * (double)azi;
         rangelat = asin(sin(ssplat) * cos(beta) + cos(azimuth) *
@@ -1403,53 +1829,79 @@ static guint calculate_footprint(GtkSatMap * satmap, sat_t * sat,
         num = cos(beta) - (sin(ssplat) * sin(rangelat));
         dem = cos(ssplat) * cos(rangelat);
 
-        if (azi == 0 && north_pole_is_covered(sat))
-            rangelon = ssplon + pi;
+        if (azi == 0 && north)
+            rangelon = pi;
         else if (fabs(num / dem) > 1.0)
-            rangelon = ssplon;
+            rangelon = 0.0;
         else
-        {
-            if ((180.0 - azi) >= 0)
-                rangelon = ssplon - arccos(num, dem);
-            else
-                rangelon = ssplon + arccos(num, dem);
-        }
+            rangelon = -arccos(num, dem);
 
-        while (rangelon < -pi)
-            rangelon += twopi;
+        ring->lat[azi] = rangelat / de2ra;
+        ring->lon[azi] = rangelon / de2ra;
+    }
 
-        while (rangelon > (pi))
-            rangelon -= twopi;
+    g_hash_table_insert(footprint_cache, key, ring);
 
-        rangelat = rangelat / de2ra;
-        rangelon = rangelon / de2ra;
+    return ring;
+}
 
-        if (mirror_lon(sat, rangelon, &mlon, satmap->left_side_lon))
-            warped = TRUE;
+/**
+ * Calculate the footprint of a satellite.
+ *
+ * The footprint is stored in obj in map coordinates, see lonlat_to_map(),
+ * so it does not change when the map is resized.
+ */
+static guint calculate_footprint(GtkSatMap * satmap, sat_t * sat,
+                                 sat_map_obj_t * obj)
+{
+    const footprint_ring_t *ring;
+    guint           azi;
+    gdouble        *points1, *points2;
+    gdouble         ssx, ssy;
+    gdouble         rangelon, mlon;
+    gboolean        warped = FALSE;
+    guint           numrc = 1;
+    gint            n1, n2;
+
+    if (obj->range1_points == NULL)
+        obj->range1_points = g_new(gdouble, 4 * FOOTPRINT_POINTS);
+    if (obj->range2_points == NULL)
+        obj->range2_points = g_new(gdouble, 4 * FOOTPRINT_POINTS);
+    points1 = obj->range1_points;
+    points2 = obj->range2_points;
 
-        lonlat_to_xy(satmap, rangelon, rangelat, &sx, &sy);
-        lonlat_to_xy(satmap, mlon, rangelat, &msx, &msy);
+    ring = footprint_ring(sat);
 
-        temp_points1[2 * azi] = sx;
-        temp_points1[2 * azi + 1] = sy;
+    for (azi = 0; azi < FOOTPRINT_POINTS; azi++)
+    {
+        rangelon = sat->ssplon + ring->lon[azi];
+        while (rangelon < -180.0)
+            rangelon += 360.0;
+        while (rangelon > 180.0)
+            rangelon -= 360.0;
 
-        temp_points1[718 - 2 * azi] = msx;
-        temp_points1[719 - 2 * azi] = msy;
+        if (mirror_lon(sat, rangelon, &mlon, satmap->left_side_lon))
+            warped = TRUE;
+
+        lonlat_to_map(satmap, rangelon, ring->lat[azi],
+                      &points1[2 * azi], &points1[2 * azi + 1]);
+        lonlat_to_map(satmap, mlon, ring->lat[azi],
+                      &points1[718 - 2 * azi], &points1[719 - 2 * azi]);
     }
 
     if (pole_is_covered(sat))
     {
-        sort_points_x(satmap, sat, temp_points1, 360);
+        sort_points_x(sat, points1, 360);
         numrc = 1;
         n1 = 360;
         n2 = 0;
     }
     else if (warped == TRUE)
     {
-        lonlat_to_xy(satmap, sat->ssplon, sat->ssplat, &ssx, &ssy);
+        lonlat_to_map(satmap, sat->ssplon, sat->ssplat, &ssx, &ssy);
         n1 = 360;
         n2 = 360;
-        split_points(satmap, sat, ssx, temp_points1, &n1, temp_points2, &n2);
+        split_points(sat, ssx, points1, &n1, points2, &n2);
         numrc = 2;
     }
     else
@@ -1459,33 +1911,41 @@ static guint calculate_footprint(GtkSatMap * satmap, sat_t * sat,
         n2 = 0;
     }
 
-    g_free(obj->range1_points);
-    obj->range1_points = g_new(gdouble, n1 * 2);
-    memcpy(obj->range1_points, temp_points1, n1 * 2 * sizeof(gdouble));
     obj->range1_count = n1;
-
-    if (numrc == 2 && n2 > 0)
-    {
-        g_free(obj->range2_points);
-        obj->range2_points = g_new(gdouble, n2 * 2);
-        memcpy(obj->range2_points, temp_points2, n2 * 2 * sizeof(gdouble));
-        obj->range2_count = n2;
-    }
-    else
-    {
-        g_free(obj->range2_points);
-        obj->range2_points = NULL;
-        obj->range2_count = 0;
-    }
+    obj->range2_count = (numrc == 2) ? n2 : 0;
 
     return numrc;
 }
 
-static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx,
+/**
+ * Add a footprint polygon to the cairo path.
+ *
+ * The points are in map coordinates and are projected to the screen with
+ * the transformation matrix. The path is kept in screen coordinates, so
+ * the line width is not affected.
+ */
+static void footprint_path(GtkSatMap * satmap, cairo_t * cr,
+                           const gdouble * points, gint num)
+{
+    gint            i;
+
+    cairo_save(cr);
+    cairo_translate(cr, satmap->x0, satmap->y0);
+    cairo_scale(cr, satmap->width / 360.0, satmap->height / 180.0);
+
+    cairo_move_to(cr, points[0], points[1]);
+    for (i = 1; i < num; i++)
+        cairo_line_to(cr, points[2 * i], points[2 * i + 1]);
+    cairo_close_path(cr);
+
+    cairo_restore(cr);
+}
+
+static void split_points(sat_t * sat, gdouble sspx,
                          gdouble * points1, gint * n1,
                          gdouble * points2, gint * n2)
 {
-    gdouble        *tps1, *tps2;
+    gdouble         tps1[720], tps2[720];
     gint            n, np1, np2, ns, i, j, k;
 
     n = 360;
@@ -1495,14 +1955,12 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx,
     j = 0;
     k = 0;
     ns = 0;
-    tps1 = g_new0(gdouble, n * 2);
-    tps2 = g_new0(gdouble, n * 2);
 
     if ((sat->ssplon >= 179.4) || (sat->ssplon <= -179.4))
     {
         for (i = 0; i < n; i++)
         {
-            if (points1[2 * i] > (satmap->x0 + satmap->width / 2))
+            if (points1[2 * i] > 180.0)
             {
                 tps1[2 * np1] = points1[2 * i];
                 tps1[2 * np1 + 1] = points1[2 * i + 1];
@@ -1516,10 +1974,10 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx,
             }
         }
 
-        sort_points_y(satmap, sat, tps1, np1);
-        sort_points_y(satmap, sat, tps2, np2);
+        sort_points_y(sat, tps1, np1);
+        sort_points_y(sat, tps2, np2);
     }
-    else if (sspx < (satmap->x0 + satmap->width / 2))
+    else if (sspx < 180.0)
     {
         while (points1[2 * i] <= sspx)
         {
@@ -1527,7 +1985,7 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx,
         }
         ns = i - 1;
 
-        while (points1[2 * i] > (satmap->x0 + satmap->width / 2))
+        while (points1[2 * i] > 180.0)
         {
             tps2[2 * j] = points1[2 * i];
             tps2[2 * j + 1] = points1[2 * i + 1];
@@ -1562,7 +2020,7 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx,
         }
         ns = i + 1;
 
-        while (points1[2 * i] < (satmap->x0 + satmap->width / 2))
+        while (points1[2 * i] < 180.0)
         {
             tps2[2 * j] = points1[2 * i];
             tps2[2 * j + 1] = points1[2 * i + 1];
@@ -1603,30 +2061,26 @@ static void split_points(GtkSatMap * satmap, sat_t * sat, gdouble sspx,
     }
     *n2 = np2;
 
-    g_free(tps1);
-    g_free(tps2);
-
     if (np1 > 0 && np2 > 0)
     {
-        if (points1[0] > (satmap->x0 + satmap->width / 2))
+        if (points1[0] > 180.0)
         {
-            points1[0] = satmap->x0 + satmap->width;
-            points1[2 * (np1 - 1)] = satmap->x0 + satmap->width;
-            points2[0] = satmap->x0;
-            points2[2 * (np2 - 1)] = satmap->x0;
+            points1[0] = 360.0;
+            points1[2 * (np1 - 1)] = 360.0;
+            points2[0] = 0.0;
+            points2[2 * (np2 - 1)] = 0.0;
         }
         else
         {
-            points2[0] = satmap->x0 + satmap->width;
-            points2[2 * (np2 - 1)] = satmap->x0 + satmap->width;
-            points1[0] = satmap->x0;
-            points1[2 * (np1 - 1)] = satmap->x0;
+            points2[0] = 360.0;
+            points2[2 * (np2 - 1)] = 360.0;
+            points1[0] = 0.0;
+            points1[2 * (np1 - 1)] = 0.0;
         }
     }
 }
 
-static void sort_points_x(GtkSatMap * satmap, sat_t * sat,
-                          gdouble * points, gint num)
+static void sort_points_x(sat_t * sat, gdouble * points, gint num)
 {
     gsize           size = 2 * sizeof(double);
 
@@ -1636,36 +2090,34 @@ static void sort_points_x(GtkSatMap * satmap, sat_t * sat,
     g_qsort_with_data(points, num, size, compare_coordinates_x, NULL);
 #endif
 
-    points[2] = satmap->x0;
+    points[2] = 0.0;
     points[3] = points[1];
 
-    points[716] = satmap->x0 + satmap->width;
+    points[716] = 360.0;
     points[717] = points[719];
 
     if (sat->ssplat > 0.0)
     {
-        points[0] = satmap->x0;
-        points[1] = satmap->y0;
+        points[0] = 0.0;
+        points[1] = 0.0;
 
-        points[718] = satmap->x0 + satmap->width;
-        points[719] = satmap->y0;
+        points[718] = 360.0;
+        points[719] = 0.0;
     }
     else
     {
-        points[0] = satmap->x0;
-        points[1] = satmap->y0 + satmap->height;
+        points[0] = 0.0;
+        points[1] = 180.0;
 
-        points[718] = satmap->x0 + satmap->width;
-        points[719] = satmap->y0 + satmap->height;
+        points[718] = 360.0;
+        points[719] = 180.0;
     }
 }
 
-static void sort_points_y(GtkSatMap * satmap, sat_t * sat,
-                          gdouble * points, gint num)
+static void sort_points_y(sat_t * sat, gdouble * points, gint num)
 {
     gsize           size;
 
-    (void)satmap;
     (void)sat;
     size = 2 * sizeof(double);
 
@@ -1763,9 +2215,16 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
     obj->oldrcnum = 0;
     obj->newrcnum = 0;
     obj->catnum = sat->tle.catnr;
-    obj->track_data.latlon = NULL;
-    obj->track_data.lines = NULL;
+    obj->track_data.orbits = NULL;
+    obj->track_data.size = 0;
+    obj->track_data.first = 0;
+    obj->track_data.count = 0;
     obj->track_orbit = 0;
+    obj->track_job = NULL;
+    obj->track_dirty.x = 0;
+    obj->track_dirty.y = 0;
+    obj->track_dirty.width = 0;
+    obj->track_dirty.height = 0;
 
     obj->x = x;
     obj->y = y;
@@ -1804,7 +2263,9 @@ static void free_sat_obj(gpointer key, gpointer value, gpointer data)
     if (obj->showtrack)
     {
         sat = SAT(g_hash_table_lookup(satmap->sats, &obj->catnum));
-        ground_track_delete(satmap, sat, satmap->qth, obj, TRUE);
+
+        /* no redraw; the whole map is redrawn or being destroyed */
+        ground_track_delete(NULL, sat, satmap->qth, obj, TRUE);
     }
 
     g_free(obj->nickname);
@@ -1825,28 +2286,17 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
     sat_t          *sat = SAT(value);
     gfloat          x, y;
     gfloat          oldx, oldy;
-    gdouble         now;
     gchar          *tooltip;
     gchar          *aosstr;
 
     catnum = g_new0(gint, 1);
     *catnum = sat->tle.catnr;
 
-    now = satmap->tstamp;
-
-    if (sat->aos > now)
-    {
-        if ((sat->aos < satmap->naos) || (satmap->naos == 0.0))
-        {
-            satmap->naos = sat->aos;
-            satmap->ncat = sat->tle.catnr;
-        }
-    }
-
     obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, catnum));
 
     if (decayed(sat) && obj != NULL)
     {
+        satmap->dirty_all = TRUE;
         free_sat_obj(NULL, obj, satmap);
         g_hash_table_remove(satmap->obj, catnum);
         g_free(catnum);
@@ -1863,6 +2313,7 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         else
         {
             plot_sat(key, value, data);
+            satmap->dirty_all = TRUE;
             g_free(catnum);
             return;
         }
@@ -1898,11 +2349,21 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
     if ((fabs(oldx - x) >= 2 * MARKER_SIZE_HALF) ||
         (fabs(oldy - y) >= 2 * MARKER_SIZE_HALF))
     {
+        invalidate_sat(satmap, obj);
+
         obj->x = x;
         obj->y = y;
 
-        obj->newrcnum = calculate_footprint(satmap, sat, obj);
-        obj->oldrcnum = obj->newrcnum;
+        /* the footprint is in map coordinates and only needs to be
+           calculated when the satellite has moved, not when the map
+           has been resized */
+        if (!satmap->resize)
+        {
+            obj->newrcnum = calculate_footprint(satmap, sat, obj);
+            obj->oldrcnum = obj->newrcnum;
+        }
+
+        invalidate_sat(satmap, obj);
     }
 
     if (obj->showtrack)
@@ -2016,8 +2477,10 @@ static void update_selected(GtkSatMap * satmap, sat_t * sat)
         g_free(alsstr);
     }
 
+    invalidate_info(satmap, satmap->sel_text, INFO_RIGHT | INFO_BOTTOM);
     g_free(satmap->sel_text);
     satmap->sel_text = text;
+    invalidate_info(satmap, satmap->sel_text, INFO_RIGHT | INFO_BOTTOM);
 }
 
 static inline gdouble sgn(gdouble const t)
@@ -2081,6 +2544,7 @@ static void redraw_terminator(GtkSatMap * satmap)
         (satmap->y0 + satmap->height);
 
     satmap->terminator_count = 363;
+    invalidate_layer(satmap);
 }
 
 void gtk_sat_map_lonlat_to_xy(GtkSatMap * m,
@@ -2101,8 +2565,6 @@ void gtk_sat_map_lonlat_to_xy(GtkSatMap * m,
 void gtk_sat_map_reload_sats(GtkWidget * satmap, GHashTable * sats)
 {
     GTK_SAT_MAP(satmap)->sats = sats;
-    GTK_SAT_MAP(satmap)->naos = 0.0;
-    GTK_SAT_MAP(satmap)->ncat = 0;
 
     g_hash_table_foreach(GTK_SAT_MAP(satmap)->obj, reset_ground_track, NULL);
 }
@@ -6,6 +6,7 @@
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 
+#include "event-heap.h"
 #include "gtk-sat-data.h"
 
 /* *INDENT-OFF* */
@@ -30,10 +31,32 @@ typedef struct {
     double          lon;        /*!< Longitude in decimal degrees West. */
 } ssp_t;
 
-/** Data storage for ground tracks */
+/** Line segment of a ground track */
 typedef struct {
-    GSList         *latlon;     /*!< List of ssp_t */
-    GSList         *lines;      /*!< List of line segments (stored as point arrays) */
+    gdouble        *points;     /*!< Array of x,y coordinate pairs */
+    gint            count;      /*!< Number of points in this segment */
+} line_segment_t;
+
+/** Ground track of one orbit */
+typedef struct {
+    long            orbit;      /*!< Orbit number */
+    ssp_t          *ssp;        /*!< Array of num SSPs, ending in the next orbit */
+    guint           num;        /*!< Number of entries in ssp */
+    GSList         *lines;      /*!< List of line_segment_t */
+} ground_track_orbit_t;
+
+/**
+ * Data storage for ground tracks.
+ *
+ * The orbits are kept in a ring buffer, so that when the satellite enters
+ * a new orbit the oldest one can be replaced with the next one.
+ */
+typedef struct {
+    ground_track_orbit_t *orbits;   /*!< Ring buffer of size orbits */
+    guint           size;       /*!< Number of orbits in the ground track */
+    guint           first;      /*!< Index of the oldest orbit */
+    guint           count;      /*!< Number of orbits calculated */
+    gdouble         t_end;      /*!< Time of the last SSP */
 } ground_track_t;
 
 /**
@@ -59,7 +82,7 @@ typedef struct {
     gchar          *nickname;   /*!< Satellite nickname for label */
     gchar          *tooltip;    /*!< Tooltip text */
 
-    /* Range circle points */
+    /* Range circle points in map coordinates, i.e. on a 360 x 180 map */
     gdouble        *range1_points;  /*!< First part of the range circle points. */
     gint            range1_count;   /*!< Number of points in range1. */
     gdouble        *range2_points;  /*!< Second part of the range circle points. */
@@ -72,6 +95,9 @@ typedef struct {
 
     ground_track_t  track_data; /*!< Ground track data. */
     long            track_orbit;        /*!< Orbit when the ground track has been updated. */
+    GCancellable   *track_job;  /*!< Pending ground track calculation, or NULL. */
+    GdkRectangle    track_dirty;        /*!< Area of the ground track segments changed since
+                                           the last redraw; empty if none. */
 
 } sat_map_obj_t;
 
@@ -91,22 +117,35 @@ typedef struct {
     gchar          *next_text;   /*!< Next event text. */
     gchar          *sel_text;    /*!< Text showing info about the selected satellite. */
 
-    /* Grid line positions (calculated during draw) */
-    gboolean        grid_lines_valid;  /*!< Whether grid lines need recalculation */
+    /* Static layer: map, grid and terminator, drawn again only when changed */
+    cairo_surface_t *layer;     /*!< Cached static layer, or NULL. */
+    gboolean        layer_nsew; /*!< Grid labels of the layer use N/S/E/W. */
+    PangoLayout    *layout;     /*!< Layout for all text, created at the first draw. */
+    PangoFontDescription *font_desc;    /*!< Font of the layout. */
+
+    /* Parts of the canvas that need to be drawn again */
+    cairo_region_t *dirty;      /*!< Changed areas, or NULL. */
+    gboolean        dirty_all;  /*!< The whole canvas has changed. */
+
+    /* Drawing time [usec], summed over stat_frames frames */
+    gint64          stat_draw;  /*!< Total drawing time */
+    gint64          stat_draw_max;      /*!< Longest frame */
+    guint           stat_frames;        /*!< Number of frames */
+    guint           stat_layers;        /*!< Number of static layers drawn */
+    guint64         stat_pixels;        /*!< Number of pixels drawn */
+    gint64          stat_start; /*!< Start of the statistics [usec] */
 
     /* Terminator points */
     gdouble        *terminator_points;  /*!< Terminator polyline points. */
     gint            terminator_count;   /*!< Number of terminator points. */
     gdouble         terminator_last_tstamp;     /*!< Timestamp of the last terminator drawn. */
 
-    gdouble         naos;       /*!< Next event time. */
-    gint            ncat;       /*!< Next event catnum. */
-
     gdouble         tstamp;     /*!< Time stamp for calculations; set by GtkSatModule */
 
     GKeyFile       *cfgdata;    /*!< Module configuration data. */
     GHashTable     *sats;       /*!< Pointer to satellites (owned by parent GtkSatModule). */
     qth_t          *qth;        /*!< Pointer to current location. */
+    event_heap_t   *events;     /*!< Upcoming events (owned by parent GtkSatModule). */
 
     GHashTable     *obj;        /*!< Satellite objects (sat_map_obj_t) for each satellite. */
     GHashTable     *showtracks; /*!< A hash of satellites to show tracks for. */
@@ -143,6 +182,7 @@ typedef struct {
     guint32         col_terminator; /*!< Terminator color. */
 
     GdkPixbuf      *origmap;    /*!< Original map kept here for high quality scaling. */
+    GPtrArray      *mipmaps;    /*!< origmap halved once, twice, ... */
     GdkPixbuf      *map;        /*!< Scaled map for current size. */
 
     gchar          *font;       /*!< Default font name */
@@ -155,7 +195,8 @@ struct _GtkSatMapClass {
 
 GType           gtk_sat_map_get_type(void);
 GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata,
-                                GHashTable * sats, qth_t * qth);
+                                GHashTable * sats, qth_t * qth,
+                                event_heap_t * events);
 void            gtk_sat_map_update(GtkWidget * widget);
 void            gtk_sat_map_reconf(GtkWidget * widget, GKeyFile * cfgdat);
 void            gtk_sat_map_lonlat_to_xy(GtkSatMap * m,
@@ -164,6 +205,7 @@ void            gtk_sat_map_lonlat_to_xy(GtkSatMap * m,
 
 void            gtk_sat_map_reload_sats(GtkWidget * satmap, GHashTable * sats);
 void            gtk_sat_map_select_sat(GtkWidget * satmap, gint catnum);
+void            gtk_sat_map_queue_sat(GtkSatMap * satmap, sat_map_obj_t * obj);
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -65,6 +65,11 @@
 #include "time-tools.h"
 
 
+/* Fewest satellites per update thread. Waking up a thread and waiting for
+   it costs about as much as updating a couple of hundred satellites, so
+   smaller modules are updated in the calling thread. */
+#define MODULE_SHARD_MIN_SATS 200
+
 static GtkVBoxClass *parent_class = NULL;
 
 static void gtk_sat_module_free_sat(gpointer sat)
@@ -186,7 +191,26 @@ static void gtk_sat_module_destroy(GtkWidget * widget)
         module->qth = NULL;
     }
 
+    /* stop update threads */
+    if (module->pool)
+    {
+        g_thread_pool_free(module->pool, FALSE, TRUE);
+        module->pool = NULL;
+    }
+
     /* clean up satellites */
+    predict_batch_free(module->batch);
+    module->batch = NULL;
+    event_heap_free(module->events);
+    module->events = NULL;
+    g_free(module->ephem);
+    module->ephem = NULL;
+    if (module->satlist)
+    {
+        g_ptr_array_free(module->satlist, TRUE);
+        module->satlist = NULL;
+    }
+
     if (module->satellites)
     {
         g_hash_table_destroy(module->satellites);
@@ -228,6 +252,11 @@ static void gtk_sat_module_init(GtkSatModule * module,
 
     module->satellites = g_hash_table_new_full(g_int_hash, g_int_equal,
                                                g_free, gtk_sat_module_free_sat);
+    module->batch = NULL;
+    module->satlist = NULL;
+    module->events = event_heap_new();
+    module->use_ephem = FALSE;
+    module->ephem = NULL;
 
     module->rotctrlwin = NULL;
     module->rotctrl = NULL;
@@ -241,6 +270,17 @@ static void gtk_sat_module_init(GtkSatModule * module,
 
     g_mutex_init(&module->busy);
 
+    module->nthreads = 1;
+    module->pool = NULL;
+    module->pending = 0;
+    g_mutex_init(&module->pool_lock);
+    g_cond_init(&module->pool_cond);
+    module->stat_sats = 0;
+    module->stat_views = 0;
+    module->stat_other = 0;
+    module->stat_max = 0;
+    module->stat_cycles = 0;
+
     /* open the gpsd device */
     module->gps_data = NULL;
 
@@ -310,12 +350,14 @@ static GtkWidget *create_view(GtkSatModule * module, guint num)
 
     case GTK_SAT_MOD_VIEW_MAP:
         view = gtk_sat_map_new(module->cfgdata,
-                               module->satellites, module->qth);
+                               module->satellites, module->qth,
+                               module->events);
         break;
 
     case GTK_SAT_MOD_VIEW_POLAR:
         view = gtk_polar_view_new(module->cfgdata,
-                                  module->satellites, module->qth);
+                                  module->satellites, module->qth,
+                                  module->events);
         break;
 
     case GTK_SAT_MOD_VIEW_SINGLE:
@@ -494,6 +536,47 @@ static void gtk_sat_module_load_sats(GtkSatModule * module)
                 _("%s: Read %d out of %d satellites"), __func__, succ, length);
 
     g_free(sats);
+
+    /* near-earth satellites are propagated together in the timeout */
+    predict_batch_free(module->batch);
+    module->batch = predict_batch_new(module->satellites);
+
+    /* array of satellites to share among the update threads, in the order
+       of the batch so that each thread updates one part of the batch */
+    module->satlist = g_ptr_array_sized_new(succ);
+    for (i = 0; i < (guint) module->batch->sgp4.num; i++)
+        g_ptr_array_add(module->satlist, module->batch->sgp4.sats[i]);
+    for (i = 0; i < module->batch->deep->len; i++)
+        g_ptr_array_add(module->satlist,
+                        g_ptr_array_index(module->batch->deep, i));
+    event_heap_set_sats(module->events, module->satlist);
+}
+
+/**
+ * Replace the GtkSkyGlance widget with a new one
+ *
+ * @param module Pointer to the GtkSatModule widget
+ *
+ * This recalculates all passes and is used when the qth has moved or the
+ * satellites have been reloaded.
+ */
+static void rebuild_skg(GtkSatModule * module)
+{
+    gint64          t0 = g_get_monotonic_time();
+
+    gtk_container_remove(GTK_CONTAINER(module->skgwin), module->skg);
+    module->skg =
+        gtk_sky_glance_new(module->satellites, module->qth, module->tmgCdnum);
+    gtk_container_add(GTK_CONTAINER(module->skgwin), module->skg);
+    gtk_widget_show_all(module->skg);
+
+    module->lastSkgUpd = module->tmgCdnum;
+    qth_small_save(module->qth, &(module->lastSkgUpdqth));
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Rebuilt GtkSkyGlance for %s in %.1f ms"),
+                __func__, module->name,
+                (g_get_monotonic_time() - t0) / 1000.0);
 }
 
 /**
@@ -508,10 +591,10 @@ static void gtk_sat_module_load_sats(GtkSatModule * module)
  * GtkSkyGlance widget was last updated and triggers an update if necessary.
  * The current distance is set to 1km.
  *
- * This is a cheap/lazy implementation of automatic update. Instead of
- * performing a real update by "moving" the objects on the GtkSkyGlance canvas,
- * we simply replace the current GtkSkyGlance object with a new one.
- * Ugly but safe.
+ * When only the time has changed, the time window of the widget is moved
+ * using gtk_sky_glance_set_time(), which keeps the passes still inside the
+ * window and only calculates the new ones. A qth move changes all passes,
+ * so the widget is replaced with a new one.
  *
  * To ensure smooth performance while running in simulated real time with high
  * throttle value or manual time mode, the caller is responsible for only calling
@@ -520,23 +603,15 @@ static void gtk_sat_module_load_sats(GtkSatModule * module)
 static void update_skg(GtkSatModule * module)
 {
     /* update SKG if ~60 seconds have passed or we have moved 1 km */
-    if (G_UNLIKELY(fabs(module->tmgCdnum - module->lastSkgUpd) > 7.0e-4) ||
-        G_UNLIKELY(qth_small_dist(module->qth, module->lastSkgUpdqth) > 1.0))
+    if (G_UNLIKELY(qth_small_dist(module->qth, module->lastSkgUpdqth) > 1.0))
     {
-
-        sat_log_log(SAT_LOG_LEVEL_INFO,
-                    _("%s: Updating GtkSkyGlance for %s"),
-                    __func__, module->name);
-
-        gtk_container_remove(GTK_CONTAINER(module->skgwin), module->skg);
-        module->skg =
-            gtk_sky_glance_new(module->satellites, module->qth,
-                               module->tmgCdnum);
-        gtk_container_add(GTK_CONTAINER(module->skgwin), module->skg);
-        gtk_widget_show_all(module->skg);
-
+        rebuild_skg(module);
+    }
+    else if (G_UNLIKELY(fabs(module->tmgCdnum - module->lastSkgUpd) > 7.0e-4))
+    {
+        gtk_sky_glance_set_time(GTK_SKY_GLANCE(module->skg),
+                                module->tmgCdnum);
         module->lastSkgUpd = module->tmgCdnum;
-        qth_small_save(module->qth, &(module->lastSkgUpdqth));
     }
 }
 
@@ -618,35 +693,31 @@ static void update_child(GtkWidget * child, gdouble tstamp)
 /**
  * Update a given satellite.
  *
- * @param key The hash table key (catnum)
- * @param val The hash table value (sat_t structure)
- * @param data User data (the GtkSatModule widget).
+ * @param module The GtkSatModule widget.
+ * @param sat The satellite to update.
+ * @param eph The ephemeris of the satellite or NULL to calculate exactly.
  *
- * This function updates the tracking data for a given satellite. It is called by
- * the timeout handler for each element in the hash table.
+ * This function updates the tracking data for a given satellite. It is called
+ * by gtk_sat_module_update_sats() for each satellite in the module, possibly
+ * from one of the update threads. It must therefore not touch anything but
+ * the satellite, its ephemeris and read-only module data.
  */
-static void gtk_sat_module_update_sat(gpointer key, gpointer val,
-                                      gpointer data)
+static void gtk_sat_module_update_sat(GtkSatModule * module, sat_t * sat,
+                                      cheb_ephem_t * eph)
 {
-    sat_t          *sat;
-    GtkSatModule   *module;
     gdouble         daynum;
     gdouble         maxdt;
+    gdouble         tol;
 
-    (void)key;
-
-    g_return_if_fail((val != NULL) && (data != NULL));
-
-    sat = SAT(val);
-    module = GTK_SAT_MODULE(data);
-    maxdt = (gdouble) sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
+    maxdt = module->upd_maxdt;
+    tol = module->upd_tol;
 
     /* get current time (real or simulated */
     daynum = module->tmgCdnum;
 
     /* update events if the event counter has been reset
        and the other requirements are fulfilled */
-    if ((GTK_SAT_MODULE(module)->event_count == 0) &&
+    if ((module->event_count == 0) &&
         has_aos(sat, module->qth))
     {
         /* Note that has_aos may return TRUE for geostationary sats
@@ -654,8 +725,8 @@ static void gtk_sat_module_update_sat(gpointer key, gpointer val,
            find_aos and find_los will not go beyond the time limit
            we specify (in those cases they return 0.0 for AOS/LOS times.
            We use SAT_CFG_INT_PRED_LOOK_AHEAD for upper time limit */
-        sat->aos = find_aos(sat, module->qth, daynum, maxdt);
-        sat->los = find_los(sat, module->qth, daynum, maxdt);
+        sat->aos = find_aos(sat, module->qth, daynum, maxdt, tol);
+        sat->los = find_los(sat, module->qth, daynum, maxdt, tol);
     }
     /*
        Update AOS and LOS for this satellite if it was known and is before
@@ -694,12 +765,198 @@ static void gtk_sat_module_update_sat(gpointer key, gpointer val,
        for most circumstances.
      */
     if (sat->aos > 0 && sat->aos < daynum)
-        sat->aos = find_aos(sat, module->qth, daynum, maxdt);
+        sat->aos = find_aos(sat, module->qth, daynum, maxdt, tol);
 
     if (sat->los > 0 && sat->los < daynum)
-        sat->los = find_los(sat, module->qth, daynum, maxdt);
+        sat->los = find_los(sat, module->qth, daynum, maxdt, tol);
+
+    /* when the module has a batch, the position is calculated afterwards
+       by predict_calc_batch() or predict_calc_batch_part(); the ephemeris
+       replaces both */
+    if (eph != NULL)
+        predict_calc_ephem(sat, eph, &module->upd_ctx);
+    else if (module->batch == NULL || module->upd_ephem)
+        predict_calc_ctx(sat, &module->upd_ctx);
+}
+
+/**
+ * Get the ephemeris to use for a satellite in this cycle.
+ *
+ * @param module The GtkSatModule widget.
+ * @param i The index of the satellite in satlist.
+ * @return The ephemeris or NULL if the satellite is calculated exactly.
+ */
+static cheb_ephem_t *gtk_sat_module_sat_ephem(GtkSatModule * module, guint i)
+{
+    sat_t          *sat = SAT(g_ptr_array_index(module->satlist, i));
+
+    if (!module->upd_ephem || sat == module->upd_exact[0] ||
+        sat == module->upd_exact[1])
+        return NULL;
+
+    return &module->ephem[i];
+}
+
+/**
+ * Update the satellites first to last - 1 in satlist.
+ *
+ * @param module The GtkSatModule widget.
+ * @param first Index of the first satellite.
+ * @param last Index after the last satellite.
+ */
+static void gtk_sat_module_update_range(GtkSatModule * module, guint first,
+                                        guint last)
+{
+    guint           i;
+
+    for (i = first; i < last; i++)
+        gtk_sat_module_update_sat(module,
+                                  SAT(g_ptr_array_index(module->satlist, i)),
+                                  gtk_sat_module_sat_ephem(module, i));
+}
+
+/**
+ * Update a shard of the satellites.
+ *
+ * @param data The shard number + 1.
+ * @param user_data The GtkSatModule widget.
+ *
+ * This is the thread pool function. Each of the upd_shards shards is one
+ * part of the batch from predict_batch_part(), whose satellites it updates
+ * and then propagates, so that no two threads touch the same satellite.
+ */
+static void gtk_sat_module_update_shard(gpointer data, gpointer user_data)
+{
+    GtkSatModule   *module = (GtkSatModule *) user_data;
+    guint           shard = GPOINTER_TO_UINT(data) - 1;
+    guint           nnear = module->batch->sgp4.num;
+    predict_batch_part_t range;
+
+    /* satlist holds the near-earth satellites of the batch followed by
+       the deep-space ones */
+    predict_batch_part(module->batch, shard, module->upd_shards, &range);
+    gtk_sat_module_update_range(module, range.first, range.last);
+    gtk_sat_module_update_range(module, nnear + range.dfirst,
+                                nnear + range.dlast);
+
+    if (!module->upd_ephem)
+        predict_calc_batch_part(module->batch, &range, &module->upd_ctx);
+
+    g_mutex_lock(&module->pool_lock);
+    if (--module->pending == 0)
+        g_cond_signal(&module->pool_cond);
+    g_mutex_unlock(&module->pool_lock);
+}
+
+/**
+ * Update all satellites.
+ *
+ * @param module The GtkSatModule widget.
+ *
+ * The satellites are updated by the thread pool if there is one and the
+ * module has at least MODULE_SHARD_MIN_SATS satellites per thread,
+ * otherwise in the calling thread. In either case the function returns when
+ * all satellites have been updated, so that the views see consistent data.
+ *
+ * When the ephemeris cache is enabled and the time controller is not running
+ * in real time, the positions are evaluated from the ephemerides, except for
+ * the targets of the radio and rotator controllers.
+ */
+static void gtk_sat_module_update_sats(GtkSatModule * module)
+{
+    guint           i;
+
+    if (module->satlist == NULL)
+        return;
+
+    /* sat-cfg and the controllers may not be read from the update threads */
+    module->upd_maxdt = (gdouble) sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
+    module->upd_tol = predict_event_tol();
+    predict_ctx_init(&module->upd_ctx, module->qth, module->tmgCdnum);
+    module->upd_ephem = module->use_ephem && (module->throttle != 1);
+    module->upd_exact[0] = module->rigctrl ?
+        GTK_RIG_CTRL(module->rigctrl)->target : NULL;
+    module->upd_exact[1] = module->rotctrl ?
+        GTK_ROT_CTRL(module->rotctrl)->target : NULL;
+    module->upd_shards = MIN(module->nthreads,
+                             module->satlist->len / MODULE_SHARD_MIN_SATS);
+
+    if (module->upd_ephem && module->ephem == NULL)
+    {
+        module->ephem = g_new(cheb_ephem_t, module->satlist->len);
+        for (i = 0; i < module->satlist->len; i++)
+            Cheb_Init(&module->ephem[i]);
+    }
+
+    if (module->pool == NULL || module->upd_shards < 2)
+    {
+        gtk_sat_module_update_range(module, 0, module->satlist->len);
+
+        if (!module->upd_ephem)
+            predict_calc_batch(module->batch, &module->upd_ctx);
+    }
+    else
+    {
+        module->pending = module->upd_shards;
+        for (i = 0; i < module->upd_shards; i++)
+            g_thread_pool_push(module->pool, GUINT_TO_POINTER(i + 1), NULL);
+
+        /* wait for all shards to finish */
+        g_mutex_lock(&module->pool_lock);
+        while (module->pending > 0)
+            g_cond_wait(&module->pool_cond, &module->pool_lock);
+        g_mutex_unlock(&module->pool_lock);
+    }
 
-    predict_calc(sat, module->qth, daynum);
+    /* the heap is not thread safe; only the satellites whose events were
+       recalculated above are moved */
+    for (i = 0; i < module->satlist->len; i++)
+        event_heap_update(module->events, i);
+}
+
+/**
+ * Log the average duration of the update stages and reset the counters.
+ *
+ * The cost of the AOS/LOS searches and the pass cache statistics are logged
+ * too. Those counters are shared by all modules and are never reset.
+ */
+static void gtk_sat_module_log_timing(GtkSatModule * module)
+{
+    guint           events, calls;
+    guint           hits, misses;
+
+    if (module->stat_cycles > 0)
+    {
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: %s: %u cycles, %u threads, average [usec]: "
+                      "sats %" G_GINT64_FORMAT ", views %" G_GINT64_FORMAT
+                      ", other %" G_GINT64_FORMAT "; max cycle %"
+                      G_GINT64_FORMAT), __func__, module->name,
+                    module->stat_cycles, module->nthreads,
+                    module->stat_sats / module->stat_cycles,
+                    module->stat_views / module->stat_cycles,
+                    module->stat_other / module->stat_cycles,
+                    module->stat_max);
+
+        predict_event_stats(&events, &calls);
+        if (events > 0)
+            sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                        _("%s: %u AOS/LOS searches, %.1f orbit calculations "
+                          "per search"), __func__, events,
+                        (gdouble) calls / events);
+
+        predict_cache_stats(&hits, &misses);
+        if (hits + misses > 0)
+            sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                        _("%s: pass cache: %u hits, %u misses"), __func__,
+                        hits, misses);
+    }
+
+    module->stat_sats = 0;
+    module->stat_views = 0;
+    module->stat_other = 0;
+    module->stat_max = 0;
+    module->stat_cycles = 0;
 }
 
 /** Module timeout callback. */
@@ -711,6 +968,7 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
     GdkWindowState  state;
     gdouble         delta;
     guint           i;
+    gint64          t0, t1, t2, t3, t4;
 
     /*update the qth position */
     qth_data_update(mod->qth, mod->tmgCdnum);
@@ -773,6 +1031,7 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
             qth_small_dist(mod->qth, mod->qth_event) > 1.0)
         {
             mod->event_count = 0;       // will trigger find_aos() and find_los()
+            gtk_sat_module_log_timing(mod);
         }
 
         /* if the events are going to be recalculated store the position */
@@ -782,9 +1041,9 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
         }
 
         /* update satellite data */
-        if (mod->satellites != NULL)
-            g_hash_table_foreach(mod->satellites,
-                                 gtk_sat_module_update_sat, module);
+        t0 = g_get_monotonic_time();
+        gtk_sat_module_update_sats(mod);
+        t1 = g_get_monotonic_time();
 
         /* update children */
         for (i = 0; i < mod->nviews; i++)
@@ -792,11 +1051,11 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
             child = GTK_WIDGET(g_slist_nth_data(mod->views, i));
             update_child(child, mod->tmgCdnum);
         }
+        t2 = g_get_monotonic_time();
 
         /* update satellite data (it may have got out of sync during child updates) */
-        if (mod->satellites != NULL)
-            g_hash_table_foreach(mod->satellites,
-                                 gtk_sat_module_update_sat, module);
+        gtk_sat_module_update_sats(mod);
+        t3 = g_get_monotonic_time();
 
         /* update target if autotracking is enabled */
         if (mod->autotrack)
@@ -816,6 +1075,13 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
         if (mod->skg)
             update_skg(mod);
 
+        t4 = g_get_monotonic_time();
+        mod->stat_sats += (t1 - t0) + (t3 - t2);
+        mod->stat_views += t2 - t1;
+        mod->stat_other += t4 - t3;
+        mod->stat_max = MAX(mod->stat_max, t4 - t0);
+        mod->stat_cycles++;
+
         mod->event_count++;
 
         /* store time keeping variables */
@@ -941,6 +1207,21 @@ static void gtk_sat_module_read_cfg_data(GtkSatModule * module,
                                       MOD_CFG_TIMEOUT_KEY,
                                       SAT_CFG_INT_MODULE_TIMEOUT);
 
+    /* get number of satellite update threads; 0 means one per CPU */
+    module->nthreads = mod_cfg_get_int(module->cfgdata,
+                                       MOD_CFG_GLOBAL_SECTION,
+                                       MOD_CFG_THREADS_KEY,
+                                       SAT_CFG_INT_MODULE_THREADS);
+    if (module->nthreads == 0)
+        module->nthreads = g_get_num_processors();
+    module->nthreads = CLAMP(module->nthreads, 1, 64);
+
+    /* approximate orbits when not running in real time */
+    module->use_ephem = mod_cfg_get_bool(module->cfgdata,
+                                         MOD_CFG_GLOBAL_SECTION,
+                                         MOD_CFG_EPHEM_KEY,
+                                         SAT_CFG_BOOL_MODULE_EPHEM_CACHE);
+
     /* get grid layout configuration (introduced in 1.2) */
     buffer = mod_cfg_get_str(module->cfgdata,
                              MOD_CFG_GLOBAL_SECTION,
@@ -1003,6 +1284,7 @@ GtkWidget *gtk_sat_module_new(const gchar * cfgfile)
 {
     GtkSatModule   *module;
     GtkWidget      *butbox;
+    GError         *error = NULL;
 
     /* Read configuration data.
      * If cfgfile is not existing or is NULL, start the wizard
@@ -1093,6 +1375,21 @@ GtkWidget *gtk_sat_module_new(const gchar * cfgfile)
     create_module_layout(module);
     gtk_widget_show_all(GTK_WIDGET(module));
 
+    /* create satellite update threads */
+    if (module->nthreads > 1)
+    {
+        module->pool = g_thread_pool_new(gtk_sat_module_update_shard, module,
+                                         module->nthreads, TRUE, &error);
+        if (module->pool == NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Could not create update threads (%s)"),
+                        __func__, error->message);
+            g_clear_error(&error);
+            module->nthreads = 1;
+        }
+    }
+
     /* start timeout */
     module->timerid = g_timeout_add(module->timeout, gtk_sat_module_timeout_cb,
                                     module);
@@ -1443,7 +1740,18 @@ void gtk_sat_module_reload_sats(GtkSatModule * module)
                 _("%s: Reloading satellites for module %s"),
                 __func__, module->name);
 
-    /* remove each element from the hash table, but keep the hash table */
+    /* remove each element from the hash table, but keep the hash table;
+       the batch points to the satellites so it must go first */
+    predict_batch_free(module->batch);
+    module->batch = NULL;
+    event_heap_set_sats(module->events, NULL);
+    g_free(module->ephem);
+    module->ephem = NULL;
+    if (module->satlist)
+    {
+        g_ptr_array_free(module->satlist, TRUE);
+        module->satlist = NULL;
+    }
     g_hash_table_remove_all(module->satellites);
 
     /* reset event counter so that next AOS/LOS gets re-calculated */
@@ -1459,6 +1767,10 @@ void gtk_sat_module_reload_sats(GtkSatModule * module)
         reload_sats_in_child(child, module);
     }
 
+    /* the sky at a glance refers to the old satellites */
+    if (module->skg)
+        rebuild_skg(module);
+
     /* FIXME: radio and rotator controller */
 
     /* unlock module */
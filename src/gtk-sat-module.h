@@ -5,8 +5,10 @@
 #include <glib.h>
 #include <gtk/gtk.h>
 
+#include "event-heap.h"
 #include "qth-data.h"
 #include "gtk-sat-data.h"
+#include "predict-tools.h"
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -78,6 +80,10 @@ struct _gtk_sat_module {
     qth_t          *qth;        /*!< QTH information. */
     qth_small_t     qth_event;  /*!< QTH information for last AOS/LOS update. */
     GHashTable     *satellites; /*!< Satellites. */
+    predict_batch_t *batch;     /*!< Satellites propagated together in each cycle. */
+    GPtrArray      *satlist;    /*!< The satellites as an array, split into shards
+                                   by the update threads. */
+    event_heap_t   *events;     /*!< Next AOS and LOS of the satellites in satlist. */
 
     guint32         timeout;    /*!< Timeout value [msec] */
 
@@ -88,6 +94,32 @@ struct _gtk_sat_module {
                                    finished or not. Also used for blocking
                                    the module during TLE update. */
 
+    /* parallel satellite update */
+    guint           nthreads;   /*!< Number of satellite update threads */
+    GThreadPool    *pool;       /*!< Update threads; NULL if nthreads is 1 */
+    guint           upd_shards; /*!< Number of shards in this cycle */
+    guint           pending;    /*!< Number of shards still being updated */
+    GMutex          pool_lock;  /*!< Protects pending */
+    GCond           pool_cond;  /*!< Signalled when pending drops to 0 */
+    gdouble         upd_maxdt;  /*!< AOS/LOS look-ahead used in this cycle */
+    gdouble         upd_tol;    /*!< AOS/LOS tolerance used in this cycle */
+    obs_frame_t     upd_ctx;    /*!< Observer frame of this cycle */
+
+    /* approximate orbits when not running in real time */
+    gboolean        use_ephem;  /*!< Whether the ephemeris cache is enabled */
+    cheb_ephem_t   *ephem;      /*!< Ephemerides in the order of satlist;
+                                   NULL until first needed */
+    gboolean        upd_ephem;  /*!< Whether ephem is used in this cycle */
+    sat_t          *upd_exact[2];       /*!< Radio and rotator targets; always
+                                           calculated exactly */
+
+    /* timing of the update stages [usec], summed over stat_cycles cycles */
+    gint64          stat_sats;  /*!< Satellite update */
+    gint64          stat_views; /*!< Child view update */
+    gint64          stat_other; /*!< Autotrack, rig/rot control and sky at a glance */
+    gint64          stat_max;   /*!< Longest cycle */
+    guint           stat_cycles;
+
     /* time keeping */
     gdouble         rtNow;      /*!< Real-time in this cycle */
     gdouble         rtPrev;     /*!< Real-time in previous cycle */
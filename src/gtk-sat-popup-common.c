@@ -25,6 +25,7 @@
 #include "predict-tools.h"
 #include "sat-cfg.h"
 #include "sat-pass-dialogs.h"
+#include "time-tools.h"
 
 
 void add_pass_menu_items(GtkWidget * menu, sat_t * sat, qth_t * qth,
@@ -118,43 +119,17 @@ void show_next_pass_dialog(sat_t * sat, qth_t * qth, gdouble tstamp,
                            GtkWindow * toplevel)
 {
     GtkWidget      *dialog;
-    pass_t         *pass;
 
     /* check whether sat actually has AOS */
     if (has_aos(sat, qth))
     {
         if (sat_cfg_get_bool(SAT_CFG_BOOL_PRED_USE_REAL_T0))
-        {
-            pass = get_next_pass(sat, qth,
-                                 sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD));
-        }
-        else
-        {
-            pass = get_pass(sat, qth, tstamp,
-                            sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD));
-        }
-
-        if (pass != NULL)
-        {
-            show_pass(sat->nickname, qth, pass, GTK_WIDGET(toplevel));
-        }
-        else
-        {
-            /* show dialog that there are no passes within time frame */
-            dialog = gtk_message_dialog_new(toplevel,
-                                            GTK_DIALOG_MODAL |
-                                            GTK_DIALOG_DESTROY_WITH_PARENT,
-                                            GTK_MESSAGE_INFO,
-                                            GTK_BUTTONS_OK,
-                                            _("Satellite %s has no passes\n"
-                                              "within the next %d days"),
-                                            sat->nickname,
-                                            sat_cfg_get_int
-                                            (SAT_CFG_INT_PRED_LOOK_AHEAD));
-
-            gtk_dialog_run(GTK_DIALOG(dialog));
-            gtk_widget_destroy(dialog);
-        }
+            tstamp = get_current_daynum();
+
+        /* the dialog shows the pass or tells that there is none */
+        show_pass_async(sat, qth, tstamp,
+                        sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD),
+                        GTK_WIDGET(toplevel));
     }
     else
     {
@@ -181,52 +156,17 @@ void show_next_pass_dialog(sat_t * sat, qth_t * qth, gdouble tstamp,
 void show_future_passes_dialog(sat_t * sat, qth_t * qth, gdouble tstamp,
                                GtkWindow * toplevel)
 {
-    GSList         *passes = NULL;
-    GtkWidget      *dialog;
-
     /* check wheather sat actially has AOS */
     if (has_aos(sat, qth))
     {
-
         if (sat_cfg_get_bool(SAT_CFG_BOOL_PRED_USE_REAL_T0))
-        {
-            passes = get_next_passes(sat, qth,
-                                     sat_cfg_get_int
-                                     (SAT_CFG_INT_PRED_LOOK_AHEAD),
-                                     sat_cfg_get_int
-                                     (SAT_CFG_INT_PRED_NUM_PASS));
-        }
-        else
-        {
-            passes = get_passes(sat, qth, tstamp,
-                                sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD),
-                                sat_cfg_get_int(SAT_CFG_INT_PRED_NUM_PASS));
-
-        }
-
-
-        if (passes != NULL)
-        {
-            show_passes(sat->nickname, qth, passes, GTK_WIDGET(toplevel));
-        }
-        else
-        {
-            /* show dialog that there are no passes within time frame */
-            dialog = gtk_message_dialog_new(toplevel,
-                                            GTK_DIALOG_MODAL |
-                                            GTK_DIALOG_DESTROY_WITH_PARENT,
-                                            GTK_MESSAGE_INFO,
-                                            GTK_BUTTONS_OK,
-                                            _("Satellite %s has no passes\n"
-                                              "within the next %d days"),
-                                            sat->nickname,
-                                            sat_cfg_get_int
-                                            (SAT_CFG_INT_PRED_LOOK_AHEAD));
-
-            gtk_dialog_run(GTK_DIALOG(dialog));
-            gtk_widget_destroy(dialog);
-        }
+            tstamp = get_current_daynum();
 
+        /* the dialog shows the passes or tells that there are none */
+        show_passes_async(sat, qth, tstamp,
+                          sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD),
+                          sat_cfg_get_int(SAT_CFG_INT_PRED_NUM_PASS),
+                          GTK_WIDGET(toplevel));
     }
     else
     {
@@ -60,6 +60,7 @@
 #define SKG_MARGIN              15
 #define SKG_FOOTER              50
 #define SKG_CURSOR_WIDTH        0.5
+#define SKG_MAX_PASSES          10      /* passes per satellite */
 
 static GtkBoxClass *parent_class = NULL;
 
@@ -80,6 +81,7 @@ static void gtk_sky_glance_init(GtkSkyGlance * skg,
     skg->sats = NULL;
     skg->qth = NULL;
     skg->passes = NULL;
+    skg->satdata = NULL;
     skg->satlab = NULL;
     skg->x0 = 0;
     skg->y0 = 0;
@@ -90,6 +92,7 @@ static void gtk_sky_glance_init(GtkSkyGlance * skg,
     skg->satcnt = 0;
     skg->ts = 0.0;
     skg->te = 0.0;
+    skg->cancellable = NULL;
     skg->num_ticks = 0;
     skg->major_x = NULL;
     skg->minor_x = NULL;
@@ -109,20 +112,20 @@ static void free_sat_label(gpointer data)
     }
 }
 
-static void gtk_sky_glance_destroy(GtkWidget * widget)
+/** Free all passes and satellite labels */
+static void clear_passes(GtkSkyGlance * skg)
 {
-    GtkSkyGlance *skg = GTK_SKY_GLANCE(widget);
-    sky_pass_t   *skypass;
-    guint         i, n;
+    sky_pass_t     *skypass;
+    GSList         *node;
+    guint           i;
 
     /* free passes */
     /* FIXME: TBC whether this is enough */
     if (skg->passes != NULL)
     {
-        n = g_slist_length(skg->passes);
-        for (i = 0; i < n; i++)
+        for (node = skg->passes; node != NULL; node = node->next)
         {
-            skypass = (sky_pass_t *)g_slist_nth_data(skg->passes, i);
+            skypass = (sky_pass_t *)node->data;
             free_pass(skypass->pass);
             g_free(skypass);
         }
@@ -137,7 +140,20 @@ static void gtk_sky_glance_destroy(GtkWidget * widget)
         skg->satlab = NULL;
     }
 
-    /* free tick data */
+    /* the satellites lose their rows with their labels */
+    for (i = 0; skg->satdata != NULL && i < skg->numsat; i++)
+    {
+        skg->satdata[i].row = -1;
+        skg->satdata[i].label = NULL;
+        skg->satdata[i].num_passes = 0;
+    }
+}
+
+/** Free the time tick data */
+static void free_time_ticks(GtkSkyGlance * skg)
+{
+    guint           i;
+
     g_free(skg->major_x);
     skg->major_x = NULL;
 
@@ -153,6 +169,26 @@ static void gtk_sky_glance_destroy(GtkWidget * widget)
         g_free(skg->tick_labels);
         skg->tick_labels = NULL;
     }
+}
+
+static void gtk_sky_glance_destroy(GtkWidget * widget)
+{
+    GtkSkyGlance *skg = GTK_SKY_GLANCE(widget);
+
+    /* the prediction must not add passes to a destroyed widget */
+    if (skg->cancellable != NULL)
+    {
+        g_cancellable_cancel(skg->cancellable);
+        g_clear_object(&skg->cancellable);
+    }
+
+    clear_passes(skg);
+
+    g_free(skg->satdata);
+    skg->satdata = NULL;
+
+    /* free tick data */
+    free_time_ticks(skg);
 
     g_free(skg->time_label);
     skg->time_label = NULL;
@@ -440,95 +476,112 @@ static gboolean on_button_release(GtkWidget *widget, GdkEventButton *event, gpoi
     return TRUE;
 }
 
-static void size_allocate_cb(GtkWidget * widget, GtkAllocation * allocation,
-                             gpointer data)
+/**
+ * Update the position of the time ticks, pass boxes and labels
+ *
+ * This is called when the size of the canvas or the time window changes.
+ */
+static void update_positions(GtkSkyGlance * skg)
 {
-    GtkSkyGlance   *skg;
-    gint            i, j, n;
-    guint           curcat;
+    gint            i;
+    guint           j;
     gdouble         th, tm;
     sky_pass_t     *skp;
+    sky_sat_t      *ssat;
     gdouble         x, y, w, h;
     sat_label_t    *label;
     GSList         *node;
+    gboolean       *placed;
 
-    if (gtk_widget_get_realized(widget))
+    /* Update tick positions */
+    th = ceil(skg->ts * 24.0) / 24.0;
+    th += 0.00069;  /* workaround for bug 1839140 */
+
+    if ((th - skg->ts) > 0.0208333)
+        tm = th - 0.0208333;
+    else
+        tm = th + 0.0208333;
+
+    for (i = 0; i < skg->num_ticks; i++)
     {
-        skg = GTK_SKY_GLANCE(data);
-        skg->w = allocation->width;
-        skg->h = allocation->height - SKG_FOOTER;
-        skg->x0 = 0;
-        skg->y0 = 0;
-        skg->pps = (skg->h - SKG_MARGIN) / skg->numsat - SKG_MARGIN;
+        if (skg->major_x)
+            skg->major_x[i] = t2x(skg, th);
+        if (skg->minor_x)
+            skg->minor_x[i] = t2x(skg, tm);
 
-        /* Update tick positions */
-        th = ceil(skg->ts * 24.0) / 24.0;
-        th += 0.00069;  /* workaround for bug 1839140 */
+        th += 0.04167;
+        tm += 0.04167;
+    }
 
-        if ((th - skg->ts) > 0.0208333)
-            tm = th - 0.0208333;
-        else
-            tm = th + 0.0208333;
+    /* Update pass box positions */
+    placed = g_new0(gboolean, skg->numsat);
+    for (node = skg->passes; node != NULL; node = node->next)
+    {
+        skp = (sky_pass_t *)node->data;
+        ssat = &skg->satdata[skp->sat];
 
-        for (i = 0; i < skg->num_ticks; i++)
-        {
-            if (skg->major_x)
-                skg->major_x[i] = t2x(skg, th);
-            if (skg->minor_x)
-                skg->minor_x[i] = t2x(skg, tm);
+        x = t2x(skg, skp->pass->aos);
+        w = t2x(skg, skp->pass->los) - x;
+        y = ssat->row * (skg->pps + SKG_MARGIN) + SKG_MARGIN;
+        h = skg->pps;
 
-            th += 0.04167;
-            tm += 0.04167;
+        /* update label position next to the first pass */
+        if (!placed[skp->sat] && ssat->label != NULL)
+        {
+            placed[skp->sat] = TRUE;
+            label = ssat->label;
+            label->y = y + h / 2.0;
+            if (x > (skg->x0 + 100))
+            {
+                label->x = x - 5;
+                label->anchor = 1;  /* East */
+            }
+            else
+            {
+                label->x = x + w + 5;
+                label->anchor = 0;  /* West */
+            }
         }
 
-        /* Update pass box positions */
-        n = g_slist_length(skg->passes);
-        j = -1;
-        curcat = 0;
-        y = 10.0;
-        h = 10.0;
-        node = skg->satlab;
-        for (i = 0; i < n; i++)
+        skp->x = x;
+        skp->y = y;
+        skp->w = w;
+        skp->h = h;
+    }
+
+    /* satellites whose passes have all ended keep their row and label */
+    for (j = 0; j < skg->numsat; j++)
+    {
+        ssat = &skg->satdata[j];
+        if (!placed[j] && ssat->label != NULL)
         {
-            skp = (sky_pass_t *)g_slist_nth_data(skg->passes, i);
+            label = ssat->label;
+            label->y = ssat->row * (skg->pps + SKG_MARGIN) + SKG_MARGIN +
+                skg->pps / 2.0;
+            label->x = skg->x0 + 5;
+            label->anchor = 0;  /* West */
+        }
+    }
+    g_free(placed);
 
-            x = t2x(skg, skp->pass->aos);
-            w = t2x(skg, skp->pass->los) - x;
+    gtk_widget_queue_draw(skg->canvas);
+}
 
-            /* new satellite? */
-            if (skp->catnum != curcat)
-            {
-                j++;
-                curcat = skp->catnum;
-                y = j * (skg->pps + SKG_MARGIN) + SKG_MARGIN;
-                h = skg->pps;
-
-                /* update label position */
-                if (node)
-                {
-                    label = (sat_label_t *)node->data;
-                    label->y = y + h / 2.0;
-                    if (x > (skg->x0 + 100))
-                    {
-                        label->x = x - 5;
-                        label->anchor = 1;  /* East */
-                    }
-                    else
-                    {
-                        label->x = x + w + 5;
-                        label->anchor = 0;  /* West */
-                    }
-                    node = node->next;
-                }
-            }
+static void size_allocate_cb(GtkWidget * widget, GtkAllocation * allocation,
+                             gpointer data)
+{
+    GtkSkyGlance   *skg;
 
-            skp->x = x;
-            skp->y = y;
-            skp->w = w;
-            skp->h = h;
-        }
+    if (gtk_widget_get_realized(widget))
+    {
+        skg = GTK_SKY_GLANCE(data);
+        skg->w = allocation->width;
+        skg->h = allocation->height - SKG_FOOTER;
+        skg->x0 = 0;
+        skg->y0 = 0;
+        skg->pps = (skg->h - SKG_MARGIN) / skg->numsat - SKG_MARGIN;
 
-        gtk_widget_queue_draw(skg->canvas);
+        update_positions(skg);
     }
 }
 
@@ -605,76 +658,243 @@ static void get_colors(guint i, guint * bcol, guint * fcol)
     *fcol = (tmp * 0x100) | 0xA0;
 }
 
+/** A pass prediction started by add_passes(). */
+typedef struct {
+    GtkSkyGlance   *skg;
+    gdouble         start;      /* Start of the time window */
+    gboolean        ongoing;    /* Whether to add passes in progress */
+    gint64          t0;         /* When the prediction was started [usec] */
+} skg_job_t;
+
 /**
- * Create canvas items for a satellite
+ * Add the passes found by add_passes() to the graph
+ *
+ * @param source Unused.
+ * @param result The result of get_pass_timeline_async().
+ * @param data The skg_job_t.
+ *
+ * The passes are appended to skg->passes, which therefore stays sorted by
+ * AOS as long as the start of the window is not before the AOS of the
+ * passes already in the graph. Satellites that get their first pass are
+ * given a row and a label, in the order of satdata. Nothing is done if the
+ * prediction was cancelled, in which case the widget may be gone.
  */
-static void create_sat(gpointer key, gpointer value, gpointer data)
+static void add_passes_done(GObject * source, GAsyncResult * result,
+                            gpointer data)
 {
-    sat_t          *sat = SAT(value);
-    GtkSkyGlance   *skg = GTK_SKY_GLANCE(data);
-    GSList         *passes = NULL;
-    gdouble         maxdt;
-    guint           i, n;
-    pass_t         *tmppass = NULL;
+    skg_job_t      *job = data;
+    GtkSkyGlance   *skg = job->skg;
+    pass_timeline_t *timeline;
+    timeline_pass_t *tlpass;
+    sky_sat_t      *ssat;
     sky_pass_t     *skypass;
-    guint           bcol, fcol;
     sat_label_t    *label;
+    GSList         *added = NULL;
+    gboolean       *want;
+    gint            row = 0;
+    guint           i, n = 0;
 
-    (void)key;
+    (void)source;
 
-    get_colors(skg->satcnt++, &bcol, &fcol);
-    maxdt = skg->te - skg->ts;
-
-    /* get passes for satellite */
-    passes = get_passes(sat, skg->qth, skg->ts, maxdt, 10);
-    n = g_slist_length(passes);
-    sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                _("%s:%d: %s has %d passes within %.4f days\n"),
-                __FILE__, __LINE__, sat->nickname, n, maxdt);
-
-    if (passes != NULL)
+    timeline = get_pass_timeline_finish(result, NULL);
+    if (timeline == NULL)
     {
-        /* add pass items */
-        for (i = 0; i < n; i++)
-        {
-            skypass = g_try_new0(sky_pass_t, 1);
-            if (skypass == NULL)
-            {
-                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                            _("%s:%s: Could not allocate memory."),
-                            __FILE__, __func__);
-                continue;
-            }
+        g_free(job);
+        return;
+    }
 
-            skypass->catnum = sat->tle.catnr;
-            tmppass = (pass_t *)g_slist_nth_data(passes, i);
-            skypass->pass = copy_pass(tmppass);
-            skypass->bcol = bcol;
-            skypass->fcol = fcol;
+    g_clear_object(&skg->cancellable);
 
-            /* Initial position will be set in size_allocate_cb */
-            skypass->x = 0;
-            skypass->y = 0;
-            skypass->w = 10;
-            skypass->h = 10;
+    want = g_new0(gboolean, skg->numsat);
+    for (i = 0; i < skg->numsat; i++)
+        row = MAX(row, skg->satdata[i].row + 1);
 
-            skg->passes = g_slist_append(skg->passes, skypass);
+    /* passes in progress at start are already in the graph */
+    for (i = 0; i < timeline->num_passes; i++)
+    {
+        tlpass = &timeline->passes[i];
+        if (!job->ongoing && tlpass->pass->aos <= job->start)
+        {
+            free_pass(tlpass->pass);
+            tlpass->pass = NULL;
         }
+        else
+        {
+            want[tlpass->index] = TRUE;
+        }
+    }
 
-        free_passes(passes);
+    /* new rows and labels */
+    for (i = 0; i < skg->numsat; i++)
+    {
+        ssat = &skg->satdata[i];
+        if (!want[i] || ssat->row >= 0)
+            continue;
+
+        ssat->row = row++;
 
-        /* add satellite label */
         label = g_try_new0(sat_label_t, 1);
         if (label)
         {
-            label->name = g_strdup(sat->nickname);
-            label->color = bcol;
+            label->name = g_strdup(ssat->sat->nickname);
+            label->color = ssat->bcol;
             label->x = 5;
             label->y = 0;
             label->anchor = 0;
-            skg->satlab = g_slist_append(skg->satlab, label);
+            skg->satlab = g_slist_prepend(skg->satlab, label);
+            ssat->label = label;
+        }
+    }
+
+    /* add pass items */
+    for (i = 0; i < timeline->num_passes; i++)
+    {
+        tlpass = &timeline->passes[i];
+        ssat = &skg->satdata[tlpass->index];
+        if (tlpass->pass == NULL || ssat->num_passes >= SKG_MAX_PASSES)
+            continue;
+
+        skypass = g_try_new0(sky_pass_t, 1);
+        if (skypass == NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s:%s: Could not allocate memory."),
+                        __FILE__, __func__);
+            continue;
+        }
+
+        skypass->catnum = ssat->sat->tle.catnr;
+        skypass->pass = tlpass->pass;
+        skypass->bcol = ssat->bcol;
+        skypass->fcol = ssat->fcol;
+        skypass->sat = tlpass->index;
+
+        /* the pass now belongs to skypass */
+        tlpass->pass = NULL;
+        ssat->num_passes++;
+
+        /* Initial position will be set in update_positions */
+        skypass->x = 0;
+        skypass->y = 0;
+        skypass->w = 10;
+        skypass->h = 10;
+
+        added = g_slist_prepend(added, skypass);
+        n++;
+    }
+    skg->passes = g_slist_concat(skg->passes, g_slist_reverse(added));
+
+    free_pass_timeline(timeline);
+    g_free(want);
+
+    if (gtk_widget_get_realized(skg->canvas))
+        update_positions(skg);
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: %d satellites have %d new passes within [%f;%f] "
+                  "(%.1f ms)"), __func__, skg->numsat, n, job->start,
+                skg->te, (g_get_monotonic_time() - job->t0) / 1000.0);
+
+    g_free(job);
+}
+
+/**
+ * Start adding the passes of all satellites in a time window
+ *
+ * @param skg The GtkSkyGlance widget.
+ * @param start Start of the time window.
+ * @param end End of the time window.
+ * @param ongoing Whether to add passes that are in progress at start.
+ *
+ * The passes are calculated in the background by get_pass_timeline_async()
+ * and added by add_passes_done(), so that the GUI does not block while a
+ * module with many satellites is predicted. There must be no other
+ * prediction running.
+ */
+static void add_passes(GtkSkyGlance * skg, gdouble start, gdouble end,
+                       gboolean ongoing)
+{
+    sat_t         **sats;
+    skg_job_t      *job;
+    guint           i;
+
+    sats = g_new(sat_t *, skg->numsat);
+    for (i = 0; i < skg->numsat; i++)
+        sats[i] = skg->satdata[i].sat;
+
+    job = g_new(skg_job_t, 1);
+    job->skg = skg;
+    job->start = start;
+    job->ongoing = ongoing;
+    job->t0 = g_get_monotonic_time();
+
+    skg->cancellable = g_cancellable_new();
+    get_pass_timeline_async(sats, skg->numsat, skg->qth, start, end - start,
+                            SKG_MAX_PASSES, skg->cancellable,
+                            add_passes_done, job);
+    g_free(sats);
+}
+
+/**
+ * Remove the passes that end before a given time
+ *
+ * @param skg The GtkSkyGlance widget.
+ * @param t The time.
+ * @return The number of passes removed.
+ */
+static guint drop_passes(GtkSkyGlance * skg, gdouble t)
+{
+    GSList         *node;
+    GSList         *kept = NULL;
+    sky_pass_t     *skypass;
+    guint           n = 0;
+
+    for (node = skg->passes; node != NULL; node = node->next)
+    {
+        skypass = (sky_pass_t *)node->data;
+        if (skypass->pass->los < t)
+        {
+            skg->satdata[skypass->sat].num_passes--;
+            free_pass(skypass->pass);
+            g_free(skypass);
+            n++;
         }
+        else
+        {
+            kept = g_slist_prepend(kept, skypass);
+        }
+    }
+
+    g_slist_free(skg->passes);
+    skg->passes = g_slist_reverse(kept);
+
+    return n;
+}
+
+/**
+ * Create canvas items for the satellites
+ *
+ * Each satellite gets a colour in the order of the hash table. Only the
+ * satellites with passes get a row and a label.
+ */
+static void create_sats(GtkSkyGlance * skg)
+{
+    GHashTableIter  iter;
+    gpointer        value;
+    sky_sat_t      *ssat;
+
+    skg->satdata = g_new0(sky_sat_t, skg->numsat);
+
+    g_hash_table_iter_init(&iter, skg->sats);
+    while (g_hash_table_iter_next(&iter, NULL, &value))
+    {
+        ssat = &skg->satdata[skg->satcnt];
+        ssat->sat = SAT(value);
+        ssat->row = -1;
+        get_colors(skg->satcnt++, &ssat->bcol, &ssat->fcol);
     }
+
+    add_passes(skg, skg->ts, skg->te, TRUE);
 }
 
 /**
@@ -777,9 +997,67 @@ GtkWidget      *gtk_sky_glance_new(GHashTable * sats, qth_t * qth, gdouble ts)
     create_time_ticks(skg);
 
     /* Create satellite pass data */
-    g_hash_table_foreach(skg->sats, create_sat, skg);
+    create_sats(skg);
 
     gtk_box_pack_start(GTK_BOX(skg), skg->canvas, TRUE, TRUE, 0);
 
     return GTK_WIDGET(skg);
 }
+
+/**
+ * Move the time window of a GtkSkyGlance widget.
+ *
+ * @param skg The GtkSkyGlance widget.
+ * @param ts The new start of the time window.
+ *
+ * The length of the time window is kept. When the window moves forward by
+ * less than its length, the passes that have ended before ts are dropped
+ * and only the passes starting in the new part of the window are
+ * calculated. Otherwise, or if the previous prediction has not finished
+ * yet, all passes are calculated again. The new passes appear when the
+ * prediction in the background has finished.
+ *
+ * The satellites must not have been reloaded since the widget was created,
+ * in which case a new widget must be created instead.
+ */
+void gtk_sky_glance_set_time(GtkSkyGlance * skg, gdouble ts)
+{
+    gdouble         span = skg->te - skg->ts;
+    gdouble         te = skg->te;
+    guint           dropped;
+    gint64          t0;
+
+    t0 = g_get_monotonic_time();
+
+    if (skg->cancellable == NULL && ts >= skg->ts && ts < skg->te)
+    {
+        dropped = drop_passes(skg, ts);
+        skg->ts = ts;
+        skg->te = ts + span;
+        add_passes(skg, te, skg->te, FALSE);
+    }
+    else
+    {
+        /* the passes of an unfinished prediction are missing */
+        if (skg->cancellable != NULL)
+        {
+            g_cancellable_cancel(skg->cancellable);
+            g_clear_object(&skg->cancellable);
+        }
+
+        dropped = g_slist_length(skg->passes);
+        clear_passes(skg);
+        skg->ts = ts;
+        skg->te = ts + span;
+        add_passes(skg, skg->ts, skg->te, TRUE);
+    }
+
+    free_time_ticks(skg);
+    create_time_ticks(skg);
+    if (gtk_widget_get_realized(skg->canvas))
+        update_positions(skg);
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: %d passes dropped; layout %.1f ms"), __func__,
+                dropped, (g_get_monotonic_time() - t0) / 1000.0);
+}
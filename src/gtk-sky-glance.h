@@ -52,6 +52,15 @@ typedef struct _GtkSkyGlance GtkSkyGlance;
 typedef struct _GtkSkyGlanceClass GtkSkyGlanceClass;
 
 
+/** Satellite label structure for drawing */
+typedef struct {
+    gchar          *name;       /* Satellite name */
+    guint32         color;      /* Label color */
+    gdouble         x;          /* X position */
+    gdouble         y;          /* Y position */
+    gint            anchor;     /* Anchor type: 0=west, 1=east */
+} sat_label_t;
+
 /** Satellite object on graph. */
 typedef struct {
     guint           catnum;     /* Catalog number of satellite */
@@ -62,8 +71,19 @@ typedef struct {
     gdouble         h;          /* Height of box */
     guint32         bcol;       /* Border color */
     guint32         fcol;       /* Fill color */
+    guint           sat;        /* Index of the satellite in satdata */
 } sky_pass_t;
 
+/** Satellite row on graph. */
+typedef struct {
+    sat_t          *sat;        /* The satellite */
+    gint            row;        /* Row in the graph or -1 if none yet */
+    sat_label_t    *label;      /* Label, created with the row */
+    guint32         bcol;       /* Border color */
+    guint32         fcol;       /* Fill color */
+    guint           num_passes; /* Number of passes in the graph */
+} sky_sat_t;
+
 
 #define SKY_PASS_T(obj) ((sky_pass_t *)obj)
 
@@ -77,7 +97,9 @@ struct _GtkSkyGlance {
     GHashTable     *sats;       /* Local copy of satellites. */
     qth_t          *qth;        /* Pointer to current location. */
 
-    GSList         *passes;     /* List of sky_pass_t representing each pass. */
+    GSList         *passes;     /* List of sky_pass_t representing each pass,
+                                   sorted by AOS. */
+    sky_sat_t      *satdata;    /* Satellites in the order of the hash table. */
     GSList         *satlab;     /* List of satellite label data (name, color, position). */
 
     /* Satellite label data structure */
@@ -97,6 +119,8 @@ struct _GtkSkyGlance {
                                    from sat-cfg.
                                  */
     gdouble         ts, te;     /* Start and end times (Julian date) */
+    GCancellable   *cancellable;        /* Cancels the pass prediction;
+                                           NULL when none is running */
 
     /* Time tick data */
     gint            num_ticks;  /* Number of time ticks */
@@ -112,14 +136,6 @@ struct _GtkSkyGlance {
 
 };
 
-/** Satellite label structure for drawing */
-typedef struct {
-    gchar          *name;       /* Satellite name */
-    guint32         color;      /* Label color */
-    gdouble         x;          /* X position */
-    gdouble         y;          /* Y position */
-    gint            anchor;     /* Anchor type: 0=west, 1=east */
-} sat_label_t;
 struct _GtkSkyGlanceClass {
     GtkBoxClass     parent_class;
 };
@@ -127,6 +143,7 @@ struct _GtkSkyGlanceClass {
 
 GType           gtk_sky_glance_get_type(void);
 GtkWidget      *gtk_sky_glance_new(GHashTable * sats, qth_t * qth, gdouble ts);
+void            gtk_sky_glance_set_time(GtkSkyGlance * skg, gdouble ts);
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -35,6 +35,7 @@
 #include "first-time.h"
 #include "tle-update.h"
 #include "mod-mgr.h"
+#include "predict-cli.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
 
@@ -113,8 +114,6 @@ int main(int argc, char *argv[])
         g_setenv("GDK_BACKEND", "quartz", 0);
     }
 #endif
-	
-    gtk_init(&argc, &argv);
 
     context = g_option_context_new("");
     g_option_context_add_main_entries(context, entries, GETTEXT_PACKAGE);
@@ -123,7 +122,9 @@ int main(int argc, char *argv[])
                                    "tracking and orbit prediction program.\n"
                                    "Gpredict does not require any command line "
                                    "options for nominal operation."));
-    g_option_context_add_group(context, gtk_get_option_group(TRUE));
+    g_option_context_add_group(context, predict_cli_get_option_group());
+    /* the display is opened by gtk_init() below, unless running headless */
+    g_option_context_add_group(context, gtk_get_option_group(FALSE));
     if (!g_option_context_parse(context, &argc, &argv, &err))
         g_print(_("Option parsing failed: %s\n"), err->message);
 
@@ -150,6 +151,20 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    /* predict passes without the GUI */
+    if (predict_cli_requested())
+    {
+        error = predict_cli_run();
+
+        g_option_context_free(context);
+        sat_log_close();
+        sat_cfg_close();
+
+        return error;
+    }
+
+    gtk_init(&argc, &argv);
+
     /* create application */
     gpredict_app_create();
     gtk_widget_show_all(app);
@@ -589,6 +589,9 @@ void mod_mgr_reload_sats()
         return;
     }
 
+    /* the cached passes were calculated with the old TLE data */
+    predict_cache_clear();
+
     /* for each module in the GSList execute sat_module_reload_sats() */
     for (i = 0; i < num; i++)
     {
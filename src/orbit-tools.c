@@ -169,3 +169,132 @@ has_aos        (sat_t *sat, qth_t *qth)
      }
      return retcode;
 }
+
+
+/* Smallest radius of the Earth (polar radius) in km */
+#define RMIN            (xkmper * (1.0 - __f))
+
+/* Safety margin of the footprint in radians; covers the precession of the
+   orbit plane during a skip and the difference between the osculating and
+   the mean orbit */
+#define FOOTPRINT_MARGIN (2.0 * de2ra)
+
+/* Longest time returned by time_to_footprint() in days */
+#define FOOTPRINT_MAX_WAIT 0.1
+
+
+/** \brief Get the time until the satellite can be above the horizon.
+ *  \param sat Pointer to satellite data, calculated for the time of frame.
+ *  \param frame The observer frame.
+ *  \return The time in days during which the satellite is certainly
+ *          below the horizon, or 0.0 if it may rise at any time.
+ *
+ * This is a geometric prefilter for AOS searches, so that they do not need
+ * to step through the revolutions where the ground track does not come
+ * close to the QTH. The QTH can only see the satellite when it is within
+ * the footprint half angle of the sub-satellite point. The half angle is
+ * taken at apogee, where the footprint is largest, over the polar radius of
+ * the Earth. Two bounds are used:
+ *
+ *  - The QTH must be within the half angle of the orbit plane. If it is not,
+ *    the time until the rotation of the Earth brings it there is solved
+ *    from the orbit normal and the QTH position.
+ *  - Otherwise, the satellite must be within the half angle of the QTH
+ *    along the orbit. If it is not, the time is bounded by the highest
+ *    angular velocity of the satellite, at perigee, plus the rotation of
+ *    the Earth.
+ *
+ * The result is limited to FOOTPRINT_MAX_WAIT, after which the orbit plane
+ * may have moved more than the margin.
+ */
+gdouble
+time_to_footprint (sat_t *sat, const obs_frame_t *frame)
+{
+     vector_t n, q, r, p, tmp;
+     double   sma, rmax, rmin, lambda, s, c, a, b, cc, rr;
+     double   lo, hi, x0, dx, w, u;
+
+     if ((sat->meanmo <= 0.0) || (sat->tle.eo >= 1.0))
+          return 0.0;
+
+     /* footprint half angle at apogee */
+     sma = 331.25 * exp(log(1440.0/sat->meanmo) * (2.0/3.0));
+     r = sat->pos;
+     Magnitude (&r);
+     rmax = MAX(sma * (1.0 + sat->tle.eo), r.w);
+     rmin = MIN(sma * (1.0 - sat->tle.eo), r.w);
+     if (rmin <= RMIN)
+          return 0.0;
+
+     lambda = acos (RMIN / rmax) + FOOTPRINT_MARGIN;
+
+     /* everything is visible from somewhere on the orbit */
+     if (lambda >= pio2)
+          return 0.0;
+
+     s = sin (lambda);
+
+     /* orbit normal and QTH direction */
+     Cross (&r, &sat->vel, &n);
+     if (n.w <= 0.0)
+          return 0.0;
+     Normalize (&n);
+     Normalize (&r);
+     q = frame->obs_pos;
+     Normalize (&q);
+
+     /* angle between the QTH and the orbit plane; after the Earth has
+        turned by x it is asin (a cos x + b sin x + cc) */
+     a = n.x * q.x + n.y * q.y;
+     b = n.y * q.x - n.x * q.y;
+     cc = n.z * q.z;
+     c = a + cc;
+
+     if (fabs (c) > s) {
+          /* the QTH never gets close to the orbit plane */
+          rr = sqrt (a * a + b * b);
+          if (rr <= 0.0)
+               return FOOTPRINT_MAX_WAIT;
+
+          lo = (-s - cc) / rr;
+          hi = (s - cc) / rr;
+          if ((lo > 1.0) || (hi < -1.0))
+               return FOOTPRINT_MAX_WAIT;
+
+          lo = MAX(lo, -1.0);
+          hi = MIN(hi, 1.0);
+
+          /* with y = x - atan2 (b, a), the QTH is close to the plane for
+             y in [acos(hi), acos(lo)] and [2pi - acos(lo), 2pi - acos(hi)];
+             we are outside both, so the next one starts at one of their
+             lower ends */
+          x0 = FMod2p (-atan2 (b, a));
+          dx = MIN(FMod2p (acos (hi) - x0),
+                   FMod2p (twopi - acos (lo) - x0));
+
+          return MIN(dx / omega_ER, FOOTPRINT_MAX_WAIT);
+     }
+
+     /* projection of the QTH on the orbit plane */
+     p.x = q.x - c * n.x;
+     p.y = q.y - c * n.y;
+     p.z = q.z - c * n.z;
+     Magnitude (&p);
+     if (p.w <= 0.0)
+          return 0.0;
+     Normalize (&p);
+
+     /* angle from the satellite forward to the projection of the QTH */
+     Cross (&r, &p, &tmp);
+     u = atan2 (Dot (&tmp, &n), Dot (&r, &p));
+     if (u < -lambda)
+          u += twopi;
+     if (u <= lambda)
+          return 0.0;
+
+     /* highest angular velocity of the satellite in rad/day, and of the
+        projection of the QTH, which can move towards it */
+     w = n.w / (rmin * rmin) * 86400.0 + omega_ER / cos (lambda);
+
+     return MIN((u - lambda) / w, FOOTPRINT_MAX_WAIT);
+}
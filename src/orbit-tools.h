@@ -36,6 +36,7 @@ orbit_type_t get_orbit_type (sat_t *sat);
 gboolean     geostationary  (sat_t *sat);
 gboolean     decayed        (sat_t *sat);
 gboolean     has_aos        (sat_t *sat, qth_t *qth);
+gdouble      time_to_footprint (sat_t *sat, const obs_frame_t *frame);
 
 
 #endif
@@ -20,6 +20,7 @@
 #include <build-config.h>
 #endif
 #include <gtk/gtk.h>
+#include <string.h>
 
 #include "gtk-sat-data.h"
 #include "locator.h"
@@ -232,230 +233,264 @@ gchar          *pass_to_txt_tblheader(pass_t * pass, qth_t * qth, gint fields)
     return buff;
 }
 
-gchar          *pass_to_txt_tblcontents(pass_t * pass, qth_t * qth,
-                                        gint fields)
+/**
+ * Append a number to a table row.
+ *
+ * @param line The row.
+ * @param csv Whether the row is CSV or aligned text.
+ * @param sep The column separator of aligned text.
+ * @param fmt The printf format of aligned text.
+ * @param value The number.
+ *
+ * CSV uses the same precision, without padding and always with a decimal
+ * point, regardless of the locale.
+ */
+static void append_number(GString * line, gboolean csv, const gchar * sep,
+                          const gchar * fmt, gdouble value)
+{
+    gchar           buff[G_ASCII_DTOSTR_BUF_SIZE];
+
+    if (csv)
+    {
+        g_ascii_formatd(buff, sizeof(buff), fmt, value);
+        g_string_append_c(line, ',');
+        g_string_append(line, g_strchug(buff));
+    }
+    else
+    {
+        g_string_append(line, sep);
+        g_string_append_printf(line, fmt, value);
+    }
+}
+
+/**
+ * Append a CSV field.
+ *
+ * Fields containing a comma, a quote or a line break are quoted, with the
+ * quotes inside doubled, as in RFC 4180.
+ */
+static void append_csv_field(GString * line, const gchar * str)
+{
+    const gchar    *c;
+
+    if (strpbrk(str, ",\"\r\n") == NULL)
+    {
+        g_string_append(line, str);
+        return;
+    }
+
+    g_string_append_c(line, '"');
+    for (c = str; *c != '\0'; c++)
+    {
+        if (*c == '"')
+            g_string_append_c(line, '"');
+        g_string_append_c(line, *c);
+    }
+    g_string_append_c(line, '"');
+}
+
+/** Append a string to a table row; see append_number(). */
+static void append_string(GString * line, gboolean csv, const gchar * sep,
+                          const gchar * str)
+{
+    if (csv)
+    {
+        g_string_append_c(line, ',');
+        append_csv_field(line, str);
+    }
+    else
+    {
+        g_string_append_printf(line, "%s%s", sep, str);
+    }
+}
+
+/**
+ * Append a row of the pass details table.
+ *
+ * @param line The string to append the row to, without the newline.
+ * @param detail The pass detail shown in the row.
+ * @param qth The observer data.
+ * @param fields The visible columns.
+ * @param fmtstr The time format.
+ * @param csv Whether to format the row as CSV instead of aligned text.
+ */
+static void append_detail_row(GString * line, const pass_detail_t * detail,
+                              qth_t * qth, gint fields, const gchar * fmtstr,
+                              gboolean csv)
 {
-    gchar          *fmtstr;
     gchar           tbuff[TIME_FORMAT_MAX_LENGTH];
-    guint           i, num;
-    gchar          *line;
-    gchar          *data = NULL;
-    gchar          *buff;
-    pass_detail_t  *detail;
+    gchar           ssp[7];
+    gchar           vis[2];
     obs_astro_t     astro;
-    gdouble         ra, dec, numf;
-    gchar          *ssp;
 
-    /* first, get the length of the time field */
-    fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
-    daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->aos);
+    /* time */
+    daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, detail->time);
+    if (csv)
+        append_csv_field(line, tbuff);
+    else
+        g_string_append_printf(line, " %s", tbuff);
+
+    if (fields & SINGLE_PASS_FLAG_AZ)
+        append_number(line, csv, " ", "%6.2f", detail->az);
 
-    /* get number of rows */
-    num = g_slist_length(pass->details);
+    if (fields & SINGLE_PASS_FLAG_EL)
+        append_number(line, csv, " ", "%6.2f", detail->el);
 
-    for (i = 0; i < num; i++)
+    if (fields & (SINGLE_PASS_FLAG_RA | SINGLE_PASS_FLAG_DEC))
+        Calc_RADec(detail->time, detail->az, detail->el, qth, &astro);
+
+    if (fields & SINGLE_PASS_FLAG_RA)
+        append_number(line, csv, " ", "%6.2f", Degrees(astro.ra));
+
+    if (fields & SINGLE_PASS_FLAG_DEC)
+        append_number(line, csv, " ", "%6.2f", Degrees(astro.dec));
+
+    if (fields & SINGLE_PASS_FLAG_RANGE)
+        append_number(line, csv, " ", "%5.0f", detail->range);
+
+    if (fields & SINGLE_PASS_FLAG_RANGE_RATE)
+        append_number(line, csv, " ", "%6.3f", detail->range_rate);
+
+    if (fields & SINGLE_PASS_FLAG_LAT)
+        append_number(line, csv, " ", "%6.2f", detail->lat);
+
+    if (fields & SINGLE_PASS_FLAG_LON)
+        append_number(line, csv, " ", "%7.2f", detail->lon);
+
+    /* the column is left out of text rows if the locator fails */
+    if (fields & SINGLE_PASS_FLAG_SSP)
     {
+        if (longlat2locator(detail->lon, detail->lat, ssp, 3) == RIG_OK)
+            append_string(line, csv, " ", ssp);
+        else if (csv)
+            g_string_append_c(line, ',');
+    }
 
-        /* get detail */
-        detail = PASS_DETAIL(g_slist_nth_data(pass->details, i));
+    if (fields & SINGLE_PASS_FLAG_FOOTPRINT)
+        append_number(line, csv, " ", "%5.0f", detail->footprint);
 
-        /* time */
-        daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, detail->time);
+    if (fields & SINGLE_PASS_FLAG_ALT)
+        append_number(line, csv, " ", "%5.0f", detail->alt);
 
-        line = g_strdup_printf(" %s", tbuff);
+    if (fields & SINGLE_PASS_FLAG_VEL)
+        append_number(line, csv, " ", "%5.3f", detail->velo);
 
-        /* Az */
-        if (fields & SINGLE_PASS_FLAG_AZ)
-        {
-            buff = g_strdup_printf("%s %6.2f", line, detail->az);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    /* Doppler at 100 MHz */
+    if (fields & SINGLE_PASS_FLAG_DOPPLER)
+        append_number(line, csv, " ", "%5.0f",
+                      -100.0e06 * (detail->range_rate / 299792.4580));
 
-        /* El */
-        if (fields & SINGLE_PASS_FLAG_EL)
-        {
-            buff = g_strdup_printf("%s %6.2f", line, detail->el);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    /* path loss at 100 MHz in dB */
+    if (fields & SINGLE_PASS_FLAG_LOSS)
+        append_number(line, csv, " ", "%6.2f",
+                      72.4 + 20.0 * log10(detail->range));
 
-        /* Ra */
-        if (fields & SINGLE_PASS_FLAG_RA)
-        {
-            Calc_RADec(detail->time, detail->az, detail->el, qth, &astro);
-            ra = Degrees(astro.ra);
-            buff = g_strdup_printf("%s %6.2f", line, ra);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    /* delay in msec */
+    if (fields & SINGLE_PASS_FLAG_DELAY)
+        append_number(line, csv, " ", "%5.2f", detail->range / 299.7924580);
 
-        /* Dec */
-        if (fields & SINGLE_PASS_FLAG_DEC)
-        {
-            Calc_RADec(detail->time, detail->az, detail->el, qth, &astro);
-            dec = Degrees(astro.dec);
-            buff = g_strdup_printf("%s %6.2f", line, dec);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & SINGLE_PASS_FLAG_MA)
+        append_number(line, csv, " ", "%6.2f", detail->ma);
 
-        /* Range */
-        if (fields & SINGLE_PASS_FLAG_RANGE)
-        {
-            buff = g_strdup_printf("%s %5.0f", line, detail->range);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & SINGLE_PASS_FLAG_PHASE)
+        append_number(line, csv, " ", "%6.2f", detail->phase);
 
-        /* Range Rate */
-        if (fields & SINGLE_PASS_FLAG_RANGE_RATE)
-        {
-            buff = g_strdup_printf("%s %6.3f", line, detail->range_rate);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & SINGLE_PASS_FLAG_VIS)
+    {
+        vis[0] = vis_to_chr(detail->vis);
+        vis[1] = '\0';
+        append_string(line, csv, "  ", vis);
+    }
+}
 
-        /* Lat */
-        if (fields & SINGLE_PASS_FLAG_LAT)
-        {
-            buff = g_strdup_printf("%s %6.2f", line, detail->lat);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+/**
+ * Append a row of the pass summary table.
+ *
+ * @param line The string to append the row to, without the newline.
+ * @param pass The pass shown in the row.
+ * @param fields The visible columns.
+ * @param fmtstr The time format.
+ * @param csv Whether to format the row as CSV instead of aligned text.
+ */
+static void append_pass_row(GString * line, const pass_t * pass,
+                            gint fields, const gchar * fmtstr, gboolean csv)
+{
+    gchar           tbuff[TIME_FORMAT_MAX_LENGTH];
+    gchar           buff[16];
+    guint           h, m, s;
 
-        /* Lon */
-        if (fields & SINGLE_PASS_FLAG_LON)
-        {
-            buff = g_strdup_printf("%s %7.2f", line, detail->lon);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    /* AOS, TCA and LOS */
+    daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->aos);
+    if (csv)
+        append_csv_field(line, tbuff);
+    else
+        g_string_append_printf(line, " %s", tbuff);
 
-        /* SSP */
-        if (fields & SINGLE_PASS_FLAG_SSP)
-        {
-            ssp = g_try_malloc(7);
-            if (longlat2locator(detail->lon, detail->lat, ssp, 3) == RIG_OK)
-            {
-                buff = g_strdup_printf("%s %s", line, ssp);
-                g_free(line);
-                line = g_strdup(buff);
-                g_free(buff);
-            }
-            g_free(ssp);
-        }
+    daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->tca);
+    append_string(line, csv, "  ", tbuff);
 
-        /* Footprint */
-        if (fields & SINGLE_PASS_FLAG_FOOTPRINT)
-        {
-            buff = g_strdup_printf("%s %5.0f", line, detail->footprint);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->los);
+    append_string(line, csv, "  ", tbuff);
 
-        /* Alt */
-        if (fields & SINGLE_PASS_FLAG_ALT)
-        {
-            buff = g_strdup_printf("%s %5.0f", line, detail->alt);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & (1 << MULTI_PASS_COL_DURATION))
+    {
+        /* convert julian date to seconds */
+        s = (guint) ((pass->los - pass->aos) * 86400);
 
-        /* Vel */
-        if (fields & SINGLE_PASS_FLAG_VEL)
-        {
-            buff = g_strdup_printf("%s %5.3f", line, detail->velo);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+        /* extract hours */
+        h = (guint) floor(s / 3600);
+        s -= 3600 * h;
 
-        /* Doppler */
-        if (fields & SINGLE_PASS_FLAG_DOPPLER)
-        {
-            numf = -100.0e06 * (detail->range_rate / 299792.4580);
-            buff = g_strdup_printf("%s %5.0f", line, numf);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+        /* extract minutes */
+        m = (guint) floor(s / 60);
+        s -= 60 * m;
 
-        /* Loss */
-        if (fields & SINGLE_PASS_FLAG_LOSS)
-        {
-            numf = 72.4 + 20.0 * log10(detail->range);  // dB
-            buff = g_strdup_printf("%s %6.2f", line, numf);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+        g_snprintf(buff, sizeof(buff), "%02d:%02d:%02d", h, m, s);
+        append_string(line, csv, "  ", buff);
+    }
 
-        /* Delay */
-        if (fields & SINGLE_PASS_FLAG_DELAY)
-        {
-            numf = detail->range / 299.7924580; // msec 
-            buff = g_strdup_printf("%s %5.2f", line, numf);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & (1 << MULTI_PASS_COL_MAX_EL))
+        append_number(line, csv, "  ", "%6.2f", pass->max_el);
 
-        /* MA */
-        if (fields & SINGLE_PASS_FLAG_MA)
-        {
-            buff = g_strdup_printf("%s %6.2f", line, detail->ma);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & (1 << MULTI_PASS_COL_AOS_AZ))
+        append_number(line, csv, "  ", "%6.2f", pass->aos_az);
 
-        /* Phase */
-        if (fields & SINGLE_PASS_FLAG_PHASE)
-        {
-            buff = g_strdup_printf("%s %6.2f", line, detail->phase);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & (1 << MULTI_PASS_COL_MAX_EL_AZ))
+        append_number(line, csv, "  ", "%9.2f", pass->maxel_az);
 
-        /* Visibility */
-        if (fields & SINGLE_PASS_FLAG_VIS)
-        {
-            buff = g_strdup_printf("%s  %c", line, vis_to_chr(detail->vis));
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & (1 << MULTI_PASS_COL_LOS_AZ))
+        append_number(line, csv, "  ", "%6.2f", pass->los_az);
 
-        /* append line to return string */
-        if (i == 0)
-        {
-            data = g_strdup_printf("%s\n", line);
-            g_free(line);
-        }
-        else
-        {
-            buff = g_strconcat(data, line, "\n", NULL);
-            g_free(data);
-            data = g_strdup(buff);
-            g_free(buff);
-        }
+    if (fields & (1 << MULTI_PASS_COL_ORBIT))
+    {
+        g_snprintf(buff, sizeof(buff), csv ? "%d" : "%5d", pass->orbit);
+        append_string(line, csv, "  ", buff);
+    }
+
+    if (fields & (1 << MULTI_PASS_COL_VIS))
+        append_string(line, csv, "  ", pass->vis);
+}
+
+gchar          *pass_to_txt_tblcontents(pass_t * pass, qth_t * qth,
+                                        gint fields)
+{
+    gchar          *fmtstr;
+    GString        *data;
+    guint           i;
+
+    fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
+    data = g_string_new(NULL);
+
+    for (i = 0; i < pass->num_details; i++)
+    {
+        append_detail_row(data, &pass->details[i], qth, fields, fmtstr,
+                          FALSE);
+        g_string_append_c(data, '\n');
     }
 
     g_free(fmtstr);
 
-    return data;
+    return g_string_free(data, FALSE);
 }
 
 gchar          *passes_to_txt_pgheader(GSList * passes, qth_t * qth,
@@ -536,147 +571,376 @@ gchar          *passes_to_txt_tblcontents(GSList * passes, qth_t * qth,
                                           gint fields)
 {
     gchar          *fmtstr;
-    gchar           tbuff[TIME_FORMAT_MAX_LENGTH];
-    guint           i, num;
-    gchar          *line = NULL;
-    gchar          *data = NULL;
-    gchar          *buff;
-    pass_t         *pass;
+    GString        *data;
+    GSList         *node;
 
     (void)qth;                  /* avoid unused parameter compiler warning */
 
-    pass = PASS(g_slist_nth_data(passes, 0));
-
-    /* first, get the length of the time field */
     fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
-    daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->aos);
+    data = g_string_new(NULL);
 
-    /* get number of rows */
-    num = g_slist_length(passes);
-
-    for (i = 0; i < num; i++)
+    for (node = passes; node != NULL; node = node->next)
     {
+        append_pass_row(data, PASS(node->data), fields, fmtstr, FALSE);
+        g_string_append_c(data, '\n');
+    }
 
-        pass = PASS(g_slist_nth_data(passes, i));
+    g_free(fmtstr);
 
-        /* AOS */
-        daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->aos);
+    return g_string_free(data, FALSE);
+}
 
-        line = g_strdup_printf(" %s", tbuff);
+/*
+ * Streaming pass writer.
+ *
+ * The writer formats one row at a time into a buffer that is reused for
+ * the whole export and writes it to a GOutputStream right away, so the
+ * memory used does not grow with the number of passes or details.
+ *
+ * The binary format is a sequence of little endian records after a file
+ * header:
+ *
+ *   header:  "GPPS", uint32 version (1), double qth lat, double qth lon,
+ *            int32 qth alt
+ *   pass:    'P', int32 orbit, double aos, tca, los, float max_el, aos_az,
+ *            maxel_az, los_az, char vis[4], uint32 number of details,
+ *            uint16 length of the satellite name, the name without '\0'
+ *   detail:  'D', double time, float az, el, range, range_rate, lat, lon,
+ *            alt, velo, ma, phase, footprint, int32 orbit, uint8 vis
+ *
+ * Each pass record is followed by its detail records. The pass records of
+ * a summary have no details. Times are Julian dates, all other values are
+ * in the units of pass_t and pass_detail_t.
+ */
+
+#define PASS_WRITER_MAGIC   "GPPS"
+#define PASS_WRITER_VERSION 1
+
+/* CSV column names of the single and multi pass tables */
+static const gchar *SPCSV[] = {
+    "time", "az", "el", "ra", "dec", "range", "range_rate", "lat", "lon",
+    "ssp", "footprint", "alt", "vel", "doppler", "loss", "delay", "ma",
+    "phase", "vis"
+};
 
-        /* TCA */
-        daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->tca);
+static const gchar *MPCSV[] = {
+    "aos", "tca", "los", "duration", "max_el", "aos_az", "max_el_az",
+    "los_az", "orbit", "vis"
+};
 
-        buff = g_strdup(line);
-        g_free(line);
-        line = g_strdup_printf("%s  %s", buff, tbuff);
-        g_free(buff);
+static void put_uint32(GString * buff, guint32 val)
+{
+    val = GUINT32_TO_LE(val);
+    g_string_append_len(buff, (const gchar *)&val, sizeof(val));
+}
 
-        /* LOS */
-        daynum_to_str(tbuff, TIME_FORMAT_MAX_LENGTH, fmtstr, pass->los);
+static void put_double(GString * buff, gdouble val)
+{
+    union {
+        gdouble         d;
+        guint64         u;
+    } bits;
+
+    bits.d = val;
+    bits.u = GUINT64_TO_LE(bits.u);
+    g_string_append_len(buff, (const gchar *)&bits.u, sizeof(bits.u));
+}
 
-        buff = g_strdup(line);
-        g_free(line);
-        line = g_strdup_printf("%s  %s", buff, tbuff);
-        g_free(buff);
+static void put_float(GString * buff, gdouble val)
+{
+    union {
+        gfloat          f;
+        guint32         u;
+    } bits;
 
-        /* Duration */
-        if (fields & (1 << MULTI_PASS_COL_DURATION))
-        {
-            guint           h, m, s;
+    bits.f = (gfloat) val;
+    put_uint32(buff, bits.u);
+}
 
-            /* convert julian date to seconds */
-            s = (guint) ((pass->los - pass->aos) * 86400);
+/** Write the buffer of the writer to its stream and empty the buffer. */
+static gboolean pass_writer_flush(pass_writer_t * pw, GError ** error)
+{
+    gboolean        ok;
 
-            /* extract hours */
-            h = (guint) floor(s / 3600);
-            s -= 3600 * h;
+    ok = g_output_stream_write_all(pw->stream, pw->buff->str, pw->buff->len,
+                                   NULL, NULL, error);
+    g_string_truncate(pw->buff, 0);
 
-            /* extract minutes */
-            m = (guint) floor(s / 60);
-            s -= 60 * m;
+    return ok;
+}
 
-            buff = g_strdup_printf("%s  %02d:%02d:%02d", line, h, m, s);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+/** Write a string created by one of the pass_to_txt functions. */
+static gboolean pass_writer_take(pass_writer_t * pw, gchar * text,
+                                 GError ** error)
+{
+    g_string_append(pw->buff, text);
+    g_free(text);
 
-        /* Max El */
-        if (fields & (1 << MULTI_PASS_COL_MAX_EL))
-        {
-            buff = g_strdup_printf("%s  %6.2f", line, pass->max_el);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    return pass_writer_flush(pw, error);
+}
 
-        /* AOS Az */
-        if (fields & (1 << MULTI_PASS_COL_AOS_AZ))
-        {
-            buff = g_strdup_printf("%s  %6.2f", line, pass->aos_az);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+/** Start a binary record; the file header comes before the first one. */
+static void pass_writer_bin_start(pass_writer_t * pw)
+{
+    if (pw->started)
+        return;
+
+    g_string_append_len(pw->buff, PASS_WRITER_MAGIC, 4);
+    put_uint32(pw->buff, PASS_WRITER_VERSION);
+    put_double(pw->buff, pw->qth->lat);
+    put_double(pw->buff, pw->qth->lon);
+    put_uint32(pw->buff, (guint32) pw->qth->alt);
+    pw->started = TRUE;
+}
 
-        /* Max El Az */
-        if (fields & (1 << MULTI_PASS_COL_MAX_EL_AZ))
-        {
-            buff = g_strdup_printf("%s  %9.2f", line, pass->maxel_az);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+/** Append the binary record of a pass. */
+static void pass_writer_bin_pass(pass_writer_t * pw, const pass_t * pass,
+                                 guint num_details)
+{
+    gsize           len = strlen(pass->satname);
+
+    len = MIN(len, G_MAXUINT16);
+
+    pass_writer_bin_start(pw);
+    g_string_append_c(pw->buff, 'P');
+    put_uint32(pw->buff, (guint32) pass->orbit);
+    put_double(pw->buff, pass->aos);
+    put_double(pw->buff, pass->tca);
+    put_double(pw->buff, pass->los);
+    put_float(pw->buff, pass->max_el);
+    put_float(pw->buff, pass->aos_az);
+    put_float(pw->buff, pass->maxel_az);
+    put_float(pw->buff, pass->los_az);
+    g_string_append_len(pw->buff, pass->vis, 4);
+    put_uint32(pw->buff, num_details);
+    g_string_append_c(pw->buff, (gchar) (len & 0xff));
+    g_string_append_c(pw->buff, (gchar) (len >> 8));
+    g_string_append_len(pw->buff, pass->satname, len);
+}
 
-        /* LOS Az */
-        if (fields & (1 << MULTI_PASS_COL_LOS_AZ))
-        {
-            buff = g_strdup_printf("%s  %6.2f", line, pass->los_az);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+/** Append the binary record of a pass detail. */
+static void pass_writer_bin_detail(pass_writer_t * pw,
+                                   const pass_detail_t * detail)
+{
+    g_string_append_c(pw->buff, 'D');
+    put_double(pw->buff, detail->time);
+    put_float(pw->buff, detail->az);
+    put_float(pw->buff, detail->el);
+    put_float(pw->buff, detail->range);
+    put_float(pw->buff, detail->range_rate);
+    put_float(pw->buff, detail->lat);
+    put_float(pw->buff, detail->lon);
+    put_float(pw->buff, detail->alt);
+    put_float(pw->buff, detail->velo);
+    put_float(pw->buff, detail->ma);
+    put_float(pw->buff, detail->phase);
+    put_float(pw->buff, detail->footprint);
+    put_uint32(pw->buff, (guint32) detail->orbit);
+    g_string_append_c(pw->buff, (gchar) detail->vis);
+}
 
-        /* Orbit */
-        if (fields & (1 << MULTI_PASS_COL_ORBIT))
-        {
-            buff = g_strdup_printf("%s  %5d", line, pass->orbit);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+/**
+ * Create a pass writer.
+ *
+ * @param stream The stream to write to. The caller keeps the reference and
+ *               closes the stream when done. A buffered stream is
+ *               recommended, since the writer writes one row at a time.
+ * @param format The output format.
+ * @param qth The observer data.
+ * @return The new writer, to be freed with pass_writer_free().
+ */
+pass_writer_t  *pass_writer_new(GOutputStream * stream,
+                                pass_writer_format_t format, qth_t * qth)
+{
+    pass_writer_t  *pw;
 
-        /* Visibility */
-        if (fields & (1 << MULTI_PASS_COL_VIS))
-        {
-            buff = g_strdup_printf("%s  %s", line, pass->vis);
-            g_free(line);
-            line = g_strdup(buff);
-            g_free(buff);
-        }
+    pw = g_new0(pass_writer_t, 1);
+    pw->stream = stream;
+    pw->format = format;
+    pw->qth = qth;
+    pw->fmtstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
+    pw->buff = g_string_sized_new(256);
+
+    return pw;
+}
+
+void pass_writer_free(pass_writer_t * pw)
+{
+    g_free(pw->fmtstr);
+    g_string_free(pw->buff, TRUE);
+    g_free(pw);
+}
+
+/**
+ * Write the page header of a single pass.
+ *
+ * Only text output has a page header; the other formats ignore it.
+ */
+gboolean pass_writer_pass_info(pass_writer_t * pw, pass_t * pass,
+                               gint fields, GError ** error)
+{
+    if (pw->format != PASS_WRITER_TXT)
+        return TRUE;
+
+    return pass_writer_take(pw, pass_to_txt_pgheader(pass, pw->qth, fields),
+                            error);
+}
+
+/**
+ * Write the page header of a list of passes.
+ *
+ * @param pass The first pass of the list.
+ *
+ * Only text output has a page header; the other formats ignore it.
+ */
+gboolean pass_writer_passes_info(pass_writer_t * pw, pass_t * pass,
+                                 gint fields, GError ** error)
+{
+    GSList          first = { pass, NULL };
+
+    if (pw->format != PASS_WRITER_TXT)
+        return TRUE;
+
+    return pass_writer_take(pw,
+                            passes_to_txt_pgheader(&first, pw->qth, fields),
+                            error);
+}
+
+/**
+ * Write the header of a pass summary table.
+ *
+ * @param pass The first pass of the table, used for the column widths.
+ */
+gboolean pass_writer_summary_header(pass_writer_t * pw, pass_t * pass,
+                                    gint fields, GError ** error)
+{
+    GSList          first = { pass, NULL };
+    guint           i;
+
+    switch (pw->format)
+    {
+    case PASS_WRITER_TXT:
+        return pass_writer_take(pw, passes_to_txt_tblheader(&first, pw->qth,
+                                                            fields), error);
+
+    case PASS_WRITER_CSV:
+        g_string_append(pw->buff, "aos,tca,los");
+        for (i = MULTI_PASS_COL_DURATION; i < MULTI_PASS_COL_NUMBER; i++)
+            if (fields & (1 << i))
+                g_string_append_printf(pw->buff, ",%s", MPCSV[i]);
+        g_string_append_c(pw->buff, '\n');
+        return pass_writer_flush(pw, error);
+
+    default:
+        return TRUE;
+    }
+}
 
-        /* append line to return string */
-        if (i == 0)
+/** Write a row of a pass summary table. */
+gboolean pass_writer_summary_row(pass_writer_t * pw, pass_t * pass,
+                                 gint fields, GError ** error)
+{
+    if (pw->format == PASS_WRITER_BIN)
+    {
+        pass_writer_bin_pass(pw, pass, 0);
+    }
+    else
+    {
+        append_pass_row(pw->buff, pass, fields, pw->fmtstr,
+                        pw->format == PASS_WRITER_CSV);
+        g_string_append_c(pw->buff, '\n');
+    }
+
+    return pass_writer_flush(pw, error);
+}
+
+/**
+ * Write the title of the details of a pass in a list of passes.
+ *
+ * Text and CSV output get an empty line and the orbit number; binary
+ * output needs no title.
+ */
+gboolean pass_writer_details_title(pass_writer_t * pw, pass_t * pass,
+                                   GError ** error)
+{
+    switch (pw->format)
+    {
+    case PASS_WRITER_TXT:
+        g_string_append_printf(pw->buff, "\n Orbit %d\n", pass->orbit);
+        return pass_writer_flush(pw, error);
+
+    case PASS_WRITER_CSV:
+        g_string_append_printf(pw->buff, "\norbit,%d\n", pass->orbit);
+        return pass_writer_flush(pw, error);
+
+    default:
+        return TRUE;
+    }
+}
+
+/** Write the header of a pass details table. */
+gboolean pass_writer_details_header(pass_writer_t * pw, pass_t * pass,
+                                    gint fields, GError ** error)
+{
+    guint           i;
+
+    switch (pw->format)
+    {
+    case PASS_WRITER_TXT:
+        return pass_writer_take(pw, pass_to_txt_tblheader(pass, pw->qth,
+                                                          fields), error);
+
+    case PASS_WRITER_CSV:
+        g_string_append(pw->buff, SPCSV[0]);
+        for (i = 1; i < NUMCOL; i++)
+            if (fields & (1 << i))
+                g_string_append_printf(pw->buff, ",%s", SPCSV[i]);
+        g_string_append_c(pw->buff, '\n');
+        return pass_writer_flush(pw, error);
+
+    default:
+        return TRUE;
+    }
+}
+
+/**
+ * Write the details of a pass, one row at a time.
+ *
+ * Binary output writes the pass record followed by all details; the
+ * fields are ignored since all values are written.
+ */
+gboolean pass_writer_details(pass_writer_t * pw, pass_t * pass, gint fields,
+                             GError ** error)
+{
+    gboolean        csv = (pw->format == PASS_WRITER_CSV);
+    guint           i;
+
+    if (pw->format == PASS_WRITER_BIN)
+    {
+        pass_writer_bin_pass(pw, pass, pass->num_details);
+        if (!pass_writer_flush(pw, error))
+            return FALSE;
+    }
+
+    for (i = 0; i < pass->num_details; i++)
+    {
+        if (pw->format == PASS_WRITER_BIN)
         {
-            data = g_strdup_printf("%s\n", line);
-            g_free(line);
+            pass_writer_bin_detail(pw, &pass->details[i]);
         }
         else
         {
-            buff = g_strconcat(data, line, "\n", NULL);
-            g_free(data);
-            data = g_strdup(buff);
-            g_free(buff);
+            append_detail_row(pw->buff, &pass->details[i], pw->qth, fields,
+                              pw->fmtstr, csv);
+            g_string_append_c(pw->buff, '\n');
         }
 
+        if (!pass_writer_flush(pw, error))
+            return FALSE;
     }
 
-    g_free(fmtstr);
-
-    return data;
+    return TRUE;
 }
-
 static void Calc_RADec(gdouble jul_utc, gdouble saz, gdouble sel,
                        qth_t * qth, obs_astro_t * obs_set)
 {
@@ -6,6 +6,22 @@
 #include "predict-tools.h"
 #include "gtk-sat-data.h"
 
+/** Output formats of pass_writer_t. */
+typedef enum {
+    PASS_WRITER_TXT = 0,        /*!< Aligned text, as in the pass dialogs. */
+    PASS_WRITER_CSV,            /*!< Comma separated values. */
+    PASS_WRITER_BIN             /*!< Compact binary records. */
+} pass_writer_format_t;
+
+/** Writer that streams pass predictions to a GOutputStream. */
+typedef struct {
+    GOutputStream  *stream;     /*!< Destination, owned by the caller. */
+    pass_writer_format_t format;        /*!< Output format. */
+    qth_t          *qth;        /*!< Observer data. */
+    gchar          *fmtstr;     /*!< Time format. */
+    GString        *buff;       /*!< Reused for every row. */
+    gboolean        started;    /*!< Binary file header written. */
+} pass_writer_t;
 
 gchar          *pass_to_txt_pgheader(pass_t * pass, qth_t * qth, gint fields);
 gchar          *pass_to_txt_tblheader(pass_t * pass, qth_t * qth, gint fields);
@@ -19,5 +35,22 @@ gchar          *passes_to_txt_tblheader(GSList * passes, qth_t * qth,
 gchar          *passes_to_txt_tblcontents(GSList * passes, qth_t * qth,
                                           gint fields);
 
+pass_writer_t  *pass_writer_new(GOutputStream * stream,
+                                pass_writer_format_t format, qth_t * qth);
+void            pass_writer_free(pass_writer_t * pw);
+gboolean        pass_writer_pass_info(pass_writer_t * pw, pass_t * pass,
+                                      gint fields, GError ** error);
+gboolean        pass_writer_passes_info(pass_writer_t * pw, pass_t * pass,
+                                        gint fields, GError ** error);
+gboolean        pass_writer_summary_header(pass_writer_t * pw, pass_t * pass,
+                                           gint fields, GError ** error);
+gboolean        pass_writer_summary_row(pass_writer_t * pw, pass_t * pass,
+                                        gint fields, GError ** error);
+gboolean        pass_writer_details_title(pass_writer_t * pw, pass_t * pass,
+                                          GError ** error);
+gboolean        pass_writer_details_header(pass_writer_t * pw, pass_t * pass,
+                                           gint fields, GError ** error);
+gboolean        pass_writer_details(pass_writer_t * pw, pass_t * pass,
+                                    gint fields, GError ** error);
 
 #endif
@@ -0,0 +1,518 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Pass prediction without the GUI.
+ *
+ * Usage: gpredict --predict [--qth=NAME ...] [--module=NAME ...]
+ *                 [--start=TIME] [--days=DAYS] [--passes=NUM]
+ *                 [--format=csv|json]
+ *
+ * The passes of the satellites in the given modules, or of all satellites
+ * in the satellite data directory, are predicted for each ground station
+ * with get_pass_timeline(), which uses all processors. The passes are
+ * written to stdout one ground station at a time, in the order of the
+ * --qth options, sorted by AOS and then by catalog number. The output is
+ * the same for the same input regardless of the number of processors.
+ *
+ * CSV output has a header line. JSON output has one object per line, so
+ * that it can be processed while it is being written. A summary with the
+ * throughput of each ground station is written to stderr.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "compat.h"
+#include "config-keys.h"
+#include "gtk-sat-data.h"
+#include "orbit-tools.h"
+#include "predict-cli.h"
+#include "predict-tools.h"
+#include "qth-data.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+#include "time-tools.h"
+
+/* Command line flag for headless prediction */
+static gboolean predict = FALSE;
+
+/* Ground stations, modules, time window and output format */
+static gchar  **qth_names = NULL;
+static gchar  **mod_names = NULL;
+static gchar   *start_str = NULL;
+static gint     days = 0;
+static gint     num_passes = 0;
+static gchar   *format = NULL;
+
+static GOptionEntry entries[] = {
+    {"predict", 0, 0, G_OPTION_ARG_NONE, &predict,
+     "Predict passes without the GUI and write them to stdout", NULL},
+    {"qth", 0, 0, G_OPTION_ARG_STRING_ARRAY, &qth_names,
+     "Ground station (.qth file); may be repeated. "
+     "Default is the default ground station", "NAME"},
+    {"module", 0, 0, G_OPTION_ARG_STRING_ARRAY, &mod_names,
+     "Use the satellites of a module; may be repeated. "
+     "Default is all satellites", "NAME"},
+    {"start", 0, 0, G_OPTION_ARG_STRING, &start_str,
+     "Start of the prediction as ISO 8601 time. Default is now", "TIME"},
+    {"days", 0, 0, G_OPTION_ARG_INT, &days,
+     "Number of days to predict. Default is the pass prediction setting",
+     "DAYS"},
+    {"passes", 0, 0, G_OPTION_ARG_INT, &num_passes,
+     "Maximum number of passes per satellite. "
+     "Default is the pass prediction setting", "NUM"},
+    {"format", 0, 0, G_OPTION_ARG_STRING, &format,
+     "Output format, csv (default) or json", "FORMAT"},
+    {NULL}
+};
+
+
+/** Get the options of the headless prediction. */
+GOptionGroup   *predict_cli_get_option_group(void)
+{
+    GOptionGroup   *group;
+
+    group = g_option_group_new("predict", "Headless prediction options:",
+                               "Show headless prediction options", NULL,
+                               NULL);
+    g_option_group_add_entries(group, entries);
+
+    return group;
+}
+
+/** Check whether --predict was given on the command line. */
+gboolean predict_cli_requested(void)
+{
+    return predict;
+}
+
+/**
+ * Read a ground station.
+ *
+ * @param name The name of a .qth file in the configuration directory, with
+ *             or without the extension, or the path of a .qth file.
+ * @return The QTH data or NULL if the file could not be read.
+ */
+static qth_t   *read_qth(const gchar * name)
+{
+    qth_t          *qth;
+    gchar          *confdir;
+    gchar          *fname;
+
+    if (g_file_test(name, G_FILE_TEST_IS_REGULAR))
+    {
+        fname = g_strdup(name);
+    }
+    else
+    {
+        confdir = get_user_conf_dir();
+        if (g_str_has_suffix(name, ".qth"))
+            fname = g_strconcat(confdir, G_DIR_SEPARATOR_S, name, NULL);
+        else
+            fname = g_strconcat(confdir, G_DIR_SEPARATOR_S, name, ".qth",
+                                NULL);
+        g_free(confdir);
+    }
+
+    qth = g_new0(qth_t, 1);
+    qth_init(qth);
+    if (!qth_data_read(fname, qth))
+    {
+        g_printerr(_("Could not read ground station %s\n"), fname);
+        qth_data_free(qth);
+        qth = NULL;
+    }
+    g_free(fname);
+
+    return qth;
+}
+
+/**
+ * Add the catalog numbers of the satellites in a module.
+ *
+ * @param name The name of the module, with or without the extension.
+ * @param catnums Array of gint to add the catalog numbers to.
+ * @return TRUE if the module could be read.
+ */
+static gboolean read_module(const gchar * name, GArray * catnums)
+{
+    GKeyFile       *cfgdata;
+    GError         *error = NULL;
+    gchar          *moddir;
+    gchar          *fname;
+    gint           *sats;
+    gsize           length;
+
+    moddir = get_modules_dir();
+    if (g_str_has_suffix(name, ".mod"))
+        fname = g_strconcat(moddir, G_DIR_SEPARATOR_S, name, NULL);
+    else
+        fname = g_strconcat(moddir, G_DIR_SEPARATOR_S, name, ".mod", NULL);
+    g_free(moddir);
+
+    cfgdata = g_key_file_new();
+    g_key_file_set_list_separator(cfgdata, ';');
+    if (!g_key_file_load_from_file(cfgdata, fname, G_KEY_FILE_NONE, &error))
+    {
+        g_printerr(_("Could not read module %s (%s)\n"), fname,
+                   error->message);
+        g_clear_error(&error);
+        g_key_file_free(cfgdata);
+        g_free(fname);
+        return FALSE;
+    }
+
+    sats = g_key_file_get_integer_list(cfgdata, MOD_CFG_GLOBAL_SECTION,
+                                       MOD_CFG_SATS_KEY, &length, &error);
+    if (error != NULL)
+    {
+        g_printerr(_("Could not get the satellites of module %s (%s)\n"),
+                   fname, error->message);
+        g_clear_error(&error);
+        length = 0;
+    }
+
+    if (sats != NULL)
+    {
+        g_array_append_vals(catnums, sats, length);
+        g_free(sats);
+    }
+
+    g_key_file_free(cfgdata);
+    g_free(fname);
+
+    return TRUE;
+}
+
+/** Add the catalog numbers of all satellites in the satellite data dir. */
+static void read_all_sats(GArray * catnums)
+{
+    GDir           *dir;
+    gchar          *dirname;
+    const gchar    *fname;
+    gint            catnum;
+
+    dirname = get_satdata_dir();
+    dir = g_dir_open(dirname, 0, NULL);
+    g_free(dirname);
+
+    if (dir == NULL)
+        return;
+
+    while ((fname = g_dir_read_name(dir)) != NULL)
+    {
+        if (!g_str_has_suffix(fname, ".sat"))
+            continue;
+
+        catnum = atoi(fname);
+        if (catnum > 0)
+            g_array_append_val(catnums, catnum);
+    }
+    g_dir_close(dir);
+}
+
+static gint compare_catnum(gconstpointer a, gconstpointer b)
+{
+    gint            ca = *(const gint *)a;
+    gint            cb = *(const gint *)b;
+
+    return (ca > cb) - (ca < cb);
+}
+
+/**
+ * Read the satellites to predict.
+ *
+ * @param qth The QTH used to initialise the satellites.
+ * @return Array of sat_t pointers sorted by catalog number, without
+ *         duplicates.
+ */
+static GPtrArray *read_sats(qth_t * qth)
+{
+    GPtrArray      *sats;
+    GArray         *catnums;
+    sat_t          *sat;
+    gint            catnum;
+    guint           i;
+
+    catnums = g_array_new(FALSE, FALSE, sizeof(gint));
+    if (mod_names != NULL)
+    {
+        for (i = 0; mod_names[i] != NULL; i++)
+            read_module(mod_names[i], catnums);
+    }
+    else
+    {
+        read_all_sats(catnums);
+    }
+
+    /* the order of the satellites decides the order of simultaneous AOS */
+    g_array_sort(catnums, compare_catnum);
+
+    sats = g_ptr_array_new();
+    for (i = 0; i < catnums->len; i++)
+    {
+        catnum = g_array_index(catnums, gint, i);
+        if (i > 0 && catnum == g_array_index(catnums, gint, i - 1))
+            continue;
+
+        sat = g_new0(sat_t, 1);
+        if (gtk_sat_data_read_sat(catnum, sat))
+        {
+            g_printerr(_("Could not read data for #%d\n"), catnum);
+            g_free(sat);
+            continue;
+        }
+        gtk_sat_data_init_sat(sat, qth);
+        g_ptr_array_add(sats, sat);
+    }
+    g_array_free(catnums, TRUE);
+
+    return sats;
+}
+
+/** Format a Julian date as ISO 8601 UTC, rounded to the second. */
+static void format_time(gchar * buff, gsize size, gdouble t)
+{
+    GDateTime      *dt;
+    gchar          *str;
+
+    dt = g_date_time_new_from_unix_utc((gint64)
+                                       floor((t - 2440587.5) * 86400.0 +
+                                             0.5));
+    str = g_date_time_format(dt, "%Y-%m-%dT%H:%M:%SZ");
+    g_strlcpy(buff, str, size);
+    g_free(str);
+    g_date_time_unref(dt);
+}
+
+/** Write a string as a quoted CSV field. */
+static void print_csv_string(const gchar * str)
+{
+    putchar('"');
+    for (; *str != '\0'; str++)
+    {
+        if (*str == '"')
+            putchar('"');
+        putchar(*str);
+    }
+    putchar('"');
+}
+
+/** Write a string as a JSON string. */
+static void print_json_string(const gchar * str)
+{
+    putchar('"');
+    for (; *str != '\0'; str++)
+    {
+        if (*str == '"' || *str == '\\')
+            printf("\\%c", *str);
+        else if ((guchar) * str < 0x20)
+            printf("\\u%04x", (guchar) * str);
+        else
+            putchar(*str);
+    }
+    putchar('"');
+}
+
+/** Write one pass in the selected format. */
+static void print_pass(gboolean json, const qth_t * qth, const sat_t * sat,
+                       const pass_t * pass)
+{
+    gchar           aos[32], tca[32], los[32];
+
+    format_time(aos, sizeof(aos), pass->aos);
+    format_time(tca, sizeof(tca), pass->tca);
+    format_time(los, sizeof(los), pass->los);
+
+    if (json)
+    {
+        printf("{\"qth\":");
+        print_json_string(qth->name);
+        printf(",\"catnum\":%d,\"satellite\":", sat->tle.catnr);
+        print_json_string(sat->nickname);
+        printf(",\"aos\":\"%s\",\"tca\":\"%s\",\"los\":\"%s\","
+               "\"duration\":%.0f,\"aos_az\":%.2f,\"max_el\":%.2f,"
+               "\"max_el_az\":%.2f,\"los_az\":%.2f,\"orbit\":%d,"
+               "\"vis\":\"%s\"}\n",
+               aos, tca, los, (pass->los - pass->aos) * 86400.0,
+               pass->aos_az, pass->max_el, pass->maxel_az, pass->los_az,
+               pass->orbit, pass->vis);
+    }
+    else
+    {
+        print_csv_string(qth->name);
+        printf(",%d,", sat->tle.catnr);
+        print_csv_string(sat->nickname);
+        printf(",%s,%s,%s,%.0f,%.2f,%.2f,%.2f,%.2f,%d,%s\n",
+               aos, tca, los, (pass->los - pass->aos) * 86400.0,
+               pass->aos_az, pass->max_el, pass->maxel_az, pass->los_az,
+               pass->orbit, pass->vis);
+    }
+}
+
+/**
+ * Run the headless prediction.
+ *
+ * @return The exit code of the program: 0 on success, 1 if the options
+ *         are wrong or no ground station or satellite could be read.
+ */
+gint predict_cli_run(void)
+{
+    GPtrArray      *qths;
+    GPtrArray      *sats;
+    GPtrArray      *visible;
+    pass_timeline_t *timeline;
+    qth_t          *qth;
+    sat_t          *sat;
+    GTimeVal        tv;
+    gchar          *name;
+    gboolean        json = FALSE;
+    gdouble         start, maxdt;
+    gint64          t0, dt, total_dt = 0;
+    guint           total_passes = 0;
+    guint           i, j;
+    gint            ret = 0;
+
+    if (format != NULL && !g_strcmp0(format, "json"))
+    {
+        json = TRUE;
+    }
+    else if (format != NULL && g_strcmp0(format, "csv"))
+    {
+        g_printerr(_("Unknown output format %s\n"), format);
+        return 1;
+    }
+
+    if (start_str != NULL)
+    {
+        if (!g_time_val_from_iso8601(start_str, &tv))
+        {
+            g_printerr(_("Invalid start time %s\n"), start_str);
+            return 1;
+        }
+        start = 2440587.5 + (tv.tv_sec + tv.tv_usec / 1.0e6) / 86400.0;
+    }
+    else
+    {
+        start = get_current_daynum();
+    }
+
+    maxdt = days > 0 ? days : sat_cfg_get_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
+    if (num_passes <= 0)
+        num_passes = sat_cfg_get_int(SAT_CFG_INT_PRED_NUM_PASS);
+
+    /* ground stations in the order given */
+    qths = g_ptr_array_new();
+    if (qth_names != NULL)
+    {
+        for (i = 0; qth_names[i] != NULL; i++)
+            if ((qth = read_qth(qth_names[i])) != NULL)
+                g_ptr_array_add(qths, qth);
+    }
+    else
+    {
+        name = sat_cfg_get_str(SAT_CFG_STR_DEF_QTH);
+        if ((qth = read_qth(name)) != NULL)
+            g_ptr_array_add(qths, qth);
+        g_free(name);
+    }
+
+    if (qths->len == 0)
+    {
+        g_printerr(_("No ground station\n"));
+        g_ptr_array_free(qths, TRUE);
+        return 1;
+    }
+
+    sats = read_sats(g_ptr_array_index(qths, 0));
+    if (sats->len == 0)
+    {
+        g_printerr(_("No satellites\n"));
+        ret = 1;
+    }
+    else if (!json)
+    {
+        printf("qth,catnum,satellite,aos,tca,los,duration,aos_az,max_el,"
+               "max_el_az,los_az,orbit,vis\n");
+    }
+
+    visible = g_ptr_array_new();
+    for (i = 0; ret == 0 && i < qths->len; i++)
+    {
+        qth = g_ptr_array_index(qths, i);
+
+        /* has_aos() is cheap, and it keeps the satellites that can never
+           be seen from the station out of the thread pool */
+        g_ptr_array_set_size(visible, 0);
+        for (j = 0; j < sats->len; j++)
+        {
+            sat = g_ptr_array_index(sats, j);
+            if (has_aos(sat, qth) && !decayed(sat))
+                g_ptr_array_add(visible, sat);
+        }
+
+        t0 = g_get_monotonic_time();
+        timeline = get_pass_timeline((sat_t **) visible->pdata, visible->len,
+                                     qth, start, maxdt, num_passes);
+        dt = g_get_monotonic_time() - t0;
+
+        for (j = 0; j < timeline->num_passes; j++)
+            print_pass(json, qth, timeline->passes[j].sat,
+                       timeline->passes[j].pass);
+        fflush(stdout);
+
+        g_printerr(_("%s: %u passes of %u satellites in %.3f s "
+                     "(%.1f satellites/s)\n"),
+                   qth->name, timeline->num_passes, visible->len, dt / 1.0e6,
+                   dt > 0 ? visible->len * 1.0e6 / dt : 0.0);
+
+        total_passes += timeline->num_passes;
+        total_dt += dt;
+        free_pass_timeline(timeline);
+    }
+
+    if (ret == 0 && qths->len > 1)
+        g_printerr(_("Total: %u passes for %u ground stations in %.3f s "
+                     "(%.1f passes/s)\n"),
+                   total_passes, qths->len, total_dt / 1.0e6,
+                   total_dt > 0 ? total_passes * 1.0e6 / total_dt : 0.0);
+
+    g_ptr_array_free(visible, TRUE);
+    for (i = 0; i < sats->len; i++)
+        gtk_sat_data_free_sat(g_ptr_array_index(sats, i));
+    g_ptr_array_free(sats, TRUE);
+    for (i = 0; i < qths->len; i++)
+        qth_data_free(g_ptr_array_index(qths, i));
+    g_ptr_array_free(qths, TRUE);
+
+    return ret;
+}
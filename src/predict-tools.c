@@ -33,6 +33,7 @@
 #include <build-config.h>
 #endif
 
+#include <float.h>
 #include <glib.h>
 #include <glib/gi18n.h>
 
@@ -44,28 +45,160 @@
 #include "sgpsdp/sgp4sdp4.h"
 #include "time-tools.h"
 
+/** \brief Prediction settings read from sat-cfg, see predict_cfg_load(). */
+typedef struct {
+    gdouble         min_el;     /*!< Minimum elevation of get_pass() */
+    gdouble         tres;       /*!< Pass detail time resolution in days */
+    gint            nument;     /*!< Pass detail number of entries */
+    gdouble         event_tol;  /*!< AOS/LOS tolerance in days */
+    gdouble         twilight;   /*!< Twilight threshold in degrees */
+} predict_cfg_t;
+
+static void     predict_cfg_load(predict_cfg_t * cfg);
+static pass_t  *get_pass_cfg(sat_t * sat, qth_t * qth, gdouble start,
+                             gdouble maxdt, const predict_cfg_t * cfg);
+static GSList  *get_passes_cfg(sat_t * sat, qth_t * qth, gdouble start,
+                               gdouble maxdt, guint num,
+                               const predict_cfg_t * cfg);
 static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
-                                gdouble maxdt, gdouble min_el);
+                                gdouble maxdt, gdouble min_el,
+                                const predict_cfg_t * cfg);
+static void     predict_calc_obs(sat_t * sat, const obs_frame_t * ctx);
+static void     pass_detail_set(pass_detail_t * detail, sat_t * sat);
+
+/* Number of times propagated at once by predict_calc_series() */
+#define PREDICT_SERIES_CHUNK 64
+
+/* Max number of orbit calculations in one AOS/LOS search, including the
+   search for the end of a pass in progress */
+#define EVENT_MAX_CALLS 10000
+
+/* Max number of iterations used to locate an AOS or LOS in its bracket */
+#define EVENT_MAX_ITER  60
+
+/* Max number of passes below the minimum elevation that get_pass_engine()
+   skips before giving up */
+#define PASS_MAX_SKIPPED 1000
+
+/** \brief State of one AOS/LOS search. */
+typedef struct {
+    guint           calls;      /*!< Number of predict_calc() calls */
+    guint           steps;      /*!< Bracketing steps and solver iterations */
+    gdouble         tol;        /*!< Time tolerance in days */
+} event_search_t;
+
+/* AOS/LOS solver statistics, see predict_event_stats() */
+static gint     event_stat_events = 0;
+static gint     event_stat_calls = 0;
+
+/* Per satellite statistics: catalog number -> event_sat_stats_t */
+static GHashTable *event_sat_stats = NULL;
+G_LOCK_DEFINE_STATIC(event_sat_stats);
+
+/* Max number of passes cached per satellite and QTH */
+#define PASS_CACHE_SIZE 50
+
+/* Max number of QTHs cached per satellite */
+#define PASS_CACHE_QTHS 4
+
+/** \brief A pass in the pass cache. */
+typedef struct {
+    gdouble         from;       /*!< Start time of the search that found it */
+    gdouble         min_el;     /*!< Minimum elevation used for the search */
+    pass_t         *pass;       /*!< The pass */
+} pass_cache_entry_t;
+
+/** \brief Cached passes of a satellite seen from a QTH. */
+typedef struct {
+    qth_small_t     qth;        /*!< QTH the passes were calculated for */
+    gdouble         epoch;      /*!< TLE epoch */
+    gdouble         tres;       /*!< Pass detail time resolution */
+    gint            nument;     /*!< Pass detail number of entries */
+    gdouble         twilight;   /*!< Twilight threshold of the visibility */
+    GSList         *entries;    /*!< pass_cache_entry_t, newest first */
+} pass_cache_t;
+
+/* Pass cache: catalog number -> list of pass_cache_t, one per QTH */
+static GHashTable *pass_cache = NULL;
+static guint    pass_cache_hits = 0;
+static guint    pass_cache_misses = 0;
+G_LOCK_DEFINE_STATIC(pass_cache);
+
+static pass_t  *pass_cache_get(sat_t * sat, qth_t * qth, gdouble start,
+                               gdouble maxdt, gdouble min_el,
+                               const predict_cfg_t * cfg);
+static pass_t  *pass_cache_lookup(sat_t * sat, qth_t * qth, gdouble start,
+                                  gdouble min_el, const predict_cfg_t * cfg);
+static void     pass_cache_insert(sat_t * sat, qth_t * qth, gdouble start,
+                                  gdouble min_el, pass_t * pass,
+                                  const predict_cfg_t * cfg);
+static void     pass_cache_flush(pass_cache_t * cache);
+static void     pass_cache_free(gpointer cache);
+static void     pass_cache_free_list(gpointer list);
 
 /**
  * \brief SGP4SDP4 driver for doing AOS/LOS calculations.
  * \param sat Pointer to the satellite data.
  * \param qth Pointer to the QTH data.
  * \param t The time for calculation (Julian Date)
+ *
+ * When several satellites are calculated for the same time and QTH, or
+ * one satellite for many times, use predict_calc_ctx() instead.
  */
 void predict_calc(sat_t * sat, qth_t * qth, gdouble t)
 {
-    obs_set_t       obs_set;
-    geodetic_t      sat_geodetic;
+    obs_frame_t     ctx;
+
+    predict_ctx_init(&ctx, qth, t);
+    predict_calc_ctx(sat, &ctx);
+}
+
+/**
+ * \brief Set up an observer frame for predict_calc_ctx().
+ * \param ctx The frame to set up.
+ * \param qth Pointer to the QTH data.
+ * \param t The time for calculation (Julian Date)
+ *
+ * The frame holds everything about the observer and the sidereal time that
+ * predict_calc() would otherwise calculate again for every satellite. It
+ * has to be set up again if the QTH moves.
+ */
+void predict_ctx_init(obs_frame_t * ctx, qth_t * qth, gdouble t)
+{
     geodetic_t      obs_geodetic;
-    double          age;
 
     obs_geodetic.lon = qth->lon * de2ra;
     obs_geodetic.lat = qth->lat * de2ra;
     obs_geodetic.alt = qth->alt / 1000.0;
     obs_geodetic.theta = 0;
 
-    sat->jul_utc = t;
+    Initialize_Frame(ctx, &obs_geodetic);
+    Set_Frame_Time(ctx, t);
+}
+
+/**
+ * \brief Move an observer frame to a new time.
+ * \param ctx The frame set up with predict_ctx_init().
+ * \param t The time for calculation (Julian Date)
+ *
+ * Only the sidereal time and the observer position and velocity are
+ * calculated again, and only if t has changed.
+ */
+void predict_ctx_set_time(obs_frame_t * ctx, gdouble t)
+{
+    Set_Frame_Time(ctx, t);
+}
+
+/**
+ * \brief Same as predict_calc() using an observer frame.
+ * \param sat Pointer to the satellite data.
+ * \param ctx The observer frame, which also gives the time.
+ *
+ * The frame is not modified, so it can be shared by several threads.
+ */
+void predict_calc_ctx(sat_t * sat, const obs_frame_t * ctx)
+{
+    sat->jul_utc = ctx->jd;
     sat->tsince = (sat->jul_utc - sat->jul_epoch) * xmnpda;
 
     /* call the norad routines according to the deep-space flag */
@@ -74,13 +207,147 @@ void predict_calc(sat_t * sat, qth_t * qth, gdouble t)
     else
         SGP4(sat, sat->tsince);
 
+    predict_calc_obs(sat, ctx);
+}
+
+/**
+ * \brief Same as predict_calc_ctx() using a Chebyshev ephemeris.
+ * \param sat Pointer to the satellite data.
+ * \param eph Pointer to the ephemeris of the satellite.
+ * \param ctx The observer frame, which also gives the time.
+ *
+ * The position is evaluated from the ephemeris, which is fitted to SGP4/SDP4
+ * as t moves. It is accurate to CHEB_POS_TOL and much faster than
+ * predict_calc() when t moves in small steps, but it should not be used
+ * where the exact position is needed, e.g. for radio and rotator control.
+ * If the ephemeris can not be fitted, SGP4/SDP4 is used instead.
+ * The squint angle elements in sat->tle are not updated.
+ */
+void predict_calc_ephem(sat_t * sat, cheb_ephem_t * eph,
+                        const obs_frame_t * ctx)
+{
+    sat->jul_utc = ctx->jd;
+    sat->tsince = (sat->jul_utc - sat->jul_epoch) * xmnpda;
+
+    if (Cheb_Propagate(eph, &sat->elset, sat->tsince, &sat->pos, &sat->vel,
+                       &sat->phase))
+    {
+        predict_calc_ctx(sat, ctx);
+        return;
+    }
+
+    predict_calc_obs(sat, ctx);
+}
+
+/**
+ * \brief Calculate a satellite for a series of equally spaced times.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param start The first time (Julian Date).
+ * \param step The time step in days; may be negative.
+ * \param num The number of times.
+ * \param details Array of num entries for the results; vis is not set.
+ *
+ * Calculates the same as predict_calc() for start + i * step,
+ * i = 0 ... num - 1, but the orbit is propagated with Propagate_Series()
+ * and the observer frame is moved with Step_Frame_Time(), which carry
+ * most of the work from one time to the next. Afterwards sat holds the
+ * data of the last time, as after predict_calc().
+ *
+ * The results are not identical. The position and velocity agree with
+ * SGP4()/SDP4() to within SERIES_POS_TOL and SERIES_VEL_TOL (~13 m and
+ * ~16 mm/s), and the stepped observer position drifts from the exact one
+ * by less than 1 m; it is set exactly at the start of each chunk of
+ * PREDICT_SERIES_CHUNK times, and test-006 measures 0.85 m after 500
+ * steps of 10 minutes.
+ */
+void predict_calc_series(sat_t * sat, qth_t * qth, gdouble start,
+                         gdouble step, guint num, pass_detail_t * details)
+{
+    sgpsdp_point_t  points[PREDICT_SERIES_CHUNK];
+    obs_frame_t     ctx;
+    gdouble         t;
+    guint           i, j, n;
+
+    predict_ctx_init(&ctx, qth, start);
+    Set_Frame_Step(&ctx, step);
+
+    for (i = 0; i < num; i += n)
+    {
+        n = MIN(num - i, PREDICT_SERIES_CHUNK);
+        Propagate_Series(&sat->elset, &sat->state,
+                         (start + i * step - sat->jul_epoch) * xmnpda,
+                         step * xmnpda, n, points);
+
+        /* the frame is set exactly at the start of each chunk */
+        for (j = 0; j < n; j++)
+        {
+            t = start + (i + j) * step;
+            if (j == 0)
+                predict_ctx_set_time(&ctx, t);
+            else
+                Step_Frame_Time(&ctx, t);
+
+            sat->jul_utc = t;
+            sat->tsince = (t - sat->jul_epoch) * xmnpda;
+            sat->pos = points[j].pos;
+            sat->vel = points[j].vel;
+            sat->phase = points[j].phase;
+            predict_calc_obs(sat, &ctx);
+            pass_detail_set(&details[i + j], sat);
+        }
+    }
+
+    sat->tle.omegao1 = sat->state.omegao1;
+    sat->tle.xincl1 = sat->state.xincl1;
+    sat->tle.xnodeo1 = sat->state.xnodeo1;
+}
+
+/**
+ * \brief Store the current data of a satellite in a pass detail.
+ * \param detail The pass detail; vis is not set.
+ * \param sat Pointer to the satellite data, as after predict_calc().
+ */
+static void pass_detail_set(pass_detail_t * detail, sat_t * sat)
+{
+    detail->time = sat->jul_utc;
+    detail->pos = sat->pos;
+    detail->vel = sat->vel;
+    detail->velo = sat->velo;
+    detail->az = sat->az;
+    detail->el = sat->el;
+    detail->range = sat->range;
+    detail->range_rate = sat->range_rate;
+    detail->lat = sat->ssplat;
+    detail->lon = sat->ssplon;
+    detail->alt = sat->alt;
+    detail->ma = sat->ma;
+    detail->phase = sat->phase;
+    detail->footprint = sat->footprint;
+    detail->orbit = sat->orbit;
+}
+
+/**
+ * \brief Compute the observer dependent data from the raw SGP4/SDP4 output.
+ * \param sat Pointer to the satellite data.
+ * \param ctx The observer frame for sat->jul_utc.
+ *
+ * This function is called once sat->pos, sat->vel and sat->phase contain
+ * the raw output of the propagator for sat->jul_utc.
+ */
+static void predict_calc_obs(sat_t * sat, const obs_frame_t * ctx)
+{
+    obs_set_t       obs_set;
+    geodetic_t      sat_geodetic;
+    double          age;
+
     Convert_Sat_State(&sat->pos, &sat->vel);
 
     /* get the velocity of the satellite */
     Magnitude(&sat->vel);
     sat->velo = sat->vel.w;
-    Calculate_Obs(sat->jul_utc, &sat->pos, &sat->vel, &obs_geodetic, &obs_set);
-    Calculate_LatLonAlt(sat->jul_utc, &sat->pos, &sat_geodetic);
+    Calculate_Obs_Frame(ctx, &sat->pos, &sat->vel, &obs_set);
+    Calculate_LatLonAlt_Frame(ctx, &sat->pos, &sat_geodetic);
 
     while (sat_geodetic.lon < -pi)
         sat_geodetic.lon += twopi;
@@ -110,251 +377,747 @@ void predict_calc(sat_t * sat, qth_t * qth, gdouble t)
       + sat->tle.revnum ;
 }
 
+static void predict_batch_add(gpointer key, gpointer value, gpointer data)
+{
+    predict_batch_t *batch = (predict_batch_t *) data;
+    sat_t          *sat = SAT(value);
+
+    (void)key;
+
+    /* SGP4_Batch_Add refuses deep-space satellites */
+    if (SGP4_Batch_Add(&batch->sgp4, sat))
+        g_ptr_array_add(batch->deep, sat);
+}
+
 /**
- * \brief Find the AOS time of the next pass.
- * \author Alexandru Csete, OZ9AEC
- * \author John A. Magliacane, KD2BD
- * \param sat Pointer to the satellite data.
- * \param qth Pointer to the QTH data.
- * \param start The time where calculation should start.
- * \param maxdt The upper time limit in days (0.0 = no limit)
- * \return The time of the next AOS or 0.0 if the satellite has no AOS.
+ * \brief Create a propagation batch for a set of satellites.
+ * \param sats Hash table containing the satellites (sat_t).
+ * \return A newly allocated batch that must be freed with predict_batch_free().
  *
- * This function finds the time of AOS for the first coming pass taking place
- * no earlier that start.
- * If the satellite is currently within range, the function first calls
- * find_los to get the next LOS time. Then the calculations are done using
- * the new start time.
+ * The batch keeps pointers to the satellites in the hash table and must be
+ * recreated whenever the satellites are reloaded.
  */
-gdouble find_aos(sat_t * sat, qth_t * qth, gdouble start, gdouble maxdt)
+predict_batch_t *predict_batch_new(GHashTable * sats)
 {
-    gdouble         t = start;
-    gdouble         aostime = 0.0;
+    predict_batch_t *batch;
 
-    /* make sure current sat values are in sync with the time */
-    predict_calc(sat, qth, start);
+    batch = g_new(predict_batch_t, 1);
+    SGP4_Batch_Init(&batch->sgp4);
+    batch->deep = g_ptr_array_new();
 
-    /* check whether satellite has aos */
-    if (!has_aos(sat, qth))
-        return 0.0;
+    g_hash_table_foreach(sats, predict_batch_add, batch);
 
-    if (sat->el > 0.0)
-        t = find_los(sat, qth, start, maxdt) + 0.014;   // +20 min
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: %d near-earth and %d deep-space satellites in batch"),
+                __func__, batch->sgp4.num, batch->deep->len);
 
-    /* invalid time (potentially returned by find_los) */
-    if (t < 0.1)
-        return 0.0;
+    return batch;
+}
 
-    /* update satellite data */
-    predict_calc(sat, qth, t);
+/** \brief Free a batch created by predict_batch_new(). */
+void predict_batch_free(predict_batch_t * batch)
+{
+    if (batch == NULL)
+        return;
 
-    /* use upper time limit */
-    if (maxdt > 0.0)
-    {
+    SGP4_Batch_Free(&batch->sgp4);
+    g_ptr_array_free(batch->deep, TRUE);
+    g_free(batch);
+}
 
-        /* coarse time steps */
-        while ((sat->el < -1.0) && (t <= (start + maxdt)))
-        {
-            t -= 0.00035 * (sat->el * ((sat->alt / 8400.0) + 0.46) - 2.0);
-            predict_calc(sat, qth, t);
-        }
+/**
+ * \brief Batch version of predict_calc_ctx().
+ * \param batch The batch of satellites to update.
+ * \param ctx The observer frame, which also gives the time.
+ *
+ * Calculates the same as predict_calc_ctx() for each satellite in the
+ * batch, except that the near-earth satellites are propagated together
+ * using SGP4_Batch(). Their positions and velocities are not identical to
+ * those of SGP4() but agree to within SGP4_BATCH_POS_TOL and
+ * SGP4_BATCH_VEL_TOL (~13 m and ~16 mm/s).
+ */
+void predict_calc_batch(predict_batch_t * batch, const obs_frame_t * ctx)
+{
+    predict_batch_part_t range;
 
-        /* fine steps */
-        while ((aostime == 0.0) && (t <= (start + maxdt)))
-        {
+    predict_batch_part(batch, 0, 1, &range);
+    predict_calc_batch_part(batch, &range, ctx);
+}
 
-            if (fabs(sat->el) < 0.005)
-            {
-                aostime = t;
-            }
-            else
-            {
-                t -= sat->el * sqrt(sat->alt) / 530000.0;
-                predict_calc(sat, qth, t);
-            }
+/**
+ * \brief Split a batch into parts of about the same size.
+ * \param batch The batch of satellites.
+ * \param part The number of the part, 0 to nparts - 1.
+ * \param nparts The number of parts.
+ * \param range Location where the satellites of the part are stored.
+ *
+ * The near-earth satellites are split on whole vectors of SGP4_Batch(),
+ * so that different threads can calculate the parts at the same time with
+ * predict_calc_batch_part().
+ */
+void predict_batch_part(const predict_batch_t * batch, guint part,
+                        guint nparts, predict_batch_part_t * range)
+{
+    guint           nvec, ndeep;
 
-        }
+    nvec = (batch->sgp4.num + SGP4_BATCH_LANES - 1) / SGP4_BATCH_LANES;
+    range->first = part * nvec / nparts * SGP4_BATCH_LANES;
+    range->last = MIN((part + 1) * nvec / nparts * SGP4_BATCH_LANES,
+                      (guint) batch->sgp4.num);
 
-    }
-    /* don't use upper time limit */
-    else
-    {
-        /* coarse time steps */
-        while (sat->el < -1.0)
-        {
-            t -= 0.00035 * (sat->el * ((sat->alt / 8400.0) + 0.46) - 2.0);
-            predict_calc(sat, qth, t);
-        }
+    ndeep = batch->deep->len;
+    range->dfirst = part * ndeep / nparts;
+    range->dlast = (part + 1) * ndeep / nparts;
+}
 
-        /* fine steps */
-        while (aostime == 0.0)
-        {
+/**
+ * \brief Calculate a part of a batch.
+ * \param batch The batch of satellites to update.
+ * \param range The part of the batch from predict_batch_part().
+ * \param ctx The observer frame, which also gives the time.
+ *
+ * Same as predict_calc_batch() for the satellites in range only.
+ */
+void predict_calc_batch_part(predict_batch_t * batch,
+                             const predict_batch_part_t * range,
+                             const obs_frame_t * ctx)
+{
+    sat_t          *sat;
+    gint            i;
+    guint           j;
 
-            if (fabs(sat->el) < 0.005)
-            {
-                aostime = t;
-            }
-            else
-            {
-                t -= sat->el * sqrt(sat->alt) / 530000.0;
-                predict_calc(sat, qth, t);
-            }
-        }
+    SGP4_Batch_Range(&batch->sgp4, ctx->jd, range->first, range->last);
+
+    for (i = range->first; i < range->last; i++)
+    {
+        sat = batch->sgp4.sats[i];
+        sat->jul_utc = ctx->jd;
+        sat->tsince = (ctx->jd - sat->jul_epoch) * xmnpda;
+        predict_calc_obs(sat, ctx);
     }
 
-    return aostime;
+    for (j = range->dfirst; j < range->dlast; j++)
+        predict_calc_ctx(SAT(g_ptr_array_index(batch->deep, j)), ctx);
 }
 
 /**
- * \brief Find the LOS time of the next pass.
- * \author Alexandru Csete, OZ9AEC
- * \author John A. Magliacane, KD2BD
+ * \brief Evaluate the elevation during an AOS/LOS search.
  * \param sat Pointer to the satellite data.
- * \param qth Pointer to the QTH data.
- * \param start The time where calculation should start.
- * \param maxdt The upper time limit in days (0.0 = no limit)
- * \return The time of the next LOS or 0.0 if the satellite has no LOS.
- *
- * This function finds the time of LOS for the first coming pass taking place
- * no earlier that start.
- * If the satellite is currently out of range, the function first calls
- * find_aos to get the next AOS time. Then the calculations are done using
- * the new start time.
- * The function has a built-in watchdog to ensure that we don't end up in
- * lengthy loops.
+ * \param ctx The observer frame of the search.
+ * \param t The time for calculation (Julian Date)
+ * \param search The search, which counts the predict_calc() calls.
  */
-gdouble find_los(sat_t * sat, qth_t * qth, gdouble start, gdouble maxdt)
+static void event_calc(sat_t * sat, obs_frame_t * ctx, gdouble t,
+                       event_search_t * search)
 {
-    gdouble         t = start;
-    gdouble         lostime = 0.0;
-    gdouble         eltemp;
+    predict_ctx_set_time(ctx, t);
+    predict_calc_ctx(sat, ctx);
+    search->calls++;
+}
+
+static void event_sat_stats_free(gpointer stats)
+{
+    g_free(((event_sat_stats_t *) stats)->name);
+    g_free(stats);
+}
+
+/**
+ * \brief Add the cost of an AOS/LOS search to the statistics.
+ * \param sat The satellite.
+ * \param search The finished search.
+ * \param status The result of the search.
+ * \param usec The duration of the search.
+ */
+static void event_done(sat_t * sat, const event_search_t * search,
+                       event_status_t status, gint64 usec)
+{
+    event_sat_stats_t *stats;
 
-    predict_calc(sat, qth, start);
+    /* satellites that never rise are rejected before the search */
+    if (status == EVENT_NEVER)
+        return;
 
-    /* check whether satellite has aos */
-    if (!has_aos(sat, qth))
+    g_atomic_int_inc(&event_stat_events);
+    g_atomic_int_add(&event_stat_calls, (gint) search->calls);
+
+    G_LOCK(event_sat_stats);
+
+    if (event_sat_stats == NULL)
+        event_sat_stats = g_hash_table_new_full(g_int_hash, g_int_equal,
+                                                NULL, event_sat_stats_free);
+
+    stats = g_hash_table_lookup(event_sat_stats, &sat->tle.catnr);
+    if (stats == NULL)
     {
-        return 0.0;
+        stats = g_new0(event_sat_stats_t, 1);
+        stats->catnr = sat->tle.catnr;
+        stats->name = g_strdup(sat->nickname);
+        g_hash_table_insert(event_sat_stats, &stats->catnr, stats);
     }
 
-    if (sat->el < 0.0)
-        t = find_aos(sat, qth, start, maxdt) + 0.001;   // +1.5 min
+    stats->searches++;
+    if (status == EVENT_BUDGET)
+        stats->exhausted++;
+    stats->steps += search->steps;
+    stats->calls += search->calls;
+    stats->usec += usec;
+    stats->max_calls = MAX(stats->max_calls, search->calls);
 
-    /* invalid time (potentially returned by find_aos) */
-    if (t < 0.01)
-        return 0.0;
+    G_UNLOCK(event_sat_stats);
+}
 
-    /* update satellite data */
-    predict_calc(sat, qth, t);
+/**
+ * \brief Get the configured tolerance of the AOS/LOS solver.
+ * \return The tolerance in days.
+ *
+ * sat-cfg stores the tolerance in milliseconds. This reads sat-cfg, so it
+ * must be called in the main thread; code running in other threads gets the
+ * tolerance from its caller.
+ */
+gdouble predict_event_tol(void)
+{
+    gint            tol = sat_cfg_get_int(SAT_CFG_INT_PRED_EVENT_TOL);
+
+    if (tol < 1)
+        tol = 1;
+
+    return tol / 8.64e7;
+}
+
+/**
+ * \brief Read the prediction settings.
+ * \param cfg Location to store the settings.
+ *
+ * Like predict_event_tol() this must be called in the main thread. The
+ * pass prediction functions that hand work to other threads read the
+ * settings once and pass them on, so a change in the preferences dialog
+ * cannot race with them.
+ */
+static void predict_cfg_load(predict_cfg_t * cfg)
+{
+    cfg->min_el = sat_cfg_get_int(SAT_CFG_INT_PRED_MIN_EL);
+    if (cfg->min_el == 0.0)
+        cfg->min_el = 1.0;
+
+    /* sat-cfg stores the resolution in seconds */
+    cfg->tres = sat_cfg_get_int(SAT_CFG_INT_PRED_RESOLUTION) / 86400.0;
+    cfg->nument = sat_cfg_get_int(SAT_CFG_INT_PRED_NUM_ENTRIES);
+    cfg->event_tol = predict_event_tol();
+    cfg->twilight = sat_cfg_get_int(SAT_CFG_INT_PRED_TWILIGHT_THLD);
+}
 
-    /* use upper time limit */
-    if (maxdt > 0.0)
+/**
+ * \brief Find the time where the elevation crosses the horizon.
+ * \param sat Pointer to the satellite data.
+ * \param ctx The observer frame of the search.
+ * \param a Start of the bracketing interval.
+ * \param fa Elevation at a.
+ * \param b End of the bracketing interval.
+ * \param fb Elevation at b.
+ * \param tol The time tolerance in days.
+ * \param search The search, which counts the iterations.
+ * \return The time of the horizon crossing.
+ *
+ * This is Brent's method, i.e. inverse quadratic interpolation safeguarded
+ * by bisection. fa and fb must have opposite signs. The search stops when
+ * the root is known within tol or after EVENT_MAX_ITER evaluations, which
+ * is more than bisection needs to shrink a one day interval to 1 ms.
+ */
+static gdouble find_crossing(sat_t * sat, obs_frame_t * ctx, gdouble a,
+                             gdouble fa, gdouble b, gdouble fb, gdouble tol,
+                             event_search_t * search)
+{
+    gdouble         c = a;
+    gdouble         fc = fa;
+    gdouble         d = b - a;
+    gdouble         e = d;
+    gdouble         p, q, r, s;
+    gdouble         tol1, xm;
+    guint           iter;
+
+    for (iter = 0; iter < EVENT_MAX_ITER; iter++)
     {
-        /* coarse steps */
-        while ((sat->el >= 1.0) && (t <= (start + maxdt)))
+        /* keep the root between b and c */
+        if ((fb > 0.0 && fc > 0.0) || (fb < 0.0 && fc < 0.0))
         {
-            t += cos((sat->el - 1.0) * de2ra) * sqrt(sat->alt) / 25000.0;
-            predict_calc(sat, qth, t);
+            c = a;
+            fc = fa;
+            e = d = b - a;
         }
 
-        /* fine steps */
-        while ((lostime == 0.0) && (t <= (start + maxdt)))
+        /* b is the best estimate so far */
+        if (fabs(fc) < fabs(fb))
         {
-            t += sat->el * sqrt(sat->alt) / 502500.0;
-            predict_calc(sat, qth, t);
+            a = b;
+            b = c;
+            c = a;
+            fa = fb;
+            fb = fc;
+            fc = fa;
+        }
+
+        tol1 = 2.0 * DBL_EPSILON * fabs(b) + 0.5 * tol;
+        xm = 0.5 * (c - b);
+
+        if (fabs(xm) <= tol1 || fb == 0.0)
+            break;
 
-            if (fabs(sat->el) < 0.005)
+        if (fabs(e) >= tol1 && fabs(fa) > fabs(fb))
+        {
+            /* try interpolation */
+            s = fb / fa;
+            if (a == c)
+            {
+                p = 2.0 * xm * s;
+                q = 1.0 - s;
+            }
+            else
             {
-                /* Two things are true at LOS time, the elevation is a zero and
-                   sat is descending. This checks that those two are true. */
-                eltemp = sat->el;
+                q = fa / fc;
+                r = fb / fc;
+                p = s * (2.0 * xm * q * (q - r) - (b - a) * (r - 1.0));
+                q = (q - 1.0) * (r - 1.0) * (s - 1.0);
+            }
 
-                /* check elevation 1 second earlier */
-                predict_calc(sat, qth, t - 1.0 / 86400.0);
+            if (p > 0.0)
+                q = -q;
+            p = fabs(p);
 
-                if (sat->el > eltemp)
-                    lostime = t;
+            if (2.0 * p < MIN(3.0 * xm * q - fabs(tol1 * q), fabs(e * q)))
+            {
+                e = d;
+                d = p / q;
+            }
+            else
+            {
+                /* interpolation failed, bisect */
+                d = xm;
+                e = d;
             }
         }
-    }
-    /* don't use upper limit */
-    else
-    {
-        /* coarse steps */
-        while (sat->el >= 1.0)
+        else
         {
-            t += cos((sat->el - 1.0) * de2ra) * sqrt(sat->alt) / 25000.0;
-            predict_calc(sat, qth, t);
+            /* bounds decreasing too slowly, bisect */
+            d = xm;
+            e = d;
         }
 
-        /* fine steps */
-        while (lostime == 0.0)
-        {
-            t += sat->el * sqrt(sat->alt) / 502500.0;
-            predict_calc(sat, qth, t);
-
-            if (fabs(sat->el) < 0.005)
-            {
-                /* two things are true at LOS time
-                   The elevation is a zero and descending.
-                   This checks that those two are true.
-                 */
-                eltemp = sat->el;
+        a = b;
+        fa = fb;
 
-                /*check elevation 1 second earlier */
-                predict_calc(sat, qth, t - 1.0 / 86400.0);
+        if (fabs(d) > tol1)
+            b += d;
+        else
+            b += (xm > 0.0) ? tol1 : -tol1;
 
-                if (sat->el > eltemp)
-                    lostime = t;
-            }
-        }
+        event_calc(sat, ctx, b, search);
+        search->steps++;
+        fb = sat->el;
     }
 
-    return lostime;
+    return b;
 }
 
+static event_status_t los_search(sat_t * sat, qth_t * qth, gdouble start,
+                                 gdouble maxdt, event_search_t * search,
+                                 gdouble * los);
+
 /**
- * \brief Find AOS time of current pass.
- * \param sat The satellite to find AOS for.
- * \param qth The ground station.
- * \param start Start time, prefereably now.
- * \return The time of the previous AOS or 0.0 if the satellite has no AOS.
+ * \brief Search the AOS of the next pass.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param start The time where calculation should start.
+ * \param maxdt The upper time limit in days (0.0 = no limit)
+ * \param search The search, which limits the number of orbit calculations.
+ * \param aos Location to store the AOS time, 0.0 if there is none.
+ * \return EVENT_FOUND or the reason why no AOS was found.
  *
- * This function can be used to find the AOS time in the past of the
- * current pass.
+ * See find_aos() for the method. The search gives up when it has used
+ * EVENT_MAX_CALLS orbit calculations, which also covers the nested search
+ * for the LOS of a pass in progress.
  */
-gdouble find_prev_aos(sat_t * sat, qth_t * qth, gdouble start)
+static event_status_t aos_search(sat_t * sat, qth_t * qth, gdouble start,
+                                 gdouble maxdt, event_search_t * search,
+                                 gdouble * aos)
 {
-    gdouble         aostime = start;
+    obs_frame_t     ctx;
+    event_status_t  status;
+    gdouble         t = start;
+    gdouble         t0, el0;
+    guint           steps = 0;
+
+    *aos = 0.0;
 
     /* make sure current sat values are in sync with the time */
-    predict_calc(sat, qth, start);
+    predict_ctx_init(&ctx, qth, start);
+    event_calc(sat, &ctx, start, search);
 
     /* check whether satellite has aos */
     if (!has_aos(sat, qth))
+        return EVENT_NEVER;
+
+    if (sat->el > 0.0)
     {
-        return 0.0;
+        status = los_search(sat, qth, start, maxdt, search, &t);
+        if (status != EVENT_FOUND)
+            return status;
+
+        t += 0.014;             // +20 min
     }
 
-    while (sat->el >= 0.0)
+    /* update satellite data */
+    event_calc(sat, &ctx, t, search);
+    t0 = t;
+    el0 = sat->el;
+
+    /* bracket the AOS */
+    while (sat->el < 0.0)
     {
-        aostime -= 0.0005;      // 0.75 min
-        predict_calc(sat, qth, aostime);
+        if ((maxdt > 0.0) && (t > (start + maxdt)))
+            return EVENT_TIMEOUT;
+
+        if (search->calls >= EVENT_MAX_CALLS)
+            return EVENT_BUDGET;
+
+        steps++;
+        search->steps++;
+        t0 = t;
+        el0 = sat->el;
+        t += MAX(0.00035 * (2.0 - sat->el * ((sat->alt / 8400.0) + 0.46)),
+                 time_to_footprint(sat, &ctx));
+        event_calc(sat, &ctx, t, search);
     }
 
-    return aostime;
+    /* the orbit model fails for decayed satellites */
+    if (isnan(sat->el))
+        return EVENT_DECAYED;
+
+    if (steps > 0)
+        t = find_crossing(sat, &ctx, t0, el0, t, sat->el, search->tol,
+                          search);
+
+    if ((maxdt > 0.0) && (t > (start + maxdt)))
+        return EVENT_TIMEOUT;
+
+    *aos = t;
+
+    return EVENT_FOUND;
 }
 
 /**
- * \brief Predict the next pass.
+ * \brief Search the LOS of the next pass.
  * \param sat Pointer to the satellite data.
- * \param qth Pointer to the observer data.
- * \param maxdt The maximum number of days to look ahead.
- * \return Pointer newly allocated pass_t structure that should be freed
- *         with free_pass when no longer needed, or NULL if no pass can be
- *         found.
+ * \param qth Pointer to the QTH data.
+ * \param start The time where calculation should start.
+ * \param maxdt The upper time limit in days (0.0 = no limit)
+ * \param search The search, which limits the number of orbit calculations.
+ * \param los Location to store the LOS time, 0.0 if there is none.
+ * \return EVENT_FOUND or the reason why no LOS was found.
  *
- * This function simply wraps the get_pass function using the current time
+ * See find_los() for the method and aos_search() for the limits.
+ */
+static event_status_t los_search(sat_t * sat, qth_t * qth, gdouble start,
+                                 gdouble maxdt, event_search_t * search,
+                                 gdouble * los)
+{
+    obs_frame_t     ctx;
+    event_status_t  status;
+    gdouble         t = start;
+    gdouble         t0, el0;
+    gdouble         tol = search->tol;
+    guint           steps = 0;
+
+    *los = 0.0;
+
+    predict_ctx_init(&ctx, qth, start);
+    event_calc(sat, &ctx, start, search);
+
+    /* check whether satellite has aos */
+    if (!has_aos(sat, qth))
+        return EVENT_NEVER;
+
+    /* the AOS is only known within tol, so step a little bit into the pass;
+       start may be such an AOS on the wrong side of the horizon, and the
+       bracketing in aos_search() would then step over a short pass */
+    if (sat->el < 0.0)
+    {
+        event_calc(sat, &ctx, start + 2.0 * tol, search);
+        if (sat->el >= 0.0)
+        {
+            t = start + 2.0 * tol;
+        }
+        else
+        {
+            status = aos_search(sat, qth, start, maxdt, search, &t);
+            if (status != EVENT_FOUND)
+                return status;
+
+            t += 2.0 * tol;
+        }
+    }
+
+    /* update satellite data */
+    event_calc(sat, &ctx, t, search);
+    t0 = t;
+    el0 = sat->el;
+
+    /* bracket the LOS */
+    while (sat->el >= 0.0)
+    {
+        if ((maxdt > 0.0) && (t > (start + maxdt)))
+            return EVENT_TIMEOUT;
+
+        if (search->calls >= EVENT_MAX_CALLS)
+            return EVENT_BUDGET;
+
+        steps++;
+        search->steps++;
+        t0 = t;
+        el0 = sat->el;
+        t += cos((sat->el - 1.0) * de2ra) * sqrt(sat->alt) / 25000.0;
+        event_calc(sat, &ctx, t, search);
+    }
+
+    /* decayed satellite */
+    if (isnan(sat->el))
+        return EVENT_DECAYED;
+
+    /* no steps means that the pass is shorter than the tolerance */
+    if (steps > 0)
+        t = find_crossing(sat, &ctx, t0, el0, t, sat->el, tol, search);
+
+    *los = t;
+
+    return EVENT_FOUND;
+}
+
+/**
+ * \brief Find the AOS time of the next pass.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param start The time where calculation should start.
+ * \param maxdt The upper time limit in days (0.0 = no limit)
+ * \param tol The time tolerance in days, see predict_event_tol().
+ * \param aos Location to store the AOS time, 0.0 if there is none.
+ * \return EVENT_FOUND or the reason why no AOS was found.
+ *
+ * Same as find_aos() but tells why the search failed.
+ */
+event_status_t find_aos_status(sat_t * sat, qth_t * qth, gdouble start,
+                               gdouble maxdt, gdouble tol, gdouble * aos)
+{
+    event_search_t  search = { 0, 0, tol };
+    event_status_t  status;
+    gint64          t0 = g_get_monotonic_time();
+
+    status = aos_search(sat, qth, start, maxdt, &search, aos);
+    event_done(sat, &search, status, g_get_monotonic_time() - t0);
+
+    return status;
+}
+
+/**
+ * \brief Find the LOS time of the next pass.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param start The time where calculation should start.
+ * \param maxdt The upper time limit in days (0.0 = no limit)
+ * \param tol The time tolerance in days, see predict_event_tol().
+ * \param los Location to store the LOS time, 0.0 if there is none.
+ * \return EVENT_FOUND or the reason why no LOS was found.
+ *
+ * Same as find_los() but tells why the search failed.
+ */
+event_status_t find_los_status(sat_t * sat, qth_t * qth, gdouble start,
+                               gdouble maxdt, gdouble tol, gdouble * los)
+{
+    event_search_t  search = { 0, 0, tol };
+    event_status_t  status;
+    gint64          t0 = g_get_monotonic_time();
+
+    status = los_search(sat, qth, start, maxdt, &search, los);
+    event_done(sat, &search, status, g_get_monotonic_time() - t0);
+
+    return status;
+}
+
+/**
+ * \brief Find the AOS time of the next pass.
+ * \author Alexandru Csete, OZ9AEC
+ * \author John A. Magliacane, KD2BD
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param start The time where calculation should start.
+ * \param maxdt The upper time limit in days (0.0 = no limit)
+ * \param tol The time tolerance in days, see predict_event_tol().
+ * \return The time of the next AOS or 0.0 if the satellite has no AOS.
+ *
+ * This function finds the time of AOS for the first coming pass taking place
+ * no earlier that start.
+ * If the satellite is currently within range, the function first calls
+ * find_los to get the next LOS time. Then the calculations are done using
+ * the new start time.
+ * The AOS is first bracketed using time steps that get shorter as the
+ * satellite approaches the horizon, then located with find_crossing().
+ * Where time_to_footprint() shows that the satellite can not rise for a
+ * while, the bracketing jumps ahead by that time instead.
+ * The whole search, including the LOS of a pass in progress, is limited to
+ * EVENT_MAX_CALLS orbit calculations, even when there is no time limit.
+ */
+gdouble find_aos(sat_t * sat, qth_t * qth, gdouble start, gdouble maxdt,
+                 gdouble tol)
+{
+    gdouble         aos;
+
+    find_aos_status(sat, qth, start, maxdt, tol, &aos);
+
+    return aos;
+}
+
+/**
+ * \brief Find the LOS time of the next pass.
+ * \author Alexandru Csete, OZ9AEC
+ * \author John A. Magliacane, KD2BD
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param start The time where calculation should start.
+ * \param maxdt The upper time limit in days (0.0 = no limit)
+ * \param tol The time tolerance in days, see predict_event_tol().
+ * \return The time of the next LOS or 0.0 if the satellite has no LOS.
+ *
+ * This function finds the time of LOS for the first coming pass taking place
+ * no earlier that start.
+ * If the satellite is currently out of range, the function first calls
+ * find_aos to get the next AOS time. Then the calculations are done using
+ * the new start time.
+ * Like find_aos, the LOS is bracketed and then located with find_crossing().
+ * The bracket starts above and ends below the horizon, so the satellite is
+ * always descending at the LOS time that is found.
+ */
+gdouble find_los(sat_t * sat, qth_t * qth, gdouble start, gdouble maxdt,
+                 gdouble tol)
+{
+    gdouble         los;
+
+    find_los_status(sat, qth, start, maxdt, tol, &los);
+
+    return los;
+}
+
+/**
+ * \brief Get the cost of the AOS/LOS calculations.
+ * \param events Location to store the number of AOS/LOS searches.
+ * \param calls Location to store the number of predict_calc() calls used.
+ *
+ * The counters are shared by all satellites and accumulate from the start
+ * of the program. Searches that end because the satellite has no AOS are
+ * not counted.
+ */
+void predict_event_stats(guint * events, guint * calls)
+{
+    *events = (guint) g_atomic_int_get(&event_stat_events);
+    *calls = (guint) g_atomic_int_get(&event_stat_calls);
+}
+
+static void event_sat_stats_append(gpointer key, gpointer value,
+                                   gpointer data)
+{
+    event_sat_stats_t stats = *((event_sat_stats_t *) value);
+
+    (void)key;
+
+    stats.name = g_strdup(stats.name);
+    g_array_append_val((GArray *) data, stats);
+}
+
+static void event_sat_stats_clear(gpointer stats)
+{
+    g_free(((event_sat_stats_t *) stats)->name);
+}
+
+/**
+ * \brief Get the cost of the AOS/LOS calculations for each satellite.
+ * \return Array of event_sat_stats_t, which should be freed with
+ *         g_array_unref().
+ *
+ * The array holds a copy of the counters of every satellite that has been
+ * searched since the start of the program or the last call to
+ * predict_event_sat_stats_clear().
+ */
+GArray         *predict_event_sat_stats(void)
+{
+    GArray         *stats;
+
+    stats = g_array_new(FALSE, FALSE, sizeof(event_sat_stats_t));
+    g_array_set_clear_func(stats, event_sat_stats_clear);
+
+    G_LOCK(event_sat_stats);
+    if (event_sat_stats != NULL)
+        g_hash_table_foreach(event_sat_stats, event_sat_stats_append, stats);
+    G_UNLOCK(event_sat_stats);
+
+    return stats;
+}
+
+/** \brief Reset the per satellite AOS/LOS statistics. */
+void predict_event_sat_stats_clear(void)
+{
+    G_LOCK(event_sat_stats);
+    if (event_sat_stats != NULL)
+        g_hash_table_remove_all(event_sat_stats);
+    G_UNLOCK(event_sat_stats);
+}
+
+/**
+ * \brief Find AOS time of current pass.
+ * \param sat The satellite to find AOS for.
+ * \param qth The ground station.
+ * \param start Start time, prefereably now.
+ * \return The time of the previous AOS or 0.0 if the satellite has no AOS.
+ *
+ * This function can be used to find the AOS time in the past of the
+ * current pass. Like find_aos(), it gives up after EVENT_MAX_CALLS orbit
+ * calculations, e.g. for a satellite that never sets.
+ */
+gdouble find_prev_aos(sat_t * sat, qth_t * qth, gdouble start)
+{
+    obs_frame_t     ctx;
+    gdouble         aostime = start;
+    guint           calls = 0;
+
+    /* make sure current sat values are in sync with the time */
+    predict_ctx_init(&ctx, qth, start);
+    predict_calc_ctx(sat, &ctx);
+
+    /* check whether satellite has aos */
+    if (!has_aos(sat, qth))
+    {
+        return 0.0;
+    }
+
+    while (sat->el >= 0.0)
+    {
+        if (calls++ == EVENT_MAX_CALLS)
+            return 0.0;
+
+        aostime -= 0.0005;      // 0.75 min
+        predict_ctx_set_time(&ctx, aostime);
+        predict_calc_ctx(sat, &ctx);
+    }
+
+    return aostime;
+}
+
+/**
+ * \brief Predict the next pass.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the observer data.
+ * \param maxdt The maximum number of days to look ahead.
+ * \return Pointer newly allocated pass_t structure that should be freed
+ *         with free_pass when no longer needed, or NULL if no pass can be
+ *         found.
+ *
+ * This function simply wraps the get_pass function using the current time
  * as parameter.
  *
  * \note the data in sat will be corrupt (future) and must be refreshed
@@ -409,15 +1172,33 @@ GSList         *get_next_passes(sat_t * sat, qth_t * qth, gdouble maxdt,
  * 
  *   This function assumes that you want a pass that achieves the 
  *   minimum elevation of is configured for.
+ *
+ *   Passes are shared with other callers through the pass cache.
  */
 pass_t *get_pass(sat_t * sat_in, qth_t * qth, gdouble start, gdouble maxdt)
 {
-    int      min_ele = sat_cfg_get_int(SAT_CFG_INT_PRED_MIN_EL);
+    predict_cfg_t   cfg;
 
-    if (min_ele == 0)
-        min_ele = 1;
+    predict_cfg_load(&cfg);
 
-    return get_pass_engine(sat_in, qth, start, maxdt, min_ele);
+    return get_pass_cfg(sat_in, qth, start, maxdt, &cfg);
+}
+
+/**
+ * \brief Predict first pass after a certain time with the given settings.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the location data.
+ * \param start Starting time.
+ * \param maxdt The maximum number of days to look ahead (0 for no limit).
+ * \param cfg The prediction settings.
+ * \return Same as get_pass().
+ *
+ * This is get_pass() for the worker threads, which must not read sat-cfg.
+ */
+static pass_t  *get_pass_cfg(sat_t * sat, qth_t * qth, gdouble start,
+                             gdouble maxdt, const predict_cfg_t * cfg)
+{
+    return pass_cache_get(sat, qth, start, maxdt, cfg->min_el, cfg);
 }
 
 /**
@@ -434,7 +1215,11 @@ pass_t *get_pass(sat_t * sat_in, qth_t * qth, gdouble start, gdouble maxdt)
 pass_t         *get_pass_no_min_el(sat_t * sat_in, qth_t * qth, gdouble start,
                                    gdouble maxdt)
 {
-    return get_pass_engine(sat_in, qth, start, maxdt, 0.0);
+    predict_cfg_t   cfg;
+
+    predict_cfg_load(&cfg);
+
+    return pass_cache_get(sat_in, qth, start, maxdt, 0.0, &cfg);
 }
 
 /**
@@ -443,6 +1228,8 @@ pass_t         *get_pass_no_min_el(sat_t * sat_in, qth_t * qth, gdouble start,
  * \param qth Pointer to the location data.
  * \param start Starting time.
  * \param maxdt The maximum number of days to look ahead (0 for no limit).
+ * \param min_el The minimum elevation of the pass.
+ * \param cfg The prediction settings.
  * \return Pointer to a newly allocated pass_t structure or NULL if
  *         there was an error.
  *
@@ -455,12 +1242,12 @@ pass_t         *get_pass_no_min_el(sat_t * sat_in, qth_t * qth, gdouble start,
  *       by the caller, if the caller will need it later on (eg. if the caller
  *       is GtkSatList).
  *
- * \note Prepending to a singly linked list is much faster than appending.
- *       Therefore, the elements are prepended whereafter the GSList is
- *       reversed
+ * \note The details are calculated at once by predict_calc_series() and
+ *       stored in one array.
  */
 static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
-                                gdouble maxdt, gdouble min_el)
+                                gdouble maxdt, gdouble min_el,
+                                const predict_cfg_t * cfg)
 {
     gdouble         aos = 0.0;  /* time of AOS */
     gdouble         tca = 0.0;  /* time of TCA */
@@ -476,24 +1263,44 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
     gboolean        done = FALSE;
     guint           iter = 0;   /* number of iterations */
     sat_t          *sat, sat_working;
-
-    /* FIXME: watchdog */
+    GArray         *points;     /* visibility input for each detail */
+    sat_vis_point_t point;
+    guint           i, num;
 
     /*copy sat_in to a working structure */
     sat = memcpy(&sat_working, sat_in, sizeof(sat_t));
 
-    /* get time resolution; sat-cfg stores it in seconds */
-    tres = sat_cfg_get_int(SAT_CFG_INT_PRED_RESOLUTION) / 86400.0;
+    /* get time resolution */
+    tres = cfg->tres;
+
+    points = g_array_new(FALSE, FALSE, sizeof(sat_vis_point_t));
 
     /* loop until we find a pass with elevation > SAT_CFG_INT_PRED_MIN_EL
-       or we run out of time
-       FIXME: we should have a safety break
+       or we run out of time; without a time limit the number of passes
+       and the cost of each search are limited instead
      */
     while (!done)
     {
+        if (iter == PASS_MAX_SKIPPED)
+        {
+            sat_log_log(SAT_LOG_LEVEL_WARN,
+                        _("%s: No pass of %s above %.0f degrees in %d passes"),
+                        __func__, sat->nickname, min_el, PASS_MAX_SKIPPED);
+            break;
+        }
+
         /* Find los of next pass or of current pass */
-        los = find_los(sat, qth, t0, maxdt);    // See if a pass is ongoing
-        aos = find_aos(sat, qth, t0, start + maxdt - t0);
+        if ((find_los_status(sat, qth, t0, maxdt, cfg->event_tol, &los) ==
+             EVENT_BUDGET) ||
+            (find_aos_status(sat, qth, t0, start + maxdt - t0,
+                             cfg->event_tol, &aos) == EVENT_BUDGET))
+        {
+            sat_log_log(SAT_LOG_LEVEL_WARN,
+                        _("%s: AOS/LOS search for %s exceeded %d orbit "
+                          "calculations"), __func__, sat->nickname,
+                        EVENT_MAX_CALLS);
+            break;
+        }
 
         if (aos > los)
             // los is from an currently happening pass, find previous aos
@@ -516,7 +1323,7 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
             dt = los - aos;
 
             /* get time step, which will give us the max number of entries */
-            step = dt / sat_cfg_get_int(SAT_CFG_INT_PRED_NUM_ENTRIES);
+            step = dt / cfg->nument;
 
             /* but if this is smaller than the required resolution
                we go with the resolution
@@ -539,178 +1346,660 @@ static pass_t  *get_pass_engine(sat_t * sat_in, qth_t * qth, gdouble start,
             pass->vis[3] = 0;
             pass->satname = g_strdup(sat->nickname);
             pass->details = NULL;
+            pass->num_details = 0;
             /*copy qth data into the pass for later comparisons */
             qth_small_save(qth, &(pass->qth_comp));
 
-            /* iterate over each time step */
-            for (t = pass->aos; t <= pass->los; t += step)
+            /* calculate all time steps at once */
+            for (t = pass->aos, num = 0; t <= pass->los; t += step)
+                num++;
+            pass->num_details = num;
+            pass->details = g_new(pass_detail_t, num);
+            predict_calc_series(sat, qth, pass->aos, step, num,
+                                pass->details);
+
+            g_array_set_size(points, 0);
+            for (i = 0; i < pass->num_details; i++)
             {
+                detail = &pass->details[i];
 
-                /* calculate satellite data */
-                predict_calc(sat, qth, t);
+                /* in the first iter we want to store
+                   pass->aos_az
+                 */
+                if (i == 0)
+                {
+                    pass->aos_az = detail->az;
+                    pass->orbit = detail->orbit;
+                }
+
+                /* the visibility is calculated for all details at once */
+                point.time = detail->time;
+                point.pos = detail->pos;
+                point.el = detail->el;
+                g_array_append_val(points, point);
+
+                /* store elevation if greater than the
+                   previously stored one
+                 */
+                if (detail->el > max_el)
+                {
+                    max_el = detail->el;
+                    tca = detail->time;
+                    pass->maxel_az = detail->az;
+                }
+            }
+
+            get_sat_vis_batch(qth, (sat_vis_point_t *) points->data,
+                              points->len, cfg->twilight);
+            for (i = 0; i < pass->num_details; i++)
+            {
+                detail = &pass->details[i];
+                detail->vis = g_array_index(points, sat_vis_point_t, i).vis;
+
+                /* also store visibility "bit" */
+                switch (detail->vis)
+                {
+                case SAT_VIS_VISIBLE:
+                    pass->vis[0] = 'V';
+                    break;
+                case SAT_VIS_DAYLIGHT:
+                    pass->vis[1] = 'D';
+                    break;
+                case SAT_VIS_ECLIPSED:
+                    pass->vis[2] = 'E';
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            /* calculate satellite data */
+            predict_calc(sat, qth, pass->los);
+            /* store los_az, max_el and tca */
+            pass->los_az = sat->az;
+            pass->max_el = max_el;
+            pass->tca = tca;
+
+            /* check whether this pass is good */
+            if (max_el >= min_el)
+            {
+                done = TRUE;
+            }
+            else
+            {
+                done = FALSE;
+                t0 = los + 0.014;       // +20 min
+                free_pass(pass);
+                pass = NULL;
+            }
+
+            iter++;
+        }
+    }
+
+    g_array_free(points, TRUE);
+
+    return pass;
+}
+
+/**
+ * Predict passes after a certain time.
+ *
+ * This function calculates num upcoming passes with AOS no earlier
+ * than t = start and not later that t = (start+maxdt). The function will
+ * repeatedly call get_pass until the number of predicted passes is equal to
+ * num, the time has reached limit or the get_pass function returns NULL.
+ *
+ * \note For no time limit use maxdt = 0.0
+ *
+ * \note the data in sat will be corrupt (future) and must be refreshed
+ *       by the caller, if the caller will need it later on (eg. if the caller
+ *       is GtkSatList).
+ *
+ * \note Prepending to a singly linked list is much faster than appending.
+ *       Therefore, the elements are prepended whereafter the GSList is
+ *       reversed
+ */
+GSList         *get_passes(sat_t * sat, qth_t * qth, gdouble start,
+                           gdouble maxdt, guint num)
+{
+    predict_cfg_t   cfg;
+
+    predict_cfg_load(&cfg);
+
+    return get_passes_cfg(sat, qth, start, maxdt, num, &cfg);
+}
+
+/**
+ * \brief Predict passes with the given settings.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the observer data.
+ * \param start Starting time.
+ * \param maxdt The maximum number of days to look ahead (0 for no limit).
+ * \param num The number of passes to predict.
+ * \param cfg The prediction settings.
+ * \return Same as get_passes().
+ *
+ * This is get_passes() for the worker threads, which must not read sat-cfg.
+ */
+static GSList  *get_passes_cfg(sat_t * sat, qth_t * qth, gdouble start,
+                               gdouble maxdt, guint num,
+                               const predict_cfg_t * cfg)
+{
+    GSList         *passes = NULL;
+    pass_t         *pass = NULL;
+    guint           i;
+    gdouble         t;
+
+    /* if no number has been specified
+       set it to something big */
+    if (num == 0)
+        num = 100;
+
+    t = start;
+
+    for (i = 0; i < num; i++)
+    {
+        pass = get_pass_cfg(sat, qth, t, maxdt, cfg);
+
+        if (pass != NULL)
+        {
+            passes = g_slist_prepend(passes, pass);
+            t = pass->los + 0.014;      // +20 min
+
+            /* if maxdt > 0.0 check whether we have reached t = start+maxdt
+               if yes finish predictions
+             */
+            if ((maxdt > 0.0) && (t >= (start + maxdt)))
+            {
+                i = num;
+            }
+        }
+        else
+        {
+            /* we can't get any more passes */
+            i = num;
+        }
+
+    }
+
+    if (passes != NULL)
+        passes = g_slist_reverse(passes);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Found %d passes for %s in time window [%f;%f]"),
+                __func__, g_slist_length(passes), sat->nickname, start,
+                start + maxdt);
+
+    return passes;
+}
+
+/** State of a get_passes_async() task. */
+typedef struct {
+    sat_t          *sat;        /* private copy of the satellite */
+    qth_t           qth;        /* copy of the QTH position */
+    predict_cfg_t   cfg;        /* settings read when the task was started */
+    gdouble         start;
+    gdouble         maxdt;
+    guint           num;
+    pass_found_cb   found;
+    gpointer        data;
+} passes_job_t;
+
+/** A pass on its way from the worker to the found callback. */
+typedef struct {
+    GTask          *task;
+    pass_t         *pass;
+    gdouble         progress;
+} passes_found_t;
+
+static void passes_job_free(gpointer data)
+{
+    passes_job_t   *job = data;
+
+    gtk_sat_data_free_sat(job->sat);
+    g_free(job);
+}
+
+/**
+ * \brief Deliver a pass found by get_passes_thread().
+ * \param data The passes_found_t.
+ *
+ * This runs in the main context of the task, so the found callback can
+ * update the GUI. Passes arriving after the task was cancelled are
+ * dropped.
+ */
+static gboolean passes_found_idle(gpointer data)
+{
+    passes_found_t *found = data;
+    passes_job_t   *job = g_task_get_task_data(found->task);
+
+    if (g_cancellable_is_cancelled(g_task_get_cancellable(found->task)))
+        free_pass(found->pass);
+    else
+        job->found(found->pass, found->progress, job->data);
+
+    g_object_unref(found->task);
+    g_free(found);
+
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * \brief Worker thread of get_passes_async().
+ *
+ * Same loop as get_passes(), except that each pass is handed to the main
+ * context as soon as it is found, and that the cancellable is checked
+ * between passes.
+ */
+static void get_passes_thread(GTask * task, gpointer source, gpointer data,
+                              GCancellable * cancellable)
+{
+    passes_job_t   *job = data;
+    passes_found_t *found;
+    pass_t         *pass;
+    gdouble         t = job->start;
+    gdouble         progress;
+    guint           i;
+
+    (void)source;
+    (void)cancellable;
+
+    for (i = 0; i < job->num; i++)
+    {
+        if (g_task_return_error_if_cancelled(task))
+            return;
+
+        pass = get_pass_cfg(job->sat, &job->qth, t, job->maxdt, &job->cfg);
+        if (pass == NULL)
+            break;
+
+        t = pass->los + 0.014;  // +20 min
+
+        progress = (gdouble) (i + 1) / job->num;
+        if (job->maxdt > 0.0)
+            progress = MAX(progress, (t - job->start) / job->maxdt);
+
+        found = g_new(passes_found_t, 1);
+        found->task = g_object_ref(task);
+        found->pass = pass;
+        found->progress = MIN(progress, 1.0);
+        g_main_context_invoke(g_task_get_context(task), passes_found_idle,
+                              found);
+
+        if ((job->maxdt > 0.0) && (t >= (job->start + job->maxdt)))
+        {
+            i++;
+            break;
+        }
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Found %d passes for %s in time window [%f;%f]"),
+                __func__, i, job->sat->nickname, job->start,
+                job->start + job->maxdt);
+
+    g_task_return_int(task, i);
+}
+
+/**
+ * \brief Predict passes in a worker thread.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the observer data.
+ * \param start Starting time.
+ * \param maxdt The maximum number of days to look ahead (0 for no limit).
+ * \param num The number of passes to predict (0 for 100).
+ * \param cancellable Optional GCancellable to stop the prediction.
+ * \param found Function called with each pass as soon as it is found.
+ * \param callback Function called when the prediction has finished.
+ * \param data User data for found and callback.
+ *
+ * This is the asynchronous version of get_passes(), for callers in the GUI
+ * that must not block while a long look-ahead or a deep-space satellite is
+ * calculated. The satellite and the QTH position are copied, so they may
+ * change or be freed while the prediction is running. The prediction
+ * settings are read when the prediction is started.
+ *
+ * found and callback are called in the thread-default main context of the
+ * caller. All passes are delivered before callback, which should call
+ * get_passes_finish(). After cancellation, no more passes are delivered;
+ * the pass being calculated in the worker at that time is finished first,
+ * and is then discarded.
+ */
+void get_passes_async(sat_t * sat, qth_t * qth, gdouble start, gdouble maxdt,
+                      guint num, GCancellable * cancellable,
+                      pass_found_cb found, GAsyncReadyCallback callback,
+                      gpointer data)
+{
+    GTask          *task;
+    passes_job_t   *job;
+
+    job = g_new0(passes_job_t, 1);
+    job->qth.lat = qth->lat;
+    job->qth.lon = qth->lon;
+    job->qth.alt = qth->alt;
+    job->sat = gtk_sat_data_dup_sat(sat);
+    predict_cfg_load(&job->cfg);
+    job->start = start;
+    job->maxdt = maxdt;
+    job->num = (num == 0) ? 100 : num;
+    job->found = found;
+    job->data = data;
+
+    task = g_task_new(NULL, cancellable, callback, data);
+    g_task_set_source_tag(task, get_passes_async);
+    g_task_set_task_data(task, job, passes_job_free);
+    g_task_run_in_thread(task, get_passes_thread);
+    g_object_unref(task);
+}
+
+/**
+ * \brief Finish a prediction started with get_passes_async().
+ * \param result The GAsyncResult given to the callback.
+ * \param error Location to store the error, or NULL.
+ * \return The number of passes found, or -1 if the prediction was
+ *         cancelled.
+ */
+gssize get_passes_finish(GAsyncResult * result, GError ** error)
+{
+    g_return_val_if_fail(g_task_is_valid(result, NULL), -1);
+
+    return g_task_propagate_int(G_TASK(result), error);
+}
+
+/** Shared state of the workers of get_pass_timeline(). */
+typedef struct {
+    sat_t         **sats;
+    qth_t          *qth;
+    gdouble         start;
+    gdouble         maxdt;
+    guint           num;
+    predict_cfg_t   cfg;
+    GCancellable   *cancellable;        /* NULL unless asynchronous */
+    GSList        **passes;     /* passes of each satellite */
+} timeline_job_t;
+
+/**
+ * \brief Thread pool function of get_pass_timeline().
+ * \param data The index of the satellite + 1.
+ * \param user_data The timeline_job_t.
+ *
+ * Each satellite only writes its own slot in job->passes. Satellites still
+ * waiting when the job is cancelled are skipped.
+ */
+static void timeline_worker(gpointer data, gpointer user_data)
+{
+    timeline_job_t *job = user_data;
+    guint           i = GPOINTER_TO_UINT(data) - 1;
+
+    if (g_cancellable_is_cancelled(job->cancellable))
+        return;
+
+    job->passes[i] = get_passes_cfg(job->sats[i], job->qth, job->start,
+                                    job->maxdt, job->num, &job->cfg);
+}
+
+/** Sort timeline passes by AOS, then by satellite. */
+static gint timeline_compare(gconstpointer a, gconstpointer b)
+{
+    const timeline_pass_t *pa = a;
+    const timeline_pass_t *pb = b;
+
+    if (pa->pass->aos < pb->pass->aos)
+        return -1;
+    if (pa->pass->aos > pb->pass->aos)
+        return 1;
+
+    return (pa->index > pb->index) - (pa->index < pb->index);
+}
+
+/**
+ * \brief Calculate a timeline with a thread pool.
+ * \param job The prepared job; passes is allocated here.
+ * \param num_sats The number of satellites in job->sats.
+ * \param owners The satellites to store in the timeline, in the same order
+ *        as job->sats.
+ * \return The timeline.
+ */
+static pass_timeline_t *timeline_calc(timeline_job_t * job, guint num_sats,
+                                      sat_t ** owners)
+{
+    pass_timeline_t *timeline;
+    GThreadPool    *pool = NULL;
+    GError         *error = NULL;
+    GSList         *node;
+    guint           nthreads;
+    guint           i, n;
+
+    job->passes = g_new0(GSList *, num_sats);
+
+    nthreads = MIN(g_get_num_processors(), num_sats);
+    if (nthreads > 1)
+    {
+        pool = g_thread_pool_new(timeline_worker, job, nthreads, FALSE,
+                                 &error);
+        if (pool == NULL)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Could not create thread pool (%s)"),
+                        __func__, error ? error->message : "?");
+            g_clear_error(&error);
+        }
+    }
+
+    if (pool != NULL)
+    {
+        for (i = 0; i < num_sats; i++)
+            g_thread_pool_push(pool, GUINT_TO_POINTER(i + 1), NULL);
+
+        /* wait for all satellites to finish */
+        g_thread_pool_free(pool, FALSE, TRUE);
+    }
+    else
+    {
+        for (i = 0; i < num_sats; i++)
+            timeline_worker(GUINT_TO_POINTER(i + 1), job);
+    }
+
+    /* merge the passes of all satellites into one array */
+    timeline = g_new(pass_timeline_t, 1);
+    timeline->num_passes = 0;
+    for (i = 0; i < num_sats; i++)
+        timeline->num_passes += g_slist_length(job->passes[i]);
+
+    timeline->passes = g_new(timeline_pass_t, timeline->num_passes);
+    n = 0;
+    for (i = 0; i < num_sats; i++)
+    {
+        for (node = job->passes[i]; node != NULL; node = node->next)
+        {
+            timeline->passes[n].sat = owners[i];
+            timeline->passes[n].index = i;
+            timeline->passes[n].pass = PASS(node->data);
+            n++;
+        }
+        g_slist_free(job->passes[i]);
+    }
+    g_free(job->passes);
+    job->passes = NULL;
+
+    if (timeline->num_passes > 1)
+        qsort(timeline->passes, timeline->num_passes,
+              sizeof(timeline_pass_t), timeline_compare);
+
+    return timeline;
+}
+
+/**
+ * \brief Predict the passes of several satellites.
+ * \param sats Array of satellites.
+ * \param num_sats The number of satellites in sats.
+ * \param qth Pointer to the QTH data.
+ * \param start Starting time.
+ * \param maxdt The time window in days (0 for no limit).
+ * \param num The maximum number of passes per satellite.
+ * \return A newly allocated timeline, which must be freed with
+ *         free_pass_timeline().
+ *
+ * Gives the same passes as calling get_passes() for each satellite, but the
+ * satellites are calculated in parallel by a thread pool with one thread
+ * per processor, and the passes are returned in one array sorted by AOS.
+ * The function returns when all satellites are done. The satellites are not
+ * modified.
+ */
+pass_timeline_t *get_pass_timeline(sat_t ** sats, guint num_sats,
+                                   qth_t * qth, gdouble start, gdouble maxdt,
+                                   guint num)
+{
+    timeline_job_t  job;
 
-                /* in the first iter we want to store
-                   pass->aos_az
-                 */
-                if (t == pass->aos)
-                {
-                    pass->aos_az = sat->az;
-                    pass->orbit = sat->orbit;
-                }
+    job.sats = sats;
+    job.qth = qth;
+    job.start = start;
+    job.maxdt = maxdt;
+    job.num = num;
+    predict_cfg_load(&job.cfg);
+    job.cancellable = NULL;
 
-                /* append details to sat->details */
-                detail = g_new(pass_detail_t, 1);
-                detail->time = t;
-                detail->pos.x = sat->pos.x;
-                detail->pos.y = sat->pos.y;
-                detail->pos.z = sat->pos.z;
-                detail->pos.w = sat->pos.w;
-                detail->vel.x = sat->vel.x;
-                detail->vel.y = sat->vel.y;
-                detail->vel.z = sat->vel.z;
-                detail->vel.w = sat->vel.w;
-                detail->velo = sat->velo;
-                detail->az = sat->az;
-                detail->el = sat->el;
-                detail->range = sat->range;
-                detail->range_rate = sat->range_rate;
-                detail->lat = sat->ssplat;
-                detail->lon = sat->ssplon;
-                detail->alt = sat->alt;
-                detail->ma = sat->ma;
-                detail->phase = sat->phase;
-                detail->footprint = sat->footprint;
-                detail->orbit = sat->orbit;
-                detail->vis = get_sat_vis(sat, qth, t);
+    return timeline_calc(&job, num_sats, sats);
+}
 
-                /* also store visibility "bit" */
-                switch (detail->vis)
-                {
-                case SAT_VIS_VISIBLE:
-                    pass->vis[0] = 'V';
-                    break;
-                case SAT_VIS_DAYLIGHT:
-                    pass->vis[1] = 'D';
-                    break;
-                case SAT_VIS_ECLIPSED:
-                    pass->vis[2] = 'E';
-                    break;
-                default:
-                    break;
-                }
+/** State of a get_pass_timeline_async() task. */
+typedef struct {
+    timeline_job_t  job;        /* job.sats are private copies */
+    sat_t         **owners;     /* the satellites given by the caller */
+    guint           num_sats;
+    qth_t           qth;        /* copy of the QTH position */
+} timeline_task_t;
 
-                pass->details = g_slist_prepend(pass->details, detail);
+static void timeline_task_free(gpointer data)
+{
+    timeline_task_t *tt = data;
+    guint           i;
 
-                /* store elevation if greater than the
-                   previously stored one
-                 */
-                if (sat->el > max_el)
-                {
-                    max_el = sat->el;
-                    tca = t;
-                    pass->maxel_az = sat->az;
-                }
+    for (i = 0; i < tt->num_sats; i++)
+        gtk_sat_data_free_sat(tt->job.sats[i]);
 
-                /*     g_print ("TIME: %f\tAZ: %f\tEL: %f (MAX: %f)\n", */
-                /*           t, sat->az, sat->el, max_el); */
-            }
+    g_free(tt->job.sats);
+    g_free(tt->owners);
+    g_free(tt);
+}
 
-            pass->details = g_slist_reverse(pass->details);
+/** \brief Worker thread of get_pass_timeline_async(). */
+static void get_pass_timeline_thread(GTask * task, gpointer source,
+                                     gpointer data,
+                                     GCancellable * cancellable)
+{
+    timeline_task_t *tt = data;
+    pass_timeline_t *timeline;
 
-            /* calculate satellite data */
-            predict_calc(sat, qth, pass->los);
-            /* store los_az, max_el and tca */
-            pass->los_az = sat->az;
-            pass->max_el = max_el;
-            pass->tca = tca;
+    (void)source;
 
-            /* check whether this pass is good */
-            if (max_el >= min_el)
-            {
-                done = TRUE;
-            }
-            else
-            {
-                done = FALSE;
-                t0 = los + 0.014;       // +20 min
-                free_pass(pass);
-                pass = NULL;
-            }
+    tt->job.cancellable = cancellable;
+    timeline = timeline_calc(&tt->job, tt->num_sats, tt->owners);
 
-            iter++;
-        }
+    /* the timeline is incomplete if satellites were skipped */
+    if (g_task_return_error_if_cancelled(task))
+    {
+        free_pass_timeline(timeline);
+        return;
     }
 
-    return pass;
+    g_task_return_pointer(task, timeline,
+                          (GDestroyNotify) free_pass_timeline);
 }
 
 /**
- * Predict passes after a certain time.
- *
- * This function calculates num upcoming passes with AOS no earlier
- * than t = start and not later that t = (start+maxdt). The function will
- * repeatedly call get_pass until the number of predicted passes is equal to
- * num, the time has reached limit or the get_pass function returns NULL.
- *
- * \note For no time limit use maxdt = 0.0
+ * \brief Predict the passes of several satellites in a worker thread.
+ * \param sats Array of satellites.
+ * \param num_sats The number of satellites in sats.
+ * \param qth Pointer to the QTH data.
+ * \param start Starting time.
+ * \param maxdt The time window in days (0 for no limit).
+ * \param num The maximum number of passes per satellite.
+ * \param cancellable Optional GCancellable to stop the prediction.
+ * \param callback Function called when the prediction has finished.
+ * \param data User data for callback.
  *
- * \note the data in sat will be corrupt (future) and must be refreshed
- *       by the caller, if the caller will need it later on (eg. if the caller
- *       is GtkSatList).
+ * This is the asynchronous version of get_pass_timeline(), for callers in
+ * the GUI. Like get_passes_async(), the satellites and the QTH position
+ * are copied and the prediction settings are read when the prediction is
+ * started. The sat fields of the timeline still point to the satellites
+ * in sats; a caller that may free them in the meantime should use the
+ * index fields instead.
  *
- * \note Prepending to a singly linked list is much faster than appending.
- *       Therefore, the elements are prepended whereafter the GSList is
- *       reversed
+ * callback is called in the thread-default main context of the caller and
+ * should call get_pass_timeline_finish().
  */
-GSList         *get_passes(sat_t * sat, qth_t * qth, gdouble start,
-                           gdouble maxdt, guint num)
+void get_pass_timeline_async(sat_t ** sats, guint num_sats, qth_t * qth,
+                             gdouble start, gdouble maxdt, guint num,
+                             GCancellable * cancellable,
+                             GAsyncReadyCallback callback, gpointer data)
 {
-    GSList         *passes = NULL;
-    pass_t         *pass = NULL;
+    GTask          *task;
+    timeline_task_t *tt;
     guint           i;
-    gdouble         t;
-
-    /* if no number has been specified
-       set it to something big */
-    if (num == 0)
-        num = 100;
-
-    t = start;
 
-    for (i = 0; i < num; i++)
+    tt = g_new0(timeline_task_t, 1);
+    tt->num_sats = num_sats;
+    tt->owners = g_new(sat_t *, num_sats);
+    tt->job.sats = g_new(sat_t *, num_sats);
+    for (i = 0; i < num_sats; i++)
     {
-        pass = get_pass(sat, qth, t, maxdt);
+        tt->owners[i] = sats[i];
+        tt->job.sats[i] = gtk_sat_data_dup_sat(sats[i]);
+    }
 
-        if (pass != NULL)
-        {
-            passes = g_slist_prepend(passes, pass);
-            t = pass->los + 0.014;      // +20 min
+    tt->qth.lat = qth->lat;
+    tt->qth.lon = qth->lon;
+    tt->qth.alt = qth->alt;
+    tt->job.qth = &tt->qth;
+    tt->job.start = start;
+    tt->job.maxdt = maxdt;
+    tt->job.num = num;
+    predict_cfg_load(&tt->job.cfg);
+
+    task = g_task_new(NULL, cancellable, callback, data);
+    g_task_set_source_tag(task, get_pass_timeline_async);
+    g_task_set_task_data(task, tt, timeline_task_free);
+    g_task_run_in_thread(task, get_pass_timeline_thread);
+    g_object_unref(task);
+}
 
-            /* if maxdt > 0.0 check whether we have reached t = start+maxdt
-               if yes finish predictions
-             */
-            if ((maxdt > 0.0) && (t >= (start + maxdt)))
-            {
-                i = num;
-            }
-        }
-        else
-        {
-            /* we can't get any more passes */
-            i = num;
-        }
+/**
+ * \brief Finish a prediction started with get_pass_timeline_async().
+ * \param result The GAsyncResult given to the callback.
+ * \param error Location to store the error, or NULL.
+ * \return The timeline, which must be freed with free_pass_timeline(), or
+ *         NULL if the prediction was cancelled.
+ */
+pass_timeline_t *get_pass_timeline_finish(GAsyncResult * result,
+                                          GError ** error)
+{
+    g_return_val_if_fail(g_task_is_valid(result, NULL), NULL);
 
-    }
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
 
-    if (passes != NULL)
-        passes = g_slist_reverse(passes);
+/**
+ * \brief Free a pass timeline.
+ * \param timeline The timeline created by get_pass_timeline().
+ *
+ * Passes that have been set to NULL are skipped, so the caller can take
+ * over the passes it needs.
+ */
+void free_pass_timeline(pass_timeline_t * timeline)
+{
+    guint           i;
 
-    sat_log_log(SAT_LOG_LEVEL_INFO,
-                _("%s: Found %d passes for %s in time window [%f;%f]"),
-                __func__, g_slist_length(passes), sat->nickname, start,
-                start + maxdt);
+    if (timeline == NULL)
+        return;
 
-    return passes;
+    for (i = 0; i < timeline->num_passes; i++)
+        free_pass(timeline->passes[i].pass);
+
+    g_free(timeline->passes);
+    g_free(timeline);
 }
 
 pass_t         *copy_pass(pass_t * pass)
@@ -733,7 +2022,9 @@ pass_t         *copy_pass(pass_t * pass)
         new->vis[1] = pass->vis[1];
         new->vis[2] = pass->vis[2];
         new->vis[3] = pass->vis[3];
-        new->details = copy_pass_details(pass->details);
+        new->details = copy_pass_details(pass->details, pass->num_details);
+        new->num_details = pass->num_details;
+        new->qth_comp = pass->qth_comp;
 
         if (pass->satname != NULL)
             new->satname = g_strdup(pass->satname);
@@ -744,21 +2035,21 @@ pass_t         *copy_pass(pass_t * pass)
     return new;
 }
 
-GSList         *copy_pass_details(GSList * details)
+/**
+ * \brief Copy an array of pass details.
+ * \param details The details to copy.
+ * \param num The number of entries in details.
+ * \return A newly allocated copy or NULL if there are no details.
+ */
+pass_detail_t  *copy_pass_details(const pass_detail_t * details, guint num)
 {
-    GSList         *new = NULL;
-    guint           i, n;
+    pass_detail_t  *new;
 
-    n = g_slist_length(details);
-    for (i = 0; i < n; i++)
-    {
-        new = g_slist_prepend(new,
-                              copy_pass_detail(PASS_DETAIL
-                                               (g_slist_nth_data
-                                                (details, i))));
-    }
+    if (details == NULL || num == 0)
+        return NULL;
 
-    new = g_slist_reverse(new);
+    new = g_new(pass_detail_t, num);
+    memcpy(new, details, num * sizeof(pass_detail_t));
 
     return new;
 }
@@ -837,8 +2128,8 @@ void free_passes(GSList * passes)
 /**
  * \brief Free a pass detail structure.
  *
- * This function is not rarely useful except for the
- * free_pass function.
+ * Only for details created with copy_pass_detail(); the details of a pass
+ * are freed by free_pass().
  */
 void free_pass_detail(pass_detail_t * detail)
 {
@@ -846,26 +2137,26 @@ void free_pass_detail(pass_detail_t * detail)
     detail = NULL;
 }
 
-/** Free the whole list of details. */
-void free_pass_details(GSList * details)
+/** Free the array of details of a pass. */
+void free_pass_details(pass_detail_t * details)
 {
-    guint           n, i;
-    gpointer        detail;
-
-    n = g_slist_length(details);
-
-    for (i = 0; i < n; i++)
-    {
-
-        detail = g_slist_nth_data(details, i);
+    g_free(details);
+}
 
-        /* free element data */
-        free_pass_detail(PASS_DETAIL(detail));
-    }
+/**
+ * \brief Get a pass detail.
+ * \param pass The pass.
+ * \param i The index of the detail.
+ * \return Pointer to the detail or NULL if i is out of range.
+ *
+ * This replaces g_slist_nth_data() on the former list of details.
+ */
+pass_detail_t  *get_pass_detail(pass_t * pass, guint i)
+{
+    if (pass == NULL || i >= pass->num_details)
+        return NULL;
 
-    /* free list elements */
-    g_slist_free(details);
-    details = NULL;
+    return &pass->details[i];
 }
 
 /**
@@ -891,6 +2182,10 @@ pass_t         *get_current_pass(sat_t * sat_in, qth_t * qth, gdouble start)
     gdouble         el0;
     sat_t          *sat, sat_working;
     pass_t         *pass;
+    obs_frame_t     ctx;
+    predict_cfg_t   cfg;
+
+    predict_cfg_load(&cfg);
 
     /*copy sat_in to a working structure */
     sat = memcpy(&sat_working, sat_in, sizeof(sat_t));
@@ -899,7 +2194,8 @@ pass_t         *get_current_pass(sat_t * sat_in, qth_t * qth, gdouble start)
         t = start;
     else
         t = get_current_daynum();
-    predict_calc(sat, qth, t);
+    predict_ctx_init(&ctx, qth, t);
+    predict_calc_ctx(sat, &ctx);
 
     /*save initial conditions for later comparison */
     t0 = t;
@@ -909,14 +2205,22 @@ pass_t         *get_current_pass(sat_t * sat_in, qth_t * qth, gdouble start)
     if (!has_aos(sat, qth))
         return NULL;
 
+    /* another view may already have calculated the pass */
+    pass = pass_cache_lookup(sat, qth, t, 0.0, &cfg);
+    if (pass != NULL)
+        return pass;
+
     /* find a time before AOS */
     while (sat->el > 0.0)
     {
-        predict_calc(sat, qth, t);
+        predict_ctx_set_time(&ctx, t);
+        predict_calc_ctx(sat, &ctx);
         t -= 0.007;             // +10 min
     }
 
-    pass = get_pass_no_min_el(sat, qth, t, 0.0);
+    pass = get_pass_engine(sat, qth, t, 0.0, 0.0, &cfg);
+    if (pass != NULL)
+        pass_cache_insert(sat, qth, t, 0.0, pass, &cfg);
     if (el0 > 0.0)
     {
         /* this function is only specified if the elevation 
@@ -939,3 +2243,251 @@ pass_t         *get_current_pass(sat_t * sat_in, qth_t * qth, gdouble start)
 
     return pass;
 }
+
+/**
+ * \brief Find the pass cache of a satellite.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param cfg The prediction settings of the caller.
+ * \return The cache for sat and qth.
+ *
+ * The cache is created if it doesn't exist. Cached passes are dropped when
+ * the TLE, the pass detail settings or the twilight threshold used for the
+ * visibility have changed. A QTH that has moved more than 1 km gets a new
+ * cache.
+ * Must be called with the pass_cache lock held.
+ */
+static pass_cache_t *pass_cache_find(sat_t * sat, qth_t * qth,
+                                     const predict_cfg_t * cfg)
+{
+    pass_cache_t   *cache = NULL;
+    GSList         *list;
+    GSList         *node;
+
+    if (pass_cache == NULL)
+        pass_cache = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                           NULL, pass_cache_free_list);
+
+    list = g_hash_table_lookup(pass_cache, GINT_TO_POINTER(sat->tle.catnr));
+
+    for (node = list; node != NULL; node = node->next)
+    {
+        if (qth_small_dist(qth, ((pass_cache_t *) node->data)->qth) <= 1.0)
+        {
+            cache = node->data;
+            list = g_slist_delete_link(list, node);
+            break;
+        }
+    }
+
+    if (cache == NULL)
+    {
+        cache = g_new0(pass_cache_t, 1);
+        qth_small_save(qth, &(cache->qth));
+
+        /* forget the least recently used QTH */
+        if (g_slist_length(list) >= PASS_CACHE_QTHS)
+        {
+            node = g_slist_last(list);
+            pass_cache_free(node->data);
+            list = g_slist_delete_link(list, node);
+        }
+    }
+
+    /* most recently used first */
+    list = g_slist_prepend(list, cache);
+    g_hash_table_steal(pass_cache, GINT_TO_POINTER(sat->tle.catnr));
+    g_hash_table_insert(pass_cache, GINT_TO_POINTER(sat->tle.catnr), list);
+
+    if ((cache->epoch != sat->tle.epoch) || (cache->tres != cfg->tres) ||
+        (cache->nument != cfg->nument) || (cache->twilight != cfg->twilight))
+    {
+        pass_cache_flush(cache);
+        cache->epoch = sat->tle.epoch;
+        cache->tres = cfg->tres;
+        cache->nument = cfg->nument;
+        cache->twilight = cfg->twilight;
+    }
+
+    return cache;
+}
+
+/**
+ * \brief Look up a pass in the cache.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param start The time where the search starts.
+ * \param min_el The minimum elevation of the pass.
+ * \param cfg The prediction settings of the caller.
+ * \return A copy of the pass get_pass_engine() would find, or NULL if the
+ *         cache doesn't know.
+ *
+ * A cached pass is the answer if it is in progress at start, or if it was
+ * found by a search that started no later than start using a minimum
+ * elevation no higher than min_el; the passes that search skipped are
+ * then also below min_el.
+ */
+static pass_t *pass_cache_lookup(sat_t * sat, qth_t * qth, gdouble start,
+                                 gdouble min_el, const predict_cfg_t * cfg)
+{
+    pass_cache_t   *cache;
+    pass_cache_entry_t *entry;
+    GSList         *node;
+    pass_t         *pass = NULL;
+
+    G_LOCK(pass_cache);
+
+    cache = pass_cache_find(sat, qth, cfg);
+
+    for (node = cache->entries; node != NULL; node = node->next)
+    {
+        entry = node->data;
+
+        if ((entry->pass->max_el >= min_el) && (start < entry->pass->los) &&
+            ((entry->pass->aos <= start) ||
+             ((entry->from <= start) && (entry->min_el <= min_el))))
+        {
+            pass = copy_pass(entry->pass);
+            break;
+        }
+    }
+
+    if (pass != NULL)
+        pass_cache_hits++;
+    else
+        pass_cache_misses++;
+
+    G_UNLOCK(pass_cache);
+
+    return pass;
+}
+
+/**
+ * \brief Store a pass in the cache.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param start The time where the search started.
+ * \param min_el The minimum elevation used for the search.
+ * \param pass The pass that was found. The cache stores a copy.
+ * \param cfg The prediction settings used for the search.
+ */
+static void pass_cache_insert(sat_t * sat, qth_t * qth, gdouble start,
+                              gdouble min_el, pass_t * pass,
+                              const predict_cfg_t * cfg)
+{
+    pass_cache_t   *cache;
+    pass_cache_entry_t *entry;
+    GSList         *node;
+
+    G_LOCK(pass_cache);
+
+    cache = pass_cache_find(sat, qth, cfg);
+
+    entry = g_new(pass_cache_entry_t, 1);
+    entry->from = start;
+    entry->min_el = min_el;
+    entry->pass = copy_pass(pass);
+    cache->entries = g_slist_prepend(cache->entries, entry);
+
+    if (g_slist_length(cache->entries) > PASS_CACHE_SIZE)
+    {
+        node = g_slist_last(cache->entries);
+        free_pass(((pass_cache_entry_t *) node->data)->pass);
+        g_free(node->data);
+        cache->entries = g_slist_delete_link(cache->entries, node);
+    }
+
+    G_UNLOCK(pass_cache);
+}
+
+/**
+ * \brief Predict a pass using the pass cache.
+ * \param sat Pointer to the satellite data.
+ * \param qth Pointer to the QTH data.
+ * \param start Starting time.
+ * \param maxdt The maximum number of days to look ahead (0 for no limit).
+ * \param min_el The minimum elevation of the pass.
+ * \param cfg The prediction settings.
+ * \return Same as get_pass_engine().
+ */
+static pass_t *pass_cache_get(sat_t * sat, qth_t * qth, gdouble start,
+                              gdouble maxdt, gdouble min_el,
+                              const predict_cfg_t * cfg)
+{
+    pass_t         *pass;
+
+    pass = pass_cache_lookup(sat, qth, start, min_el, cfg);
+
+    if (pass == NULL)
+    {
+        pass = get_pass_engine(sat, qth, start, maxdt, min_el, cfg);
+        if (pass != NULL)
+            pass_cache_insert(sat, qth, start, min_el, pass, cfg);
+    }
+    else if ((maxdt > 0.0) && (pass->aos > (start + maxdt)))
+    {
+        free_pass(pass);
+        pass = NULL;
+    }
+
+    return pass;
+}
+
+/** \brief Free the passes in a pass cache. */
+static void pass_cache_flush(pass_cache_t * cache)
+{
+    GSList         *node;
+
+    for (node = cache->entries; node != NULL; node = node->next)
+    {
+        free_pass(((pass_cache_entry_t *) node->data)->pass);
+        g_free(node->data);
+    }
+
+    g_slist_free(cache->entries);
+    cache->entries = NULL;
+}
+
+/** \brief Free a pass cache. */
+static void pass_cache_free(gpointer cache)
+{
+    pass_cache_flush((pass_cache_t *) cache);
+    g_free(cache);
+}
+
+/** \brief Free the list of pass caches of a satellite. */
+static void pass_cache_free_list(gpointer list)
+{
+    g_slist_free_full((GSList *) list, pass_cache_free);
+}
+
+/**
+ * \brief Empty the pass cache.
+ *
+ * This is done when the TLE data is reloaded. Passes are also keyed by the
+ * TLE epoch, so outdated passes are never returned anyway; clearing the
+ * cache releases their memory.
+ */
+void predict_cache_clear(void)
+{
+    G_LOCK(pass_cache);
+
+    if (pass_cache != NULL)
+        g_hash_table_remove_all(pass_cache);
+
+    G_UNLOCK(pass_cache);
+}
+
+/**
+ * \brief Get the pass cache statistics.
+ * \param hits Location to store the number of passes found in the cache.
+ * \param misses Location to store the number of passes that had to be
+ *               calculated.
+ */
+void predict_cache_stats(guint * hits, guint * misses)
+{
+    G_LOCK(pass_cache);
+    *hits = pass_cache_hits;
+    *misses = pass_cache_misses;
+    G_UNLOCK(pass_cache);
+}
@@ -29,27 +29,12 @@
 #define PREDICT_TOOLS_H 1
 
 #include <glib.h>
+#include <gio/gio.h>
 #include "gtk-sat-data.h"
 #include "sat-vis.h"
 #include "sgpsdp/sgp4sdp4.h"
 
 
-/** \brief Brief satellite pass info. */
-typedef struct {
-    gchar      *satname;  /*!< satellite name */
-    gdouble     aos;      /*!< AOS time in "jul_utc" */
-    gdouble     tca;      /*!< TCA time in "jul_utc" */
-    gdouble     los;      /*!< LOS time in "jul_utc" */
-    gdouble     max_el;   /*!< Maximum elevation during pass */
-    gdouble     aos_az;   /*!< Azimuth at AOS */
-    gdouble     los_az;   /*!< Azimuth at LOS */
-    gint        orbit;    /*!< Orbit number */
-    gdouble     maxel_az; /*!< Azimuth at maximum elevation */
-    gchar       vis[4];   /*!< Visibility string, e.g. VSE, -S-, V-- */
-    GSList     *details;  /*!< List of pass_detail_t entries */
-    qth_small_t qth_comp; /*!< Short version of qth at time computed */
-} pass_t;
-
 /**
  * \brief Pass detail entry.
  *
@@ -78,6 +63,93 @@ typedef struct {
     gint      orbit;
 } pass_detail_t;
 
+/** \brief Brief satellite pass info. */
+typedef struct {
+    gchar      *satname;  /*!< satellite name */
+    gdouble     aos;      /*!< AOS time in "jul_utc" */
+    gdouble     tca;      /*!< TCA time in "jul_utc" */
+    gdouble     los;      /*!< LOS time in "jul_utc" */
+    gdouble     max_el;   /*!< Maximum elevation during pass */
+    gdouble     aos_az;   /*!< Azimuth at AOS */
+    gdouble     los_az;   /*!< Azimuth at LOS */
+    gint        orbit;    /*!< Orbit number */
+    gdouble     maxel_az; /*!< Azimuth at maximum elevation */
+    gchar       vis[4];   /*!< Visibility string, e.g. VSE, -S-, V-- */
+    pass_detail_t *details;   /*!< Array of num_details entries */
+    guint       num_details;  /*!< Number of entries in details */
+    qth_small_t qth_comp; /*!< Short version of qth at time computed */
+} pass_t;
+
+/** \brief Pass of one satellite in a pass timeline. */
+typedef struct {
+    sat_t      *sat;      /*!< The satellite */
+    guint       index;    /*!< Index of sat in the array of satellites */
+    pass_t     *pass;     /*!< The pass, owned by the timeline */
+} timeline_pass_t;
+
+/**
+ * \brief Passes of several satellites in one time window.
+ *
+ * The passes of all satellites are kept in one array sorted by AOS.
+ */
+typedef struct {
+    timeline_pass_t *passes;     /*!< Array of num_passes entries */
+    guint            num_passes; /*!< Number of entries in passes */
+} pass_timeline_t;
+
+/**
+ * \brief Set of satellites that are propagated together.
+ *
+ * Near-earth satellites are kept in an SGP4 batch, while deep-space
+ * satellites, which need SDP4, are propagated one by one.
+ */
+typedef struct {
+    sgp4_batch_t  sgp4;   /*!< Near-earth satellites */
+    GPtrArray    *deep;   /*!< Deep-space satellites (sat_t *) */
+} predict_batch_t;
+
+/**
+ * \brief Part of a batch that can be calculated in its own thread.
+ *
+ * The parts of a batch given by predict_batch_part() do not overlap, and
+ * together they cover all satellites in the batch.
+ */
+typedef struct {
+    gint      first;    /*!< First near-earth satellite in batch->sgp4 */
+    gint      last;     /*!< One after the last near-earth satellite */
+    guint     dfirst;   /*!< First deep-space satellite in batch->deep */
+    guint     dlast;    /*!< One after the last deep-space satellite */
+} predict_batch_part_t;
+
+/** \brief Result of an AOS/LOS search. */
+typedef enum {
+    EVENT_FOUND = 0,    /*!< The event was found */
+    EVENT_NEVER,        /*!< The satellite never rises above the horizon */
+    EVENT_TIMEOUT,      /*!< No event within the time limit */
+    EVENT_DECAYED,      /*!< The orbit model failed, the satellite has decayed */
+    EVENT_BUDGET        /*!< The search used up its orbit calculations */
+} event_status_t;
+
+/** \brief Cost of the AOS/LOS searches for one satellite. */
+typedef struct {
+    gint        catnr;      /*!< Catalog number */
+    gchar      *name;       /*!< Satellite name */
+    guint       searches;   /*!< Number of searches */
+    guint       exhausted;  /*!< Searches that ended with EVENT_BUDGET */
+    guint64     steps;      /*!< Bracketing steps and solver iterations */
+    guint64     calls;      /*!< Orbit calculations */
+    guint       max_calls;  /*!< Orbit calculations of the costliest search */
+    gint64      usec;       /*!< Time spent [usec] */
+} event_sat_stats_t;
+
+/**
+ * \brief Callback for each pass found by get_passes_async().
+ * \param pass The pass, which now belongs to the callback.
+ * \param progress The fraction of the search done so far, 0.0 to 1.0.
+ * \param data The data passed to get_passes_async().
+ */
+typedef void (*pass_found_cb) (pass_t *pass, gdouble progress, gpointer data);
+
 /* type casting macros */
 #define PASS(x) ((pass_t *) x)
 #define PASS_DETAIL(x) ((pass_detail_t *) x)
@@ -85,10 +157,42 @@ typedef struct {
 /* SGP4/SDP4 driver */
 void predict_calc (sat_t *sat, qth_t *qth, gdouble t);
 
+/* observer frame shared by calculations for the same QTH */
+void predict_ctx_init     (obs_frame_t *ctx, qth_t *qth, gdouble t);
+void predict_ctx_set_time (obs_frame_t *ctx, gdouble t);
+void predict_calc_ctx     (sat_t *sat, const obs_frame_t *ctx);
+void predict_calc_ephem   (sat_t *sat, cheb_ephem_t *eph, const obs_frame_t *ctx);
+
+/* equally spaced times, e.g. for ground tracks and pass details */
+void predict_calc_series  (sat_t *sat, qth_t *qth, gdouble start, gdouble step,
+                           guint num, pass_detail_t *details);
+
+/* batch propagation */
+predict_batch_t *predict_batch_new  (GHashTable *sats);
+void             predict_batch_free (predict_batch_t *batch);
+void             predict_calc_batch (predict_batch_t *batch, const obs_frame_t *ctx);
+void             predict_batch_part (const predict_batch_t *batch, guint part,
+                                     guint nparts, predict_batch_part_t *range);
+void             predict_calc_batch_part (predict_batch_t *batch,
+                                          const predict_batch_part_t *range,
+                                          const obs_frame_t *ctx);
+
 /* AOS/LOS time calculators */
-gdouble find_aos           (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt);
-gdouble find_los           (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt);
+gdouble predict_event_tol  (void);
+gdouble find_aos           (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt,
+                            gdouble tol);
+gdouble find_los           (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt,
+                            gdouble tol);
 gdouble find_prev_aos      (sat_t *sat, qth_t *qth, gdouble start);
+event_status_t find_aos_status (sat_t *sat, qth_t *qth, gdouble start,
+                                gdouble maxdt, gdouble tol, gdouble *aos);
+event_status_t find_los_status (sat_t *sat, qth_t *qth, gdouble start,
+                                gdouble maxdt, gdouble tol, gdouble *los);
+
+/* cost of the AOS/LOS searches */
+void    predict_event_stats (guint *events, guint *calls);
+GArray *predict_event_sat_stats (void);
+void    predict_event_sat_stats_clear (void);
 
 /* next events */
 pass_t *get_next_pass      (sat_t *sat, qth_t *qth, gdouble maxdt);
@@ -100,15 +204,42 @@ GSList *get_passes         (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt
 pass_t *get_current_pass   (sat_t *sat, qth_t *qth, gdouble start);
 pass_t *get_pass_no_min_el (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt);
 
+/* future events calculated in a worker thread */
+void    get_passes_async   (sat_t *sat, qth_t *qth, gdouble start, gdouble maxdt,
+                            guint num, GCancellable *cancellable,
+                            pass_found_cb found, GAsyncReadyCallback callback,
+                            gpointer data);
+gssize  get_passes_finish  (GAsyncResult *result, GError **error);
+
+/* future events of several satellites */
+pass_timeline_t *get_pass_timeline  (sat_t **sats, guint num_sats, qth_t *qth,
+                                     gdouble start, gdouble maxdt, guint num);
+void             free_pass_timeline (pass_timeline_t *timeline);
+void             get_pass_timeline_async  (sat_t **sats, guint num_sats,
+                                           qth_t *qth, gdouble start,
+                                           gdouble maxdt, guint num,
+                                           GCancellable *cancellable,
+                                           GAsyncReadyCallback callback,
+                                           gpointer data);
+pass_timeline_t *get_pass_timeline_finish (GAsyncResult *result,
+                                           GError **error);
+
 /* copying */
 pass_t        *copy_pass         (pass_t *pass);
-GSList        *copy_pass_details (GSList *details);
+pass_detail_t *copy_pass_details (const pass_detail_t *details, guint num);
 pass_detail_t *copy_pass_detail  (pass_detail_t *detail);
 
+/* accessing details */
+pass_detail_t *get_pass_detail   (pass_t *pass, guint i);
+
+/* pass cache */
+void predict_cache_clear (void);
+void predict_cache_stats (guint *hits, guint *misses);
+
 /* memory cleaning */
 void free_pass         (pass_t *pass);
 void free_passes       (GSList *passes);
 void free_pass_detail  (pass_detail_t *detail);
-void free_pass_details (GSList *details);
+void free_pass_details (pass_detail_t *details);
 
 #endif
@@ -138,7 +138,8 @@ sat_cfg_bool_t  sat_cfg_bool[SAT_CFG_BOOL_NUM] = {
     {"TLE", "PROXY_AUTH", FALSE},
     {"TLE", "ADD_NEW_SATS", TRUE},
     {"LOG", "KEEP_LOG_FILES", FALSE},
-    {"PREDICT", "USE_REAL_T0", FALSE}
+    {"PREDICT", "USE_REAL_T0", FALSE},
+    {"MODULES", "EPHEM_CACHE", FALSE}
 };
 
 /** Array containing the integer configuration parameters */
@@ -212,7 +213,9 @@ sat_cfg_int_t   sat_cfg_int[SAT_CFG_INT_NUM] = {
     {"TLE", "AUTO_UPDATE_ACTION", 1},   /* notify, see tle_auto_upd_action_t */
     {"TLE", "LAST_UPDATE", 0},
     {"LOG", "CLEAN_AGE", 0},    /* 0 = Never clean */
-    {"LOG", "LEVEL", 2}
+    {"LOG", "LEVEL", 2},
+    {"MODULES", "UPDATE_THREADS", 0},
+    {"PREDICT", "EVENT_TOLERANCE", 100}
 };
 
 /** Array containing the string configuration values */
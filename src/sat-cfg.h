@@ -59,6 +59,7 @@ typedef enum {
     SAT_CFG_BOOL_TLE_ADD_NEW,   /*!< Add new satellites to database. */
     SAT_CFG_BOOL_KEEP_LOG_FILES,        /*!< Whether to keep old log files */
     SAT_CFG_BOOL_PRED_USE_REAL_T0,      /*!< Whether to use current time as T0 fro predictions */
+    SAT_CFG_BOOL_MODULE_EPHEM_CACHE,    /*!< Use Chebyshev ephemerides when not in real time */
     SAT_CFG_BOOL_NUM            /*!< Number of boolean parameters */
 } sat_cfg_bool_e;
 
@@ -134,6 +135,8 @@ typedef enum {
     SAT_CFG_INT_TLE_LAST_UPDATE,        /*!< Date and time of last update, Unix seconds. */
     SAT_CFG_INT_LOG_CLEAN_AGE,  /*!< Age of log file to delete (seconds) */
     SAT_CFG_INT_LOG_LEVEL,      /*!< Logging level */
+    SAT_CFG_INT_MODULE_THREADS, /*!< Satellite update threads (0 = one per CPU) */
+    SAT_CFG_INT_PRED_EVENT_TOL, /*!< AOS/LOS time tolerance in msec */
     SAT_CFG_INT_NUM             /*!< Number of integer parameters. */
 } sat_cfg_int_e;
 
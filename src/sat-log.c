@@ -55,6 +55,9 @@ static GIOChannel *logfile = NULL;
 static sat_log_level_t loglevel = SAT_LOG_LEVEL_DEBUG;
 static gboolean debug_to_stderr = FALSE; // whether to also send debug msg to stderr
 
+/* Serializes the writes to logfile; messages come from worker threads too */
+G_LOCK_DEFINE_STATIC(logfile);
+
 /** String representation of debug levels. */
 const gchar    *debug_level_str[] = {
     N_(" --- "),
@@ -143,10 +146,12 @@ void sat_log_close()
     if (initialised)
     {
         sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Session ended"), __func__);
+        G_LOCK(logfile);
         g_io_channel_shutdown(logfile, TRUE, NULL);
         g_io_channel_unref(logfile);
         logfile = NULL;
         initialised = FALSE;
+        G_UNLOCK(logfile);
 
         /* Always call log_rotate to get rid of old logs */
         log_rotate();
@@ -227,7 +232,8 @@ static void manage_debug_message(sat_log_level_t debug_level,
 
     g_free(msg_time);
 
-    /* print debug message */
+    /* print debug message; one line at a time */
+    G_LOCK(logfile);
     if G_LIKELY(initialised)
     {
         /* save to file */
@@ -245,6 +251,7 @@ static void manage_debug_message(sat_log_level_t debug_level,
         /* send to stderr */
         g_fprintf(stderr, "%s", msg);
     }
+    G_UNLOCK(logfile);
 
     g_free(msg);
 }
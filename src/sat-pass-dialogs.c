@@ -338,11 +338,11 @@ void show_pass(const gchar * satname, qth_t * qth, pass_t * pass,
                                    G_TYPE_STRING);      // visibility
 
     /* add rows to list store */
-    num = g_slist_length(pass->details);
+    num = pass->num_details;
 
     for (i = 0; i < num; i++)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(pass->details, i));
+        detail = &pass->details[i];
 
         gtk_list_store_append(liststore, &item);
         gtk_list_store_set(liststore, &item,
@@ -914,31 +914,29 @@ static void Calc_RADec(gdouble jul_utc, gdouble saz, gdouble sel,
 /***   MULTI PASS  ***/
 
 /**
- * Show details about a satellite pass.
+ * Create the dialog for a list of passes.
  *
  * @param satname The name of the satellite.
  * @param qth Pointer to the QTH data.
- * @param passes List of passes to show.
  * @param toplevel The toplevel window or NULL.
+ * @return The dialog, which has not been shown yet.
  *
- * This function creates a dialog window with a list showing the
- * details of a pass.
- *
+ * The list of the dialog is empty. Passes are added with
+ * multi_pass_append(). The list view is stored in the "list" data of
+ * the dialog.
  */
-void show_passes(const gchar * satname, qth_t * qth, GSList * passes,
-                 GtkWidget * toplevel)
+static GtkWidget *create_multi_pass_dialog(const gchar * satname,
+                                           qth_t * qth, GtkWidget * toplevel)
 {
     GtkWidget      *dialog;
     GtkWidget      *list;
     GtkListStore   *liststore;
     GtkCellRenderer *renderer;
     GtkTreeViewColumn *column;
-    GtkTreeIter     item;
     GtkWidget      *swin;
     gchar          *title;
     guint           flags;
-    guint           i, num;
-    pass_t         *pass = NULL;
+    guint           i;
     gchar          *buff;
 
     /* get columns flags */
@@ -985,33 +983,11 @@ void show_passes(const gchar * satname, qth_t * qth, GSList * passes,
                                    G_TYPE_STRING,       // visibility
                                    G_TYPE_INT); // row number
 
-    /* add rows to list store */
-    num = g_slist_length(passes);
-
-    for (i = 0; i < num; i++)
-    {
-        pass = PASS(g_slist_nth_data(passes, i));
-        gtk_list_store_append(liststore, &item);
-        gtk_list_store_set(liststore, &item,
-                           MULTI_PASS_COL_AOS_TIME, pass->aos,
-                           MULTI_PASS_COL_TCA, pass->tca,
-                           MULTI_PASS_COL_LOS_TIME, pass->los,
-                           MULTI_PASS_COL_DURATION, (pass->los - pass->aos),
-                           MULTI_PASS_COL_AOS_AZ, pass->aos_az,
-                           MULTI_PASS_COL_MAX_EL, pass->max_el,
-                           MULTI_PASS_COL_MAX_EL_AZ, pass->maxel_az,
-                           MULTI_PASS_COL_LOS_AZ, pass->los_az,
-                           MULTI_PASS_COL_ORBIT, pass->orbit,
-                           MULTI_PASS_COL_VIS, pass->vis,
-                           MULTI_PASS_COL_NUMBER, i, -1);
-    }
-
     /* connect model to tree view */
     gtk_tree_view_set_model(GTK_TREE_VIEW(list), GTK_TREE_MODEL(liststore));
     g_object_unref(liststore);
 
-    /* store reference to passes and QTH */
-    g_object_set_data(G_OBJECT(list), "passes", passes);
+    /* store reference to QTH; the passes are added later */
     g_object_set_data(G_OBJECT(list), "qth", qth);
 
     /* mouse events => popup menu */
@@ -1056,9 +1032,10 @@ void show_passes(const gchar * satname, qth_t * qth, GSList * passes,
     /* allow interaction with other windows */
     gtk_window_set_modal(GTK_WINDOW(dialog), FALSE);
 
-    g_object_set_data(G_OBJECT(dialog), "sat", (gpointer) satname);
+    g_object_set_data_full(G_OBJECT(dialog), "sat", g_strdup(satname),
+                           g_free);
     g_object_set_data(G_OBJECT(dialog), "qth", qth);
-    g_object_set_data(G_OBJECT(dialog), "passes", passes);
+    g_object_set_data(G_OBJECT(dialog), "list", list);
 
     g_signal_connect(dialog, "response", G_CALLBACK(multi_pass_response),
                      NULL);
@@ -1071,6 +1048,75 @@ void show_passes(const gchar * satname, qth_t * qth, GSList * passes,
                        swin, TRUE, TRUE, 0);
 
     gtk_window_set_default_size(GTK_WINDOW(dialog), -1, 300);
+
+    return dialog;
+}
+
+/**
+ * Add a pass to a multi-pass dialog.
+ *
+ * @param dialog The dialog created with create_multi_pass_dialog().
+ * @param pass The pass, which now belongs to the dialog.
+ */
+static void multi_pass_append(GtkWidget * dialog, pass_t * pass)
+{
+    GtkWidget      *list;
+    GtkListStore   *liststore;
+    GtkTreeIter     item;
+    GSList         *passes;
+    guint           row;
+
+    list = GTK_WIDGET(g_object_get_data(G_OBJECT(dialog), "list"));
+    liststore =
+        GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(list)));
+    passes = (GSList *) g_object_get_data(G_OBJECT(dialog), "passes");
+
+    row = g_slist_length(passes);
+    passes = g_slist_append(passes, pass);
+
+    gtk_list_store_append(liststore, &item);
+    gtk_list_store_set(liststore, &item,
+                       MULTI_PASS_COL_AOS_TIME, pass->aos,
+                       MULTI_PASS_COL_TCA, pass->tca,
+                       MULTI_PASS_COL_LOS_TIME, pass->los,
+                       MULTI_PASS_COL_DURATION, (pass->los - pass->aos),
+                       MULTI_PASS_COL_AOS_AZ, pass->aos_az,
+                       MULTI_PASS_COL_MAX_EL, pass->max_el,
+                       MULTI_PASS_COL_MAX_EL_AZ, pass->maxel_az,
+                       MULTI_PASS_COL_LOS_AZ, pass->los_az,
+                       MULTI_PASS_COL_ORBIT, pass->orbit,
+                       MULTI_PASS_COL_VIS, pass->vis,
+                       MULTI_PASS_COL_NUMBER, row, -1);
+
+    /* the list and the dialog share the passes */
+    g_object_set_data(G_OBJECT(list), "passes", passes);
+    g_object_set_data(G_OBJECT(dialog), "passes", passes);
+}
+
+/**
+ * Show details about a satellite pass.
+ *
+ * @param satname The name of the satellite.
+ * @param qth Pointer to the QTH data.
+ * @param passes List of passes to show.
+ * @param toplevel The toplevel window or NULL.
+ *
+ * This function creates a dialog window with a list showing the
+ * details of a pass.
+ *
+ */
+void show_passes(const gchar * satname, qth_t * qth, GSList * passes,
+                 GtkWidget * toplevel)
+{
+    GtkWidget      *dialog;
+    GSList         *node;
+
+    dialog = create_multi_pass_dialog(satname, qth, toplevel);
+
+    for (node = passes; node != NULL; node = node->next)
+        multi_pass_append(dialog, PASS(node->data));
+    g_slist_free(passes);
+
     gtk_widget_show_all(dialog);
 }
 
@@ -1127,6 +1173,292 @@ static void multi_pass_dialog_destroy(GtkWidget * dialog, gpointer data)
     gtk_widget_destroy(dialog);
 }
 
+/***   ASYNCHRONOUS PREDICTION  ***/
+
+/** State of a pass prediction running for a dialog. */
+typedef struct {
+    GtkWidget      *dialog;     /*!< The dialog, NULL once destroyed. */
+    GtkWidget      *progress;   /*!< Progress bar. */
+    GtkWidget      *toplevel;   /*!< Parent of the dialogs. */
+    GCancellable   *cancellable;        /*!< Cancels the prediction. */
+    qth_t          *qth;        /*!< The QTH. */
+    gchar          *satname;    /*!< Name of the satellite. */
+    gdouble         maxdt;      /*!< Look ahead in days. */
+    guint           count;      /*!< Number of passes received. */
+    guint           pulse;      /*!< Pulse timeout until the first pass. */
+} pass_job_t;
+
+static void pass_job_stop_pulse(pass_job_t * job)
+{
+    if (job->pulse > 0)
+    {
+        g_source_remove(job->pulse);
+        job->pulse = 0;
+    }
+}
+
+static void pass_job_free(pass_job_t * job)
+{
+    pass_job_stop_pulse(job);
+    g_object_unref(job->cancellable);
+    g_free(job->satname);
+    g_free(job);
+}
+
+/** Pulse the progress bar while nothing is known about the progress. */
+static gboolean pass_job_pulse(gpointer data)
+{
+    pass_job_t     *job = data;
+
+    gtk_progress_bar_pulse(GTK_PROGRESS_BAR(job->progress));
+
+    return G_SOURCE_CONTINUE;
+}
+
+/** Stop the prediction when its dialog goes away. */
+static void pass_job_dialog_destroy(GtkWidget * dialog, gpointer data)
+{
+    pass_job_t     *job = data;
+
+    (void)dialog;
+
+    pass_job_stop_pulse(job);
+    job->dialog = NULL;
+    g_cancellable_cancel(job->cancellable);
+}
+
+/** Tell the user that there are no passes within the look ahead. */
+static void pass_job_no_passes(pass_job_t * job)
+{
+    GtkWidget      *dialog;
+
+    dialog = gtk_message_dialog_new(GTK_WINDOW(job->toplevel),
+                                    GTK_DIALOG_MODAL |
+                                    GTK_DIALOG_DESTROY_WITH_PARENT,
+                                    GTK_MESSAGE_INFO,
+                                    GTK_BUTTONS_OK,
+                                    _("Satellite %s has no passes\n"
+                                      "within the next %d days"),
+                                    job->satname, (gint) job->maxdt);
+
+    gtk_dialog_run(GTK_DIALOG(dialog));
+    gtk_widget_destroy(dialog);
+}
+
+/**
+ * Finish a prediction.
+ *
+ * @param source Unused.
+ * @param result The result of get_passes_async().
+ * @param data The pass_job_t.
+ *
+ * If the dialog is still there and no pass was found, the dialog is
+ * replaced by a message saying so. Otherwise the progress bar of a list
+ * of passes is hidden.
+ */
+static void pass_job_done(GObject * source, GAsyncResult * result,
+                          gpointer data)
+{
+    pass_job_t     *job = data;
+    gssize          num;
+
+    (void)source;
+
+    num = get_passes_finish(result, NULL);
+    pass_job_stop_pulse(job);
+
+    if (job->dialog != NULL)
+    {
+        g_signal_handlers_disconnect_by_func(job->dialog,
+                                             pass_job_dialog_destroy, job);
+
+        if (num == 0)
+        {
+            gtk_widget_destroy(job->dialog);
+            pass_job_no_passes(job);
+        }
+        else
+        {
+            gtk_widget_hide(gtk_widget_get_parent(job->progress));
+        }
+    }
+
+    pass_job_free(job);
+}
+
+/**
+ * Create the state of a prediction for a dialog.
+ *
+ * @param sat The satellite.
+ * @param qth The QTH.
+ * @param maxdt The look ahead in days.
+ * @param toplevel The toplevel window or NULL.
+ *
+ * The dialog and the progress bar are set by the caller.
+ */
+static pass_job_t *pass_job_new(sat_t * sat, qth_t * qth, gdouble maxdt,
+                                GtkWidget * toplevel)
+{
+    pass_job_t     *job;
+
+    job = g_new0(pass_job_t, 1);
+    job->toplevel = toplevel;
+    job->cancellable = g_cancellable_new();
+    job->qth = qth;
+    job->satname = g_strdup(sat->nickname);
+    job->maxdt = maxdt;
+
+    return job;
+}
+
+/** Start the prediction once the dialog is set up. */
+static void pass_job_start(pass_job_t * job, sat_t * sat, gdouble start,
+                           guint num, pass_found_cb found)
+{
+    g_signal_connect(job->dialog, "destroy",
+                     G_CALLBACK(pass_job_dialog_destroy), job);
+
+    gtk_progress_bar_set_pulse_step(GTK_PROGRESS_BAR(job->progress), 0.05);
+    job->pulse = g_timeout_add(100, pass_job_pulse, job);
+
+    get_passes_async(sat, job->qth, start, job->maxdt, num,
+                     job->cancellable, found, pass_job_done, job);
+}
+
+/** Show the first pass found for show_pass_async(). */
+static void single_pass_found(pass_t * pass, gdouble progress,
+                              gpointer data)
+{
+    pass_job_t     *job = data;
+
+    (void)progress;
+
+    job->count++;
+
+    /* the progress dialog is no longer needed */
+    gtk_widget_destroy(job->dialog);
+
+    show_pass(job->satname, job->qth, pass, job->toplevel);
+}
+
+/** Add a pass found for show_passes_async() to the list. */
+static void multi_pass_found(pass_t * pass, gdouble progress, gpointer data)
+{
+    pass_job_t     *job = data;
+    gchar          *text;
+
+    pass_job_stop_pulse(job);
+
+    multi_pass_append(job->dialog, pass);
+    job->count++;
+
+    text = g_strdup_printf(_("%d passes"), job->count);
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(job->progress), text);
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(job->progress), progress);
+    g_free(text);
+}
+
+static void pass_job_cancel_clicked(GtkWidget * button, gpointer data)
+{
+    pass_job_t     *job = data;
+
+    g_cancellable_cancel(job->cancellable);
+    gtk_widget_set_sensitive(button, FALSE);
+}
+
+/**
+ * Show the next pass of a satellite without blocking the GUI.
+ *
+ * @param sat The satellite.
+ * @param qth Pointer to the QTH data.
+ * @param start The time to start the search from.
+ * @param maxdt The number of days to look ahead.
+ * @param toplevel The toplevel window or NULL.
+ *
+ * The pass is predicted in a worker thread while a dialog with a progress
+ * bar and a cancel button is shown. When the pass is found, the dialog is
+ * replaced by the details of the pass as in show_pass().
+ */
+void show_pass_async(sat_t * sat, qth_t * qth, gdouble start, gdouble maxdt,
+                     GtkWidget * toplevel)
+{
+    pass_job_t     *job;
+    GtkWidget      *vbox;
+    GtkWidget      *label;
+    gchar          *text;
+
+    job = pass_job_new(sat, qth, maxdt, toplevel);
+
+    job->dialog = gtk_dialog_new_with_buttons(_("Predicting pass"),
+                                              GTK_WINDOW(toplevel),
+                                              GTK_DIALOG_DESTROY_WITH_PARENT,
+                                              "_Cancel", GTK_RESPONSE_CANCEL,
+                                              NULL);
+    g_signal_connect(job->dialog, "response",
+                     G_CALLBACK(gtk_widget_destroy), NULL);
+
+    vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+    gtk_container_set_border_width(GTK_CONTAINER(vbox), 10);
+    text = g_strdup_printf(_("Looking for the next pass of %s"),
+                           job->satname);
+    label = gtk_label_new(text);
+    g_free(text);
+    gtk_box_pack_start(GTK_BOX(vbox), label, FALSE, FALSE, 0);
+    job->progress = gtk_progress_bar_new();
+    gtk_box_pack_start(GTK_BOX(vbox), job->progress, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX
+                       (gtk_dialog_get_content_area(GTK_DIALOG(job->dialog))),
+                       vbox, TRUE, TRUE, 0);
+
+    gtk_widget_show_all(job->dialog);
+
+    pass_job_start(job, sat, start, 1, single_pass_found);
+}
+
+/**
+ * Show the upcoming passes of a satellite without blocking the GUI.
+ *
+ * @param sat The satellite.
+ * @param qth Pointer to the QTH data.
+ * @param start The time to start the search from.
+ * @param maxdt The number of days to look ahead.
+ * @param num The number of passes.
+ * @param toplevel The toplevel window or NULL.
+ *
+ * The dialog of show_passes() is shown right away, and the passes are
+ * added to it as they are predicted in a worker thread. A progress bar
+ * and a cancel button below the list are hidden when the prediction is
+ * done.
+ */
+void show_passes_async(sat_t * sat, qth_t * qth, gdouble start,
+                       gdouble maxdt, guint num, GtkWidget * toplevel)
+{
+    pass_job_t     *job;
+    GtkWidget      *hbox;
+    GtkWidget      *button;
+
+    job = pass_job_new(sat, qth, maxdt, toplevel);
+    job->dialog = create_multi_pass_dialog(job->satname, qth, toplevel);
+
+    hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    job->progress = gtk_progress_bar_new();
+    gtk_progress_bar_set_show_text(GTK_PROGRESS_BAR(job->progress), TRUE);
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(job->progress),
+                              _("Calculating passes"));
+    gtk_box_pack_start(GTK_BOX(hbox), job->progress, TRUE, TRUE, 0);
+    button = gtk_button_new_with_mnemonic("_Cancel");
+    g_signal_connect(button, "clicked",
+                     G_CALLBACK(pass_job_cancel_clicked), job);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX
+                       (gtk_dialog_get_content_area(GTK_DIALOG(job->dialog))),
+                       hbox, FALSE, FALSE, 0);
+
+    gtk_widget_show_all(job->dialog);
+
+    pass_job_start(job, sat, start, num, multi_pass_found);
+}
+
 /** Set cell renderer function. */
 static void check_and_set_multi_cell_renderer(GtkTreeViewColumn * column,
                                               GtkCellRenderer * renderer,
@@ -24,6 +24,7 @@
 
 #include "sat-cfg.h"
 #include "sat-pref-conditions.h"
+#include "sat-vis.h"
 
 
 static GtkWidget *tzero;
@@ -32,6 +33,7 @@ static GtkWidget *numpass;
 static GtkWidget *lookahead;
 static GtkWidget *res;
 static GtkWidget *nument;
+static GtkWidget *evtol;
 static GtkWidget *twspin;
 
 static gboolean dirty = FALSE;  /* used to check whether any changes have occurred */
@@ -63,12 +65,16 @@ void sat_pref_conditions_ok()
         sat_cfg_set_int(SAT_CFG_INT_PRED_NUM_ENTRIES,
                         gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON
                                                          (nument)));
+        sat_cfg_set_int(SAT_CFG_INT_PRED_EVENT_TOL,
+                        gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON
+                                                         (evtol)));
         sat_cfg_set_int(SAT_CFG_INT_PRED_TWILIGHT_THLD,
                         gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON
                                                          (twspin)));
         sat_cfg_set_bool(SAT_CFG_BOOL_PRED_USE_REAL_T0,
                          gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON
                                                       (tzero)));
+        sat_vis_cache_clear();
 
         dirty = FALSE;
     }
@@ -79,8 +85,10 @@ void sat_pref_conditions_ok()
         sat_cfg_reset_int(SAT_CFG_INT_PRED_LOOK_AHEAD);
         sat_cfg_reset_int(SAT_CFG_INT_PRED_RESOLUTION);
         sat_cfg_reset_int(SAT_CFG_INT_PRED_NUM_ENTRIES);
+        sat_cfg_reset_int(SAT_CFG_INT_PRED_EVENT_TOL);
         sat_cfg_reset_int(SAT_CFG_INT_PRED_TWILIGHT_THLD);
         sat_cfg_reset_bool(SAT_CFG_BOOL_PRED_USE_REAL_T0);
+        sat_vis_cache_clear();
 
         reset = FALSE;
     }
@@ -113,6 +121,9 @@ static void reset_cb(GtkWidget * button, gpointer data)
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(nument),
                               sat_cfg_get_int_def
                               (SAT_CFG_INT_PRED_NUM_ENTRIES));
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(evtol),
+                              sat_cfg_get_int_def
+                              (SAT_CFG_INT_PRED_EVENT_TOL));
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(twspin),
                               sat_cfg_get_int_def
                               (SAT_CFG_INT_PRED_TWILIGHT_THLD));
@@ -272,20 +283,41 @@ GtkWidget      *sat_pref_conditions_create()
                      G_CALLBACK(spin_changed_cb), NULL);
     gtk_grid_attach(GTK_GRID(table), nument, 1, 8, 1, 1);
 
+    /* AOS/LOS tolerance */
+    label = gtk_label_new(_("AOS/LOS time tolerance"));
+    g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 9, 1, 1);
+    evtol = gtk_spin_button_new_with_range(1, 10000, 10);
+    gtk_widget_set_tooltip_text(evtol,
+                                _("The AOS and LOS times are calculated "
+                                  "with this accuracy. A larger value "
+                                  "requires fewer orbit calculations."));
+    gtk_spin_button_set_digits(GTK_SPIN_BUTTON(evtol), 0);
+    gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(evtol), TRUE);
+    gtk_spin_button_set_wrap(GTK_SPIN_BUTTON(evtol), FALSE);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(evtol),
+                              sat_cfg_get_int(SAT_CFG_INT_PRED_EVENT_TOL));
+    g_signal_connect(G_OBJECT(evtol), "value-changed",
+                     G_CALLBACK(spin_changed_cb), NULL);
+    gtk_grid_attach(GTK_GRID(table), evtol, 1, 9, 1, 1);
+    label = gtk_label_new(_("[msec]"));
+    g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 2, 9, 1, 1);
+
     gtk_grid_attach(GTK_GRID(table),
                      gtk_separator_new(GTK_ORIENTATION_HORIZONTAL),
-                     0, 9, 3, 1);
+                     0, 10, 3, 1);
 
     /* satellite visibility */
     label = gtk_label_new(NULL);
     gtk_label_set_markup(GTK_LABEL(label), _("<b>Satellite Visibility:</b>"));
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 0, 10, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 11, 1, 1);
 
     /* twilight threshold */
     label = gtk_label_new(_("Twilight threshold"));
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 0, 11, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 12, 1, 1);
     twspin = gtk_spin_button_new_with_range(-18, 0, 1);
     gtk_widget_set_tooltip_text(twspin,
                                 _("Satellites are only considered "
@@ -301,14 +333,14 @@ GtkWidget      *sat_pref_conditions_create()
                               sat_cfg_get_int(SAT_CFG_INT_PRED_TWILIGHT_THLD));
     g_signal_connect(G_OBJECT(twspin), "value-changed",
                      G_CALLBACK(spin_changed_cb), NULL);
-    gtk_grid_attach(GTK_GRID(table), twspin, 1, 11, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), twspin, 1, 12, 1, 1);
     label = gtk_label_new(_("[deg]"));
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 2, 11, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), label, 2, 12, 1, 1);
 
     gtk_grid_attach(GTK_GRID(table),
                     gtk_separator_new(GTK_ORIENTATION_HORIZONTAL),
-                    0, 12, 3, 1);
+                    0, 13, 3, 1);
 
     /* T0 for predictions */
     tzero = gtk_check_button_new_with_label(_("Always use real time for "
@@ -327,7 +359,7 @@ GtkWidget      *sat_pref_conditions_create()
     g_signal_connect(G_OBJECT(tzero), "toggled", G_CALLBACK(spin_changed_cb),
                      NULL);
 
-    gtk_grid_attach(GTK_GRID(table), tzero, 0, 13, 3, 1);
+    gtk_grid_attach(GTK_GRID(table), tzero, 0, 14, 3, 1);
 
     vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
     gtk_box_set_homogeneous(GTK_BOX(vbox), FALSE);
@@ -24,6 +24,7 @@
 
 #include "compat.h"
 #include "gpredict-utils.h"
+#include "predict-tools.h"
 #include "sat-cfg.h"
 #include "sat-pref-debug.h"
 
@@ -32,8 +33,22 @@
 #define SEC_PER_WEEK        604800
 #define SEC_PER_MONTH       18144000
 
+/* Columns of the AOS/LOS search statistics */
+enum {
+    STATS_COL_CATNUM = 0,
+    STATS_COL_NAME,
+    STATS_COL_SEARCHES,
+    STATS_COL_EXHAUSTED,
+    STATS_COL_CALLS,            /* average per search */
+    STATS_COL_MAX_CALLS,
+    STATS_COL_STEPS,            /* average per search */
+    STATS_COL_TIME,             /* total in msec */
+    STATS_COL_NUMBER
+};
+
 static GtkWidget *level;
 static GtkWidget *age;
+static GtkWidget *stats;
 
 static gboolean dirty = FALSE;
 static gboolean reset = FALSE;
@@ -149,6 +164,138 @@ static void reset_cb(GtkWidget * button, gpointer data)
     dirty = FALSE;
 }
 
+/* Reload the AOS/LOS search statistics from predict-tools. */
+static void fill_stats(GtkListStore * store)
+{
+    GArray         *array = predict_event_sat_stats();
+    event_sat_stats_t *entry;
+    GtkTreeIter     item;
+    guint           i;
+
+    gtk_list_store_clear(store);
+
+    for (i = 0; i < array->len; i++)
+    {
+        entry = &g_array_index(array, event_sat_stats_t, i);
+
+        gtk_list_store_append(store, &item);
+        gtk_list_store_set(store, &item,
+                           STATS_COL_CATNUM, entry->catnr,
+                           STATS_COL_NAME, entry->name,
+                           STATS_COL_SEARCHES, entry->searches,
+                           STATS_COL_EXHAUSTED, entry->exhausted,
+                           STATS_COL_CALLS,
+                           (gdouble) entry->calls / entry->searches,
+                           STATS_COL_MAX_CALLS, entry->max_calls,
+                           STATS_COL_STEPS,
+                           (gdouble) entry->steps / entry->searches,
+                           STATS_COL_TIME, entry->usec / 1000.0, -1);
+    }
+
+    g_array_unref(array);
+}
+
+/* Render averages and times with one decimal. */
+static void stats_cell_data_function(GtkTreeViewColumn * col,
+                                     GtkCellRenderer * renderer,
+                                     GtkTreeModel * model,
+                                     GtkTreeIter * iter, gpointer column)
+{
+    gdouble         number;
+    gchar          *buff;
+
+    (void)col;
+
+    gtk_tree_model_get(model, iter, GPOINTER_TO_UINT(column), &number, -1);
+    buff = g_strdup_printf("%.1f", number);
+    g_object_set(renderer, "text", buff, NULL);
+    g_free(buff);
+}
+
+static void stats_refresh_cb(GtkWidget * button, gpointer data)
+{
+    (void)button;
+    (void)data;
+
+    fill_stats(GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(stats))));
+}
+
+static void stats_clear_cb(GtkWidget * button, gpointer data)
+{
+    (void)button;
+    (void)data;
+
+    predict_event_sat_stats_clear();
+    fill_stats(GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(stats))));
+}
+
+/*
+ * Create the list of AOS/LOS search statistics.
+ *
+ * The list shows the cost of the AOS/LOS searches for each satellite, with
+ * the most expensive satellites first, so that satellites with TLEs that
+ * make the searches run out of orbit calculations can be found.
+ */
+static GtkWidget *create_stats_list(void)
+{
+    GtkListStore   *store;
+    GtkCellRenderer *renderer;
+    GtkTreeViewColumn *column;
+    guint           i;
+
+    const gchar    *titles[STATS_COL_NUMBER] = {
+        N_("Catnum"),
+        N_("Satellite"),
+        N_("Searches"),
+        N_("Exhausted"),
+        N_("Calc/search"),
+        N_("Max calc"),
+        N_("Iter/search"),
+        N_("Time [ms]")
+    };
+
+    store = gtk_list_store_new(STATS_COL_NUMBER, G_TYPE_INT, G_TYPE_STRING,
+                               G_TYPE_UINT, G_TYPE_UINT, G_TYPE_DOUBLE,
+                               G_TYPE_UINT, G_TYPE_DOUBLE, G_TYPE_DOUBLE);
+    fill_stats(store);
+    gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(store),
+                                         STATS_COL_TIME,
+                                         GTK_SORT_DESCENDING);
+
+    stats = gtk_tree_view_new_with_model(GTK_TREE_MODEL(store));
+    g_object_unref(store);
+    gtk_widget_set_tooltip_text(stats,
+                                _("Exhausted searches ran out of orbit "
+                                  "calculations before the AOS or LOS was "
+                                  "found. Satellites with many of them slow "
+                                  "down the modules that track them."));
+
+    for (i = 0; i < STATS_COL_NUMBER; i++)
+    {
+        renderer = gtk_cell_renderer_text_new();
+        if (i != STATS_COL_NAME)
+            g_object_set(G_OBJECT(renderer), "xalign", 1.0, NULL);
+
+        column = gtk_tree_view_column_new_with_attributes(_(titles[i]),
+                                                          renderer,
+                                                          "text", i, NULL);
+        gtk_tree_view_column_set_sort_column_id(column, i);
+        if (i == STATS_COL_NAME)
+            gtk_tree_view_column_set_expand(column, TRUE);
+
+        if (i == STATS_COL_CALLS || i == STATS_COL_STEPS ||
+            i == STATS_COL_TIME)
+            gtk_tree_view_column_set_cell_data_func(column, renderer,
+                                                    stats_cell_data_function,
+                                                    GUINT_TO_POINTER(i),
+                                                    NULL);
+
+        gtk_tree_view_insert_column(GTK_TREE_VIEW(stats), column, -1);
+    }
+
+    return stats;
+}
+
 GtkWidget      *sat_pref_debug_create()
 {
     GtkWidget      *vbox;       /* vbox containing the list part and the details part */
@@ -156,6 +303,8 @@ GtkWidget      *sat_pref_debug_create()
     GtkWidget      *rbut;
     GtkWidget      *label;
     GtkWidget      *butbox;
+    GtkWidget      *swin;
+    GtkWidget      *button;
     gchar          *msg;
     gchar          *confdir;
 
@@ -237,6 +386,38 @@ GtkWidget      *sat_pref_debug_create()
     gtk_label_set_line_wrap(GTK_LABEL(label), TRUE);
     g_free(msg);
 
+    /* separator */
+    gtk_box_pack_start(GTK_BOX(vbox),
+                       gtk_separator_new(GTK_ORIENTATION_HORIZONTAL),
+                       FALSE, FALSE, 0);
+
+    /* AOS/LOS search statistics */
+    label = gtk_label_new(_("Cost of the AOS/LOS calculations per satellite:"));
+    g_object_set(label, "xalign", 0.0f, NULL);
+    gtk_box_pack_start(GTK_BOX(vbox), label, FALSE, FALSE, 0);
+
+    swin = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(swin),
+                                   GTK_POLICY_AUTOMATIC,
+                                   GTK_POLICY_AUTOMATIC);
+    gtk_container_add(GTK_CONTAINER(swin), create_stats_list());
+    gtk_box_pack_start(GTK_BOX(vbox), swin, TRUE, TRUE, 0);
+
+    hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+    button = gtk_button_new_with_label(_("Refresh"));
+    gtk_widget_set_tooltip_text(button,
+                                _("Show the latest AOS/LOS statistics."));
+    g_signal_connect(G_OBJECT(button), "clicked",
+                     G_CALLBACK(stats_refresh_cb), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+    button = gtk_button_new_with_label(_("Clear"));
+    gtk_widget_set_tooltip_text(button,
+                                _("Reset the AOS/LOS statistics."));
+    g_signal_connect(G_OBJECT(button), "clicked",
+                     G_CALLBACK(stats_clear_cb), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
     /* reset button */
     rbut = gtk_button_new_with_label(_("Reset"));
     gtk_widget_set_tooltip_text(rbut,
@@ -29,6 +29,8 @@
 
 
 static GtkWidget *dataspin;     /* spin button for module refresh rate */
+static GtkWidget *threadspin;   /* spin button for number of update threads */
+static GtkWidget *ephemcheck;   /* check button for the ephemeris cache */
 static GtkWidget *listspin;     /* spin button for list view */
 static GtkWidget *mapspin;      /* spin button for map view */
 static GtkWidget *polarspin;    /* spin button for polar view */
@@ -59,6 +61,18 @@ void sat_pref_refresh_ok(GKeyFile * cfg)
                                    gtk_spin_button_get_value_as_int
                                    (GTK_SPIN_BUTTON(dataspin)));
 
+            g_key_file_set_integer(cfg,
+                                   MOD_CFG_GLOBAL_SECTION,
+                                   MOD_CFG_THREADS_KEY,
+                                   gtk_spin_button_get_value_as_int
+                                   (GTK_SPIN_BUTTON(threadspin)));
+
+            g_key_file_set_boolean(cfg,
+                                   MOD_CFG_GLOBAL_SECTION,
+                                   MOD_CFG_EPHEM_KEY,
+                                   gtk_toggle_button_get_active
+                                   (GTK_TOGGLE_BUTTON(ephemcheck)));
+
             g_key_file_set_integer(cfg,
                                    MOD_CFG_LIST_SECTION,
                                    MOD_CFG_LIST_REFRESH,
@@ -89,6 +103,14 @@ void sat_pref_refresh_ok(GKeyFile * cfg)
                             gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON
                                                              (dataspin)));
 
+            sat_cfg_set_int(SAT_CFG_INT_MODULE_THREADS,
+                            gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON
+                                                             (threadspin)));
+
+            sat_cfg_set_bool(SAT_CFG_BOOL_MODULE_EPHEM_CACHE,
+                             gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON
+                                                          (ephemcheck)));
+
             sat_cfg_set_int(SAT_CFG_INT_LIST_REFRESH,
                             gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON
                                                              (listspin)));
@@ -113,6 +135,8 @@ void sat_pref_refresh_ok(GKeyFile * cfg)
         {
             /* reset values in sat-cfg */
             sat_cfg_reset_int(SAT_CFG_INT_MODULE_TIMEOUT);
+            sat_cfg_reset_int(SAT_CFG_INT_MODULE_THREADS);
+            sat_cfg_reset_bool(SAT_CFG_BOOL_MODULE_EPHEM_CACHE);
             sat_cfg_reset_int(SAT_CFG_INT_LIST_REFRESH);
             sat_cfg_reset_int(SAT_CFG_INT_MAP_REFRESH);
             sat_cfg_reset_int(SAT_CFG_INT_POLAR_REFRESH);
@@ -124,6 +148,12 @@ void sat_pref_refresh_ok(GKeyFile * cfg)
             g_key_file_remove_key((GKeyFile *) (cfg),
                                   MOD_CFG_GLOBAL_SECTION,
                                   MOD_CFG_TIMEOUT_KEY, NULL);
+            g_key_file_remove_key((GKeyFile *) (cfg),
+                                  MOD_CFG_GLOBAL_SECTION,
+                                  MOD_CFG_THREADS_KEY, NULL);
+            g_key_file_remove_key((GKeyFile *) (cfg),
+                                  MOD_CFG_GLOBAL_SECTION,
+                                  MOD_CFG_EPHEM_KEY, NULL);
             g_key_file_remove_key((GKeyFile *) (cfg),
                                   MOD_CFG_LIST_SECTION,
                                   MOD_CFG_LIST_REFRESH, NULL);
@@ -174,6 +204,11 @@ static void reset_cb(GtkWidget * button, gpointer cfg)
         /* global mode, get defaults */
         val = sat_cfg_get_int_def(SAT_CFG_INT_MODULE_TIMEOUT);
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(dataspin), val);
+        val = sat_cfg_get_int_def(SAT_CFG_INT_MODULE_THREADS);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(threadspin), val);
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(ephemcheck),
+                                     sat_cfg_get_bool_def
+                                     (SAT_CFG_BOOL_MODULE_EPHEM_CACHE));
         val = sat_cfg_get_int_def(SAT_CFG_INT_LIST_REFRESH);
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(listspin), val);
         val = sat_cfg_get_int_def(SAT_CFG_INT_MAP_REFRESH);
@@ -188,6 +223,11 @@ static void reset_cb(GtkWidget * button, gpointer cfg)
         /* local mode, get global value */
         val = sat_cfg_get_int(SAT_CFG_INT_MODULE_TIMEOUT);
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(dataspin), val);
+        val = sat_cfg_get_int(SAT_CFG_INT_MODULE_THREADS);
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(threadspin), val);
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(ephemcheck),
+                                     sat_cfg_get_bool
+                                     (SAT_CFG_BOOL_MODULE_EPHEM_CACHE));
         val = sat_cfg_get_int(SAT_CFG_INT_LIST_REFRESH);
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(listspin), val);
         val = sat_cfg_get_int(SAT_CFG_INT_MAP_REFRESH);
@@ -275,13 +315,79 @@ GtkWidget      *sat_pref_refresh_create(GKeyFile * cfg)
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
     gtk_grid_attach(GTK_GRID(table), label, 2, 0, 1, 1);
 
+    /* number of update threads */
+    label = gtk_label_new(_("Update satellites using"));
+    g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 1, 1, 1);
+
+    threadspin = gtk_spin_button_new_with_range(0, 64, 1);
+    gtk_spin_button_set_increments(GTK_SPIN_BUTTON(threadspin), 1, 4);
+    gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(threadspin), TRUE);
+    gtk_spin_button_set_update_policy(GTK_SPIN_BUTTON(threadspin),
+                                      GTK_UPDATE_IF_VALID);
+    gtk_widget_set_tooltip_text(threadspin,
+                                _("Number of threads used to update the "
+                                  "satellites in a module. Use 0 to create "
+                                  "one thread per CPU and 1 to do all the "
+                                  "work in the main thread.\n"
+                                  "The change takes effect when the module "
+                                  "is reopened."));
+    if (cfg != NULL)
+    {
+        val = mod_cfg_get_int(cfg,
+                              MOD_CFG_GLOBAL_SECTION,
+                              MOD_CFG_THREADS_KEY, SAT_CFG_INT_MODULE_THREADS);
+    }
+    else
+    {
+        val = sat_cfg_get_int(SAT_CFG_INT_MODULE_THREADS);
+    }
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(threadspin), val);
+    g_signal_connect(G_OBJECT(threadspin), "value-changed",
+                     G_CALLBACK(spin_changed_cb), NULL);
+    gtk_grid_attach(GTK_GRID(table), threadspin, 1, 1, 1, 1);
+
+    label = gtk_label_new(_("[threads]"));
+    g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 2, 1, 1, 1);
+
+    /* ephemeris cache */
+    ephemcheck = gtk_check_button_new_with_label(_("Use fast approximate "
+                                                   "orbits when not in real "
+                                                   "time"));
+    gtk_widget_set_tooltip_text(ephemcheck,
+                                _("When the time controller runs faster or "
+                                  "slower than real time, calculate the "
+                                  "satellite positions from polynomials "
+                                  "fitted to the orbits. This is much faster "
+                                  "and accurate to about 30 m. Satellites "
+                                  "used for radio or rotator control are "
+                                  "always calculated exactly."));
+    if (cfg != NULL)
+    {
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(ephemcheck),
+                                     mod_cfg_get_bool(cfg,
+                                                      MOD_CFG_GLOBAL_SECTION,
+                                                      MOD_CFG_EPHEM_KEY,
+                                                      SAT_CFG_BOOL_MODULE_EPHEM_CACHE));
+    }
+    else
+    {
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(ephemcheck),
+                                     sat_cfg_get_bool
+                                     (SAT_CFG_BOOL_MODULE_EPHEM_CACHE));
+    }
+    g_signal_connect(G_OBJECT(ephemcheck), "toggled",
+                     G_CALLBACK(spin_changed_cb), NULL);
+    gtk_grid_attach(GTK_GRID(table), ephemcheck, 0, 2, 3, 1);
+
     gtk_grid_attach(GTK_GRID(table),
-                    gtk_separator_new(GTK_ORIENTATION_HORIZONTAL), 0, 1, 3, 1);
+                    gtk_separator_new(GTK_ORIENTATION_HORIZONTAL), 0, 3, 3, 1);
 
     /* List View */
     label = gtk_label_new(_("Refresh list view every"));
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 0, 2, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 4, 1, 1);
 
     listspin = gtk_spin_button_new_with_range(1, 50, 1);
     gtk_spin_button_set_increments(GTK_SPIN_BUTTON(listspin), 1, 5);
@@ -301,16 +407,16 @@ GtkWidget      *sat_pref_refresh_create(GKeyFile * cfg)
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(listspin), val);
     g_signal_connect(G_OBJECT(listspin), "value-changed",
                      G_CALLBACK(spin_changed_cb), NULL);
-    gtk_grid_attach(GTK_GRID(table), listspin, 1, 2, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), listspin, 1, 4, 1, 1);
 
     label = gtk_label_new(_("[cycle]"));
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 2, 2, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), label, 2, 4, 1, 1);
 
     /* Map View */
     label = gtk_label_new(_("Refresh map view every"));
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 0, 3, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 5, 1, 1);
 
     mapspin = gtk_spin_button_new_with_range(1, 50, 1);
     gtk_spin_button_set_increments(GTK_SPIN_BUTTON(mapspin), 1, 5);
@@ -330,16 +436,16 @@ GtkWidget      *sat_pref_refresh_create(GKeyFile * cfg)
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(mapspin), val);
     g_signal_connect(G_OBJECT(mapspin), "value-changed",
                      G_CALLBACK(spin_changed_cb), NULL);
-    gtk_grid_attach(GTK_GRID(table), mapspin, 1, 3, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), mapspin, 1, 5, 1, 1);
 
     label = gtk_label_new(_("[cycle]"));
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 2, 3, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), label, 2, 5, 1, 1);
 
     /* Polar View */
     label = gtk_label_new(_("Refresh polar view every"));
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 0, 4, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 6, 1, 1);
 
     polarspin = gtk_spin_button_new_with_range(1, 50, 1);
     gtk_spin_button_set_increments(GTK_SPIN_BUTTON(polarspin), 1, 5);
@@ -360,16 +466,16 @@ GtkWidget      *sat_pref_refresh_create(GKeyFile * cfg)
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(polarspin), val);
     g_signal_connect(G_OBJECT(polarspin), "value-changed",
                      G_CALLBACK(spin_changed_cb), NULL);
-    gtk_grid_attach(GTK_GRID(table), polarspin, 1, 4, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), polarspin, 1, 6, 1, 1);
 
     label = gtk_label_new(_("[cycle]"));
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 2, 4, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), label, 2, 6, 1, 1);
 
     /* Single-Sat View */
     label = gtk_label_new(_("Refresh single-sat view every"));
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 0, 5, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 7, 1, 1);
 
     singlespin = gtk_spin_button_new_with_range(1, 50, 1);
     gtk_spin_button_set_increments(GTK_SPIN_BUTTON(singlespin), 1, 5);
@@ -390,11 +496,11 @@ GtkWidget      *sat_pref_refresh_create(GKeyFile * cfg)
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(singlespin), val);
     g_signal_connect(G_OBJECT(singlespin), "value-changed",
                      G_CALLBACK(spin_changed_cb), NULL);
-    gtk_grid_attach(GTK_GRID(table), singlespin, 1, 5, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), singlespin, 1, 7, 1, 1);
 
     label = gtk_label_new(_("[cycle]"));
     g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
-    gtk_grid_attach(GTK_GRID(table), label, 2, 5, 1, 1);
+    gtk_grid_attach(GTK_GRID(table), label, 2, 7, 1, 1);
 
     /* create vertical box */
     vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
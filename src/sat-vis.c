@@ -32,6 +32,7 @@
 #include "gtk-sat-data.h"
 #include "sat-vis.h"
 #include "sat-cfg.h"
+#include "qth-data.h"
 
 
 static gchar VIS2CHR[SAT_VIS_NUM] = { '-', 'V', 'D', 'E'};
@@ -45,64 +46,212 @@ static gchar *VIS2STR[SAT_VIS_NUM] = {
 
 
 
+/** \brief Time between the nodes of the solar cache in get_sat_vis_batch().
+ *
+ * The sun elevation is interpolated linearly between the nodes. With 5
+ * minutes the error is below 0.005 degrees, while the error of the solar ECI
+ * position does not matter for the eclipse calculation.
+ */
+#define SUN_NODE_STEP (5.0 / 1440.0)
+
+
+/** \brief The sun seen from the QTH at the last time used by get_sat_vis(). */
+static sat_vis_sun_t sun_cache;
+static qth_small_t   sun_cache_qth;
+static gdouble       sun_cache_thld;   /* twilight threshold read with the sun */
+
+G_LOCK_DEFINE_STATIC (sun_cache);
+
+
+
+/** \brief Set up an observer frame for the QTH.
+ *  \param frame The frame to set up.
+ *  \param qth The QTH
+ */
+static void
+sun_frame_init (obs_frame_t *frame, qth_t *qth)
+{
+    geodetic_t obs_geodetic;
+
+    obs_geodetic.lon = qth->lon * de2ra;
+    obs_geodetic.lat = qth->lat * de2ra;
+    obs_geodetic.alt = qth->alt / 1000.0;
+    obs_geodetic.theta = 0;
+
+    Initialize_Frame (frame, &obs_geodetic);
+}
+
+
+/** \brief Calculate the position of the sun.
+ *  \param frame Observer frame of the QTH.
+ *  \param jul_utc The time.
+ *  \param sun Location to store the result.
+ */
+static void
+sun_calc (obs_frame_t *frame, gdouble jul_utc, sat_vis_sun_t *sun)
+{
+    vector_t zero_vector = {0,0,0,0};
+    obs_set_t solar_set;
+
+    sun->jul_utc = jul_utc;
+    Calculate_Solar_Position (jul_utc, &sun->pos);
+
+    Set_Frame_Time (frame, jul_utc);
+    Calculate_Obs_Frame (frame, &sun->pos, &zero_vector, &solar_set);
+    sun->el = Degrees (solar_set.el);
+}
+
+
+/** \brief Classify a satellite position.
+ *  \param pos The satellite ECI position.
+ *  \param el The satellite elevation in degrees.
+ *  \param sun The sun at the same time.
+ *  \param threshold The twilight threshold in degrees.
+ */
+static sat_vis_t
+sat_vis_calc (vector_t *pos, gdouble el, sat_vis_sun_t *sun,
+              gdouble threshold)
+{
+    gdouble eclipse_depth;
+
+    if (Sat_Eclipsed (pos, &sun->pos, &eclipse_depth)) {
+        /* satellite is eclipsed */
+        return SAT_VIS_ECLIPSED;
+    }
+
+    /* satellite in sunlight => may be visible */
+    if (sun->el <= threshold && el >= 0.0)
+        return SAT_VIS_VISIBLE;
+
+    return SAT_VIS_DAYLIGHT;
+}
+
+
 /** \brief Calculate satellite visibility.
  *  \param sat The satellite structure.
  *  \param qth The QTH
  *  \param jul_utc The time at which the visibility should be calculated.
  *  \return The visibility code.
  *
+ * The sun and the twilight threshold are only updated when the time or the
+ * QTH differs from the previous call, so the views calling this for each
+ * satellite at the same time share the solar position and read sat-cfg once.
+ * Since the threshold comes from sat-cfg this must be called from the main
+ * thread; use get_sat_vis_batch() elsewhere.
  */
 sat_vis_t
 get_sat_vis (sat_t *sat, qth_t *qth, gdouble jul_utc)
 {
-    gboolean sat_sun_status;
-    gdouble  sun_el;
-    gdouble  threshold;
-    gdouble  eclipse_depth;
-    sat_vis_t vis = SAT_VIS_NONE;
-    vector_t zero_vector = {0,0,0,0};
-    geodetic_t obs_geodetic;
+    sat_vis_sun_t sun;
+    obs_frame_t   frame;
+    gboolean      cached;
+    gdouble       threshold;
 
-    /* Solar ECI position vector  */
-    vector_t solar_vector=zero_vector;
+    G_LOCK (sun_cache);
+    cached = (sun_cache.jul_utc == jul_utc) &&
+        (sun_cache_qth.lat == qth->lat) &&
+        (sun_cache_qth.lon == qth->lon) &&
+        (sun_cache_qth.alt == qth->alt);
+    sun = sun_cache;
+    threshold = sun_cache_thld;
+    G_UNLOCK (sun_cache);
 
-    /* Solar observed az and el vector  */
-    obs_set_t solar_set;
+    if (!cached) {
+        sun_frame_init (&frame, qth);
+        sun_calc (&frame, jul_utc, &sun);
+        threshold = (gdouble) sat_cfg_get_int (SAT_CFG_INT_PRED_TWILIGHT_THLD);
 
-    /* FIXME: could be passed as parameter */
-    obs_geodetic.lon = qth->lon * de2ra;
-    obs_geodetic.lat = qth->lat * de2ra;
-    obs_geodetic.alt = qth->alt / 1000.0;
-    obs_geodetic.theta = 0;
+        G_LOCK (sun_cache);
+        sun_cache = sun;
+        sun_cache_thld = threshold;
+        qth_small_save (qth, &sun_cache_qth);
+        G_UNLOCK (sun_cache);
+    }
 
+    return sat_vis_calc (&sat->pos, sat->el, &sun, threshold);
+}
 
-    Calculate_Solar_Position (jul_utc, &solar_vector);
-    Calculate_Obs (jul_utc, &solar_vector, &zero_vector, &obs_geodetic, &solar_set);
 
-    if (Sat_Eclipsed (&sat->pos, &solar_vector, &eclipse_depth)) {
-        /* satellite is eclipsed */
-        sat_sun_status = FALSE;
-    }
-    else {
-        /* satellite in sunlight => may be visible */
-        sat_sun_status = TRUE;
+/** \brief Forget the sun and twilight threshold cached by get_sat_vis().
+ *
+ * Must be called when the twilight threshold has been changed in sat-cfg,
+ * since get_sat_vis() only reads it again when the time or the QTH changes.
+ */
+void
+sat_vis_cache_clear (void)
+{
+    G_LOCK (sun_cache);
+    sun_cache.jul_utc = 0.0;
+    G_UNLOCK (sun_cache);
+}
+
+
+/** \brief Calculate the visibility of many satellite positions.
+ *  \param qth The QTH
+ *  \param points The positions to classify.
+ *  \param num The number of points.
+ *  \param threshold The twilight threshold in degrees.
+ *
+ * Gives the same result as calling get_sat_vis() for each point, except that
+ * the sun is calculated on a grid of SUN_NODE_STEP covering the points and
+ * interpolated between the grid nodes. The points would typically be the
+ * details of a pass. The grid is only used if it has fewer nodes than there
+ * are points, otherwise the sun is calculated for each point. The threshold
+ * is passed in, so this can be used outside the main thread.
+ */
+void
+get_sat_vis_batch (qth_t *qth, sat_vis_point_t *points, guint num,
+                   gdouble threshold)
+{
+    sat_vis_sun_t *nodes;
+    sat_vis_sun_t  sun;
+    obs_frame_t    frame;
+    gdouble        tmin, tmax, x;
+    guint          i, j, num_nodes;
+
+    if (num == 0)
+        return;
+
+    sun_frame_init (&frame, qth);
+
+    tmin = tmax = points[0].time;
+    for (i = 1; i < num; i++) {
+        tmin = MIN (tmin, points[i].time);
+        tmax = MAX (tmax, points[i].time);
     }
 
+    num_nodes = (guint) ceil ((tmax - tmin) / SUN_NODE_STEP) + 1;
 
-    if (sat_sun_status) {
-        sun_el = Degrees (solar_set.el);
-        threshold = (gdouble) sat_cfg_get_int (SAT_CFG_INT_PRED_TWILIGHT_THLD);
-        
-        if (sun_el <= threshold && sat->el >= 0.0)
-            vis = SAT_VIS_VISIBLE;
-        else
-            vis = SAT_VIS_DAYLIGHT;
+    if (num_nodes >= num) {
+        for (i = 0; i < num; i++) {
+            sun_calc (&frame, points[i].time, &sun);
+            points[i].vis = sat_vis_calc (&points[i].pos, points[i].el,
+                                          &sun, threshold);
+        }
+        return;
     }
-    else
-        vis = SAT_VIS_ECLIPSED;
 
+    nodes = g_new (sat_vis_sun_t, num_nodes);
+    for (j = 0; j < num_nodes; j++)
+        sun_calc (&frame, tmin + j * SUN_NODE_STEP, &nodes[j]);
+
+    for (i = 0; i < num; i++) {
+        x = (points[i].time - tmin) / SUN_NODE_STEP;
+        j = MIN ((guint) x, num_nodes - 2);
+        x -= j;
+
+        sun.jul_utc = points[i].time;
+        sun.pos.x = nodes[j].pos.x + x * (nodes[j+1].pos.x - nodes[j].pos.x);
+        sun.pos.y = nodes[j].pos.y + x * (nodes[j+1].pos.y - nodes[j].pos.y);
+        sun.pos.z = nodes[j].pos.z + x * (nodes[j+1].pos.z - nodes[j].pos.z);
+        Magnitude (&sun.pos);
+        sun.el = nodes[j].el + x * (nodes[j+1].el - nodes[j].el);
+
+        points[i].vis = sat_vis_calc (&points[i].pos, points[i].el,
+                                      &sun, threshold);
+    }
 
-    return vis;
+    g_free (nodes);
 }
 
 
@@ -49,7 +49,27 @@ typedef enum {
 
 
 
+/** \brief The sun seen from a QTH. */
+typedef struct {
+     gdouble   jul_utc;    /*!< Time. */
+     vector_t  pos;        /*!< Solar ECI position. */
+     gdouble   el;         /*!< Solar elevation at the QTH in degrees. */
+} sat_vis_sun_t;
+
+/** \brief Satellite position for get_sat_vis_batch(). */
+typedef struct {
+     gdouble   time;       /*!< Time in "jul_utc". */
+     vector_t  pos;        /*!< Satellite ECI position, as in sat_t. */
+     gdouble   el;         /*!< Satellite elevation in degrees. */
+     sat_vis_t vis;        /*!< Calculated visibility. */
+} sat_vis_point_t;
+
+
+
 sat_vis_t  get_sat_vis (sat_t *sat, qth_t *qth, gdouble jul_utc);
+void       get_sat_vis_batch (qth_t *qth, sat_vis_point_t *points, guint num,
+                              gdouble threshold);
+void       sat_vis_cache_clear (void);
 gchar      vis_to_chr  (sat_vis_t vis);
 gchar     *vis_to_str  (sat_vis_t vis);
 
@@ -48,8 +48,12 @@ static void     save_passes_exec(GtkWidget * parent,
                                  GSList * passes, qth_t * qth,
                                  const gchar * savedir, const gchar * savefile,
                                  gint format, gint contents);
-static void     save_to_file(GtkWidget * parent, const gchar * fname,
-                             const gchar * data);
+static GOutputStream *create_file(GtkWidget * parent, const gchar * fname,
+                                  GCancellable * cancel);
+static void     close_file(GtkWidget * parent, const gchar * fname,
+                           GOutputStream * out, GCancellable * cancel,
+                           GError * err);
+static GtkWidget *create_format_selector(void);
 
 enum pass_content_e {
     PASS_CONTENT_ALL = 0,
@@ -62,7 +66,13 @@ enum passes_content_e {
     PASSES_CONTENT_SUM,
 };
 
-#define SAVE_FORMAT_TXT     0
+/* the formats are the output formats of pass_writer_t */
+#define SAVE_FORMAT_TXT     PASS_WRITER_TXT
+#define SAVE_FORMAT_CSV     PASS_WRITER_CSV
+#define SAVE_FORMAT_BIN     PASS_WRITER_BIN
+
+/* file name extension of each format */
+static const gchar *SAVE_EXT[] = { ".txt", ".csv", ".dat" };
 
 /**
  * Save a satellite pass.
@@ -86,6 +96,7 @@ void save_pass(GtkWidget * parent)
     GtkWidget      *dirchooser;
     GtkWidget      *filchooser;
     GtkWidget      *contents;
+    GtkWidget      *format;
     GtkWidget      *label;
     gint            response;
     pass_t         *pass;
@@ -93,6 +104,7 @@ void save_pass(GtkWidget * parent)
     gchar          *savedir = NULL;
     gchar          *savefile;
     gint            cont;
+    gint            fmt;
 
 
     /* get data attached to parent */
@@ -172,6 +184,15 @@ void save_pass(GtkWidget * parent)
                              sat_cfg_get_int(SAT_CFG_INT_PRED_SAVE_CONTENTS));
     gtk_grid_attach(GTK_GRID(grid), contents, 1, 2, 1, 1);
 
+    /* file format */
+    label = gtk_label_new(_("File format:"));
+    g_object_set(G_OBJECT(label), "halign", GTK_ALIGN_START,
+                 "valign", GTK_ALIGN_CENTER, NULL);
+    gtk_grid_attach(GTK_GRID(grid), label, 0, 3, 1, 1);
+
+    format = create_format_selector();
+    gtk_grid_attach(GTK_GRID(grid), format, 1, 3, 1, 1);
+
     gtk_widget_show_all(grid);
     gtk_container_add(GTK_CONTAINER
                       (gtk_dialog_get_content_area(GTK_DIALOG(dialog))), grid);
@@ -188,13 +209,14 @@ void save_pass(GtkWidget * parent)
         savedir = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dirchooser));
         savefile = g_strdup(gtk_entry_get_text(GTK_ENTRY(filchooser)));
         cont = gtk_combo_box_get_active(GTK_COMBO_BOX(contents));
+        fmt = gtk_combo_box_get_active(GTK_COMBO_BOX(format));
 
         /* call saver */
-        save_pass_exec(dialog, pass, qth, savedir, savefile, SAVE_FORMAT_TXT,
-                       cont);
+        save_pass_exec(dialog, pass, qth, savedir, savefile, fmt, cont);
 
         /* store new settings */
         sat_cfg_set_str(SAT_CFG_STR_PRED_SAVE_DIR, savedir);
+        sat_cfg_set_int(SAT_CFG_INT_PRED_SAVE_FORMAT, fmt);
         sat_cfg_set_int(SAT_CFG_INT_PRED_SAVE_CONTENTS, cont);
 
         /* clean up */
@@ -233,6 +255,7 @@ void save_passes(GtkWidget * parent)
     GtkWidget      *dirchooser;
     GtkWidget      *filchooser;
     GtkWidget      *contents;
+    GtkWidget      *format;
     GtkWidget      *label;
     gint            response;
     GSList         *passes;
@@ -241,6 +264,7 @@ void save_passes(GtkWidget * parent)
     gchar          *savedir = NULL;
     gchar          *savefile;
     gint            cont;
+    gint            fmt;
 
     /* get data attached to parent */
     sat = (gchar *) g_object_get_data(G_OBJECT(parent), "sat");
@@ -315,6 +339,15 @@ void save_passes(GtkWidget * parent)
     gtk_combo_box_set_active(GTK_COMBO_BOX(contents), 0);
     gtk_grid_attach(GTK_GRID(grid), contents, 1, 2, 1, 1);
 
+    /* file format */
+    label = gtk_label_new(_("File format:"));
+    g_object_set(G_OBJECT(label), "halign", GTK_ALIGN_START,
+                 "valign", GTK_ALIGN_CENTER, NULL);
+    gtk_grid_attach(GTK_GRID(grid), label, 0, 3, 1, 1);
+
+    format = create_format_selector();
+    gtk_grid_attach(GTK_GRID(grid), format, 1, 3, 1, 1);
+
     gtk_widget_show_all(grid);
     gtk_container_add(GTK_CONTAINER
                       (gtk_dialog_get_content_area(GTK_DIALOG(dialog))), grid);
@@ -331,13 +364,14 @@ void save_passes(GtkWidget * parent)
         savedir = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dirchooser));
         savefile = g_strdup(gtk_entry_get_text(GTK_ENTRY(filchooser)));
         cont = gtk_combo_box_get_active(GTK_COMBO_BOX(contents));
+        fmt = gtk_combo_box_get_active(GTK_COMBO_BOX(format));
 
         /* call saver */
-        save_passes_exec(dialog, passes, qth, savedir, savefile,
-                         SAVE_FORMAT_TXT, cont);
+        save_passes_exec(dialog, passes, qth, savedir, savefile, fmt, cont);
 
         /* store new settings */
         sat_cfg_set_str(SAT_CFG_STR_PRED_SAVE_DIR, savedir);
+        sat_cfg_set_int(SAT_CFG_INT_PRED_SAVE_FORMAT, fmt);
 
         /* clean up */
         g_free(savedir);
@@ -351,6 +385,25 @@ void save_passes(GtkWidget * parent)
     gtk_widget_destroy(dialog);
 }
 
+/** Create the combo box for selecting the file format. */
+static GtkWidget *create_format_selector(void)
+{
+    GtkWidget      *format;
+    gint            fmt;
+
+    format = gtk_combo_box_text_new();
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(format), _("Text"));
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(format), _("CSV"));
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(format), _("Binary"));
+
+    fmt = sat_cfg_get_int(SAT_CFG_INT_PRED_SAVE_FORMAT);
+    if (fmt < SAVE_FORMAT_TXT || fmt > SAVE_FORMAT_BIN)
+        fmt = SAVE_FORMAT_TXT;
+    gtk_combo_box_set_active(GTK_COMBO_BOX(format), fmt);
+
+    return format;
+}
+
 /**
  * Manage file name changes.
  *
@@ -406,7 +459,7 @@ static void file_changed(GtkWidget * widget, gpointer data)
  * Save data to file.
  *
  * @param parent Parent window (needed for error dialogs).
- * @param pass The pass data to save.
+ * @param passes The pass data to save.
  * @param qth The observer data
  * @param savedir The directory where data should be saved.
  * @param savefile The file where data should be saved.
@@ -418,8 +471,8 @@ static void file_changed(GtkWidget * widget, gpointer data)
  * The function does some last minute checking while saving and provides
  * error messages if anything fails during the process.
  *
- * @note The formatting is done by external functions according to the selected
- *       file format.
+ * @note The formatting is done by the pass writer in pass-to-txt.c, which
+ *       writes one row at a time, so the file is never held in memory.
  */
 static void save_passes_exec(GtkWidget * parent,
                              GSList * passes, qth_t * qth,
@@ -427,77 +480,81 @@ static void save_passes_exec(GtkWidget * parent,
                              gint format, gint contents)
 {
     gchar          *fname;
-    gchar          *pgheader;
-    gchar          *tblheader;
-    gchar          *tblcontents;
-    gchar          *buff = NULL;
-    gchar          *data = NULL;
+    GOutputStream  *out;
+    GCancellable   *cancel;
+    pass_writer_t  *pw;
+    GError         *err = NULL;
+    GSList         *node;
     pass_t         *pass;
     gint            fields;
-    guint           i, n;
+    gboolean        ok;
 
-    switch (format)
+    if (format < SAVE_FORMAT_TXT || format > SAVE_FORMAT_BIN)
     {
-    case SAVE_FORMAT_TXT:
-
-        /* prepare full file name */
-        fname =
-            g_strconcat(savedir, G_DIR_SEPARATOR_S, savefile, ".txt", NULL);
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Invalid file format: %d"), __func__, format);
+        return;
+    }
 
-        /* get visible columns for summary */
-        fields = sat_cfg_get_int(SAT_CFG_INT_PRED_MULTI_COL);
+    if (passes == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: No passes to save"),
+                    __func__);
+        return;
+    }
 
-        /* create file contents */
-        pgheader = passes_to_txt_pgheader(passes, qth, fields);
-        tblheader = passes_to_txt_tblheader(passes, qth, fields);
-        tblcontents = passes_to_txt_tblcontents(passes, qth, fields);
+    /* prepare full file name */
+    fname = g_strconcat(savedir, G_DIR_SEPARATOR_S, savefile,
+                        SAVE_EXT[format], NULL);
 
-        data = g_strconcat(pgheader, tblheader, tblcontents, NULL);
+    cancel = g_cancellable_new();
+    out = create_file(parent, fname, cancel);
+    if (out == NULL)
+    {
+        g_object_unref(cancel);
+        g_free(fname);
+        return;
+    }
 
-        g_free(pgheader);
-        g_free(tblheader);
-        g_free(tblcontents);
+    pw = pass_writer_new(out, format, qth);
+    pass = PASS(passes->data);
 
-        if (contents == PASSES_CONTENT_FULL)
-        {
-            fields = sat_cfg_get_int(SAT_CFG_INT_PRED_SINGLE_COL);
-            n = g_slist_length(passes);
+    /* get visible columns for summary */
+    fields = sat_cfg_get_int(SAT_CFG_INT_PRED_MULTI_COL);
 
-            for (i = 0; i < n; i++)
-            {
+    ok = pass_writer_passes_info(pw, pass, fields, &err);
 
-                pass = PASS(g_slist_nth_data(passes, i));
+    /* binary files have the passes with the details; no need for both */
+    if (format != SAVE_FORMAT_BIN || contents != PASSES_CONTENT_FULL)
+    {
+        ok = ok && pass_writer_summary_header(pw, pass, fields, &err);
+        for (node = passes; ok && node != NULL; node = node->next)
+            ok = pass_writer_summary_row(pw, PASS(node->data), fields, &err);
+    }
 
-                tblheader = pass_to_txt_tblheader(pass, qth, fields);
-                tblcontents = pass_to_txt_tblcontents(pass, qth, fields);
-                buff = g_strdup_printf("%s\n Orbit %d\n%s%s",
-                                       data, pass->orbit,
-                                       tblheader, tblcontents);
-                g_free(data);
-                data = g_strdup(buff);
-                g_free(buff);
+    if (contents == PASSES_CONTENT_FULL)
+    {
+        fields = sat_cfg_get_int(SAT_CFG_INT_PRED_SINGLE_COL);
 
-            }
+        for (node = passes; ok && node != NULL; node = node->next)
+        {
+            pass = PASS(node->data);
+            ok = pass_writer_details_title(pw, pass, &err) &&
+                pass_writer_details_header(pw, pass, fields, &err) &&
+                pass_writer_details(pw, pass, fields, &err);
         }
-
-        /* save data */
-        save_to_file(parent, fname, data);
-        g_free(data);
-        g_free(fname);
-        break;
-
-    default:
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Invalid file format: %d"), __func__, format);
-        break;
     }
+
+    pass_writer_free(pw);
+    close_file(parent, fname, out, cancel, err);
+    g_free(fname);
 }
 
 /**
  * Save data to file.
  *
  * @param parent Parent window (needed for error dialogs).
- * @param passes The pass data to save.
+ * @param pass The pass data to save.
  * @param qth The observer data
  * @param savedir The directory where data should be saved.
  * @param savefile The file where data should be saved.
@@ -509,8 +566,8 @@ static void save_passes_exec(GtkWidget * parent,
  * The function does some last minute checking while saving and provides
  * error messages if anything fails during the process.
  *
- * @note The formatting is done by external functions according to the selected
- *       file format.
+ * @note The formatting is done by the pass writer in pass-to-txt.c, which
+ *       writes one row at a time, so the file is never held in memory.
  */
 static void save_pass_exec(GtkWidget * parent,
                            pass_t * pass, qth_t * qth,
@@ -518,95 +575,82 @@ static void save_pass_exec(GtkWidget * parent,
                            gint format, gint contents)
 {
     gchar          *fname;
-    gchar          *pgheader;
-    gchar          *tblheader;
-    gchar          *tblcontents;
-    gchar          *buff = NULL;
-    gchar          *data = NULL;
+    GOutputStream  *out;
+    GCancellable   *cancel;
+    pass_writer_t  *pw;
+    GError         *err = NULL;
     gint            fields;
+    gboolean        ok = TRUE;
 
-    switch (format)
+    if (format < SAVE_FORMAT_TXT || format > SAVE_FORMAT_BIN)
     {
-    case SAVE_FORMAT_TXT:
-
-        /* prepare full file name */
-        fname =
-            g_strconcat(savedir, G_DIR_SEPARATOR_S, savefile, ".txt", NULL);
-
-        /* get visible columns */
-        fields = sat_cfg_get_int(SAT_CFG_INT_PRED_SINGLE_COL);
-
-        /* create file contents */
-        pgheader = pass_to_txt_pgheader(pass, qth, fields);
-        tblheader = pass_to_txt_tblheader(pass, qth, fields);
-        tblcontents = pass_to_txt_tblcontents(pass, qth, fields);
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Invalid file format: %d"), __func__, format);
+        return;
+    }
 
-        /* Add page header if selected */
-        if (contents == PASS_CONTENT_ALL)
-        {
-            data = g_strdup(pgheader);
-        }
+    /* prepare full file name */
+    fname = g_strconcat(savedir, G_DIR_SEPARATOR_S, savefile,
+                        SAVE_EXT[format], NULL);
 
-        /* Add table header if selected */
-        if ((contents == PASS_CONTENT_ALL) || (contents == PASS_CONTENT_TABLE))
-        {
-            if (data != NULL)
-            {
-                buff = g_strdup(data);
-                g_free(data);
-                data = g_strconcat(buff, tblheader, NULL);
-                g_free(buff);
-            }
-            else
-            {
-                data = g_strdup(tblheader);
-            }
+    cancel = g_cancellable_new();
+    out = create_file(parent, fname, cancel);
+    if (out == NULL)
+    {
+        g_object_unref(cancel);
+        g_free(fname);
+        return;
+    }
 
-        }
+    pw = pass_writer_new(out, format, qth);
 
-        /* Add data */
-        if (data != NULL)
-        {
-            buff = g_strdup(data);
-            g_free(data);
-            data = g_strconcat(buff, tblcontents, NULL);
-            g_free(buff);
-        }
-        else
-        {
-            data = g_strdup(tblcontents);
-        }
+    /* get visible columns */
+    fields = sat_cfg_get_int(SAT_CFG_INT_PRED_SINGLE_COL);
 
-        /* save data */
-        save_to_file(parent, fname, data);
+    /* Add page header if selected */
+    if (contents == PASS_CONTENT_ALL)
+        ok = pass_writer_pass_info(pw, pass, fields, &err);
 
-        /* clean up memory */
-        g_free(fname);
-        g_free(data);
-        g_free(pgheader);
-        g_free(tblheader);
-        g_free(tblcontents);
+    /* Add table header if selected */
+    if (ok && ((contents == PASS_CONTENT_ALL) ||
+               (contents == PASS_CONTENT_TABLE)))
+        ok = pass_writer_details_header(pw, pass, fields, &err);
 
-        break;
+    /* Add data */
+    if (ok)
+        pass_writer_details(pw, pass, fields, &err);
 
-    default:
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Invalid file format: %d"), __func__, format);
-        break;
-    }
+    pass_writer_free(pw);
+    close_file(parent, fname, out, cancel, err);
+    g_free(fname);
 }
 
-static void save_to_file(GtkWidget * parent, const gchar * fname,
-                         const gchar * data)
+/**
+ * Create a file for saving passes.
+ *
+ * @param parent Parent window (needed for error dialogs).
+ * @param fname The file name.
+ * @param cancel The cancellable of the stream, see close_file().
+ * @return A buffered stream writing to the file, or NULL if the file
+ *         could not be created.
+ *
+ * An existing file is only replaced when the stream is closed.
+ */
+static GOutputStream *create_file(GtkWidget * parent, const gchar * fname,
+                                  GCancellable * cancel)
 {
-    GIOChannel     *chan;
+    GFile          *file;
+    GFileOutputStream *fout;
+    GOutputStream  *out;
     GError         *err = NULL;
     GtkWidget      *dialog;
-    gsize           count;
 
-    /* create file */
-    chan = g_io_channel_new_file(fname, "w", &err);
-    if (err != NULL)
+    file = g_file_new_for_path(fname);
+    fout = g_file_replace(file, NULL, FALSE, G_FILE_CREATE_NONE, cancel,
+                          &err);
+    g_object_unref(file);
+
+    if (fout == NULL)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s: Could not create file %s (%s)"),
@@ -626,11 +670,47 @@ static void save_to_file(GtkWidget * parent, const gchar * fname,
         /* clean up and return */
         g_clear_error(&err);
 
-        return;
+        return NULL;
     }
 
-    /* save contents to file */
-    g_io_channel_write_chars(chan, data, -1, &count, &err);
+    /* the writer writes a row at a time */
+    out = g_buffered_output_stream_new(G_OUTPUT_STREAM(fout));
+    g_object_unref(fout);
+
+    return out;
+}
+
+/**
+ * Close a file created with create_file().
+ *
+ * @param parent Parent window (needed for error dialogs).
+ * @param fname The file name.
+ * @param out The stream returned by create_file(), which is freed.
+ * @param cancel The cancellable given to create_file(), which is freed.
+ * @param err The error that occurred while writing, if any; it is freed.
+ *
+ * After an error the stream is cancelled before it is closed, so that the
+ * partly written file is dropped and an existing file is kept.
+ */
+static void close_file(GtkWidget * parent, const gchar * fname,
+                       GOutputStream * out, GCancellable * cancel,
+                       GError * err)
+{
+    GtkWidget      *dialog;
+
+    /* flush the buffer; the first error is the one reported */
+    if (err == NULL)
+    {
+        g_output_stream_close(out, cancel, &err);
+    }
+    else
+    {
+        g_cancellable_cancel(cancel);
+        g_output_stream_close(out, cancel, NULL);
+    }
+    g_object_unref(out);
+    g_object_unref(cancel);
+
     if (err != NULL)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
@@ -652,12 +732,6 @@ static void save_to_file(GtkWidget * parent, const gchar * fname,
     else
     {
         sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                    _("%s: Written %d characters to %s"),
-                    __func__, count, fname);
+                    _("%s: Saved passes to %s"), __func__, fname);
     }
-
-    /* close file, we don't care about errors here */
-    g_io_channel_shutdown(chan, TRUE, NULL);
-    g_io_channel_unref(chan);
-
 }
@@ -0,0 +1,477 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2008  Alexandru Csete.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the
+          Free Software Foundation, Inc.,
+      59 Temple Place, Suite 330,
+      Boston, MA  02111-1307
+      USA
+*/
+/* Benchmark for SGP4, SDP4, SGP4_Batch, Propagate_Series and Cheb_Propagate:
+   propagations per second
+
+   Usage: bench-001 file.tle [file.tle ...]
+
+   Each file is benchmarked as a catalog. In addition, two synthetic
+   catalogs are created around the first near-earth and the first
+   deep-space satellite found in the files, and a third one with mostly
+   geostationary, Molniya and Tundra orbits around the deep-space one.
+   The results are written to stdout as CSV:
+
+     benchmark,catalog,sats,value,unit
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <glib.h>
+#include "sgp4sdp4.h"
+
+#define BENCH_SATS 1000         /* satellites in a synthetic catalog */
+#define BENCH_TIME 500000       /* minimum duration of a benchmark in usec */
+#define BENCH_AGE  (90 * xmnpda) /* age of the elements in the scrub benchmark */
+#define BENCH_SERIES 64         /* times per Propagate_Series call */
+#define BENCH_STEP 0.504        /* time step of a ground track in minutes */
+
+/* Read all TLE sets in a file; returns the number of satellites */
+static int Read_Catalog(const char *fname, sat_t ** sats)
+{
+    FILE           *fp;
+    char            tle_str[3][80];
+    tle_t           tle;
+    int             num = 0;
+
+    *sats = NULL;
+
+    fp = fopen(fname, "r");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "Could not open %s\n", fname);
+        return 0;
+    }
+
+    while (fgets(tle_str[0], 80, fp) != NULL &&
+           fgets(tle_str[1], 80, fp) != NULL &&
+           fgets(tle_str[2], 80, fp) != NULL)
+    {
+        if (Get_Next_Tle_Set(tle_str, &tle) != 1)
+            continue;
+
+        *sats = realloc(*sats, (num + 1) * sizeof(sat_t));
+        memset(&(*sats)[num], 0, sizeof(sat_t));
+        (*sats)[num].tle = tle;
+        select_ephemeris(&(*sats)[num]);
+        (*sats)[num].jul_epoch = Julian_Date_of_Epoch(tle.epoch);
+        num++;
+    }
+    fclose(fp);
+
+    return num;
+}
+
+/* Create a catalog of BENCH_SATS orbits around a satellite */
+static sat_t   *Synthetic_Catalog(const sat_t * seed)
+{
+    sat_t          *sats;
+    tle_t           tle;
+    int             i;
+    int             deep = seed->flags & DEEP_SPACE_EPHEM_FLAG;
+
+    sats = calloc(BENCH_SATS, sizeof(sat_t));
+
+    for (i = 0; i < BENCH_SATS; i++)
+    {
+        tle = seed->tle;
+
+        /* select_ephemeris() converts the elements in place; use
+           the original TLE units again */
+        tle.xno = deep ? 1.0 + 5.0 * i / BENCH_SATS :
+            12.0 + 4.0 * i / BENCH_SATS;
+        tle.eo = deep ? 0.001 + 0.7 * (i % 10) / 10.0 :
+            0.0005 + 0.02 * (i % 8) / 8.0;
+        tle.xincl = fmod(i * 7.0, 180.0);
+        tle.xnodeo = fmod(i * 37.0, 360.0);
+        tle.omegao = fmod(i * 53.0, 360.0);
+        tle.xmo = fmod(i * 71.0, 360.0);
+        tle.xndt2o = 0.0;
+        tle.xndd6o = 0.0;
+        tle.bstar = deep ? 0.0 : 1.0E-4;
+
+        sats[i].tle = tle;
+        select_ephemeris(&sats[i]);
+        sats[i].jul_epoch = Julian_Date_of_Epoch(tle.epoch);
+    }
+
+    return sats;
+}
+
+/* Create a catalog of BENCH_SATS resonant deep-space orbits around a
+   satellite: 70% geostationary, 20% Molniya and 10% Tundra */
+static sat_t   *Geo_Catalog(const sat_t * seed)
+{
+    sat_t          *sats;
+    tle_t           tle;
+    int             i;
+
+    sats = calloc(BENCH_SATS, sizeof(sat_t));
+
+    for (i = 0; i < BENCH_SATS; i++)
+    {
+        tle = seed->tle;
+
+        if (i % 10 < 7)
+        {
+            tle.xno = 1.0027 + 0.0002 * (i % 7);
+            tle.eo = 0.0002 + 0.0001 * (i % 5);
+            tle.xincl = 0.05 + 0.1 * (i % 15);
+        }
+        else if (i % 10 < 9)
+        {
+            tle.xno = 2.0056 + 0.0004 * (i % 3);
+            tle.eo = 0.72;
+            tle.xincl = 63.4;
+        }
+        else
+        {
+            tle.xno = 1.0027;
+            tle.eo = 0.27;
+            tle.xincl = 63.4;
+        }
+        tle.xnodeo = fmod(i * 37.0, 360.0);
+        tle.omegao = fmod(i * 53.0, 360.0);
+        tle.xmo = fmod(i * 71.0, 360.0);
+        tle.xndt2o = 0.0;
+        tle.xndd6o = 0.0;
+        tle.bstar = 0.0;
+
+        sats[i].tle = tle;
+        select_ephemeris(&sats[i]);
+        sats[i].jul_epoch = Julian_Date_of_Epoch(tle.epoch);
+    }
+
+    return sats;
+}
+
+/* Propagate the near-earth or deep-space satellites of a catalog in one
+   minute steps for BENCH_TIME; returns the number of satellites used and
+   stores the rate in propagations per second */
+static int Propagation_Rate(sat_t * sats, int num, int deep, double *rate)
+{
+    gint64          t0, dt;
+    double          tsince = 0.0;
+    long            calls = 0;
+    int             i, used = 0;
+
+    for (i = 0; i < num; i++)
+        if (((sats[i].flags & DEEP_SPACE_EPHEM_FLAG) != 0) == deep)
+            used++;
+
+    if (used == 0)
+        return 0;
+
+    t0 = g_get_monotonic_time();
+    do
+    {
+        for (i = 0; i < num; i++)
+        {
+            if (((sats[i].flags & DEEP_SPACE_EPHEM_FLAG) != 0) != deep)
+                continue;
+
+            if (deep)
+                SDP4(&sats[i], tsince);
+            else
+                SGP4(&sats[i], tsince);
+            calls++;
+        }
+        tsince += 1.0;
+        dt = g_get_monotonic_time() - t0;
+    }
+    while (dt < BENCH_TIME);
+
+    *rate = calls * 1.0E6 / dt;
+
+    return used;
+}
+
+/* Same as Propagation_Rate for the deep-space satellites, using times
+   that jump back and forth within a day, BENCH_AGE after epoch, like a
+   ground track, an AOS/LOS search or the time controller does */
+static int Scrub_Rate(sat_t * sats, int num, double *rate)
+{
+    gint64          t0, dt;
+    double          tsince;
+    long            calls = 0;
+    int             i, used = 0, step = 0;
+
+    for (i = 0; i < num; i++)
+        if (sats[i].flags & DEEP_SPACE_EPHEM_FLAG)
+            used++;
+
+    if (used == 0)
+        return 0;
+
+    t0 = g_get_monotonic_time();
+    do
+    {
+        tsince = BENCH_AGE + ((step * 37) % 120 - 60) * 12.0;
+        for (i = 0; i < num; i++)
+        {
+            if (!(sats[i].flags & DEEP_SPACE_EPHEM_FLAG))
+                continue;
+
+            SDP4(&sats[i], tsince);
+            calls++;
+        }
+        step++;
+        dt = g_get_monotonic_time() - t0;
+    }
+    while (dt < BENCH_TIME);
+
+    *rate = calls * 1.0E6 / dt;
+
+    return used;
+}
+
+/* Same as Propagation_Rate using Propagate_Series with the time step of
+   a ground track, BENCH_SERIES times at a time */
+static int Series_Rate(sat_t * sats, int num, int deep, double *rate)
+{
+    sgpsdp_point_t  out[BENCH_SERIES];
+    gint64          t0, dt;
+    double          tsince = 0.0;
+    long            calls = 0;
+    int             i, used = 0;
+
+    for (i = 0; i < num; i++)
+        if (((sats[i].flags & DEEP_SPACE_EPHEM_FLAG) != 0) == deep)
+            used++;
+
+    if (used == 0)
+        return 0;
+
+    t0 = g_get_monotonic_time();
+    do
+    {
+        for (i = 0; i < num; i++)
+        {
+            if (((sats[i].flags & DEEP_SPACE_EPHEM_FLAG) != 0) != deep)
+                continue;
+
+            Propagate_Series(&sats[i].elset, &sats[i].state, tsince,
+                             BENCH_STEP, BENCH_SERIES, out);
+            calls += BENCH_SERIES;
+        }
+        tsince += BENCH_SERIES * BENCH_STEP;
+        dt = g_get_monotonic_time() - t0;
+    }
+    while (dt < BENCH_TIME);
+
+    *rate = calls * 1.0E6 / dt;
+
+    return used;
+}
+
+/* Same as Propagation_Rate for the near-earth satellites using SGP4_Batch */
+static int Batch_Rate(sat_t * sats, int num, double *rate)
+{
+    sgp4_batch_t    batch;
+    gint64          t0, dt;
+    double          jul_utc;
+    long            calls = 0;
+    int             i, used;
+
+    SGP4_Batch_Init(&batch);
+    for (i = 0; i < num; i++)
+        SGP4_Batch_Add(&batch, &sats[i]);
+    used = batch.num;
+
+    if (used > 0)
+    {
+        jul_utc = sats[0].jul_epoch;
+        t0 = g_get_monotonic_time();
+        do
+        {
+            SGP4_Batch(&batch, jul_utc);
+            calls += batch.num;
+            jul_utc += 1.0 / xmnpda;
+            dt = g_get_monotonic_time() - t0;
+        }
+        while (dt < BENCH_TIME);
+
+        *rate = calls * 1.0E6 / dt;
+    }
+
+    SGP4_Batch_Free(&batch);
+
+    return used;
+}
+
+/* Same as Propagation_Rate using a Chebyshev ephemeris for each satellite.
+   The segments are fitted during the benchmark; the time steps are those of
+   the time controller running ten times faster than real time. */
+static int Cheb_Rate(sat_t * sats, int num, int deep, double *rate)
+{
+    cheb_ephem_t   *eph;
+    vector_t        pos, vel;
+    gint64          t0, dt;
+    double          phase, tsince = 0.0;
+    long            calls = 0;
+    int             i, used = 0;
+
+    for (i = 0; i < num; i++)
+        if (((sats[i].flags & DEEP_SPACE_EPHEM_FLAG) != 0) == deep)
+            used++;
+
+    if (used == 0)
+        return 0;
+
+    eph = malloc(num * sizeof(cheb_ephem_t));
+    for (i = 0; i < num; i++)
+        Cheb_Init(&eph[i]);
+
+    t0 = g_get_monotonic_time();
+    do
+    {
+        for (i = 0; i < num; i++)
+        {
+            if (((sats[i].flags & DEEP_SPACE_EPHEM_FLAG) != 0) != deep)
+                continue;
+
+            Cheb_Propagate(&eph[i], &sats[i].elset, tsince, &pos, &vel,
+                           &phase);
+            calls++;
+        }
+        tsince += 10.0 / 60.0;
+        dt = g_get_monotonic_time() - t0;
+    }
+    while (dt < BENCH_TIME);
+
+    *rate = calls * 1.0E6 / dt;
+    free(eph);
+
+    return used;
+}
+
+static void Bench_Catalog(const char *name, sat_t * sats, int num)
+{
+    double          rate;
+    int             used;
+
+    used = Propagation_Rate(sats, num, 0, &rate);
+    if (used > 0)
+        printf("sgp4,%s,%d,%.0f,prop/s\n", name, used, rate);
+
+    used = Propagation_Rate(sats, num, 1, &rate);
+    if (used > 0)
+        printf("sdp4,%s,%d,%.0f,prop/s\n", name, used, rate);
+
+    used = Scrub_Rate(sats, num, &rate);
+    if (used > 0)
+        printf("sdp4_scrub,%s,%d,%.0f,prop/s\n", name, used, rate);
+
+    used = Series_Rate(sats, num, 0, &rate);
+    if (used > 0)
+        printf("sgp4_series,%s,%d,%.0f,prop/s\n", name, used, rate);
+
+    used = Series_Rate(sats, num, 1, &rate);
+    if (used > 0)
+        printf("sdp4_series,%s,%d,%.0f,prop/s\n", name, used, rate);
+
+    used = Cheb_Rate(sats, num, 0, &rate);
+    if (used > 0)
+        printf("sgp4_cheb,%s,%d,%.0f,prop/s\n", name, used, rate);
+
+    used = Cheb_Rate(sats, num, 1, &rate);
+    if (used > 0)
+        printf("sdp4_cheb,%s,%d,%.0f,prop/s\n", name, used, rate);
+
+    used = Batch_Rate(sats, num, &rate);
+    if (used > 0)
+        printf("sgp4_batch,%s,%d,%.0f,prop/s\n", name, used, rate);
+
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    sat_t          *sats;
+    sat_t          *synth;
+    sat_t           near, deep;
+    gchar          *name;
+    int             i, j, num;
+    int             have_near = 0, have_deep = 0;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s file.tle [file.tle ...]\n", argv[0]);
+        return 1;
+    }
+
+    printf("benchmark,catalog,sats,value,unit\n");
+
+    for (i = 1; i < argc; i++)
+    {
+        num = Read_Catalog(argv[i], &sats);
+        if (num == 0)
+            continue;
+
+        for (j = 0; j < num; j++)
+        {
+            if (!have_near && !(sats[j].flags & DEEP_SPACE_EPHEM_FLAG))
+            {
+                near = sats[j];
+                have_near = 1;
+            }
+            if (!have_deep && (sats[j].flags & DEEP_SPACE_EPHEM_FLAG))
+            {
+                deep = sats[j];
+                have_deep = 1;
+            }
+        }
+
+        name = g_path_get_basename(argv[i]);
+        Bench_Catalog(name, sats, num);
+        g_free(name);
+        free(sats);
+    }
+
+    if (have_near)
+    {
+        synth = Synthetic_Catalog(&near);
+        Bench_Catalog("synthetic-near", synth, BENCH_SATS);
+        free(synth);
+    }
+
+    if (have_deep)
+    {
+        synth = Synthetic_Catalog(&deep);
+        Bench_Catalog("synthetic-deep", synth, BENCH_SATS);
+        free(synth);
+
+        synth = Geo_Catalog(&deep);
+        Bench_Catalog("synthetic-geo", synth, BENCH_SATS);
+        free(synth);
+    }
+
+    return 0;
+}
@@ -12,173 +12,229 @@
 
 #include "sgp4sdp4.h"
 
+static void SGP4_Init (sgpsdp_elset_t *elset);
+static void SDP4_Init (sgpsdp_elset_t *elset);
+static void Deep_Init (sgpsdp_elset_t *elset);
+
+/* Initialize_Elset */
+/* Fills in an element set from a tle_t structure that has been */
+/* processed by select_ephemeris(), and computes all the        */
+/* constants SGP4 or SDP4 need. flags must contain              */
+/* DEEP_SPACE_EPHEM_FLAG for deep-space satellites. The element */
+/* set is not modified by the propagator, so it can be shared   */
+/* by any number of threads.                                    */
+void Initialize_Elset (sgpsdp_elset_t *elset, tle_t *tle, int flags)
+{
+    memset (elset, 0, sizeof (sgpsdp_elset_t));
+
+    elset->flags = flags & DEEP_SPACE_EPHEM_FLAG;
+    elset->epoch = tle->epoch;
+    elset->xmo = tle->xmo;
+    elset->xnodeo = tle->xnodeo;
+    elset->omegao = tle->omegao;
+    elset->eo = tle->eo;
+    elset->xincl = tle->xincl;
+    elset->xno = tle->xno;
+    elset->bstar = tle->bstar;
+
+    if (elset->flags & DEEP_SPACE_EPHEM_FLAG)
+        SDP4_Init (elset);
+    else
+        SGP4_Init (elset);
+}
+
+/* Initialize_State */
+/* Prepares a propagator state for its first call to SGP4_r() */
+/* or SDP4_r(). Each thread needs its own state.              */
+void Initialize_State (sgpsdp_state_t *state)
+{
+    memset (state, 0, sizeof (sgpsdp_state_t));
+
+    /* force calculation of the lunar-solar periodics */
+    state->savtsn = 1E20;
+}
+
+/* Copy the results of the reentrant functions into sat */
+static void Copy_State (sat_t *sat)
+{
+    sat->pos = sat->state.pos;
+    sat->vel = sat->state.vel;
+    sat->phase = sat->state.phase;
+    sat->tle.omegao1 = sat->state.omegao1;
+    sat->tle.xincl1  = sat->state.xincl1;
+    sat->tle.xnodeo1 = sat->state.xnodeo1;
+}
+
+/* SGP4_Init */
+/* Computes the SGP4 constants of a near-earth element set. */
+static void SGP4_Init (sgpsdp_elset_t *elset)
+{
+    double x1m5th,xhdot1,a1,a3ovk2,ao,betao,betao2,c1sq,c2,
+        c3,coef,coef1,del1,delo,eeta,eosq,etasq,perige,
+        pinvsq,psisq,qoms24,s4,temp,temp1,temp2,temp3,
+        theta2,theta4,tsi;
+
+    /* Recover original mean motion (xnodp) and   */
+    /* semimajor axis (aodp) from input elements. */
+    a1 = pow (xke/elset->xno, tothrd);
+    elset->sgps.cosio = cos (elset->xincl);
+    theta2 = elset->sgps.cosio * elset->sgps.cosio;
+    elset->sgps.x3thm1 = 3 * theta2 - 1.0;
+    eosq = elset->eo * elset->eo;
+    betao2 = 1 - eosq;
+    betao = sqrt (betao2);
+    del1 = 1.5 * ck2 * elset->sgps.x3thm1 / (a1*a1*betao*betao2);
+    ao = a1*(1-del1*(0.5*tothrd+del1*(1+134.0/81.0*del1)));
+    delo = 1.5 * ck2 * elset->sgps.x3thm1 / (ao*ao*betao*betao2);
+    elset->sgps.xnodp = elset->xno / (1.0 + delo);
+    elset->sgps.aodp = ao / (1.0 - delo);
+
+    /* For perigee less than 220 kilometers, the "simple" flag is set */
+    /* and the equations are truncated to linear variation in sqrt a  */
+    /* and quadratic variation in mean anomaly.  Also, the c3 term,   */
+    /* the delta omega term, and the delta m term are dropped.        */
+    if ((elset->sgps.aodp * (1.0 - elset->eo) / ae) < (220.0 / xkmper + ae))
+        elset->flags |= SIMPLE_FLAG;
+    else
+        elset->flags &= ~SIMPLE_FLAG;
+
+    /* For perigee below 156 km, the       */ 
+    /* values of s and qoms2t are altered. */
+    s4 = __s__;
+    qoms24 = qoms2t;
+    perige = (elset->sgps.aodp * (1 - elset->eo) - ae) * xkmper;
+    if (perige < 156.0) {
+        if (perige <= 98.0)
+            s4 = 20.0;
+        else
+            s4 = perige - 78.0;
+        qoms24 = pow ((120.0 - s4) * ae / xkmper, 4);
+        s4 = s4 / xkmper + ae;
+    };
+
+    pinvsq = 1.0 / (elset->sgps.aodp * elset->sgps.aodp * betao2 * betao2);
+    tsi = 1.0 / (elset->sgps.aodp - s4);
+    elset->sgps.eta = elset->sgps.aodp * elset->eo * tsi;
+    etasq = elset->sgps.eta * elset->sgps.eta;
+    eeta = elset->eo * elset->sgps.eta;
+    psisq = fabs (1.0 - etasq);
+    coef = qoms24 * pow (tsi, 4);
+    coef1 = coef / pow (psisq, 3.5);
+    c2 = coef1 * elset->sgps.xnodp * (elset->sgps.aodp *
+                    (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) +
+                    0.75 * ck2 * tsi / psisq * elset->sgps.x3thm1 *
+                    (8.0 + 3.0 * etasq * (8 + etasq)));
+    elset->sgps.c1 = c2 * elset->bstar;
+    elset->sgps.sinio = sin (elset->xincl);
+    a3ovk2 = -xj3 / ck2 * pow (ae, 3);
+    c3 = coef * tsi * a3ovk2 * elset->sgps.xnodp * ae * elset->sgps.sinio / elset->eo;
+    elset->sgps.x1mth2 = 1.0 - theta2;
+    elset->sgps.c4 = 2.0 * elset->sgps.xnodp * coef1 * elset->sgps.aodp * betao2 *
+        (elset->sgps.eta * (2.0 + 0.5 * etasq) +
+         elset->eo * (0.5 + 2.0 * etasq) -
+         2.0 * ck2 * tsi / (elset->sgps.aodp * psisq) *
+         (-3.0 * elset->sgps.x3thm1 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) + 
+          0.75 * elset->sgps.x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * 
+          cos (2.0 * elset->omegao)));
+    elset->sgps.c5 = 2.0 * coef1 * elset->sgps.aodp * betao2 *
+        (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+    theta4 = theta2 * theta2;
+    temp1 = 3.0 * ck2 * pinvsq * elset->sgps.xnodp;
+    temp2 = temp1 * ck2 * pinvsq;
+    temp3 = 1.25 * ck4 * pinvsq * pinvsq * elset->sgps.xnodp;
+    elset->sgps.xmdot = elset->sgps.xnodp + 0.5 * temp1 * betao * elset->sgps.x3thm1 +
+        0.0625 * temp2 * betao * (13.0 - 78.0 * theta2 + 137.0 * theta4);
+    x1m5th = 1.0 - 5.0 * theta2;
+    elset->sgps.omgdot = -0.5 * temp1 * x1m5th +
+        0.0625 * temp2 * (7.0 - 114.0 * theta2 + 395.0 * theta4) +
+        temp3 * (3.0 - 36.0 * theta2 + 49.0 * theta4);
+    xhdot1 = -temp1 * elset->sgps.cosio;
+    elset->sgps.xnodot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * theta2) +
+                     2.0 * temp3 * (3.0 - 7.0 * theta2)) * elset->sgps.cosio;
+    elset->sgps.omgcof = elset->bstar * c3 * cos (elset->omegao);
+    elset->sgps.xmcof = -tothrd * coef * elset->bstar * ae / eeta;
+    elset->sgps.xnodcf = 3.5 * betao2 * xhdot1 * elset->sgps.c1;
+    elset->sgps.t2cof = 1.5 * elset->sgps.c1;
+    elset->sgps.xlcof = 0.125 * a3ovk2 * elset->sgps.sinio *
+        (3.0 + 5.0 * elset->sgps.cosio) / (1.0 + elset->sgps.cosio);
+    elset->sgps.aycof = 0.25 * a3ovk2 * elset->sgps.sinio;
+    elset->sgps.delmo = pow (1.0 + elset->sgps.eta * cos (elset->xmo), 3);
+    elset->sgps.sinmo = sin (elset->xmo);
+    elset->sgps.x7thm1 = 7.0 * theta2 - 1.0;
+    if (~elset->flags & SIMPLE_FLAG) {
+        c1sq = elset->sgps.c1 * elset->sgps.c1;
+        elset->sgps.d2 = 4.0 * elset->sgps.aodp * tsi * c1sq;
+        temp = elset->sgps.d2 * tsi * elset->sgps.c1 / 3.0;
+        elset->sgps.d3 = (17.0 * elset->sgps.aodp + s4) * temp;
+        elset->sgps.d4 = 0.5 * temp * elset->sgps.aodp * tsi *
+            (221.0 * elset->sgps.aodp + 31.0 * s4) * elset->sgps.c1;
+        elset->sgps.t3cof = elset->sgps.d2 + 2.0 * c1sq;
+        elset->sgps.t4cof = 0.25 * (3.0 * elset->sgps.d3 + elset->sgps.c1 *
+                      (12.0 * elset->sgps.d2 + 10.0 * c1sq));
+        elset->sgps.t5cof = 0.2 * (3.0 * elset->sgps.d4 +
+                     12.0 * elset->sgps.c1 * elset->sgps.d3 +
+                     6.0 * elset->sgps.d2 * elset->sgps.d2 +
+                     15.0 * c1sq * (2.0 * elset->sgps.d2 + c1sq));
+    };
+}
+
 /* SGP4 */
 /* This function is used to calculate the position and velocity */
 /* of near-earth (period < 225 minutes) satellites. tsince is   */
 /* time since epoch in minutes, tle is a pointer to a tle_t     */
 /* structure with Keplerian orbital elements and pos and vel    */
 /* are vector_t structures returning ECI satellite position and */
-/* velocity. Use Convert_Sat_State() to convert to km and km/s.*/
-void SGP4 (sat_t *sat, double tsince)
+/* This version keeps no state of its own; elset is only read  */
+/* and all results are stored in state.                        */
+void SGP4_r (const sgpsdp_elset_t *elset, double tsince,
+             sgpsdp_state_t *state)
 {
     double cosuk,sinuk,rfdotk,vx,vy,vz,ux,uy,uz,xmy,xmx,
-        cosnok,sinnok,cosik,sinik,rdotk,xinck,xnodek,uk,
-        rk,cos2u,sin2u,u,sinu,cosu,betal,rfdot,rdot,r,pl,
-        elsq,esine,ecose,epw,cosepw,x1m5th,xhdot1,tfour,
-        sinepw,capu,ayn,xlt,aynl,xll,axn,xn,beta,xl,e,a,
-        tcube,delm,delomg,templ,tempe,tempa,xnode,tsq,xmp,
-        omega,xnoddf,omgadf,xmdf,a1,a3ovk2,ao,betao,betao2,
-        c1sq,c2,c3,coef,coef1,del1,delo,eeta,eosq,etasq,
-        perige,pinvsq,psisq,qoms24,s4,temp,temp1,temp2,
-        temp3,temp4,temp5,temp6,theta2,theta4,tsi;
-
-    int i;  
-
-    /* Initialization */
-    if (~sat->flags & SGP4_INITIALIZED_FLAG) {
-        
-        sat->flags |= SGP4_INITIALIZED_FLAG;
-
-        /* Recover original mean motion (xnodp) and   */
-        /* semimajor axis (aodp) from input elements. */
-        a1 = pow (xke/sat->tle.xno, tothrd);
-        sat->sgps.cosio = cos (sat->tle.xincl);
-        theta2 = sat->sgps.cosio * sat->sgps.cosio;
-        sat->sgps.x3thm1 = 3 * theta2 - 1.0;
-        eosq = sat->tle.eo * sat->tle.eo;
-        betao2 = 1 - eosq;
-        betao = sqrt (betao2);
-        del1 = 1.5 * ck2 * sat->sgps.x3thm1 / (a1*a1*betao*betao2);
-        ao = a1*(1-del1*(0.5*tothrd+del1*(1+134.0/81.0*del1)));
-        delo = 1.5 * ck2 * sat->sgps.x3thm1 / (ao*ao*betao*betao2);
-        sat->sgps.xnodp = sat->tle.xno / (1.0 + delo);
-        sat->sgps.aodp = ao / (1.0 - delo);
-
-        /* For perigee less than 220 kilometers, the "simple" flag is set */
-        /* and the equations are truncated to linear variation in sqrt a  */
-        /* and quadratic variation in mean anomaly.  Also, the c3 term,   */
-        /* the delta omega term, and the delta m term are dropped.        */
-        if ((sat->sgps.aodp * (1.0 - sat->tle.eo) / ae) < (220.0 / xkmper + ae))
-            sat->flags |= SIMPLE_FLAG;
-        else
-            sat->flags &= ~SIMPLE_FLAG;
-
-        /* For perigee below 156 km, the       */ 
-        /* values of s and qoms2t are altered. */
-        s4 = __s__;
-        qoms24 = qoms2t;
-        perige = (sat->sgps.aodp * (1 - sat->tle.eo) - ae) * xkmper;
-        if (perige < 156.0) {
-            if (perige <= 98.0)
-                s4 = 20.0;
-            else
-                s4 = perige - 78.0;
-            qoms24 = pow ((120.0 - s4) * ae / xkmper, 4);
-            s4 = s4 / xkmper + ae;
-        };
-
-        pinvsq = 1.0 / (sat->sgps.aodp * sat->sgps.aodp * betao2 * betao2);
-        tsi = 1.0 / (sat->sgps.aodp - s4);
-        sat->sgps.eta = sat->sgps.aodp * sat->tle.eo * tsi;
-        etasq = sat->sgps.eta * sat->sgps.eta;
-        eeta = sat->tle.eo * sat->sgps.eta;
-        psisq = fabs (1.0 - etasq);
-        coef = qoms24 * pow (tsi, 4);
-        coef1 = coef / pow (psisq, 3.5);
-        c2 = coef1 * sat->sgps.xnodp * (sat->sgps.aodp *
-                        (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) +
-                        0.75 * ck2 * tsi / psisq * sat->sgps.x3thm1 *
-                        (8.0 + 3.0 * etasq * (8 + etasq)));
-        sat->sgps.c1 = c2 * sat->tle.bstar;
-        sat->sgps.sinio = sin (sat->tle.xincl);
-        a3ovk2 = -xj3 / ck2 * pow (ae, 3);
-        c3 = coef * tsi * a3ovk2 * sat->sgps.xnodp * ae * sat->sgps.sinio / sat->tle.eo;
-        sat->sgps.x1mth2 = 1.0 - theta2;
-        sat->sgps.c4 = 2.0 * sat->sgps.xnodp * coef1 * sat->sgps.aodp * betao2 *
-            (sat->sgps.eta * (2.0 + 0.5 * etasq) +
-             sat->tle.eo * (0.5 + 2.0 * etasq) -
-             2.0 * ck2 * tsi / (sat->sgps.aodp * psisq) *
-             (-3.0 * sat->sgps.x3thm1 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) + 
-              0.75 * sat->sgps.x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * 
-              cos (2.0 * sat->tle.omegao)));
-        sat->sgps.c5 = 2.0 * coef1 * sat->sgps.aodp * betao2 *
-            (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
-        theta4 = theta2 * theta2;
-        temp1 = 3.0 * ck2 * pinvsq * sat->sgps.xnodp;
-        temp2 = temp1 * ck2 * pinvsq;
-        temp3 = 1.25 * ck4 * pinvsq * pinvsq * sat->sgps.xnodp;
-        sat->sgps.xmdot = sat->sgps.xnodp + 0.5 * temp1 * betao * sat->sgps.x3thm1 +
-            0.0625 * temp2 * betao * (13.0 - 78.0 * theta2 + 137.0 * theta4);
-        x1m5th = 1.0 - 5.0 * theta2;
-        sat->sgps.omgdot = -0.5 * temp1 * x1m5th +
-            0.0625 * temp2 * (7.0 - 114.0 * theta2 + 395.0 * theta4) +
-            temp3 * (3.0 - 36.0 * theta2 + 49.0 * theta4);
-        xhdot1 = -temp1 * sat->sgps.cosio;
-        sat->sgps.xnodot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * theta2) +
-                         2.0 * temp3 * (3.0 - 7.0 * theta2)) * sat->sgps.cosio;
-        sat->sgps.omgcof = sat->tle.bstar * c3 * cos (sat->tle.omegao);
-        sat->sgps.xmcof = -tothrd * coef * sat->tle.bstar * ae / eeta;
-        sat->sgps.xnodcf = 3.5 * betao2 * xhdot1 * sat->sgps.c1;
-        sat->sgps.t2cof = 1.5 * sat->sgps.c1;
-        sat->sgps.xlcof = 0.125 * a3ovk2 * sat->sgps.sinio *
-            (3.0 + 5.0 * sat->sgps.cosio) / (1.0 + sat->sgps.cosio);
-        sat->sgps.aycof = 0.25 * a3ovk2 * sat->sgps.sinio;
-        sat->sgps.delmo = pow (1.0 + sat->sgps.eta * cos (sat->tle.xmo), 3);
-        sat->sgps.sinmo = sin (sat->tle.xmo);
-        sat->sgps.x7thm1 = 7.0 * theta2 - 1.0;
-        if (~sat->flags & SIMPLE_FLAG) {
-            c1sq = sat->sgps.c1 * sat->sgps.c1;
-            sat->sgps.d2 = 4.0 * sat->sgps.aodp * tsi * c1sq;
-            temp = sat->sgps.d2 * tsi * sat->sgps.c1 / 3.0;
-            sat->sgps.d3 = (17.0 * sat->sgps.aodp + s4) * temp;
-            sat->sgps.d4 = 0.5 * temp * sat->sgps.aodp * tsi *
-                (221.0 * sat->sgps.aodp + 31.0 * s4) * sat->sgps.c1;
-            sat->sgps.t3cof = sat->sgps.d2 + 2.0 * c1sq;
-            sat->sgps.t4cof = 0.25 * (3.0 * sat->sgps.d3 + sat->sgps.c1 *
-                          (12.0 * sat->sgps.d2 + 10.0 * c1sq));
-            sat->sgps.t5cof = 0.2 * (3.0 * sat->sgps.d4 +
-                         12.0 * sat->sgps.c1 * sat->sgps.d3 +
-                         6.0 * sat->sgps.d2 * sat->sgps.d2 +
-                         15.0 * c1sq * (2.0 * sat->sgps.d2 + c1sq));
-        };
-    };
+        cosnok,sinnok,cosik,sinik,rdotk,xinck,xnodek,uk,rk,
+        cos2u,sin2u,u,sinu,cosu,betal,rfdot,rdot,r,pl,elsq,
+        esine,ecose,epw,cosepw,tfour,sinepw,capu,ayn,xlt,
+        aynl,xll,axn,xn,beta,xl,e,a,tcube,delm,delomg,templ,
+        tempe,tempa,xnode,tsq,xmp,omega,xnoddf,omgadf,xmdf,
+        temp,temp1,temp2,temp3,temp4,temp5,temp6;
+
+    int i;
 
     /* Update for secular gravity and atmospheric drag. */
-    xmdf = sat->tle.xmo + sat->sgps.xmdot * tsince;
-    omgadf = sat->tle.omegao + sat->sgps.omgdot * tsince;
-    xnoddf = sat->tle.xnodeo + sat->sgps.xnodot * tsince;
+    xmdf = elset->xmo + elset->sgps.xmdot * tsince;
+    omgadf = elset->omegao + elset->sgps.omgdot * tsince;
+    xnoddf = elset->xnodeo + elset->sgps.xnodot * tsince;
     omega = omgadf;
     xmp = xmdf;
     tsq = tsince*tsince;
-    xnode = xnoddf + sat->sgps.xnodcf * tsq;
-    tempa = 1.0 - sat->sgps.c1 * tsince;
-    tempe = sat->tle.bstar * sat->sgps.c4 * tsince;
-    templ = sat->sgps.t2cof * tsq;
-    if (~sat->flags & SIMPLE_FLAG) {
-        delomg = sat->sgps.omgcof * tsince;
-        delm = sat->sgps.xmcof * (pow (1 + sat->sgps.eta * cos (xmdf), 3) - sat->sgps.delmo);
+    xnode = xnoddf + elset->sgps.xnodcf * tsq;
+    tempa = 1.0 - elset->sgps.c1 * tsince;
+    tempe = elset->bstar * elset->sgps.c4 * tsince;
+    templ = elset->sgps.t2cof * tsq;
+    if (~elset->flags & SIMPLE_FLAG) {
+        delomg = elset->sgps.omgcof * tsince;
+        delm = elset->sgps.xmcof * (pow (1 + elset->sgps.eta * cos (xmdf), 3) - elset->sgps.delmo);
         temp = delomg + delm;
         xmp = xmdf + temp;
         omega = omgadf - temp;
         tcube = tsq * tsince;
         tfour = tsince * tcube;
-        tempa = tempa - sat->sgps.d2 * tsq - sat->sgps.d3 * tcube - sat->sgps.d4 * tfour;
-        tempe = tempe + sat->tle.bstar * sat->sgps.c5 * (sin (xmp) - sat->sgps.sinmo);
-        templ = templ + sat->sgps.t3cof * tcube + tfour *
-            (sat->sgps.t4cof + tsince * sat->sgps.t5cof);
+        tempa = tempa - elset->sgps.d2 * tsq - elset->sgps.d3 * tcube - elset->sgps.d4 * tfour;
+        tempe = tempe + elset->bstar * elset->sgps.c5 * (sin (xmp) - elset->sgps.sinmo);
+        templ = templ + elset->sgps.t3cof * tcube + tfour *
+            (elset->sgps.t4cof + tsince * elset->sgps.t5cof);
     };
 
-    a = sat->sgps.aodp * pow (tempa, 2);
-    e = sat->tle.eo - tempe;
-    xl = xmp + omega + xnode + sat->sgps.xnodp * templ;
+    a = elset->sgps.aodp * pow (tempa, 2);
+    e = elset->eo - tempe;
+    xl = xmp + omega + xnode + elset->sgps.xnodp * templ;
     beta = sqrt (1.0 - e*e);
     xn = xke / pow (a, 1.5);
 
     /* Long period periodics */
     axn = e * cos (omega);
     temp = 1.0 / (a * beta * beta);
-    xll = temp * sat->sgps.xlcof * axn;
-    aynl = temp * sat->sgps.aycof;
+    xll = temp * elset->sgps.xlcof * axn;
+    aynl = temp * elset->sgps.aycof;
     xlt = xl + xll;
     ayn = e * sin (omega) + aynl;
 
@@ -224,13 +280,13 @@ void SGP4 (sat_t *sat, double tsince)
     temp2 = temp1 * temp;
 
     /* Update for short periodics */
-    rk = r * (1.0 - 1.5 * temp2 * betal * sat->sgps.x3thm1) +
-        0.5 * temp1 * sat->sgps.x1mth2 * cos2u;
-    uk = u - 0.25 * temp2 * sat->sgps.x7thm1 * sin2u;
-    xnodek = xnode + 1.5 * temp2 * sat->sgps.cosio * sin2u;
-    xinck = sat->tle.xincl + 1.5 * temp2 * sat->sgps.cosio * sat->sgps.sinio * cos2u;
-    rdotk = rdot - xn * temp1 * sat->sgps.x1mth2 * sin2u;
-    rfdotk = rfdot + xn * temp1 * (sat->sgps.x1mth2 * cos2u + 1.5 * sat->sgps.x3thm1);
+    rk = r * (1.0 - 1.5 * temp2 * betal * elset->sgps.x3thm1) +
+        0.5 * temp1 * elset->sgps.x1mth2 * cos2u;
+    uk = u - 0.25 * temp2 * elset->sgps.x7thm1 * sin2u;
+    xnodek = xnode + 1.5 * temp2 * elset->sgps.cosio * sin2u;
+    xinck = elset->xincl + 1.5 * temp2 * elset->sgps.cosio * elset->sgps.sinio * cos2u;
+    rdotk = rdot - xn * temp1 * elset->sgps.x1mth2 * sin2u;
+    rfdotk = rfdot + xn * temp1 * (elset->sgps.x1mth2 * cos2u + 1.5 * elset->sgps.x3thm1);
 
 
     /* Orientation vectors */
@@ -250,22 +306,125 @@ void SGP4 (sat_t *sat, double tsince)
     vz = sinik * cosuk;
 
     /* Position and velocity */
-    sat->pos.x = rk*ux;
-    sat->pos.y = rk*uy;
-    sat->pos.z = rk*uz;
-    sat->vel.x = rdotk*ux+rfdotk*vx;
-    sat->vel.y = rdotk*uy+rfdotk*vy;
-    sat->vel.z = rdotk*uz+rfdotk*vz;
-
-    sat->phase = xlt - xnode - omgadf + twopi;
-    if (sat->phase < 0)
-        sat->phase += twopi;
-    sat->phase = FMod2p (sat->phase);
-
-    sat->tle.omegao1 = omega;
-    sat->tle.xincl1  = xinck;
-    sat->tle.xnodeo1 = xnodek;
+    state->pos.x = rk*ux;
+    state->pos.y = rk*uy;
+    state->pos.z = rk*uz;
+    state->vel.x = rdotk*ux+rfdotk*vx;
+    state->vel.y = rdotk*uy+rfdotk*vy;
+    state->vel.z = rdotk*uz+rfdotk*vz;
+
+    state->phase = xlt - xnode - omgadf + twopi;
+    if (state->phase < 0)
+        state->phase += twopi;
+    state->phase = FMod2p (state->phase);
+
+    state->omegao1 = omega;
+    state->xincl1  = xinck;
+    state->xnodeo1 = xnodek;
+
+}
+
+/* SGP4 */
+/* Same as SGP4_r(), using the element set and state stored in */
+/* sat. The results are copied into sat.                       */
+void SGP4 (sat_t *sat, double tsince)
+{
+    SGP4_r (&sat->elset, tsince, &sat->state);
+    Copy_State (sat);
+}
 
+/* SDP4_Init */
+/* Computes the SDP4 constants of a deep-space element set. */
+static void SDP4_Init (sgpsdp_elset_t *elset)
+{
+    double theta4,a1,a3ovk2,ao,c2,coef,coef1,x1m5th,xhdot1,
+        del1,delo,eeta,eta,etasq,perige,psisq,tsi,qoms24,s4,
+        pinvsq,temp1,temp2,temp3;
+
+    /* Recover original mean motion (xnodp) and   */
+    /* semimajor axis (aodp) from input elements. */
+    a1 = pow (xke / elset->xno, tothrd);
+    elset->deep_arg.cosio = cos (elset->xincl);
+    elset->deep_arg.theta2 = elset->deep_arg.cosio * elset->deep_arg.cosio;
+    elset->sgps.x3thm1 = 3.0 * elset->deep_arg.theta2 - 1.0;
+    elset->deep_arg.eosq = elset->eo * elset->eo;
+    elset->deep_arg.betao2 = 1.0 - elset->deep_arg.eosq;
+    elset->deep_arg.betao = sqrt (elset->deep_arg.betao2);
+    del1 = 1.5 * ck2 * elset->sgps.x3thm1 /
+        (a1 * a1 * elset->deep_arg.betao * elset->deep_arg.betao2);
+    ao = a1 * (1.0 - del1 * (0.5 * tothrd + del1 * (1.0 + 134.0 / 81.0 * del1)));
+    delo = 1.5 * ck2 * elset->sgps.x3thm1 /
+        (ao * ao * elset->deep_arg.betao * elset->deep_arg.betao2);
+    elset->deep_arg.xnodp = elset->xno / (1.0 + delo);
+    elset->deep_arg.aodp = ao / (1.0 - delo);
+
+    /* For perigee below 156 km, the values */
+    /* of s and qoms2t are altered.         */
+    s4 = __s__;
+    qoms24 = qoms2t;
+    perige = (elset->deep_arg.aodp * (1.0 - elset->eo) - ae) * xkmper;
+    if (perige < 156.0) {
+        if (perige <= 98.0)
+            s4 = 20.0;
+        else
+            s4 = perige - 78.0;
+        qoms24 = pow ((120.0 - s4) * ae / xkmper, 4);
+        s4 = s4 / xkmper + ae;
+    }
+    pinvsq = 1.0 / (elset->deep_arg.aodp * elset->deep_arg.aodp *
+            elset->deep_arg.betao2 * elset->deep_arg.betao2);
+    elset->deep_arg.sing = sin (elset->omegao);
+    elset->deep_arg.cosg = cos (elset->omegao);
+    tsi = 1.0 / (elset->deep_arg.aodp - s4);
+    eta = elset->deep_arg.aodp * elset->eo * tsi;
+    etasq = eta * eta;
+    eeta = elset->eo * eta;
+    psisq = fabs (1.0 - etasq);
+    coef = qoms24 * pow (tsi, 4);
+    coef1 = coef / pow (psisq, 3.5);
+    c2 = coef1 * elset->deep_arg.xnodp * (elset->deep_arg.aodp *
+                        (1.0 + 1.5 * etasq + eeta *
+                         (4.0 + etasq)) + 0.75 * ck2 * tsi / psisq * 
+                        elset->sgps.x3thm1 * (8.0 + 3.0 * etasq *
+                                (8.0 + etasq)));
+    elset->sgps.c1 = elset->bstar * c2;
+    elset->deep_arg.sinio = sin (elset->xincl);
+    a3ovk2 = -xj3 / ck2 * pow (ae, 3);
+    elset->sgps.x1mth2 = 1.0 - elset->deep_arg.theta2;
+    elset->sgps.c4 = 2.0 * elset->deep_arg.xnodp * coef1 *
+        elset->deep_arg.aodp * elset->deep_arg.betao2 *
+        (eta * (2.0 + 0.5 * etasq) + elset->eo *
+         (0.5 + 2.0 * etasq) - 2.0 * ck2 * tsi /
+         (elset->deep_arg.aodp * psisq) * (-3.0 * elset->sgps.x3thm1 *
+                         (1.0 - 2.0 * eeta + etasq *
+                          (1.5 - 0.5 * eeta)) +
+                         0.75 * elset->sgps.x1mth2 * 
+                         (2.0 * etasq - eeta * (1.0 + etasq)) *
+                         cos (2.0 * elset->omegao)));
+    theta4 = elset->deep_arg.theta2 * elset->deep_arg.theta2;
+    temp1 = 3.0 * ck2 * pinvsq * elset->deep_arg.xnodp;
+    temp2 = temp1 * ck2 * pinvsq;
+    temp3 = 1.25 * ck4 * pinvsq * pinvsq * elset->deep_arg.xnodp;
+    elset->deep_arg.xmdot = elset->deep_arg.xnodp + 0.5 * temp1 * elset->deep_arg.betao *
+        elset->sgps.x3thm1 + 0.0625 * temp2 * elset->deep_arg.betao *
+        (13.0 - 78.0 * elset->deep_arg.theta2 + 137.0 * theta4);
+    x1m5th = 1.0 - 5.0 * elset->deep_arg.theta2;
+    elset->deep_arg.omgdot = -0.5 * temp1 * x1m5th + 0.0625 * temp2 *
+                    (7.0 - 114.0 * elset->deep_arg.theta2 + 395.0 * theta4) +
+                temp3 * (3.0 - 36.0 * elset->deep_arg.theta2 + 49.0 * theta4);
+    xhdot1 = -temp1 * elset->deep_arg.cosio;
+    elset->deep_arg.xnodot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * elset->deep_arg.theta2) +
+                     2.0 * temp3 * (3.0 - 7.0 * elset->deep_arg.theta2)) *
+        elset->deep_arg.cosio;
+    elset->sgps.xnodcf = 3.5 * elset->deep_arg.betao2 * xhdot1 * elset->sgps.c1;
+    elset->sgps.t2cof = 1.5 * elset->sgps.c1;
+    elset->sgps.xlcof = 0.125 * a3ovk2 * elset->deep_arg.sinio *
+        (3.0 + 5.0 * elset->deep_arg.cosio) / (1.0 + elset->deep_arg.cosio);
+    elset->sgps.aycof = 0.25 * a3ovk2 * elset->deep_arg.sinio;
+    elset->sgps.x7thm1 = 7.0 * elset->deep_arg.theta2 - 1.0;
+
+    /* initialize Deep() */
+    Deep_Init (elset);
 }
 
 /* SDP4 */
@@ -275,154 +434,66 @@ void SGP4 (sat_t *sat, double tsince)
 /* structure with Keplerian orbital elements and pos and vel    */
 /* are vector_t structures returning ECI satellite position and */
 /* velocity. Use Convert_Sat_State() to convert to km and km/s. */
-void SDP4 (sat_t *sat, double tsince)
+/* This version keeps no state of its own; elset is only read  */
+/* and all results are stored in state.                        */
+void SDP4_r (const sgpsdp_elset_t *elset, double tsince,
+             sgpsdp_state_t *state)
 {
     int i;
 
-    double a,axn,ayn,aynl,beta,betal,capu,cos2u,cosepw,cosik,
-        cosnok,cosu,cosuk,ecose,elsq,epw,esine,pl,theta4,
+    double a,axn,ayn,aynl,beta,betal,capu,cos2u,cosepw,
+        cosik,cosnok,cosu,cosuk,ecose,elsq,epw,esine,pl,
         rdot,rdotk,rfdot,rfdotk,rk,sin2u,sinepw,sinik,
-        sinnok,sinu,sinuk,tempe,templ,tsq,u,uk,ux,uy,uz,
-        vx,vy,vz,xinck,xl,xlt,xmam,xmdf,xmx,xmy,xnoddf,
-        xnodek,xll,a1,a3ovk2,ao,c2,coef,coef1,x1m5th,
-        xhdot1,del1,r,delo,eeta,eta,etasq,perige,
-        psisq,tsi,qoms24,s4,pinvsq,temp,tempa,temp1,
-        temp2,temp3,temp4,temp5,temp6;
-
-
-    /* Initialization */
-    if (~sat->flags & SDP4_INITIALIZED_FLAG) {
-
-        sat->flags |= SDP4_INITIALIZED_FLAG;
-
-        /* Recover original mean motion (xnodp) and   */
-        /* semimajor axis (aodp) from input elements. */
-        a1 = pow (xke / sat->tle.xno, tothrd);
-        sat->deep_arg.cosio = cos (sat->tle.xincl);
-        sat->deep_arg.theta2 = sat->deep_arg.cosio * sat->deep_arg.cosio;
-        sat->sgps.x3thm1 = 3.0 * sat->deep_arg.theta2 - 1.0;
-        sat->deep_arg.eosq = sat->tle.eo * sat->tle.eo;
-        sat->deep_arg.betao2 = 1.0 - sat->deep_arg.eosq;
-        sat->deep_arg.betao = sqrt (sat->deep_arg.betao2);
-        del1 = 1.5 * ck2 * sat->sgps.x3thm1 /
-            (a1 * a1 * sat->deep_arg.betao * sat->deep_arg.betao2);
-        ao = a1 * (1.0 - del1 * (0.5 * tothrd + del1 * (1.0 + 134.0 / 81.0 * del1)));
-        delo = 1.5 * ck2 * sat->sgps.x3thm1 /
-            (ao * ao * sat->deep_arg.betao * sat->deep_arg.betao2);
-        sat->deep_arg.xnodp = sat->tle.xno / (1.0 + delo);
-        sat->deep_arg.aodp = ao / (1.0 - delo);
-
-        /* For perigee below 156 km, the values */
-        /* of s and qoms2t are altered.         */
-        s4 = __s__;
-        qoms24 = qoms2t;
-        perige = (sat->deep_arg.aodp * (1.0 - sat->tle.eo) - ae) * xkmper;
-        if (perige < 156.0) {
-            if (perige <= 98.0)
-                s4 = 20.0;
-            else
-                s4 = perige - 78.0;
-            qoms24 = pow ((120.0 - s4) * ae / xkmper, 4);
-            s4 = s4 / xkmper + ae;
-        }
-        pinvsq = 1.0 / (sat->deep_arg.aodp * sat->deep_arg.aodp *
-                sat->deep_arg.betao2 * sat->deep_arg.betao2);
-        sat->deep_arg.sing = sin (sat->tle.omegao);
-        sat->deep_arg.cosg = cos (sat->tle.omegao);
-        tsi = 1.0 / (sat->deep_arg.aodp - s4);
-        eta = sat->deep_arg.aodp * sat->tle.eo * tsi;
-        etasq = eta * eta;
-        eeta = sat->tle.eo * eta;
-        psisq = fabs (1.0 - etasq);
-        coef = qoms24 * pow (tsi, 4);
-        coef1 = coef / pow (psisq, 3.5);
-        c2 = coef1 * sat->deep_arg.xnodp * (sat->deep_arg.aodp *
-                            (1.0 + 1.5 * etasq + eeta *
-                             (4.0 + etasq)) + 0.75 * ck2 * tsi / psisq * 
-                            sat->sgps.x3thm1 * (8.0 + 3.0 * etasq *
-                                    (8.0 + etasq)));
-        sat->sgps.c1 = sat->tle.bstar * c2;
-        sat->deep_arg.sinio = sin (sat->tle.xincl);
-        a3ovk2 = -xj3 / ck2 * pow (ae, 3);
-        sat->sgps.x1mth2 = 1.0 - sat->deep_arg.theta2;
-        sat->sgps.c4 = 2.0 * sat->deep_arg.xnodp * coef1 *
-            sat->deep_arg.aodp * sat->deep_arg.betao2 *
-            (eta * (2.0 + 0.5 * etasq) + sat->tle.eo *
-             (0.5 + 2.0 * etasq) - 2.0 * ck2 * tsi /
-             (sat->deep_arg.aodp * psisq) * (-3.0 * sat->sgps.x3thm1 *
-                             (1.0 - 2.0 * eeta + etasq *
-                              (1.5 - 0.5 * eeta)) +
-                             0.75 * sat->sgps.x1mth2 * 
-                             (2.0 * etasq - eeta * (1.0 + etasq)) *
-                             cos (2.0 * sat->tle.omegao)));
-        theta4 = sat->deep_arg.theta2 * sat->deep_arg.theta2;
-        temp1 = 3.0 * ck2 * pinvsq * sat->deep_arg.xnodp;
-        temp2 = temp1 * ck2 * pinvsq;
-        temp3 = 1.25 * ck4 * pinvsq * pinvsq * sat->deep_arg.xnodp;
-        sat->deep_arg.xmdot = sat->deep_arg.xnodp + 0.5 * temp1 * sat->deep_arg.betao *
-            sat->sgps.x3thm1 + 0.0625 * temp2 * sat->deep_arg.betao *
-            (13.0 - 78.0 * sat->deep_arg.theta2 + 137.0 * theta4);
-        x1m5th = 1.0 - 5.0 * sat->deep_arg.theta2;
-        sat->deep_arg.omgdot = -0.5 * temp1 * x1m5th + 0.0625 * temp2 *
-                        (7.0 - 114.0 * sat->deep_arg.theta2 + 395.0 * theta4) +
-                    temp3 * (3.0 - 36.0 * sat->deep_arg.theta2 + 49.0 * theta4);
-        xhdot1 = -temp1 * sat->deep_arg.cosio;
-        sat->deep_arg.xnodot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * sat->deep_arg.theta2) +
-                         2.0 * temp3 * (3.0 - 7.0 * sat->deep_arg.theta2)) *
-            sat->deep_arg.cosio;
-        sat->sgps.xnodcf = 3.5 * sat->deep_arg.betao2 * xhdot1 * sat->sgps.c1;
-        sat->sgps.t2cof = 1.5 * sat->sgps.c1;
-        sat->sgps.xlcof = 0.125 * a3ovk2 * sat->deep_arg.sinio *
-            (3.0 + 5.0 * sat->deep_arg.cosio) / (1.0 + sat->deep_arg.cosio);
-        sat->sgps.aycof = 0.25 * a3ovk2 * sat->deep_arg.sinio;
-        sat->sgps.x7thm1 = 7.0 * sat->deep_arg.theta2 - 1.0;
-
-        /* initialize Deep() */
-        Deep (dpinit, sat);
-    };
+        sinnok,sinu,sinuk,tempe,templ,tsq,u,uk,ux,uy,uz,vx,
+        vy,vz,xinck,xl,xlt,xmam,xmdf,xmx,xmy,xnoddf,xnodek,
+        xll,r,temp,tempa,temp1,temp2,temp3,temp4,temp5,
+        temp6;
+
+    /* working copy of the deep-space arguments */
+    deep_arg_t deep_arg = elset->deep_arg;
 
     /* Update for secular gravity and atmospheric drag */
-    xmdf = sat->tle.xmo + sat->deep_arg.xmdot * tsince;
-    sat->deep_arg.omgadf = sat->tle.omegao + sat->deep_arg.omgdot * tsince;
-    xnoddf = sat->tle.xnodeo + sat->deep_arg.xnodot * tsince;
+    xmdf = elset->xmo + deep_arg.xmdot * tsince;
+    deep_arg.omgadf = elset->omegao + deep_arg.omgdot * tsince;
+    xnoddf = elset->xnodeo + deep_arg.xnodot * tsince;
     tsq = tsince * tsince;
-    sat->deep_arg.xnode = xnoddf + sat->sgps.xnodcf * tsq;
-    tempa = 1.0 - sat->sgps.c1 * tsince;
-    tempe = sat->tle.bstar * sat->sgps.c4 * tsince;
-    templ = sat->sgps.t2cof * tsq;
-    sat->deep_arg.xn = sat->deep_arg.xnodp;
+    deep_arg.xnode = xnoddf + elset->sgps.xnodcf * tsq;
+    tempa = 1.0 - elset->sgps.c1 * tsince;
+    tempe = elset->bstar * elset->sgps.c4 * tsince;
+    templ = elset->sgps.t2cof * tsq;
+    deep_arg.xn = deep_arg.xnodp;
 
     /* Update for deep-space secular effects */
-    sat->deep_arg.xll = xmdf;
-    sat->deep_arg.t = tsince;
+    deep_arg.xll = xmdf;
+    deep_arg.t = tsince;
 
-    Deep (dpsec, sat);
+    Deep (dpsec, elset, &deep_arg, state);
 
-    xmdf = sat->deep_arg.xll;
-    a = pow (xke / sat->deep_arg.xn, tothrd) * tempa * tempa;
-    sat->deep_arg.em = sat->deep_arg.em - tempe;
-    xmam = xmdf + sat->deep_arg.xnodp * templ;
+    xmdf = deep_arg.xll;
+    a = pow (xke / deep_arg.xn, tothrd) * tempa * tempa;
+    deep_arg.em = deep_arg.em - tempe;
+    xmam = xmdf + deep_arg.xnodp * templ;
 
     /* Update for deep-space periodic effects */
-    sat->deep_arg.xll = xmam;
+    deep_arg.xll = xmam;
 
-    Deep (dpper, sat);
+    Deep (dpper, elset, &deep_arg, state);
 
-    xmam = sat->deep_arg.xll;
-    xl = xmam + sat->deep_arg.omgadf + sat->deep_arg.xnode;
-    beta = sqrt (1.0 - sat->deep_arg.em * sat->deep_arg.em);
-    sat->deep_arg.xn = xke / pow( a, 1.5);
+    xmam = deep_arg.xll;
+    xl = xmam + deep_arg.omgadf + deep_arg.xnode;
+    beta = sqrt (1.0 - deep_arg.em * deep_arg.em);
+    deep_arg.xn = xke / pow( a, 1.5);
 
     /* Long period periodics */
-    axn = sat->deep_arg.em * cos (sat->deep_arg.omgadf);
+    axn = deep_arg.em * cos (deep_arg.omgadf);
     temp = 1.0 / (a * beta * beta);
-    xll = temp * sat->sgps.xlcof * axn;
-    aynl = temp * sat->sgps.aycof;
+    xll = temp * elset->sgps.xlcof * axn;
+    aynl = temp * elset->sgps.aycof;
     xlt = xl + xll;
-    ayn = sat->deep_arg.em * sin (sat->deep_arg.omgadf) + aynl;
+    ayn = deep_arg.em * sin (deep_arg.omgadf) + aynl;
 
     /* Solve Kepler's Equation */
-    capu = FMod2p (xlt - sat->deep_arg.xnode);
+    capu = FMod2p (xlt - deep_arg.xnode);
     temp2 = capu;
 
     i = 0;
@@ -463,15 +534,15 @@ void SDP4 (sat_t *sat, double tsince)
     temp2 = temp1 * temp;
 
     /* Update for short periodics */
-    rk = r * (1.0 - 1.5 * temp2 * betal * sat->sgps.x3thm1) +
-         0.5 * temp1 * sat->sgps.x1mth2 * cos2u;
-    uk = u - 0.25 * temp2 * sat->sgps.x7thm1 * sin2u;
-    xnodek = sat->deep_arg.xnode + 1.5 * temp2 * sat->deep_arg.cosio * sin2u;
-    xinck = sat->deep_arg.xinc + 1.5 * temp2 *
-         sat->deep_arg.cosio * sat->deep_arg.sinio * cos2u;
-    rdotk = rdot - sat->deep_arg.xn * temp1 * sat->sgps.x1mth2 * sin2u;
-    rfdotk = rfdot + sat->deep_arg.xn * temp1 *
-         (sat->sgps.x1mth2 * cos2u + 1.5 * sat->sgps.x3thm1);
+    rk = r * (1.0 - 1.5 * temp2 * betal * elset->sgps.x3thm1) +
+         0.5 * temp1 * elset->sgps.x1mth2 * cos2u;
+    uk = u - 0.25 * temp2 * elset->sgps.x7thm1 * sin2u;
+    xnodek = deep_arg.xnode + 1.5 * temp2 * deep_arg.cosio * sin2u;
+    xinck = deep_arg.xinc + 1.5 * temp2 *
+         deep_arg.cosio * deep_arg.sinio * cos2u;
+    rdotk = rdot - deep_arg.xn * temp1 * elset->sgps.x1mth2 * sin2u;
+    rfdotk = rfdot + deep_arg.xn * temp1 *
+         (elset->sgps.x1mth2 * cos2u + 1.5 * elset->sgps.x3thm1);
 
     /* Orientation vectors */
     sinuk = sin (uk);
@@ -490,552 +561,560 @@ void SDP4 (sat_t *sat, double tsince)
     vz = sinik*cosuk;
 
     /* Position and velocity */
-    sat->pos.x = rk * ux;
-    sat->pos.y = rk * uy;
-    sat->pos.z = rk * uz;
-    sat->vel.x = rdotk * ux + rfdotk * vx;
-    sat->vel.y = rdotk * uy + rfdotk * vy;
-    sat->vel.z = rdotk * uz + rfdotk * vz;
+    state->pos.x = rk * ux;
+    state->pos.y = rk * uy;
+    state->pos.z = rk * uz;
+    state->vel.x = rdotk * ux + rfdotk * vx;
+    state->vel.y = rdotk * uy + rfdotk * vy;
+    state->vel.z = rdotk * uz + rfdotk * vz;
 
     /* Phase in rads */
-    sat->phase = xlt - sat->deep_arg.xnode - sat->deep_arg.omgadf + twopi;
-    if (sat->phase < 0.0)
-        sat->phase += twopi;
-    sat->phase = FMod2p (sat->phase);
-
-    sat->tle.omegao1 = sat->deep_arg.omgadf;
-    sat->tle.xincl1  = sat->deep_arg.xinc;
-    sat->tle.xnodeo1 = sat->deep_arg.xnode;
+    state->phase = xlt - deep_arg.xnode - deep_arg.omgadf + twopi;
+    if (state->phase < 0.0)
+        state->phase += twopi;
+    state->phase = FMod2p (state->phase);
+
+    state->omegao1 = deep_arg.omgadf;
+    state->xincl1  = deep_arg.xinc;
+    state->xnodeo1 = deep_arg.xnode;
 }
 
-/* DEEP */
-/* This function is used by SDP4 to add lunar and solar */
-/* perturbation effects to deep-space orbit objects.    */
-void Deep (int ientry, sat_t *sat)
+/* SDP4 */
+/* Same as SDP4_r(), using the element set and state stored in */
+/* sat. The results are copied into sat.                       */
+void SDP4 (sat_t *sat, double tsince)
 {
-    double a1,a2,a3,a4,a5,a6,a7,a8,a9,a10,ainv2,alfdp,aqnv,
-        sgh,sini2,sinis,sinok,sh,si,sil,day,betdp,dalf,
-        bfact,c,cc,cosis,cosok,cosq,ctem,f322,zx,zy,
-        dbet,dls,eoc,eq,f2,f220,f221,f3,f311,f321,xnoh,
-        f330,f441,f442,f522,f523,f542,f543,g200,g201,
-        g211,pgh,ph,s1,s2,s3,s4,s5,s6,s7,se,sel,ses,xls,
-        g300,g310,g322,g410,g422,g520,g521,g532,g533,gam,
-        sinq,sinzf,sis,sl,sll,sls,stem,temp,temp1,x1,x2,
-        x2li,x2omi,x3,x4,x5,x6,x7,x8,xl,xldot,xmao,xnddt,
-        xndot,xno2,xnodce,xnoi,xomi,xpidot,z1,z11,z12,z13,
-        z2,z21,z22,z23,z3,z31,z32,z33,ze,zf,zm,zn,
-        zsing,zsinh,zsini,zcosg,zcosh,zcosi,delt=0,ft=0;
+    SDP4_r (&sat->elset, tsince, &sat->state);
+    Copy_State (sat);
+}
 
-    switch (ientry) {
-    case dpinit : /* Entrance for deep space initialization */
-        sat->dps.thgr = ThetaG (sat->tle.epoch, &sat->deep_arg);
-        eq = sat->tle.eo;
-        sat->dps.xnq = sat->deep_arg.xnodp;
-        aqnv = 1.0 / sat->deep_arg.aodp;
-        sat->dps.xqncl = sat->tle.xincl;
-        xmao = sat->tle.xmo;
-        xpidot = sat->deep_arg.omgdot + sat->deep_arg.xnodot;
-        sinq = sin (sat->tle.xnodeo);
-        cosq = cos (sat->tle.xnodeo);
-        sat->dps.omegaq = sat->tle.omegao;
-        sat->dps.preep = 0;
-
-        /* Initialize lunar solar terms */
-        day = sat->deep_arg.ds50 + 18261.5;  /*Days since 1900 Jan 0.5*/
-        if (day != sat->dps.preep) {
-            sat->dps.preep = day;
-            xnodce = 4.5236020 - 9.2422029E-4 * day;
-            stem = sin (xnodce);
-            ctem = cos (xnodce);
-            sat->dps.zcosil = 0.91375164 - 0.03568096 * ctem;
-            sat->dps.zsinil = sqrt (1.0 - sat->dps.zcosil * sat->dps.zcosil);
-            sat->dps.zsinhl = 0.089683511 * stem / sat->dps.zsinil;
-            sat->dps.zcoshl = sqrt (1.0 - sat->dps.zsinhl * sat->dps.zsinhl);
-            c = 4.7199672 + 0.22997150 * day;
-            gam = 5.8351514 + 0.0019443680 * day;
-            sat->dps.zmol = FMod2p (c - gam);
-            zx = 0.39785416 * stem / sat->dps.zsinil;
-            zy = sat->dps.zcoshl * ctem + 0.91744867 * sat->dps.zsinhl * stem;
-            zx = AcTan (zx,zy);
-            zx = gam + zx - xnodce;
-            sat->dps.zcosgl = cos (zx);
-            sat->dps.zsingl = sin (zx);
-            sat->dps.zmos = 6.2565837 + 0.017201977 * day;
-            sat->dps.zmos = FMod2p (sat->dps.zmos);
-        } /* End if(day != preep) */
-
-        /* Do solar terms */
-        sat->dps.savtsn = 1E20;
-        zcosg = zcosgs;
-        zsing = zsings;
-        zcosi = zcosis;
-        zsini = zsinis;
-        zcosh = cosq;
-        zsinh = sinq;
-        cc = c1ss;
-        zn = zns;
-        ze = zes;
-        xnoi = 1.0 / sat->dps.xnq;
-
-        /* Loop breaks when Solar terms are done a second */
-        /* time, after Lunar terms are initialized        */
-        for(;;) {
-            /* Solar terms done again after Lunar terms are done */
-            a1 = zcosg * zcosh + zsing * zcosi * zsinh;
-            a3 = -zsing * zcosh + zcosg * zcosi * zsinh;
-            a7 = -zcosg * zsinh + zsing * zcosi * zcosh;
-            a8 = zsing * zsini;
-            a9 = zsing * zsinh + zcosg * zcosi * zcosh;
-            a10 = zcosg * zsini;
-            a2 = sat->deep_arg.cosio * a7 + sat->deep_arg.sinio * a8;
-            a4 = sat->deep_arg.cosio * a9 + sat->deep_arg.sinio * a10;
-            a5 = -sat->deep_arg.sinio * a7 + sat->deep_arg.cosio * a8;
-            a6 = -sat->deep_arg.sinio*a9+ sat->deep_arg.cosio*a10;
-            x1 = a1*sat->deep_arg.cosg+a2*sat->deep_arg.sing;
-            x2 = a3*sat->deep_arg.cosg+a4*sat->deep_arg.sing;
-            x3 = -a1*sat->deep_arg.sing+a2*sat->deep_arg.cosg;
-            x4 = -a3*sat->deep_arg.sing+a4*sat->deep_arg.cosg;
-            x5 = a5*sat->deep_arg.sing;
-            x6 = a6*sat->deep_arg.sing;
-            x7 = a5*sat->deep_arg.cosg;
-            x8 = a6*sat->deep_arg.cosg;
-            z31 = 12*x1*x1-3*x3*x3;
-            z32 = 24*x1*x2-6*x3*x4;
-            z33 = 12*x2*x2-3*x4*x4;
-            z1 = 3*(a1*a1+a2*a2)+z31*sat->deep_arg.eosq;
-            z2 = 6*(a1*a3+a2*a4)+z32*sat->deep_arg.eosq;
-            z3 = 3*(a3*a3+a4*a4)+z33*sat->deep_arg.eosq;
-            z11 = -6*a1*a5+sat->deep_arg.eosq*(-24*x1*x7-6*x3*x5);
-            z12 = -6*(a1*a6+a3*a5)+ sat->deep_arg.eosq*
-                (-24*(x2*x7+x1*x8)-6*(x3*x6+x4*x5));
-            z13 = -6*a3*a6+sat->deep_arg.eosq*(-24*x2*x8-6*x4*x6);
-            z21 = 6*a2*a5+sat->deep_arg.eosq*(24*x1*x5-6*x3*x7);
-            z22 = 6*(a4*a5+a2*a6)+ sat->deep_arg.eosq*
-                (24*(x2*x5+x1*x6)-6*(x4*x7+x3*x8));
-            z23 = 6*a4*a6+sat->deep_arg.eosq*(24*x2*x6-6*x4*x8);
-            z1 = z1+z1+sat->deep_arg.betao2*z31;
-            z2 = z2+z2+sat->deep_arg.betao2*z32;
-            z3 = z3+z3+sat->deep_arg.betao2*z33;
-            s3 = cc*xnoi;
-            s2 = -0.5*s3/sat->deep_arg.betao;
-            s4 = s3*sat->deep_arg.betao;
-            s1 = -15*eq*s4;
-            s5 = x1*x3+x2*x4;
-            s6 = x2*x3+x1*x4;
-            s7 = x2*x4-x1*x3;
-            se = s1*zn*s5;
-            si = s2*zn*(z11+z13);
-            sl = -zn*s3*(z1+z3-14-6*sat->deep_arg.eosq);
-            sgh = s4*zn*(z31+z33-6);
-            sh = -zn*s2*(z21+z23);
-            if (sat->dps.xqncl < 5.2359877E-2)
-                sh = 0;
-            sat->dps.ee2 = 2*s1*s6;
-            sat->dps.e3 = 2*s1*s7;
-            sat->dps.xi2 = 2*s2*z12;
-            sat->dps.xi3 = 2*s2*(z13-z11);
-            sat->dps.xl2 = -2*s3*z2;
-            sat->dps.xl3 = -2*s3*(z3-z1);
-            sat->dps.xl4 = -2*s3*(-21-9*sat->deep_arg.eosq)*ze;
-            sat->dps.xgh2 = 2*s4*z32;
-            sat->dps.xgh3 = 2*s4*(z33-z31);
-            sat->dps.xgh4 = -18*s4*ze;
-            sat->dps.xh2 = -2*s2*z22;
-            sat->dps.xh3 = -2*s2*(z23-z21);
-
-            if (sat->flags & LUNAR_TERMS_DONE_FLAG)
-                break;
+/* Deep_Init */
+/* Deep-space initialization, formerly the dpinit entry of Deep(). */
+static void Deep_Init (sgpsdp_elset_t *elset)
+{
+    double a1,a2,a3,a4,a5,a6,a7,a8,a9,a10,ainv2,aqnv,sgh,
+        sini2,sh,si,day,bfact,c,cc,cosq,ctem,f322,zx,zy,eoc,
+        eq,f220,f221,f311,f321,f330,f441,f442,f522,f523,
+        f542,f543,g200,g201,g211,s1,s2,s3,s4,s5,s6,s7,se,
+        g300,g310,g322,g410,g422,g520,g521,g532,g533,gam,
+        sinq,sl,stem,temp,temp1,x1,x2,x3,x4,x5,x6,x7,x8,
+        xmao,xno2,xnodce,xnoi,xpidot,z1,z11,z12,z13,z2,z21,
+        z22,z23,z3,z31,z32,z33,ze,zn,zsing,zsinh,zsini,
+        zcosg,zcosh,zcosi;
+
+    elset->dps.thgr = ThetaG (elset->epoch, &elset->deep_arg);
+    eq = elset->eo;
+    elset->dps.xnq = elset->deep_arg.xnodp;
+    aqnv = 1.0 / elset->deep_arg.aodp;
+    elset->dps.xqncl = elset->xincl;
+    xmao = elset->xmo;
+    xpidot = elset->deep_arg.omgdot + elset->deep_arg.xnodot;
+    sinq = sin (elset->xnodeo);
+    cosq = cos (elset->xnodeo);
+    elset->dps.omegaq = elset->omegao;
+    elset->dps.preep = 0;
+
+    /* Initialize lunar solar terms */
+    day = elset->deep_arg.ds50 + 18261.5;  /*Days since 1900 Jan 0.5*/
+    if (day != elset->dps.preep) {
+        elset->dps.preep = day;
+        xnodce = 4.5236020 - 9.2422029E-4 * day;
+        stem = sin (xnodce);
+        ctem = cos (xnodce);
+        elset->dps.zcosil = 0.91375164 - 0.03568096 * ctem;
+        elset->dps.zsinil = sqrt (1.0 - elset->dps.zcosil * elset->dps.zcosil);
+        elset->dps.zsinhl = 0.089683511 * stem / elset->dps.zsinil;
+        elset->dps.zcoshl = sqrt (1.0 - elset->dps.zsinhl * elset->dps.zsinhl);
+        c = 4.7199672 + 0.22997150 * day;
+        gam = 5.8351514 + 0.0019443680 * day;
+        elset->dps.zmol = FMod2p (c - gam);
+        zx = 0.39785416 * stem / elset->dps.zsinil;
+        zy = elset->dps.zcoshl * ctem + 0.91744867 * elset->dps.zsinhl * stem;
+        zx = AcTan (zx,zy);
+        zx = gam + zx - xnodce;
+        elset->dps.zcosgl = cos (zx);
+        elset->dps.zsingl = sin (zx);
+        elset->dps.zmos = 6.2565837 + 0.017201977 * day;
+        elset->dps.zmos = FMod2p (elset->dps.zmos);
+    } /* End if(day != preep) */
+
+    /* Do solar terms */
+    zcosg = zcosgs;
+    zsing = zsings;
+    zcosi = zcosis;
+    zsini = zsinis;
+    zcosh = cosq;
+    zsinh = sinq;
+    cc = c1ss;
+    zn = zns;
+    ze = zes;
+    xnoi = 1.0 / elset->dps.xnq;
+
+    /* Loop breaks when Solar terms are done a second */
+    /* time, after Lunar terms are initialized        */
+    for(;;) {
+        /* Solar terms done again after Lunar terms are done */
+        a1 = zcosg * zcosh + zsing * zcosi * zsinh;
+        a3 = -zsing * zcosh + zcosg * zcosi * zsinh;
+        a7 = -zcosg * zsinh + zsing * zcosi * zcosh;
+        a8 = zsing * zsini;
+        a9 = zsing * zsinh + zcosg * zcosi * zcosh;
+        a10 = zcosg * zsini;
+        a2 = elset->deep_arg.cosio * a7 + elset->deep_arg.sinio * a8;
+        a4 = elset->deep_arg.cosio * a9 + elset->deep_arg.sinio * a10;
+        a5 = -elset->deep_arg.sinio * a7 + elset->deep_arg.cosio * a8;
+        a6 = -elset->deep_arg.sinio*a9+ elset->deep_arg.cosio*a10;
+        x1 = a1*elset->deep_arg.cosg+a2*elset->deep_arg.sing;
+        x2 = a3*elset->deep_arg.cosg+a4*elset->deep_arg.sing;
+        x3 = -a1*elset->deep_arg.sing+a2*elset->deep_arg.cosg;
+        x4 = -a3*elset->deep_arg.sing+a4*elset->deep_arg.cosg;
+        x5 = a5*elset->deep_arg.sing;
+        x6 = a6*elset->deep_arg.sing;
+        x7 = a5*elset->deep_arg.cosg;
+        x8 = a6*elset->deep_arg.cosg;
+        z31 = 12*x1*x1-3*x3*x3;
+        z32 = 24*x1*x2-6*x3*x4;
+        z33 = 12*x2*x2-3*x4*x4;
+        z1 = 3*(a1*a1+a2*a2)+z31*elset->deep_arg.eosq;
+        z2 = 6*(a1*a3+a2*a4)+z32*elset->deep_arg.eosq;
+        z3 = 3*(a3*a3+a4*a4)+z33*elset->deep_arg.eosq;
+        z11 = -6*a1*a5+elset->deep_arg.eosq*(-24*x1*x7-6*x3*x5);
+        z12 = -6*(a1*a6+a3*a5)+ elset->deep_arg.eosq*
+            (-24*(x2*x7+x1*x8)-6*(x3*x6+x4*x5));
+        z13 = -6*a3*a6+elset->deep_arg.eosq*(-24*x2*x8-6*x4*x6);
+        z21 = 6*a2*a5+elset->deep_arg.eosq*(24*x1*x5-6*x3*x7);
+        z22 = 6*(a4*a5+a2*a6)+ elset->deep_arg.eosq*
+            (24*(x2*x5+x1*x6)-6*(x4*x7+x3*x8));
+        z23 = 6*a4*a6+elset->deep_arg.eosq*(24*x2*x6-6*x4*x8);
+        z1 = z1+z1+elset->deep_arg.betao2*z31;
+        z2 = z2+z2+elset->deep_arg.betao2*z32;
+        z3 = z3+z3+elset->deep_arg.betao2*z33;
+        s3 = cc*xnoi;
+        s2 = -0.5*s3/elset->deep_arg.betao;
+        s4 = s3*elset->deep_arg.betao;
+        s1 = -15*eq*s4;
+        s5 = x1*x3+x2*x4;
+        s6 = x2*x3+x1*x4;
+        s7 = x2*x4-x1*x3;
+        se = s1*zn*s5;
+        si = s2*zn*(z11+z13);
+        sl = -zn*s3*(z1+z3-14-6*elset->deep_arg.eosq);
+        sgh = s4*zn*(z31+z33-6);
+        sh = -zn*s2*(z21+z23);
+        if (elset->dps.xqncl < 5.2359877E-2)
+            sh = 0;
+        elset->dps.ee2 = 2*s1*s6;
+        elset->dps.e3 = 2*s1*s7;
+        elset->dps.xi2 = 2*s2*z12;
+        elset->dps.xi3 = 2*s2*(z13-z11);
+        elset->dps.xl2 = -2*s3*z2;
+        elset->dps.xl3 = -2*s3*(z3-z1);
+        elset->dps.xl4 = -2*s3*(-21-9*elset->deep_arg.eosq)*ze;
+        elset->dps.xgh2 = 2*s4*z32;
+        elset->dps.xgh3 = 2*s4*(z33-z31);
+        elset->dps.xgh4 = -18*s4*ze;
+        elset->dps.xh2 = -2*s2*z22;
+        elset->dps.xh3 = -2*s2*(z23-z21);
+
+        if (elset->flags & LUNAR_TERMS_DONE_FLAG)
+            break;
 
-            /* Do lunar terms */
-            sat->dps.sse = se;
-            sat->dps.ssi = si;
-            sat->dps.ssl = sl;
-            sat->dps.ssh = sh/sat->deep_arg.sinio;
-            sat->dps.ssg = sgh-sat->deep_arg.cosio*sat->dps.ssh;
-            sat->dps.se2 = sat->dps.ee2;
-            sat->dps.si2 = sat->dps.xi2;
-            sat->dps.sl2 = sat->dps.xl2;
-            sat->dps.sgh2 = sat->dps.xgh2;
-            sat->dps.sh2 = sat->dps.xh2;
-            sat->dps.se3 = sat->dps.e3;
-            sat->dps.si3 = sat->dps.xi3;
-            sat->dps.sl3 = sat->dps.xl3;
-            sat->dps.sgh3 = sat->dps.xgh3;
-            sat->dps.sh3 = sat->dps.xh3;
-            sat->dps.sl4 = sat->dps.xl4;
-            sat->dps.sgh4 = sat->dps.xgh4;
-            zcosg = sat->dps.zcosgl;
-            zsing = sat->dps.zsingl;
-            zcosi = sat->dps.zcosil;
-            zsini = sat->dps.zsinil;
-            zcosh = sat->dps.zcoshl*cosq+sat->dps.zsinhl*sinq;
-            zsinh = sinq*sat->dps.zcoshl-cosq*sat->dps.zsinhl;
-            zn = znl;
-            cc = c1l;
-            ze = zel;
-            sat->flags |= LUNAR_TERMS_DONE_FLAG;
-        } /* End of for(;;) */
-
-        sat->dps.sse = sat->dps.sse+se;
-        sat->dps.ssi = sat->dps.ssi+si;
-        sat->dps.ssl = sat->dps.ssl+sl;
-        sat->dps.ssg = sat->dps.ssg+sgh-sat->deep_arg.cosio/sat->deep_arg.sinio*sh;
-        sat->dps.ssh = sat->dps.ssh+sh/sat->deep_arg.sinio;
-
-        /* Geopotential resonance initialization for 12 hour orbits */
-        sat->flags &= ~RESONANCE_FLAG;
-        sat->flags &= ~SYNCHRONOUS_FLAG;
-
-        if( !((sat->dps.xnq < 0.0052359877) && (sat->dps.xnq > 0.0034906585)) ) {
-            if( (sat->dps.xnq < 0.00826) || (sat->dps.xnq > 0.00924) )
-                return;
-            if (eq < 0.5)
-                return;
-            sat->flags |= RESONANCE_FLAG;
-            eoc = eq*sat->deep_arg.eosq;
-            g201 = -0.306-(eq-0.64)*0.440;
-            if (eq <= 0.65) {
-                g211 = 3.616-13.247*eq+16.290*sat->deep_arg.eosq;
-                g310 = -19.302+117.390*eq-228.419*
-                    sat->deep_arg.eosq+156.591*eoc;
-                g322 = -18.9068+109.7927*eq-214.6334*
-                    sat->deep_arg.eosq+146.5816*eoc;
-                g410 = -41.122+242.694*eq-471.094*
-                    sat->deep_arg.eosq+313.953*eoc;
-                g422 = -146.407+841.880*eq-1629.014*
-                    sat->deep_arg.eosq+1083.435*eoc;
-                g520 = -532.114+3017.977*eq-5740*
-                    sat->deep_arg.eosq+3708.276*eoc;
-            }
-            else {
-                g211 = -72.099+331.819*eq-508.738*
-                    sat->deep_arg.eosq+266.724*eoc;
-                g310 = -346.844+1582.851*eq-2415.925*
-                    sat->deep_arg.eosq+1246.113*eoc;
-                g322 = -342.585+1554.908*eq-2366.899*
-                    sat->deep_arg.eosq+1215.972*eoc;
-                g410 = -1052.797+4758.686*eq-7193.992*
-                    sat->deep_arg.eosq+3651.957*eoc;
-                g422 = -3581.69+16178.11*eq-24462.77*
-                    sat->deep_arg.eosq+ 12422.52*eoc;
-                if (eq <= 0.715)
-                    g520 = 1464.74-4664.75*eq+3763.64*sat->deep_arg.eosq;
-                else
-                    g520 = -5149.66+29936.92*eq-54087.36*
-                        sat->deep_arg.eosq+31324.56*eoc;
-            } /* End if (eq <= 0.65) */
-
-            if (eq < 0.7) {
-                g533 = -919.2277+4988.61*eq-9064.77*
-                    sat->deep_arg.eosq+5542.21*eoc;
-                g521 = -822.71072+4568.6173*eq-8491.4146*
-                    sat->deep_arg.eosq+5337.524*eoc;
-                g532 = -853.666+4690.25*eq-8624.77*
-                    sat->deep_arg.eosq+ 5341.4*eoc;
-            }
-            else {
-                g533 = -37995.78+161616.52*eq-229838.2*
-                    sat->deep_arg.eosq+109377.94*eoc;
-                g521 = -51752.104+218913.95*eq-309468.16*
-                    sat->deep_arg.eosq+146349.42*eoc;
-                g532 = -40023.88+170470.89*eq-242699.48*
-                    sat->deep_arg.eosq+115605.82*eoc;
-            } /* End if (eq <= 0.7) */
-
-            sini2 = sat->deep_arg.sinio*sat->deep_arg.sinio;
-            f220 = 0.75*(1+2*sat->deep_arg.cosio+sat->deep_arg.theta2);
-            f221 = 1.5*sini2;
-            f321 = 1.875*sat->deep_arg.sinio*(1-2*\
-                              sat->deep_arg.cosio-3*sat->deep_arg.theta2);
-            f322 = -1.875*sat->deep_arg.sinio*(1+2*
-                               sat->deep_arg.cosio-3*sat->deep_arg.theta2);
-            f441 = 35*sini2*f220;
-            f442 = 39.3750*sini2*sini2;
-            f522 = 9.84375*sat->deep_arg.sinio*(sini2*(1-2*sat->deep_arg.cosio-5*
-                                   sat->deep_arg.theta2)+0.33333333*(-2+4*sat->deep_arg.cosio+
-                                                 6*sat->deep_arg.theta2));
-            f523 = sat->deep_arg.sinio*(4.92187512*sini2*(-2-4*
-                                  sat->deep_arg.cosio+10*sat->deep_arg.theta2)+6.56250012
-                        *(1+2*sat->deep_arg.cosio-3*sat->deep_arg.theta2));
-            f542 = 29.53125*sat->deep_arg.sinio*(2-8*
-                             sat->deep_arg.cosio+sat->deep_arg.theta2*
-                             (-12+8*sat->deep_arg.cosio+10*sat->deep_arg.theta2));
-            f543 = 29.53125*sat->deep_arg.sinio*(-2-8*sat->deep_arg.cosio+
-                             sat->deep_arg.theta2*(12+8*sat->deep_arg.cosio-10*
-                                       sat->deep_arg.theta2));
-            xno2 = sat->dps.xnq*sat->dps.xnq;
-            ainv2 = aqnv*aqnv;
-            temp1 = 3*xno2*ainv2;
-            temp = temp1*root22;
-            sat->dps.d2201 = temp*f220*g201;
-            sat->dps.d2211 = temp*f221*g211;
-            temp1 = temp1*aqnv;
-            temp = temp1*root32;
-            sat->dps.d3210 = temp*f321*g310;
-            sat->dps.d3222 = temp*f322*g322;
-            temp1 = temp1*aqnv;
-            temp = 2*temp1*root44;
-            sat->dps.d4410 = temp*f441*g410;
-            sat->dps.d4422 = temp*f442*g422;
-            temp1 = temp1*aqnv;
-            temp = temp1*root52;
-            sat->dps.d5220 = temp*f522*g520;
-            sat->dps.d5232 = temp*f523*g532;
-            temp = 2*temp1*root54;
-            sat->dps.d5421 = temp*f542*g521;
-            sat->dps.d5433 = temp*f543*g533;
-            sat->dps.xlamo = xmao+sat->tle.xnodeo+sat->tle.xnodeo-sat->dps.thgr-sat->dps.thgr;
-            bfact = sat->deep_arg.xmdot+sat->deep_arg.xnodot+
-                sat->deep_arg.xnodot-thdt-thdt;
-            bfact = bfact+sat->dps.ssl+sat->dps.ssh+sat->dps.ssh;
+        /* Do lunar terms */
+        elset->dps.sse = se;
+        elset->dps.ssi = si;
+        elset->dps.ssl = sl;
+        elset->dps.ssh = sh/elset->deep_arg.sinio;
+        elset->dps.ssg = sgh-elset->deep_arg.cosio*elset->dps.ssh;
+        elset->dps.se2 = elset->dps.ee2;
+        elset->dps.si2 = elset->dps.xi2;
+        elset->dps.sl2 = elset->dps.xl2;
+        elset->dps.sgh2 = elset->dps.xgh2;
+        elset->dps.sh2 = elset->dps.xh2;
+        elset->dps.se3 = elset->dps.e3;
+        elset->dps.si3 = elset->dps.xi3;
+        elset->dps.sl3 = elset->dps.xl3;
+        elset->dps.sgh3 = elset->dps.xgh3;
+        elset->dps.sh3 = elset->dps.xh3;
+        elset->dps.sl4 = elset->dps.xl4;
+        elset->dps.sgh4 = elset->dps.xgh4;
+        zcosg = elset->dps.zcosgl;
+        zsing = elset->dps.zsingl;
+        zcosi = elset->dps.zcosil;
+        zsini = elset->dps.zsinil;
+        zcosh = elset->dps.zcoshl*cosq+elset->dps.zsinhl*sinq;
+        zsinh = sinq*elset->dps.zcoshl-cosq*elset->dps.zsinhl;
+        zn = znl;
+        cc = c1l;
+        ze = zel;
+        elset->flags |= LUNAR_TERMS_DONE_FLAG;
+    } /* End of for(;;) */
+
+    elset->dps.sse = elset->dps.sse+se;
+    elset->dps.ssi = elset->dps.ssi+si;
+    elset->dps.ssl = elset->dps.ssl+sl;
+    elset->dps.ssg = elset->dps.ssg+sgh-elset->deep_arg.cosio/elset->deep_arg.sinio*sh;
+    elset->dps.ssh = elset->dps.ssh+sh/elset->deep_arg.sinio;
+
+    /* Geopotential resonance initialization for 12 hour orbits */
+    elset->flags &= ~RESONANCE_FLAG;
+    elset->flags &= ~SYNCHRONOUS_FLAG;
+
+    if( !((elset->dps.xnq < 0.0052359877) && (elset->dps.xnq > 0.0034906585)) ) {
+        if( (elset->dps.xnq < 0.00826) || (elset->dps.xnq > 0.00924) )
+            return;
+        if (eq < 0.5)
+            return;
+        elset->flags |= RESONANCE_FLAG;
+        eoc = eq*elset->deep_arg.eosq;
+        g201 = -0.306-(eq-0.64)*0.440;
+        if (eq <= 0.65) {
+            g211 = 3.616-13.247*eq+16.290*elset->deep_arg.eosq;
+            g310 = -19.302+117.390*eq-228.419*
+                elset->deep_arg.eosq+156.591*eoc;
+            g322 = -18.9068+109.7927*eq-214.6334*
+                elset->deep_arg.eosq+146.5816*eoc;
+            g410 = -41.122+242.694*eq-471.094*
+                elset->deep_arg.eosq+313.953*eoc;
+            g422 = -146.407+841.880*eq-1629.014*
+                elset->deep_arg.eosq+1083.435*eoc;
+            g520 = -532.114+3017.977*eq-5740*
+                elset->deep_arg.eosq+3708.276*eoc;
         }
         else {
-            sat->flags |= RESONANCE_FLAG;
-            sat->flags |= SYNCHRONOUS_FLAG;
-            /* Synchronous resonance terms initialization */
-            g200 = 1+sat->deep_arg.eosq*(-2.5+0.8125*sat->deep_arg.eosq);
-            g310 = 1+2*sat->deep_arg.eosq;
-            g300 = 1+sat->deep_arg.eosq*(-6+6.60937*sat->deep_arg.eosq);
-            f220 = 0.75*(1+sat->deep_arg.cosio)*(1+sat->deep_arg.cosio);
-            f311 = 0.9375*sat->deep_arg.sinio*sat->deep_arg.sinio*
-                (1+3*sat->deep_arg.cosio)-0.75*(1+sat->deep_arg.cosio);
-            f330 = 1+sat->deep_arg.cosio;
-            f330 = 1.875*f330*f330*f330;
-            sat->dps.del1 = 3*sat->dps.xnq*sat->dps.xnq*aqnv*aqnv;
-            sat->dps.del2 = 2*sat->dps.del1*f220*g200*q22;
-            sat->dps.del3 = 3*sat->dps.del1*f330*g300*q33*aqnv;
-            sat->dps.del1 = sat->dps.del1*f311*g310*q31*aqnv;
-            sat->dps.fasx2 = 0.13130908;
-            sat->dps.fasx4 = 2.8843198;
-            sat->dps.fasx6 = 0.37448087;
-            sat->dps.xlamo = xmao+sat->tle.xnodeo+sat->tle.omegao-sat->dps.thgr;
-            bfact = sat->deep_arg.xmdot+xpidot-thdt;
-            bfact = bfact+sat->dps.ssl+sat->dps.ssg+sat->dps.ssh;
+            g211 = -72.099+331.819*eq-508.738*
+                elset->deep_arg.eosq+266.724*eoc;
+            g310 = -346.844+1582.851*eq-2415.925*
+                elset->deep_arg.eosq+1246.113*eoc;
+            g322 = -342.585+1554.908*eq-2366.899*
+                elset->deep_arg.eosq+1215.972*eoc;
+            g410 = -1052.797+4758.686*eq-7193.992*
+                elset->deep_arg.eosq+3651.957*eoc;
+            g422 = -3581.69+16178.11*eq-24462.77*
+                elset->deep_arg.eosq+ 12422.52*eoc;
+            if (eq <= 0.715)
+                g520 = 1464.74-4664.75*eq+3763.64*elset->deep_arg.eosq;
+            else
+                g520 = -5149.66+29936.92*eq-54087.36*
+                    elset->deep_arg.eosq+31324.56*eoc;
+        } /* End if (eq <= 0.65) */
+
+        if (eq < 0.7) {
+            g533 = -919.2277+4988.61*eq-9064.77*
+                elset->deep_arg.eosq+5542.21*eoc;
+            g521 = -822.71072+4568.6173*eq-8491.4146*
+                elset->deep_arg.eosq+5337.524*eoc;
+            g532 = -853.666+4690.25*eq-8624.77*
+                elset->deep_arg.eosq+ 5341.4*eoc;
         }
+        else {
+            g533 = -37995.78+161616.52*eq-229838.2*
+                elset->deep_arg.eosq+109377.94*eoc;
+            g521 = -51752.104+218913.95*eq-309468.16*
+                elset->deep_arg.eosq+146349.42*eoc;
+            g532 = -40023.88+170470.89*eq-242699.48*
+                elset->deep_arg.eosq+115605.82*eoc;
+        } /* End if (eq <= 0.7) */
+
+        sini2 = elset->deep_arg.sinio*elset->deep_arg.sinio;
+        f220 = 0.75*(1+2*elset->deep_arg.cosio+elset->deep_arg.theta2);
+        f221 = 1.5*sini2;
+        f321 = 1.875*elset->deep_arg.sinio*(1-2*\
+                          elset->deep_arg.cosio-3*elset->deep_arg.theta2);
+        f322 = -1.875*elset->deep_arg.sinio*(1+2*
+                           elset->deep_arg.cosio-3*elset->deep_arg.theta2);
+        f441 = 35*sini2*f220;
+        f442 = 39.3750*sini2*sini2;
+        f522 = 9.84375*elset->deep_arg.sinio*(sini2*(1-2*elset->deep_arg.cosio-5*
+                               elset->deep_arg.theta2)+0.33333333*(-2+4*elset->deep_arg.cosio+
+                                             6*elset->deep_arg.theta2));
+        f523 = elset->deep_arg.sinio*(4.92187512*sini2*(-2-4*
+                              elset->deep_arg.cosio+10*elset->deep_arg.theta2)+6.56250012
+                    *(1+2*elset->deep_arg.cosio-3*elset->deep_arg.theta2));
+        f542 = 29.53125*elset->deep_arg.sinio*(2-8*
+                         elset->deep_arg.cosio+elset->deep_arg.theta2*
+                         (-12+8*elset->deep_arg.cosio+10*elset->deep_arg.theta2));
+        f543 = 29.53125*elset->deep_arg.sinio*(-2-8*elset->deep_arg.cosio+
+                         elset->deep_arg.theta2*(12+8*elset->deep_arg.cosio-10*
+                                   elset->deep_arg.theta2));
+        xno2 = elset->dps.xnq*elset->dps.xnq;
+        ainv2 = aqnv*aqnv;
+        temp1 = 3*xno2*ainv2;
+        temp = temp1*root22;
+        elset->dps.d2201 = temp*f220*g201;
+        elset->dps.d2211 = temp*f221*g211;
+        temp1 = temp1*aqnv;
+        temp = temp1*root32;
+        elset->dps.d3210 = temp*f321*g310;
+        elset->dps.d3222 = temp*f322*g322;
+        temp1 = temp1*aqnv;
+        temp = 2*temp1*root44;
+        elset->dps.d4410 = temp*f441*g410;
+        elset->dps.d4422 = temp*f442*g422;
+        temp1 = temp1*aqnv;
+        temp = temp1*root52;
+        elset->dps.d5220 = temp*f522*g520;
+        elset->dps.d5232 = temp*f523*g532;
+        temp = 2*temp1*root54;
+        elset->dps.d5421 = temp*f542*g521;
+        elset->dps.d5433 = temp*f543*g533;
+        elset->dps.xlamo = xmao+elset->xnodeo+elset->xnodeo-elset->dps.thgr-elset->dps.thgr;
+        bfact = elset->deep_arg.xmdot+elset->deep_arg.xnodot+
+            elset->deep_arg.xnodot-thdt-thdt;
+        bfact = bfact+elset->dps.ssl+elset->dps.ssh+elset->dps.ssh;
+    }
+    else {
+        elset->flags |= RESONANCE_FLAG;
+        elset->flags |= SYNCHRONOUS_FLAG;
+        /* Synchronous resonance terms initialization */
+        g200 = 1+elset->deep_arg.eosq*(-2.5+0.8125*elset->deep_arg.eosq);
+        g310 = 1+2*elset->deep_arg.eosq;
+        g300 = 1+elset->deep_arg.eosq*(-6+6.60937*elset->deep_arg.eosq);
+        f220 = 0.75*(1+elset->deep_arg.cosio)*(1+elset->deep_arg.cosio);
+        f311 = 0.9375*elset->deep_arg.sinio*elset->deep_arg.sinio*
+            (1+3*elset->deep_arg.cosio)-0.75*(1+elset->deep_arg.cosio);
+        f330 = 1+elset->deep_arg.cosio;
+        f330 = 1.875*f330*f330*f330;
+        elset->dps.del1 = 3*elset->dps.xnq*elset->dps.xnq*aqnv*aqnv;
+        elset->dps.del2 = 2*elset->dps.del1*f220*g200*q22;
+        elset->dps.del3 = 3*elset->dps.del1*f330*g300*q33*aqnv;
+        elset->dps.del1 = elset->dps.del1*f311*g310*q31*aqnv;
+        elset->dps.fasx2 = 0.13130908;
+        elset->dps.fasx4 = 2.8843198;
+        elset->dps.fasx6 = 0.37448087;
+        elset->dps.xlamo = xmao+elset->xnodeo+elset->omegao-elset->dps.thgr;
+        bfact = elset->deep_arg.xmdot+xpidot-thdt;
+        bfact = bfact+elset->dps.ssl+elset->dps.ssg+elset->dps.ssh;
+    }
 
-        sat->dps.xfact = bfact-sat->dps.xnq;
+    elset->dps.xfact = bfact-elset->dps.xnq;
 
-        /* Initialize integrator */
-        sat->dps.xli = sat->dps.xlamo;
-        sat->dps.xni = sat->dps.xnq;
-        sat->dps.atime = 0;
-        sat->dps.stepp = 720;
-        sat->dps.stepn = -720;
-        sat->dps.step2 = 259200;
-        /* End case dpinit: */
-        return;
+    /* Initialize integrator */
+    elset->dps.stepp = 720;
+    elset->dps.stepn = -720;
+    elset->dps.step2 = 259200;
+}
+
+
+/* Deep_Checkpoint */
+/* Stores the resonance integrator state after a step. Each step  */
+/* goes to the slot after that of the previous one, so the states */
+/* of the last DEEP_CHECKPOINTS steps are kept.                   */
+static void Deep_Checkpoint (const sgpsdp_elset_t *elset,
+                             sgpsdp_state_t *state)
+{
+    long step = (long) (state->atime/elset->dps.stepp);
+    int i = (int) (((step%DEEP_CHECKPOINTS)+DEEP_CHECKPOINTS)%DEEP_CHECKPOINTS);
+
+    state->ckpt[i].xli = state->xli;
+    state->ckpt[i].xni = state->xni;
+    state->ckpt[i].atime = state->atime;
+}
+
+/* Deep_Resume */
+/* Moves the resonance integrator, which is at epoch or between */
+/* epoch and t, to the checkpoint closest to t that is not past */
+/* t, if there is one closer to t than the integrator.          */
+static void Deep_Resume (double t, sgpsdp_state_t *state)
+{
+    const deep_checkpoint_t *best = NULL;
+    double atime = fabs(state->atime);
+    int i;
+
+    for (i = 0; i < DEEP_CHECKPOINTS; i++) {
+        if( (state->ckpt[i].atime == 0) ||
+            ((t >= 0) != (state->ckpt[i].atime > 0)) ||
+            (fabs(state->ckpt[i].atime) > fabs(t)) ||
+            (fabs(state->ckpt[i].atime) <= atime) )
+            continue;
+
+        best = &state->ckpt[i];
+        atime = fabs(best->atime);
+    }
 
+    if (best != NULL) {
+        state->xli = best->xli;
+        state->xni = best->xni;
+        state->atime = best->atime;
+    }
+}
+
+/* DEEP */
+/* This function is used by SDP4 to add lunar and solar */
+/* perturbation effects to deep-space orbit objects.    */
+void Deep (int ientry, const sgpsdp_elset_t *elset, deep_arg_t *deep_arg,
+           sgpsdp_state_t *state)
+{
+    double alfdp,sinis,sinok,sil,betdp,dalf,cosis,cosok,
+        dbet,dls,f2,f3,xnoh,pgh,ph,sel,ses,xls,sinzf,sis,
+        sll,sls,temp,x2li,x2omi,xl,xldot,xnddt,xndot,xomi,
+        zf,zm,delt=0,ft=0;
+
+    switch (ientry) {
     case dpsec: /* Entrance for deep space secular effects */
-        sat->deep_arg.xll = sat->deep_arg.xll+sat->dps.ssl*sat->deep_arg.t;
-        sat->deep_arg.omgadf = sat->deep_arg.omgadf+sat->dps.ssg*sat->deep_arg.t;
-        sat->deep_arg.xnode = sat->deep_arg.xnode+sat->dps.ssh*sat->deep_arg.t;
-        sat->deep_arg.em = sat->tle.eo+sat->dps.sse*sat->deep_arg.t;
-        sat->deep_arg.xinc = sat->tle.xincl+sat->dps.ssi*sat->deep_arg.t;
-        if (sat->deep_arg.xinc < 0) {
-            sat->deep_arg.xinc = -sat->deep_arg.xinc;
-            sat->deep_arg.xnode = sat->deep_arg.xnode + pi;
-            sat->deep_arg.omgadf = sat->deep_arg.omgadf-pi;
+        deep_arg->xll = deep_arg->xll+elset->dps.ssl*deep_arg->t;
+        deep_arg->omgadf = deep_arg->omgadf+elset->dps.ssg*deep_arg->t;
+        deep_arg->xnode = deep_arg->xnode+elset->dps.ssh*deep_arg->t;
+        deep_arg->em = elset->eo+elset->dps.sse*deep_arg->t;
+        deep_arg->xinc = elset->xincl+elset->dps.ssi*deep_arg->t;
+        if (deep_arg->xinc < 0) {
+            deep_arg->xinc = -deep_arg->xinc;
+            deep_arg->xnode = deep_arg->xnode + pi;
+            deep_arg->omgadf = deep_arg->omgadf-pi;
         }
-        if( ~sat->flags & RESONANCE_FLAG ) return;
-
-        do {
-            if( (sat->dps.atime == 0) ||
-                ((sat->deep_arg.t >= 0) && (sat->dps.atime < 0)) || 
-                ((sat->deep_arg.t < 0) && (sat->dps.atime >= 0)) ) {
-                /* Epoch restart */
-                if( sat->deep_arg.t >= 0 )
-                    delt = sat->dps.stepp;
-                else
-                    delt = sat->dps.stepn;
+        if( ~elset->flags & RESONANCE_FLAG ) return;
+
+        /* The integrator only steps away from epoch. When t is on */
+        /* the other side of epoch or closer to it, the integrator */
+        /* starts again from epoch or from the nearest checkpoint, */
+        /* which gives the same result as integrating from epoch.  */
+        if( (state->atime == 0) ||
+            ((deep_arg->t >= 0) && (state->atime < 0)) ||
+            ((deep_arg->t < 0) && (state->atime >= 0)) ||
+            (fabs(deep_arg->t) < fabs(state->atime)) ) {
+            /* Epoch restart */
+            state->atime = 0;
+            state->xni = elset->dps.xnq;
+            state->xli = elset->dps.xlamo;
+        }
+        Deep_Resume (deep_arg->t, state);
 
-                sat->dps.atime = 0;
-                sat->dps.xni = sat->dps.xnq;
-                sat->dps.xli = sat->dps.xlamo;
+        if( deep_arg->t >= 0 )
+            delt = elset->dps.stepp;
+        else
+            delt = elset->dps.stepn;
+
+        for (;;) {
+            /* Dot terms calculated */
+            if (elset->flags & SYNCHRONOUS_FLAG) {
+                xndot = elset->dps.del1*sin(state->xli-elset->dps.fasx2)+elset->dps.del2*sin(2*(state->xli-elset->dps.fasx4))
+                    +elset->dps.del3*sin(3*(state->xli-elset->dps.fasx6));
+                xnddt = elset->dps.del1*cos(state->xli-elset->dps.fasx2)+2*elset->dps.del2*cos(2*(state->xli-elset->dps.fasx4))
+                    +3*elset->dps.del3*cos(3*(state->xli-elset->dps.fasx6));
             }
-            else {      
-                if( fabs(sat->deep_arg.t) >= fabs(sat->dps.atime) ) {
-                    if ( sat->deep_arg.t > 0 )
-                        delt = sat->dps.stepp;
-                    else
-                        delt = sat->dps.stepn;
-                }
+            else {
+                xomi = elset->dps.omegaq+deep_arg->omgdot*state->atime;
+                x2omi = xomi+xomi;
+                x2li = state->xli+state->xli;
+                xndot = elset->dps.d2201*sin(x2omi+state->xli-g22)
+                    +elset->dps.d2211*sin(state->xli-g22)
+                    +elset->dps.d3210*sin(xomi+state->xli-g32)
+                    +elset->dps.d3222*sin(-xomi+state->xli-g32)
+                    +elset->dps.d4410*sin(x2omi+x2li-g44)
+                    +elset->dps.d4422*sin(x2li-g44)
+                    +elset->dps.d5220*sin(xomi+state->xli-g52)
+                    +elset->dps.d5232*sin(-xomi+state->xli-g52)
+                    +elset->dps.d5421*sin(xomi+x2li-g54)
+                    +elset->dps.d5433*sin(-xomi+x2li-g54);
+                xnddt = elset->dps.d2201*cos(x2omi+state->xli-g22)
+                    +elset->dps.d2211*cos(state->xli-g22)
+                    +elset->dps.d3210*cos(xomi+state->xli-g32)
+                    +elset->dps.d3222*cos(-xomi+state->xli-g32)
+                    +elset->dps.d5220*cos(xomi+state->xli-g52)
+                    +elset->dps.d5232*cos(-xomi+state->xli-g52)
+                    +2*(elset->dps.d4410*cos(x2omi+x2li-g44)
+                        +elset->dps.d4422*cos(x2li-g44)
+                        +elset->dps.d5421*cos(xomi+x2li-g54)
+                        +elset->dps.d5433*cos(-xomi+x2li-g54));
             }
 
-            do {
-                if ( fabs(sat->deep_arg.t-sat->dps.atime) >= sat->dps.stepp ) {
-                    sat->flags |= DO_LOOP_FLAG;
-                    sat->flags &= ~EPOCH_RESTART_FLAG;
-                }
-                else {
-                    ft = sat->deep_arg.t-sat->dps.atime;
-                    sat->flags &= ~DO_LOOP_FLAG;
-                }
-
-                if( fabs(sat->deep_arg.t) < fabs(sat->dps.atime) ) {
-                    if (sat->deep_arg.t >= 0)
-                        delt = sat->dps.stepn;
-                    else
-                        delt = sat->dps.stepp;
-                    sat->flags |= (DO_LOOP_FLAG | EPOCH_RESTART_FLAG);
-                }
-
-                /* Dot terms calculated */
-                if (sat->flags & SYNCHRONOUS_FLAG) {
-                    xndot = sat->dps.del1*sin(sat->dps.xli-sat->dps.fasx2)+sat->dps.del2*sin(2*(sat->dps.xli-sat->dps.fasx4))
-                        +sat->dps.del3*sin(3*(sat->dps.xli-sat->dps.fasx6));
-                    xnddt = sat->dps.del1*cos(sat->dps.xli-sat->dps.fasx2)+2*sat->dps.del2*cos(2*(sat->dps.xli-sat->dps.fasx4))
-                        +3*sat->dps.del3*cos(3*(sat->dps.xli-sat->dps.fasx6));
-                }
-                else {
-                    xomi = sat->dps.omegaq+sat->deep_arg.omgdot*sat->dps.atime;
-                    x2omi = xomi+xomi;
-                    x2li = sat->dps.xli+sat->dps.xli;
-                    xndot = sat->dps.d2201*sin(x2omi+sat->dps.xli-g22)
-                        +sat->dps.d2211*sin(sat->dps.xli-g22)
-                        +sat->dps.d3210*sin(xomi+sat->dps.xli-g32)
-                        +sat->dps.d3222*sin(-xomi+sat->dps.xli-g32)
-                        +sat->dps.d4410*sin(x2omi+x2li-g44)
-                        +sat->dps.d4422*sin(x2li-g44)
-                        +sat->dps.d5220*sin(xomi+sat->dps.xli-g52)
-                        +sat->dps.d5232*sin(-xomi+sat->dps.xli-g52)
-                        +sat->dps.d5421*sin(xomi+x2li-g54)
-                        +sat->dps.d5433*sin(-xomi+x2li-g54);
-                    xnddt = sat->dps.d2201*cos(x2omi+sat->dps.xli-g22)
-                        +sat->dps.d2211*cos(sat->dps.xli-g22)
-                        +sat->dps.d3210*cos(xomi+sat->dps.xli-g32)
-                        +sat->dps.d3222*cos(-xomi+sat->dps.xli-g32)
-                        +sat->dps.d5220*cos(xomi+sat->dps.xli-g52)
-                        +sat->dps.d5232*cos(-xomi+sat->dps.xli-g52)
-                        +2*(sat->dps.d4410*cos(x2omi+x2li-g44)
-                            +sat->dps.d4422*cos(x2li-g44)
-                            +sat->dps.d5421*cos(xomi+x2li-g54)
-                            +sat->dps.d5433*cos(-xomi+x2li-g54));
-                } /* End of if (isFlagSet(SYNCHRONOUS_FLAG)) */
-
-                xldot = sat->dps.xni+sat->dps.xfact;
-                xnddt = xnddt*xldot;
-
-                if(sat->flags & DO_LOOP_FLAG) {
-                    sat->dps.xli = sat->dps.xli+xldot*delt+xndot*sat->dps.step2;
-                    sat->dps.xni = sat->dps.xni+xndot*delt+xnddt*sat->dps.step2;
-                    sat->dps.atime = sat->dps.atime+delt;
-                }
-            }
-            while ( (sat->flags & DO_LOOP_FLAG) &&
-                (~sat->flags & EPOCH_RESTART_FLAG));
+            xldot = state->xni+elset->dps.xfact;
+            xnddt = xnddt*xldot;
+
+            if ( fabs(deep_arg->t-state->atime) < elset->dps.stepp )
+                break;
+
+            state->xli = state->xli+xldot*delt+xndot*elset->dps.step2;
+            state->xni = state->xni+xndot*delt+xnddt*elset->dps.step2;
+            state->atime = state->atime+delt;
+            Deep_Checkpoint (elset, state);
         }
-        while ((sat->flags & DO_LOOP_FLAG) && (sat->flags & EPOCH_RESTART_FLAG));
+        ft = deep_arg->t-state->atime;
 
-        sat->deep_arg.xn = sat->dps.xni+xndot*ft+xnddt*ft*ft*0.5;
-        xl = sat->dps.xli+xldot*ft+xndot*ft*ft*0.5;
-        temp = -sat->deep_arg.xnode+sat->dps.thgr+sat->deep_arg.t*thdt;
+        deep_arg->xn = state->xni+xndot*ft+xnddt*ft*ft*0.5;
+        xl = state->xli+xldot*ft+xndot*ft*ft*0.5;
+        temp = -deep_arg->xnode+elset->dps.thgr+deep_arg->t*thdt;
 
-        if (~sat->flags & SYNCHRONOUS_FLAG)
-            sat->deep_arg.xll = xl+temp+temp;
+        if (~elset->flags & SYNCHRONOUS_FLAG)
+            deep_arg->xll = xl+temp+temp;
         else
-            sat->deep_arg.xll = xl-sat->deep_arg.omgadf+temp;
+            deep_arg->xll = xl-deep_arg->omgadf+temp;
 
         return;
         /*End case dpsec: */
 
     case dpper: /* Entrance for lunar-solar periodics */
-        sinis = sin(sat->deep_arg.xinc);
-        cosis = cos(sat->deep_arg.xinc);
-        if (fabs(sat->dps.savtsn-sat->deep_arg.t) >= 30) {
-            sat->dps.savtsn = sat->deep_arg.t;
-            zm = sat->dps.zmos+zns*sat->deep_arg.t;
+        sinis = sin(deep_arg->xinc);
+        cosis = cos(deep_arg->xinc);
+        if (fabs(state->savtsn-deep_arg->t) >= 30) {
+            state->savtsn = deep_arg->t;
+            zm = elset->dps.zmos+zns*deep_arg->t;
             zf = zm+2*zes*sin(zm);
             sinzf = sin(zf);
             f2 = 0.5*sinzf*sinzf-0.25;
             f3 = -0.5*sinzf*cos(zf);
-            ses = sat->dps.se2*f2+sat->dps.se3*f3;
-            sis = sat->dps.si2*f2+sat->dps.si3*f3;
-            sls = sat->dps.sl2*f2+sat->dps.sl3*f3+sat->dps.sl4*sinzf;
-            sat->dps.sghs = sat->dps.sgh2*f2+sat->dps.sgh3*f3+sat->dps.sgh4*sinzf;
-            sat->dps.shs = sat->dps.sh2*f2+sat->dps.sh3*f3;
-            zm = sat->dps.zmol+znl*sat->deep_arg.t;
+            ses = elset->dps.se2*f2+elset->dps.se3*f3;
+            sis = elset->dps.si2*f2+elset->dps.si3*f3;
+            sls = elset->dps.sl2*f2+elset->dps.sl3*f3+elset->dps.sl4*sinzf;
+            state->sghs = elset->dps.sgh2*f2+elset->dps.sgh3*f3+elset->dps.sgh4*sinzf;
+            state->shs = elset->dps.sh2*f2+elset->dps.sh3*f3;
+            zm = elset->dps.zmol+znl*deep_arg->t;
             zf = zm+2*zel*sin(zm);
             sinzf = sin(zf);
             f2 = 0.5*sinzf*sinzf-0.25;
             f3 = -0.5*sinzf*cos(zf);
-            sel = sat->dps.ee2*f2+sat->dps.e3*f3;
-            sil = sat->dps.xi2*f2+sat->dps.xi3*f3;
-            sll = sat->dps.xl2*f2+sat->dps.xl3*f3+sat->dps.xl4*sinzf;
-            sat->dps.sghl = sat->dps.xgh2*f2+sat->dps.xgh3*f3+sat->dps.xgh4*sinzf;
-            sat->dps.sh1 = sat->dps.xh2*f2+sat->dps.xh3*f3;
-            sat->dps.pe = ses+sel;
-            sat->dps.pinc = sis+sil;
-            sat->dps.pl = sls+sll;
+            sel = elset->dps.ee2*f2+elset->dps.e3*f3;
+            sil = elset->dps.xi2*f2+elset->dps.xi3*f3;
+            sll = elset->dps.xl2*f2+elset->dps.xl3*f3+elset->dps.xl4*sinzf;
+            state->sghl = elset->dps.xgh2*f2+elset->dps.xgh3*f3+elset->dps.xgh4*sinzf;
+            state->sh1 = elset->dps.xh2*f2+elset->dps.xh3*f3;
+            state->pe = ses+sel;
+            state->pinc = sis+sil;
+            state->pl = sls+sll;
         }
 
-        pgh = sat->dps.sghs+sat->dps.sghl;
-        ph = sat->dps.shs+sat->dps.sh1;
-        sat->deep_arg.xinc = sat->deep_arg.xinc+sat->dps.pinc;
-        sat->deep_arg.em = sat->deep_arg.em+sat->dps.pe;
+        pgh = state->sghs+state->sghl;
+        ph = state->shs+state->sh1;
+        deep_arg->xinc = deep_arg->xinc+state->pinc;
+        deep_arg->em = deep_arg->em+state->pe;
 
-        if (sat->dps.xqncl >= 0.2) {
+        if (elset->dps.xqncl >= 0.2) {
             /* Apply periodics directly */
-            ph = ph/sat->deep_arg.sinio;
-            pgh = pgh-sat->deep_arg.cosio*ph;
-            sat->deep_arg.omgadf = sat->deep_arg.omgadf+pgh;
-            sat->deep_arg.xnode = sat->deep_arg.xnode+ph;
-            sat->deep_arg.xll = sat->deep_arg.xll+sat->dps.pl;
+            ph = ph/deep_arg->sinio;
+            pgh = pgh-deep_arg->cosio*ph;
+            deep_arg->omgadf = deep_arg->omgadf+pgh;
+            deep_arg->xnode = deep_arg->xnode+ph;
+            deep_arg->xll = deep_arg->xll+state->pl;
         }
         else {
             /* Apply periodics with Lyddane modification */
-            sinok = sin(sat->deep_arg.xnode);
-            cosok = cos(sat->deep_arg.xnode);
+            sinok = sin(deep_arg->xnode);
+            cosok = cos(deep_arg->xnode);
             alfdp = sinis*sinok;
             betdp = sinis*cosok;
-            dalf = ph*cosok+sat->dps.pinc*cosis*sinok;
-            dbet = -ph*sinok+sat->dps.pinc*cosis*cosok;
+            dalf = ph*cosok+state->pinc*cosis*sinok;
+            dbet = -ph*sinok+state->pinc*cosis*cosok;
             alfdp = alfdp+dalf;
             betdp = betdp+dbet;
-            sat->deep_arg.xnode = FMod2p(sat->deep_arg.xnode);
-            xls = sat->deep_arg.xll+sat->deep_arg.omgadf+cosis*sat->deep_arg.xnode;
-            dls = sat->dps.pl+pgh-sat->dps.pinc*sat->deep_arg.xnode*sinis;
+            deep_arg->xnode = FMod2p(deep_arg->xnode);
+            xls = deep_arg->xll+deep_arg->omgadf+cosis*deep_arg->xnode;
+            dls = state->pl+pgh-state->pinc*deep_arg->xnode*sinis;
             xls = xls+dls;
-            xnoh = sat->deep_arg.xnode;
-            sat->deep_arg.xnode = AcTan(alfdp,betdp);
+            xnoh = deep_arg->xnode;
+            deep_arg->xnode = AcTan(alfdp,betdp);
 
             /* This is a patch to Lyddane modification */
             /* suggested by Rob Matson. */
-            if(fabs(xnoh-sat->deep_arg.xnode) > pi) {
-                if(sat->deep_arg.xnode < xnoh)
-                    sat->deep_arg.xnode +=twopi;
+            if(fabs(xnoh-deep_arg->xnode) > pi) {
+                if(deep_arg->xnode < xnoh)
+                    deep_arg->xnode +=twopi;
                 else
-                    sat->deep_arg.xnode -=twopi;
+                    deep_arg->xnode -=twopi;
             }
 
-            sat->deep_arg.xll = sat->deep_arg.xll+sat->dps.pl;
-            sat->deep_arg.omgadf = xls-sat->deep_arg.xll-cos(sat->deep_arg.xinc)*
-                sat->deep_arg.xnode;
+            deep_arg->xll = deep_arg->xll+state->pl;
+            deep_arg->omgadf = xls-deep_arg->xll-cos(deep_arg->xinc)*
+                deep_arg->xnode;
         }
         return;
     }
 }
-
-/* Functions for testing and setting/clearing flags */
-
-/* An int variable holding the single-bit flags */
-static int Flags = 0;
-
-int isFlagSet(int flag)
-{
-  return (Flags & flag);
-}
-
-int isFlagClear(int flag)
-{
-  return (~Flags & flag);
-}
-
-void SetFlag(int flag)
-{
-  Flags |= flag;
-}
-
-void ClearFlag(int flag)
-{
-  Flags &= ~flag;
-}
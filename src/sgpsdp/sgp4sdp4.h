@@ -112,6 +112,33 @@ typedef struct {
     double          dec;        /*!< Declination [dec] */
 } obs_astro_t;
 
+/**
+ * \brief Observer frame for one location and time.
+ * \ingroup sgpsdpif
+ *
+ * Everything Calculate_Obs() and Calculate_LatLonAlt() need that does not
+ * depend on the satellite: the sidereal time, the observer position and
+ * velocity and the trigonometric functions of the observer coordinates.
+ * The location part is set up with Initialize_Frame(), the time part with
+ * Set_Frame_Time(). A frame can then be shared by any number of satellites
+ * and threads, as long as none of them changes it. For a series of equally
+ * spaced times, Set_Frame_Step() and Step_Frame_Time() move the frame by
+ * rotating it instead of calculating the sidereal time again.
+ */
+typedef struct {
+    geodetic_t      geodetic;   /*!< Observer; theta is the local sidereal time */
+    double          sin_lat, cos_lat;
+    double          rxy;        /*!< Distance from the polar axis [km] */
+    double          rz;         /*!< Distance from the equatorial plane [km] */
+    double          jd;         /*!< Time [Julian date]; 0 if not set */
+    double          thetag;     /*!< Greenwich sidereal time [rad] */
+    double          sin_theta, cos_theta;
+    vector_t        obs_pos;    /*!< Observer ECI position [km] */
+    vector_t        obs_vel;    /*!< Observer ECI velocity [km/sec] */
+    double          sin_step, cos_step; /*!< Rotation of Step_Frame_Time() */
+    double          theta_step; /*!< Sidereal angle of one step [rad] */
+} obs_frame_t;
+
 
 /* Common arguments between deep-space functions */
 typedef struct {
@@ -126,6 +153,15 @@ typedef struct {
     double          ds50;
 } deep_arg_t;
 
+/* Number of resonance integrator checkpoints kept in a state */
+#define DEEP_CHECKPOINTS 8
+
+/* Resonance integrator of Deep() at a multiple of the step size */
+typedef struct {
+    double          xli, xni;
+    double          atime;      /*!< Time since epoch [min]; 0 if unused */
+} deep_checkpoint_t;
+
 /* static data for SGP4 and SDP4 */
 typedef struct {
     double          aodp, aycof, c1, c4, c5, cosio, d2, d3, d4, delmo, omgcof;
@@ -137,18 +173,64 @@ typedef struct {
 
 /* static data for DEEP */
 typedef struct {
-    double          thgr, xnq, xqncl, omegaq, zmol, zmos, savtsn, ee2, e3, xi2;
+    double          thgr, xnq, xqncl, omegaq, zmol, zmos, ee2, e3, xi2;
     double          xl2, xl3, xl4, xgh2, xgh3, xgh4, xh2, xh3, sse, ssi, ssg,
         xi3;
     double          se2, si2, sl2, sgh2, sh2, se3, si3, sl3, sgh3, sh3, sl4,
         sgh4;
     double          ssl, ssh, d3210, d3222, d4410, d4422, d5220, d5232, d5421;
     double          d5433, del1, del2, del3, fasx2, fasx4, fasx6, xlamo, xfact;
-    double          xni, atime, stepp, stepn, step2, preep, pl, sghs, xli;
-    double          d2201, d2211, sghl, sh1, pinc, pe, shs, zsingl, zcosgl;
+    double          stepp, stepn, step2, preep;
+    double          d2201, d2211, zsingl, zcosgl;
     double          zsinhl, zcoshl, zsinil, zcosil;
 } deep_static_t;
 
+/**
+ * \brief Pre-initialised element set.
+ * \ingroup sgpsdpif
+ *
+ * Holds the mean elements in the units used by SGP4/SDP4 together with
+ * all the constants derived from them. It is filled in once by
+ * Initialize_Elset() and only read by SGP4_r() and SDP4_r(), so the same
+ * element set may be used by several threads at the same time.
+ */
+typedef struct {
+    int             flags;      /*!< SIMPLE, DEEP_SPACE, RESONANCE, ... */
+    double          epoch;      /*!< Epoch Time in NORAD TLE format */
+    double          xmo, xnodeo, omegao, eo, xincl, xno, bstar;
+    sgpsdp_static_t sgps;
+    deep_static_t   dps;
+    deep_arg_t      deep_arg;   /*!< Only the dpinit part is used */
+} sgpsdp_elset_t;
+
+/**
+ * \brief Propagator state and output.
+ * \ingroup sgpsdpif
+ *
+ * Everything SGP4_r() and SDP4_r() write. For SDP4 it also carries the
+ * resonance integrator and the lunar-solar periodics of the previous call,
+ * which only serve to speed up the next one. A state must not be used by
+ * more than one thread at a time; it is initialised with Initialize_State().
+ */
+typedef struct {
+    vector_t        pos;        /*!< Raw position */
+    vector_t        vel;        /*!< Raw velocity */
+    double          phase;      /*!< Orbit phase [rad] */
+
+    /* values needed for squint calculations */
+    double          omegao1, xincl1, xnodeo1;
+
+    /* Deep() resonance integrator */
+    double          xli, xni, atime;
+
+    /* Integrator states of the last steps, so that a step back in
+       time does not have to integrate from epoch again */
+    deep_checkpoint_t ckpt[DEEP_CHECKPOINTS];
+
+    /* Deep() lunar-solar periodics */
+    double          savtsn, pe, pinc, pl, sghs, shs, sghl, sh1;
+} sgpsdp_state_t;
+
 /**
  * \brief Satellite data structure
  * \ingroup sgpsdpif
@@ -160,9 +242,8 @@ typedef struct {
     char           *website;
     tle_t           tle;        /*!< Keplerian elements */
     int             flags;      /*!< Flags for algo ctrl */
-    sgpsdp_static_t sgps;
-    deep_static_t   dps;
-    deep_arg_t      deep_arg;
+    sgpsdp_elset_t  elset;      /*!< Elements used by SGP4()/SDP4() */
+    sgpsdp_state_t  state;      /*!< Propagator state of SGP4()/SDP4() */
     vector_t        pos;        /*!< Raw position and range */
     vector_t        vel;        /*!< Raw velocity */
 
@@ -196,6 +277,148 @@ typedef struct {
 #define SAT(sat)  ((sat_t *) sat)
 
 
+/**
+ * \brief Batch of near-earth satellites in structure-of-arrays layout.
+ * \ingroup sgpsdpif
+ *
+ * The SGP4 constants of each satellite are copied into one array per
+ * constant so that SGP4_Batch() can propagate every satellite in the batch
+ * to the same time with one loop per stage over contiguous data. The
+ * results are written back into
+ * the pos, vel and phase fields of the sat_t structures, exactly like
+ * SGP4() does.
+ *
+ * The batch only holds pointers to the satellites; it must be rebuilt
+ * whenever the satellites are reloaded.
+ */
+typedef struct {
+    int             num;        /*!< Number of satellites in the batch */
+    int             size;       /*!< Allocated length of the arrays */
+    sat_t         **sats;       /*!< The satellites */
+    double         *mem;        /*!< Single allocation holding all arrays */
+
+    /* constants, one entry per satellite */
+    double         *jul_epoch, *xmo, *omegao, *xnodeo, *xincl, *eo, *bstar;
+    double         *aodp, *xnodp, *xmdot, *omgdot, *xnodot, *xnodcf;
+    double         *c1, *c4, *c5, *d2, *d3, *d4, *t2cof, *t3cof, *t4cof,
+        *t5cof;
+    double         *omgcof, *xmcof, *eta, *delmo, *sinmo, *xlcof, *aycof;
+    double         *x3thm1, *x1mth2, *x7thm1, *cosio, *sinio;
+
+    /* work arrays */
+    double         *xnode, *omgadf, *omega, *a, *xn, *axn, *ayn, *xlt,
+        *capu, *epw;
+    double         *px, *py, *pz, *vx, *vy, *vz, *phase, *xinck, *xnodek;
+} sgp4_batch_t;
+
+/**
+ * \brief Vector width of SGP4_Batch() in satellites.
+ *
+ * The loops run over whole vectors of this many doubles, which covers the
+ * widest vectors (AVX-512); see SGP4_Batch_Range() for what this means for
+ * splitting a batch.
+ */
+#define SGP4_BATCH_LANES 8
+
+/** \brief Number of double arrays in an sgp4_batch_t */
+#define SGP4_BATCH_ARRAYS 54
+
+/**
+ * \brief Accuracy of SGP4_Batch() compared to SGP4().
+ *
+ * The batch kernel solves Kepler's equation to the rounding error while
+ * SGP4() stops once the correction drops below e6a, and it uses its own
+ * polynomials for sin(), cos() and atan2() and mathematically equivalent
+ * but not bit identical expressions for a few powers and angles. Positions
+ * agree to within SGP4_BATCH_POS_TOL and velocities to within
+ * SGP4_BATCH_VEL_TOL, both in the canonical units returned by SGP4() (earth
+ * radii and earth radii per minute).
+ */
+#define SGP4_BATCH_POS_TOL  2.0E-6      /* ~13 m */
+#define SGP4_BATCH_VEL_TOL  1.5E-7      /* ~16 mm/s */
+
+/**
+ * \brief One time of a series calculated by Propagate_Series().
+ * \ingroup sgpsdpif
+ */
+typedef struct {
+    vector_t        pos;        /*!< Raw position */
+    vector_t        vel;        /*!< Raw velocity */
+    double          phase;      /*!< Orbit phase [rad] */
+} sgpsdp_point_t;
+
+/**
+ * \brief Accuracy of Propagate_Series() compared to SGP4().
+ *
+ * The series starts Kepler's equation from the solution of the previous
+ * time, so it is all but converged after the first iteration, while SGP4()
+ * starts from the mean anomaly and stops once the correction drops below
+ * e6a. The difference is the same as for SGP4_Batch(), and like there it
+ * is the error of SGP4() that is measured. Deep-space satellites use
+ * SDP4() as it is. The limits are in the canonical units returned by
+ * SGP4() (earth radii and earth radii per minute).
+ */
+#define SERIES_POS_TOL  2.0E-6  /* ~13 m */
+#define SERIES_VEL_TOL  1.5E-7  /* ~16 mm/s */
+
+/** \brief Degree of the Chebyshev series in a cheb_ephem_t */
+#define CHEB_DEGREE     12
+
+/** \brief Number of segments kept in a cheb_ephem_t */
+#define CHEB_SEGMENTS   4
+
+/** \brief Number of fitted components: position, velocity and phase */
+#define CHEB_COMPONENTS 7
+
+/**
+ * \brief Accuracy of Cheb_Propagate() compared to SGP4()/SDP4().
+ *
+ * The segments are fitted until the estimated truncation error of the
+ * series is a fraction of these limits. The rest is left for the noise of
+ * the propagator itself: it stops iterating Kepler's equation once the
+ * correction drops below e6a, which the smooth series does not follow, and
+ * for eccentric orbits this amounts to a few 1E-6 earth radii. The limits
+ * are in the canonical units returned by SGP4() (earth radii and earth
+ * radii per minute).
+ */
+#define CHEB_POS_TOL    5.0E-6  /* ~32 m */
+#define CHEB_VEL_TOL    1.5E-7  /* ~16 mm/s */
+
+/**
+ * \brief One segment of a Chebyshev ephemeris.
+ * \ingroup sgpsdpif
+ */
+typedef struct {
+    double          t0, t1;     /*!< Time span [minutes since epoch] */
+    double          err;        /*!< Estimated position error */
+    double          verr;       /*!< Estimated velocity error */
+    double          c[CHEB_COMPONENTS][CHEB_DEGREE + 1];        /*!< Coefficients */
+    unsigned long   used;       /*!< Time of last use; 0 if the segment is empty */
+} cheb_segment_t;
+
+/**
+ * \brief Chebyshev ephemeris of a satellite.
+ * \ingroup sgpsdpif
+ *
+ * Piecewise polynomial approximation of the SGP4/SDP4 output that is much
+ * cheaper to evaluate than the propagator itself. The segments are fitted
+ * lazily by Cheb_Propagate() as the requested time moves, so the ephemeris
+ * pays off when the same stretch of the orbit is evaluated many times, e.g.
+ * when the time controller runs fast or the time slider is dragged.
+ *
+ * An ephemeris must not be used by more than one thread at a time; it is
+ * initialised with Cheb_Init() and needs no cleanup.
+ */
+typedef struct {
+    double          epoch;      /*!< Epoch of the fitted element set */
+    double          len;        /*!< Length of new segments [minutes] */
+    unsigned long   clock;      /*!< Counter for the segment LRU */
+    double          fail_t0, fail_t1;   /*!< Window where the fit failed */
+    sgpsdp_state_t  state;      /*!< Propagator state used for the fits */
+    cheb_segment_t  seg[CHEB_SEGMENTS];
+} cheb_ephem_t;
+
+
 /** Table of constant values **/
 #define de2ra    1.74532925E-2  /* Degrees to Radians */
 #define pi       3.1415926535898        /* Pi */
@@ -284,13 +507,37 @@ FIXME: Change to enu */
 
 
 /* sgp4sdp4.c */
+void            Initialize_Elset(sgpsdp_elset_t * elset, tle_t * tle,
+                                 int flags);
+void            Initialize_State(sgpsdp_state_t * state);
+void            SGP4_r(const sgpsdp_elset_t * elset, double tsince,
+                       sgpsdp_state_t * state);
+void            SDP4_r(const sgpsdp_elset_t * elset, double tsince,
+                       sgpsdp_state_t * state);
 void            SGP4(sat_t * sat, double tsince);
 void            SDP4(sat_t * sat, double tsince);
-void            Deep(int ientry, sat_t * sat);
-int             isFlagSet(int flag);
-int             isFlagClear(int flag);
-void            SetFlag(int flag);
-void            ClearFlag(int flag);
+void            Deep(int ientry, const sgpsdp_elset_t * elset,
+                     deep_arg_t * deep_arg, sgpsdp_state_t * state);
+
+/* sgp_batch.c */
+void            SGP4_Batch_Init(sgp4_batch_t * batch);
+int             SGP4_Batch_Add(sgp4_batch_t * batch, sat_t * sat);
+void            SGP4_Batch_Free(sgp4_batch_t * batch);
+void            SGP4_Batch(sgp4_batch_t * batch, double jul_utc);
+void            SGP4_Batch_Range(sgp4_batch_t * batch, double jul_utc,
+                                 int first, int last);
+
+/* sgp_series.c */
+void            Propagate_Series(const sgpsdp_elset_t * elset,
+                                 sgpsdp_state_t * state, double tsince,
+                                 double step, int num, sgpsdp_point_t * out);
+
+/* sgp_cheb.c */
+void            Cheb_Init(cheb_ephem_t * eph);
+int             Cheb_Propagate(cheb_ephem_t * eph,
+                               const sgpsdp_elset_t * elset, double tsince,
+                               vector_t * pos, vector_t * vel,
+                               double *phase);
 
 /* sgp_in.c */
 int             Checksum_Good(char *tle_set);
@@ -334,6 +581,17 @@ void            Calculate_Obs(double _time, vector_t * pos, vector_t * vel,
 void            Calculate_RADec_and_Obs(double _time, vector_t * pos,
                                         vector_t * vel, geodetic_t * geodetic,
                                         obs_astro_t * obs_set);
+void            Initialize_Frame(obs_frame_t * frame,
+                                 const geodetic_t * geodetic);
+void            Set_Frame_Time(obs_frame_t * frame, double _time);
+void            Set_Frame_Step(obs_frame_t * frame, double step);
+void            Step_Frame_Time(obs_frame_t * frame, double _time);
+void            Calculate_Obs_Frame(const obs_frame_t * frame,
+                                    vector_t * pos, vector_t * vel,
+                                    obs_set_t * obs_set);
+void            Calculate_LatLonAlt_Frame(const obs_frame_t * frame,
+                                          vector_t * pos,
+                                          geodetic_t * geodetic);
 
 /* sgp_time.c */
 double          Julian_Date_of_Epoch(double epoch);
@@ -0,0 +1,245 @@
+/*
+ * Unit SGP_Cheb
+ *
+ * Chebyshev ephemeris of a single satellite. The position, velocity and
+ * orbit phase returned by SGP4_r()/SDP4_r() are approximated by Chebyshev
+ * series over short segments of time:
+ *
+ *   1. a segment is fitted the first time a time inside it is requested,
+ *      by sampling the propagator at the CHEB_DEGREE+1 Chebyshev nodes
+ *   2. the size of the two highest order coefficients is used as the
+ *      error estimate; segments are halved until the estimate is below
+ *      CHEB_FIT_POS and CHEB_FIT_VEL
+ *   3. later requests inside the segment are evaluated with Clenshaw's
+ *      recurrence, which costs a few dozen multiplications per component
+ *
+ * Segments start on a grid of multiples of their length so that moving
+ * back and forth in time finds the same segments again. The last
+ * CHEB_SEGMENTS segments are kept; the least recently used one is replaced
+ * when a new segment is needed. If a segment cannot be fitted, e.g. for a
+ * decayed satellite, its window is remembered, and requests inside it fail
+ * at once instead of fitting again each time.
+ */
+
+#include "sgp4sdp4.h"
+
+/* Shortest segment in minutes; the fit is given up below this */
+#define CHEB_MIN_LEN 0.5
+
+/* Limits for the estimated truncation error of a segment; the total
+   error compared to SGP4()/SDP4() is within CHEB_POS_TOL/CHEB_VEL_TOL */
+#define CHEB_FIT_POS 1.0E-6
+#define CHEB_FIT_VEL 1.0E-7
+
+/* Number of Chebyshev nodes */
+#define CHEB_NODES (CHEB_DEGREE + 1)
+
+/* Forget all segments; called when the element set changes */
+static void cheb_reset(cheb_ephem_t * eph, const sgpsdp_elset_t * elset)
+{
+    int             i;
+
+    for (i = 0; i < CHEB_SEGMENTS; i++)
+        eph->seg[i].used = 0;
+
+    eph->epoch = elset->epoch;
+    eph->clock = 0;
+    eph->fail_t0 = eph->fail_t1 = 0.0;
+
+    /* a quarter of an orbit */
+    eph->len = twopi / elset->xno / 4.0;
+
+    Initialize_State(&eph->state);
+}
+
+/* Find the segment containing tsince; returns NULL if there is none */
+static cheb_segment_t *cheb_find(cheb_ephem_t * eph, double tsince)
+{
+    int             i;
+
+    for (i = 0; i < CHEB_SEGMENTS; i++)
+        if (eph->seg[i].used && tsince >= eph->seg[i].t0 &&
+            tsince < eph->seg[i].t1)
+            return &eph->seg[i];
+
+    return NULL;
+}
+
+/* Fit the segment [t0; t1]. Returns 0 on success and -1 if the
+   propagator returned an invalid state, e.g. for a decayed satellite. */
+static int cheb_fit(cheb_ephem_t * eph, const sgpsdp_elset_t * elset,
+                    cheb_segment_t * seg, double t0, double t1)
+{
+    double          f[CHEB_COMPONENTS][CHEB_NODES];
+    double          tj[CHEB_NODES][CHEB_NODES];
+    double          s, x, prev = 0.0;
+    int             i, j, k;
+
+    seg->t0 = t0;
+    seg->t1 = t1;
+
+    /* nodes in order of increasing time, i.e. decreasing cos() */
+    for (k = 0; k < CHEB_NODES; k++)
+    {
+        x = -cos(pi * (k + 0.5) / CHEB_NODES);
+
+        /* SDP4_r() only updates the lunar-solar periodics every 30
+           minutes; the fit needs them at the exact time of each node */
+        eph->state.savtsn = 1E20;
+
+        if (elset->flags & DEEP_SPACE_EPHEM_FLAG)
+            SDP4_r(elset, 0.5 * (t0 + t1) + 0.5 * (t1 - t0) * x,
+                   &eph->state);
+        else
+            SGP4_r(elset, 0.5 * (t0 + t1) + 0.5 * (t1 - t0) * x,
+                   &eph->state);
+
+        f[0][k] = eph->state.pos.x;
+        f[1][k] = eph->state.pos.y;
+        f[2][k] = eph->state.pos.z;
+        f[3][k] = eph->state.vel.x;
+        f[4][k] = eph->state.vel.y;
+        f[5][k] = eph->state.vel.z;
+
+        /* the phase is wrapped to [0; 2pi); unwrap it for the fit */
+        f[6][k] = eph->state.phase;
+        if (k > 0)
+            f[6][k] += twopi * floor((prev - f[6][k]) / twopi + 0.5);
+        prev = f[6][k];
+
+        for (i = 0; i < CHEB_COMPONENTS; i++)
+            if (!isfinite(f[i][k]))
+                return -1;
+    }
+
+    /* c_j = 2/N sum f(x_k) T_j(x_k) with the Chebyshev polynomials
+       T_j(x_k) from their recurrence */
+    for (k = 0; k < CHEB_NODES; k++)
+    {
+        x = -cos(pi * (k + 0.5) / CHEB_NODES);
+        tj[0][k] = 1.0;
+        tj[1][k] = x;
+        for (j = 2; j < CHEB_NODES; j++)
+            tj[j][k] = 2.0 * x * tj[j - 1][k] - tj[j - 2][k];
+    }
+
+    for (i = 0; i < CHEB_COMPONENTS; i++)
+    {
+        for (j = 0; j < CHEB_NODES; j++)
+        {
+            s = 0.0;
+            for (k = 0; k < CHEB_NODES; k++)
+                s += f[i][k] * tj[j][k];
+            seg->c[i][j] = 2.0 * s / CHEB_NODES;
+        }
+        seg->c[i][0] *= 0.5;
+    }
+
+    /* error estimate from the tail of the series */
+    seg->err = 0.0;
+    seg->verr = 0.0;
+    for (i = 0; i < 3; i++)
+    {
+        s = fabs(seg->c[i][CHEB_DEGREE - 1]) + fabs(seg->c[i][CHEB_DEGREE]);
+        seg->err = s > seg->err ? s : seg->err;
+        s = fabs(seg->c[i + 3][CHEB_DEGREE - 1]) +
+            fabs(seg->c[i + 3][CHEB_DEGREE]);
+        seg->verr = s > seg->verr ? s : seg->verr;
+    }
+
+    return 0;
+}
+
+/* Evaluate one component of a segment at x in [-1; 1] */
+static double cheb_eval(const double *c, double x)
+{
+    double          b0 = 0.0, b1 = 0.0, b2;
+    int             j;
+
+    for (j = CHEB_DEGREE; j > 0; j--)
+    {
+        b2 = b1;
+        b1 = b0;
+        b0 = 2.0 * x * b1 - b2 + c[j];
+    }
+
+    return x * b0 - b1 + c[0];
+}
+
+/* Cheb_Init */
+/* Prepares a Chebyshev ephemeris for its first use. */
+void Cheb_Init(cheb_ephem_t * eph)
+{
+    memset(eph, 0, sizeof(cheb_ephem_t));
+}
+
+/* Cheb_Propagate */
+/* Same as SGP4_r()/SDP4_r() but evaluated from the Chebyshev    */
+/* ephemeris, which is extended as needed. The position and      */
+/* velocity are within CHEB_POS_TOL and CHEB_VEL_TOL of the exact */
+/* values. Returns 0 on success and -1 if no segment could be    */
+/* fitted, in which case the exact propagator should be used.    */
+/* The failure is remembered for the window of the segment, so   */
+/* further calls inside it return -1 without fitting again.      */
+int Cheb_Propagate(cheb_ephem_t * eph, const sgpsdp_elset_t * elset,
+                   double tsince, vector_t * pos, vector_t * vel,
+                   double *phase)
+{
+    cheb_segment_t *seg;
+    double          t0, x, len;
+    int             i;
+
+    if (eph->len <= 0.0 || eph->epoch != elset->epoch)
+        cheb_reset(eph, elset);
+
+    seg = cheb_find(eph, tsince);
+    if (seg == NULL)
+    {
+        /* the fit has already failed here */
+        if (tsince >= eph->fail_t0 && tsince < eph->fail_t1)
+            return -1;
+
+        /* replace the least recently used segment */
+        seg = &eph->seg[0];
+        for (i = 1; i < CHEB_SEGMENTS; i++)
+            if (eph->seg[i].used < seg->used)
+                seg = &eph->seg[i];
+        seg->used = 0;
+        len = eph->len;
+
+        for (;;)
+        {
+            t0 = eph->len * floor(tsince / eph->len);
+            if (cheb_fit(eph, elset, seg, t0, t0 + eph->len) ||
+                (eph->len < 2.0 * CHEB_MIN_LEN &&
+                 (seg->err >= CHEB_FIT_POS || seg->verr >= CHEB_FIT_VEL)))
+            {
+                /* give up on the window of the first attempt, and keep
+                   the segment length for the other windows */
+                eph->len = len;
+                eph->fail_t0 = len * floor(tsince / len);
+                eph->fail_t1 = eph->fail_t0 + len;
+                return -1;
+            }
+
+            if (seg->err < CHEB_FIT_POS && seg->verr < CHEB_FIT_VEL)
+                break;
+
+            /* the shorter segments are used from now on */
+            eph->len *= 0.5;
+        }
+    }
+    seg->used = ++eph->clock;
+
+    x = (2.0 * tsince - seg->t0 - seg->t1) / (seg->t1 - seg->t0);
+
+    pos->x = cheb_eval(seg->c[0], x);
+    pos->y = cheb_eval(seg->c[1], x);
+    pos->z = cheb_eval(seg->c[2], x);
+    vel->x = cheb_eval(seg->c[3], x);
+    vel->y = cheb_eval(seg->c[4], x);
+    vel->z = cheb_eval(seg->c[5], x);
+    *phase = FMod2p(cheb_eval(seg->c[6], x));
+
+    return 0;
+}
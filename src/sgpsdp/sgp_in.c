@@ -372,5 +372,9 @@ void select_ephemeris(sat_t * sat)
     else
         sat->flags &= ~DEEP_SPACE_EPHEM_FLAG;
 
+    /* Compute the constants used by SGP4/SDP4 */
+    Initialize_Elset(&sat->elset, &sat->tle, sat->flags);
+    Initialize_State(&sat->state);
+
     return;
 }
@@ -11,6 +11,33 @@
 
 #include "sgp4sdp4.h"
 
+/* Geodetic position of pos for the Greenwich sidereal time thetag. */
+/* Reference:  The 1992 Astronomical Almanac, page K12.             */
+static void LatLonAlt(double thetag, vector_t * pos, geodetic_t * geodetic)
+{
+    double          r, e2, phi, sin_phi, c;
+
+    geodetic->theta = AcTan(pos->y, pos->x);    /* rad */
+    geodetic->lon = FMod2p(geodetic->theta - thetag);   /* rad */
+    r = sqrt(Sqr(pos->x) + Sqr(pos->y));
+    e2 = __f * (2 - __f);
+    geodetic->lat = AcTan(pos->z, r);   /* rad */
+
+    do
+    {
+        phi = geodetic->lat;
+        sin_phi = sin(phi);
+        c = 1 / sqrt(1 - e2 * Sqr(sin_phi));
+        geodetic->lat = AcTan(pos->z + xkmper * c * e2 * sin_phi, r);
+    }
+    while (fabs(geodetic->lat - phi) >= 1E-10);
+
+    geodetic->alt = r / cos(geodetic->lat) - xkmper * c;        /* km */
+
+    if (geodetic->lat > pio2)
+        geodetic->lat -= twopi;
+}
+
 /* Procedure Calculate_User_PosVel passes the user's geodetic position */
 /* and the time of interest and returns the ECI position and velocity  */
 /* of the observer. The velocity calculation assumes the geodetic      */
@@ -44,28 +71,14 @@ void Calculate_User_PosVel(double _time, geodetic_t * geodetic,
 /* oblate spheroid as defined in WGS '72.                     */
 void Calculate_LatLonAlt(double _time, vector_t * pos, geodetic_t * geodetic)
 {
-    /* Reference:  The 1992 Astronomical Almanac, page K12. */
-
-    double          r, e2, phi, c;
-
-    geodetic->theta = AcTan(pos->y, pos->x);    /* rad */
-    geodetic->lon = FMod2p(geodetic->theta - ThetaG_JD(_time)); /* rad */
-    r = sqrt(Sqr(pos->x) + Sqr(pos->y));
-    e2 = __f * (2 - __f);
-    geodetic->lat = AcTan(pos->z, r);   /* rad */
-
-    do
-    {
-        phi = geodetic->lat;
-        c = 1 / sqrt(1 - e2 * Sqr(sin(phi)));
-        geodetic->lat = AcTan(pos->z + xkmper * c * e2 * sin(phi), r);
-    }
-    while (fabs(geodetic->lat - phi) >= 1E-10);
-
-    geodetic->alt = r / cos(geodetic->lat) - xkmper * c;        /* km */
+    LatLonAlt(ThetaG_JD(_time), pos, geodetic);
+}
 
-    if (geodetic->lat > pio2)
-        geodetic->lat -= twopi;
+/* Same as Calculate_LatLonAlt using the sidereal time of a frame */
+void Calculate_LatLonAlt_Frame(const obs_frame_t * frame, vector_t * pos,
+                               geodetic_t * geodetic)
+{
+    LatLonAlt(frame->thetag, pos, geodetic);
 }
 
 /* The procedures Calculate_Obs and Calculate_RADec calculate         */
@@ -85,28 +98,122 @@ void Calculate_LatLonAlt(double _time, vector_t * pos, geodetic_t * geodetic)
 /* incorporating atmospheric refraction.                              */
 void Calculate_Obs(double _time, vector_t * pos,
                    vector_t * vel, geodetic_t * geodetic, obs_set_t * obs_set)
+{
+    obs_frame_t     frame;
+
+    Initialize_Frame(&frame, geodetic);
+    Set_Frame_Time(&frame, _time);
+    geodetic->theta = frame.geodetic.theta;
+
+    Calculate_Obs_Frame(&frame, pos, vel, obs_set);
+}
+
+/* Initialize_Frame */
+/* Sets up the location dependent part of an observer frame; */
+/* Set_Frame_Time() must be called before the frame is used. */
+void Initialize_Frame(obs_frame_t * frame, const geodetic_t * geodetic)
+{
+    double          c, sq;
+
+    frame->geodetic = *geodetic;
+    frame->sin_lat = sin(geodetic->lat);
+    frame->cos_lat = cos(geodetic->lat);
+
+    /* the constant part of Calculate_User_PosVel */
+    c = 1 / sqrt(1 + __f * (__f - 2) * Sqr(frame->sin_lat));
+    sq = Sqr(1 - __f) * c;
+    frame->rxy = (xkmper * c + geodetic->alt) * frame->cos_lat;
+    frame->rz = xkmper * sq + geodetic->alt;
+
+    frame->jd = 0.0;
+}
+
+/* ECI position and velocity of the observer of a frame from */
+/* the sine and cosine of the local sidereal time.           */
+static void Frame_Observer(obs_frame_t * frame)
+{
+    frame->obs_pos.x = frame->rxy * frame->cos_theta;   /* km */
+    frame->obs_pos.y = frame->rxy * frame->sin_theta;
+    frame->obs_pos.z = frame->rz * frame->sin_lat;
+    frame->obs_vel.x = -mfactor * frame->obs_pos.y;     /* km/sec */
+    frame->obs_vel.y = mfactor * frame->obs_pos.x;
+    frame->obs_vel.z = 0;
+    Magnitude(&frame->obs_pos);
+    Magnitude(&frame->obs_vel);
+}
+
+/* Set_Frame_Time */
+/* Updates the time dependent part of an observer frame: the */
+/* sidereal time and the ECI position and velocity of the    */
+/* observer. Nothing is done if the time has not changed.    */
+void Set_Frame_Time(obs_frame_t * frame, double _time)
+{
+    if (frame->jd == _time)
+        return;
+
+    frame->jd = _time;
+    frame->thetag = ThetaG_JD(_time);
+    frame->geodetic.theta = FMod2p(frame->thetag + frame->geodetic.lon);
+    frame->sin_theta = sin(frame->geodetic.theta);
+    frame->cos_theta = cos(frame->geodetic.theta);
+
+    Frame_Observer(frame);
+}
+
+/* Set_Frame_Step */
+/* Prepares Step_Frame_Time() for times that are step days apart. */
+void Set_Frame_Step(obs_frame_t * frame, double step)
+{
+    frame->theta_step = twopi * omega_E * step;
+    frame->sin_step = sin(frame->theta_step);
+    frame->cos_step = cos(frame->theta_step);
+}
+
+/* Step_Frame_Time */
+/* Same as Set_Frame_Time() for the time one step, as given to */
+/* Set_Frame_Step(), after the current time of the frame. The  */
+/* sidereal time is advanced at the rate used by ThetaG_JD()   */
+/* and its sine and cosine are rotated instead of calculated.  */
+/* Rounding errors add up, so Set_Frame_Time() should be used  */
+/* again every few dozen steps.                                */
+void Step_Frame_Time(obs_frame_t * frame, double _time)
+{
+    double          sin_theta = frame->sin_theta;
+
+    frame->jd = _time;
+    frame->thetag = FMod2p(frame->thetag + frame->theta_step);
+    frame->geodetic.theta = FMod2p(frame->geodetic.theta + frame->theta_step);
+    frame->sin_theta = sin_theta * frame->cos_step +
+        frame->cos_theta * frame->sin_step;
+    frame->cos_theta = frame->cos_theta * frame->cos_step -
+        sin_theta * frame->sin_step;
+
+    Frame_Observer(frame);
+}
+
+/* Same as Calculate_Obs for the location and time of a frame */
+void Calculate_Obs_Frame(const obs_frame_t * frame, vector_t * pos,
+                         vector_t * vel, obs_set_t * obs_set)
 {
     double          sin_lat, cos_lat, sin_theta, cos_theta;
     double          el, azim, top_s, top_e, top_z;
 
-    vector_t        obs_pos, obs_vel, range, rgvel;
-
-    Calculate_User_PosVel(_time, geodetic, &obs_pos, &obs_vel);
+    vector_t        range, rgvel;
 
-    range.x = pos->x - obs_pos.x;
-    range.y = pos->y - obs_pos.y;
-    range.z = pos->z - obs_pos.z;
+    range.x = pos->x - frame->obs_pos.x;
+    range.y = pos->y - frame->obs_pos.y;
+    range.z = pos->z - frame->obs_pos.z;
 
-    rgvel.x = vel->x - obs_vel.x;
-    rgvel.y = vel->y - obs_vel.y;
-    rgvel.z = vel->z - obs_vel.z;
+    rgvel.x = vel->x - frame->obs_vel.x;
+    rgvel.y = vel->y - frame->obs_vel.y;
+    rgvel.z = vel->z - frame->obs_vel.z;
 
     Magnitude(&range);
 
-    sin_lat = sin(geodetic->lat);
-    cos_lat = cos(geodetic->lat);
-    sin_theta = sin(geodetic->theta);
-    cos_theta = cos(geodetic->theta);
+    sin_lat = frame->sin_lat;
+    cos_lat = frame->cos_lat;
+    sin_theta = frame->sin_theta;
+    cos_theta = frame->cos_theta;
     top_s = sin_lat * cos_theta * range.x
         + sin_lat * sin_theta * range.y - cos_lat * range.z;
     top_e = -sin_theta * range.x + cos_theta * range.y;
@@ -130,13 +237,8 @@ void Calculate_Obs(double _time, vector_t * pos,
 /* Correction is meaningless when apparent elevation is below horizon */
 //      obs_set->el = obs_set->el + Radians((1.02/tan(Radians(Degrees(el)+
 //                                                            10.3/(Degrees(el)+5.11))))/60);
-    if (obs_set->el >= 0)
-        SetFlag(VISIBLE_FLAG);
-    else
-    {
+    if (obs_set->el < 0)
         obs_set->el = el;       /*Reset to true elevation */
-        ClearFlag(VISIBLE_FLAG);
-    }
 }
 
 void Calculate_RADec_and_Obs(double _time, vector_t * pos, vector_t * vel,
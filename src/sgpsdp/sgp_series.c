@@ -0,0 +1,239 @@
+/*
+ * Unit SGP_Series
+ *
+ * Propagation of one satellite to a series of equally spaced times, as
+ * needed for ground tracks and pass details. For near-earth satellites
+ * the algorithm is the one in SGP4_r() from sgp4sdp4.c, with the work
+ * that can be carried from one time to the next taken out of the loop:
+ *
+ *   1. the mean anomaly grows linearly with time, so its cosine is
+ *      advanced by rotating it with the sine and cosine of one step
+ *   2. Kepler's equation is started from the eccentric anomaly
+ *      extrapolated from the previous two times instead of the mean
+ *      anomaly, which saves most of its iterations
+ *   3. the powers of the secular terms are plain multiplications
+ *
+ * The recurrences are restarted from the exact values every
+ * SERIES_RESTART times so that rounding errors can not add up. Deep-space
+ * satellites are propagated with SDP4_r(), whose resonance integrator
+ * already continues from the previous time.
+ */
+
+#include "sgp4sdp4.h"
+
+/* Number of times after which the recurrences are restarted */
+#define SERIES_RESTART 64
+
+/* SGP4 part of Propagate_Series() */
+static void SGP4_Series(const sgpsdp_elset_t * elset,
+                        sgpsdp_state_t * state, double tsince,
+                        double step, int num, sgpsdp_point_t * out)
+{
+    double          cosuk, sinuk, rfdotk, vx, vy, vz, ux, uy, uz, xmy, xmx,
+        cosnok, sinnok, cosik, sinik, rdotk, xinck, xnodek, uk, rk,
+        cos2u, sin2u, u, sinu, cosu, betal, rfdot, rdot, r, pl, elsq,
+        esine, ecose, epw, cosepw, tfour, sinepw, capu, ayn, xlt,
+        aynl, xll, axn, xn, beta, xl, e, a, tcube, delm, delomg, templ,
+        tempe, tempa, xnode, tsq, xmp, omega, xnoddf, omgadf, xmdf,
+        temp, temp1, temp2, temp3, temp4, temp5, temp6;
+    double          t, cosm = 0, sinm = 0, sin_step, cos_step;
+    double          kep = 0, dkep = 0;
+    int             i, k;
+
+    sin_step = sin(elset->sgps.xmdot * step);
+    cos_step = cos(elset->sgps.xmdot * step);
+
+    for (k = 0; k < num; k++)
+    {
+        t = tsince + k * step;
+
+        /* Update for secular gravity and atmospheric drag. */
+        xmdf = elset->xmo + elset->sgps.xmdot * t;
+        omgadf = elset->omegao + elset->sgps.omgdot * t;
+        xnoddf = elset->xnodeo + elset->sgps.xnodot * t;
+        omega = omgadf;
+        xmp = xmdf;
+        tsq = t * t;
+        xnode = xnoddf + elset->sgps.xnodcf * tsq;
+        tempa = 1.0 - elset->sgps.c1 * t;
+        tempe = elset->bstar * elset->sgps.c4 * t;
+        templ = elset->sgps.t2cof * tsq;
+        if (~elset->flags & SIMPLE_FLAG)
+        {
+            if (k % SERIES_RESTART == 0)
+            {
+                cosm = cos(xmdf);
+                sinm = sin(xmdf);
+            }
+            else
+            {
+                temp = cosm;
+                cosm = cosm * cos_step - sinm * sin_step;
+                sinm = sinm * cos_step + temp * sin_step;
+            }
+
+            delomg = elset->sgps.omgcof * t;
+            temp = 1 + elset->sgps.eta * cosm;
+            delm = elset->sgps.xmcof * (temp * temp * temp -
+                                        elset->sgps.delmo);
+            temp = delomg + delm;
+            xmp = xmdf + temp;
+            omega = omgadf - temp;
+            tcube = tsq * t;
+            tfour = t * tcube;
+            tempa = tempa - elset->sgps.d2 * tsq - elset->sgps.d3 * tcube -
+                elset->sgps.d4 * tfour;
+            tempe = tempe + elset->bstar * elset->sgps.c5 *
+                (sin(xmp) - elset->sgps.sinmo);
+            templ = templ + elset->sgps.t3cof * tcube + tfour *
+                (elset->sgps.t4cof + t * elset->sgps.t5cof);
+        }
+
+        a = elset->sgps.aodp * tempa * tempa;
+        e = elset->eo - tempe;
+        xl = xmp + omega + xnode + elset->sgps.xnodp * templ;
+        beta = sqrt(1.0 - e * e);
+        xn = xke / (a * sqrt(a));
+
+        /* Long period periodics */
+        axn = e * cos(omega);
+        temp = 1.0 / (a * beta * beta);
+        xll = temp * elset->sgps.xlcof * axn;
+        aynl = temp * elset->sgps.aycof;
+        xlt = xl + xll;
+        ayn = e * sin(omega) + aynl;
+
+        /* Solve Kepler's' Equation, starting from the difference
+           between the eccentric and mean anomaly extrapolated from the
+           previous times. Like in SGP4_r() the last correction, which
+           is below e6a, is not applied, so a good start also makes the
+           result more accurate */
+        capu = FMod2p(xlt - xnode);
+        if (k % SERIES_RESTART == 0)
+        {
+            kep = 0;
+            dkep = 0;
+        }
+        temp2 = capu + kep + dkep;
+
+        i = 0;
+        do
+        {
+            sinepw = sin(temp2);
+            cosepw = cos(temp2);
+            temp3 = axn * sinepw;
+            temp4 = ayn * cosepw;
+            temp5 = axn * cosepw;
+            temp6 = ayn * sinepw;
+            epw = (capu - temp4 + temp3 - temp2) / (1.0 - temp5 - temp6) +
+                temp2;
+            if (fabs(epw - temp2) <= e6a)
+                break;
+            temp2 = epw;
+        }
+        while (i++ < 10);
+        if (k % SERIES_RESTART != 0)
+            dkep = epw - capu - kep;
+        kep = epw - capu;
+
+        /* Short period preliminary quantities */
+        ecose = temp5 + temp6;
+        esine = temp3 - temp4;
+        elsq = axn * axn + ayn * ayn;
+        temp = 1.0 - elsq;
+        pl = a * temp;
+        r = a * (1.0 - ecose);
+        temp1 = 1.0 / r;
+        rdot = xke * sqrt(a) * esine * temp1;
+        rfdot = xke * sqrt(pl) * temp1;
+        temp2 = a * temp1;
+        betal = sqrt(temp);
+        temp3 = 1.0 / (1.0 + betal);
+        cosu = temp2 * (cosepw - axn + ayn * esine * temp3);
+        sinu = temp2 * (sinepw - ayn - axn * esine * temp3);
+        u = AcTan(sinu, cosu);
+        sin2u = 2.0 * sinu * cosu;
+        cos2u = 2.0 * cosu * cosu - 1.0;
+        temp = 1.0 / pl;
+        temp1 = ck2 * temp;
+        temp2 = temp1 * temp;
+
+        /* Update for short periodics */
+        rk = r * (1.0 - 1.5 * temp2 * betal * elset->sgps.x3thm1) +
+            0.5 * temp1 * elset->sgps.x1mth2 * cos2u;
+        uk = u - 0.25 * temp2 * elset->sgps.x7thm1 * sin2u;
+        xnodek = xnode + 1.5 * temp2 * elset->sgps.cosio * sin2u;
+        xinck = elset->xincl +
+            1.5 * temp2 * elset->sgps.cosio * elset->sgps.sinio * cos2u;
+        rdotk = rdot - xn * temp1 * elset->sgps.x1mth2 * sin2u;
+        rfdotk = rfdot + xn * temp1 *
+            (elset->sgps.x1mth2 * cos2u + 1.5 * elset->sgps.x3thm1);
+
+        /* Orientation vectors */
+        sinuk = sin(uk);
+        cosuk = cos(uk);
+        sinik = sin(xinck);
+        cosik = cos(xinck);
+        sinnok = sin(xnodek);
+        cosnok = cos(xnodek);
+        xmx = -sinnok * cosik;
+        xmy = cosnok * cosik;
+        ux = xmx * sinuk + cosnok * cosuk;
+        uy = xmy * sinuk + sinnok * cosuk;
+        uz = sinik * sinuk;
+        vx = xmx * cosuk - cosnok * sinuk;
+        vy = xmy * cosuk - sinnok * sinuk;
+        vz = sinik * cosuk;
+
+        /* Position and velocity */
+        out[k].pos.x = rk * ux;
+        out[k].pos.y = rk * uy;
+        out[k].pos.z = rk * uz;
+        out[k].vel.x = rdotk * ux + rfdotk * vx;
+        out[k].vel.y = rdotk * uy + rfdotk * vy;
+        out[k].vel.z = rdotk * uz + rfdotk * vz;
+
+        out[k].phase = xlt - xnode - omgadf + twopi;
+        if (out[k].phase < 0)
+            out[k].phase += twopi;
+        out[k].phase = FMod2p(out[k].phase);
+    }
+
+    if (num > 0)
+    {
+        state->pos = out[num - 1].pos;
+        state->vel = out[num - 1].vel;
+        state->phase = out[num - 1].phase;
+        state->omegao1 = omega;
+        state->xincl1 = xinck;
+        state->xnodeo1 = xnodek;
+    }
+}
+
+/* Propagate_Series */
+/* Propagates a satellite to the num times tsince + k * step,  */
+/* k = 0 ... num - 1, in minutes since epoch, and stores the   */
+/* results in out. step may be negative. The state is left as  */
+/* SGP4_r() or SDP4_r() would leave it for the last time. For  */
+/* near-earth satellites the results agree with SGP4_r() to    */
+/* within SERIES_POS_TOL and SERIES_VEL_TOL.                   */
+void Propagate_Series(const sgpsdp_elset_t * elset, sgpsdp_state_t * state,
+                      double tsince, double step, int num,
+                      sgpsdp_point_t * out)
+{
+    int             k;
+
+    if (~elset->flags & DEEP_SPACE_EPHEM_FLAG)
+    {
+        SGP4_Series(elset, state, tsince, step, num, out);
+        return;
+    }
+
+    for (k = 0; k < num; k++)
+    {
+        SDP4_r(elset, tsince + k * step, state);
+        out[k].pos = state->pos;
+        out[k].vel = state->vel;
+        out[k].phase = state->phase;
+    }
+}
@@ -0,0 +1,204 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2008  Alexandru Csete.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the
+          Free Software Foundation, Inc.,
+      59 Temple Place, Suite 330,
+      Boston, MA  02111-1307
+      USA
+*/
+/* Unit test for SGP4_Batch: compare batch propagation against SGP4,
+   and SGP4_Batch_Range against SGP4_Batch */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "sgp4sdp4.h"
+
+#define TEST_SATS  64
+#define TEST_STEPS 97
+#define TEST_DECAY 3            /* not a multiple of the vector length */
+
+char            tle_str[3][80];
+sat_t           ref[TEST_SATS];
+sat_t           bat[TEST_SATS];
+vector_t        whole[TEST_SATS];
+
+int main(void)
+{
+    FILE           *fp;
+    sgp4_batch_t    batch;
+    tle_t           tle;
+    double          jul_utc, dp, dv, maxdp = 0.0, maxdv = 0.0;
+    int             i, j, simple = 0, fail = 0;
+
+    /* read tle file */
+    fp = fopen("test-001.tle", "r");
+    if (fp == NULL)
+    {
+        printf("Could not open test-001.tle\n");
+        return 1;
+    }
+    for (i = 0; i < 3; i++)
+    {
+        if (fgets(tle_str[i], 80, fp) == NULL)
+        {
+            printf("Error reading TLE line %d\n", i + 1);
+            fclose(fp);
+            return 1;
+        }
+    }
+    fclose(fp);
+
+    if (Get_Next_Tle_Set(tle_str, &tle) != 1)
+    {
+        printf("Could not read TLE data\n");
+        return 1;
+    }
+
+    /* create a spread of orbits around the test satellite; the higher
+       mean motions give perigees low enough for the simple model */
+    SGP4_Batch_Init(&batch);
+    for (i = 0; i < TEST_SATS; i++)
+    {
+        memset(&ref[i], 0, sizeof(sat_t));
+        ref[i].tle = tle;
+        ref[i].tle.xno = 14.0 + 2.4 * i / TEST_SATS;
+        ref[i].tle.eo = 0.0005 + 0.02 * (i % 8) / 8.0;
+        ref[i].tle.xincl = fmod(tle.xincl + 7.0 * i, 180.0);
+        ref[i].tle.xnodeo = fmod(tle.xnodeo + 37.0 * i, 360.0);
+        ref[i].tle.omegao = fmod(tle.omegao + 53.0 * i, 360.0);
+        ref[i].tle.xmo = fmod(tle.xmo + 71.0 * i, 360.0);
+        select_ephemeris(&ref[i]);
+        ref[i].jul_epoch = Julian_Date_of_Epoch(ref[i].tle.epoch);
+        bat[i] = ref[i];
+
+        if (SGP4_Batch_Add(&batch, &bat[i]))
+        {
+            printf("Could not add satellite %d to batch\n", i);
+            return 1;
+        }
+        if (bat[i].elset.flags & SIMPLE_FLAG)
+            simple++;
+    }
+
+    printf("%d satellites in batch, %d using the simple model\n\n",
+           batch.num, simple);
+
+    /* propagate one day in 15 minute steps */
+    for (j = 0; j < TEST_STEPS; j++)
+    {
+        jul_utc = ref[0].jul_epoch + j * 15.0 / xmnpda;
+        SGP4_Batch(&batch, jul_utc);
+
+        for (i = 0; i < TEST_SATS; i++)
+        {
+            SGP4(&ref[i], (jul_utc - ref[i].jul_epoch) * xmnpda);
+
+            dp = sqrt(pow(ref[i].pos.x - bat[i].pos.x, 2) +
+                      pow(ref[i].pos.y - bat[i].pos.y, 2) +
+                      pow(ref[i].pos.z - bat[i].pos.z, 2));
+            dv = sqrt(pow(ref[i].vel.x - bat[i].vel.x, 2) +
+                      pow(ref[i].vel.y - bat[i].vel.y, 2) +
+                      pow(ref[i].vel.z - bat[i].vel.z, 2));
+            maxdp = dp > maxdp ? dp : maxdp;
+            maxdv = dv > maxdv ? dv : maxdv;
+
+            if (dp > SGP4_BATCH_POS_TOL || dv > SGP4_BATCH_VEL_TOL ||
+                fabs(ref[i].phase - bat[i].phase) > 1.0E-6)
+            {
+                printf("SAT %2d  t: %7.1f  dpos: %.3e  dvel: %.3e  "
+                       "dphase: %.3e\n", i, j * 15.0, dp, dv,
+                       fabs(ref[i].phase - bat[i].phase));
+                fail++;
+            }
+        }
+    }
+
+    printf("Max position delta: %.3e ER (%.3f m)\n", maxdp,
+           maxdp * xkmper * 1000.0);
+    printf("Max velocity delta: %.3e ER/min (%.3f mm/s)\n", maxdv,
+           maxdv * xkmper * 1.0E6 / secday * xmnpda);
+
+    /* propagating the batch in ranges must give the same as all at once */
+    for (j = 0; j < TEST_STEPS; j++)
+    {
+        jul_utc = ref[0].jul_epoch + j * 15.0 / xmnpda;
+        SGP4_Batch(&batch, jul_utc);
+        for (i = 0; i < TEST_SATS; i++)
+            whole[i] = bat[i].pos;
+
+        SGP4_Batch_Range(&batch, jul_utc + 1.0, 0, batch.num);
+        SGP4_Batch_Range(&batch, jul_utc, 2 * SGP4_BATCH_LANES, batch.num);
+        SGP4_Batch_Range(&batch, jul_utc, 0, SGP4_BATCH_LANES);
+        SGP4_Batch_Range(&batch, jul_utc, SGP4_BATCH_LANES,
+                         2 * SGP4_BATCH_LANES);
+
+        for (i = 0; i < TEST_SATS; i++)
+        {
+            if (memcmp(&whole[i], &bat[i].pos, sizeof(vector_t)))
+            {
+                printf("SAT %2d  t: %7.1f  range differs\n", i, j * 15.0);
+                fail++;
+            }
+        }
+    }
+    SGP4_Batch_Free(&batch);
+
+    /* negative drag terms; the eccentricities exceed 1 after a few days,
+       after which both must give NaN */
+    SGP4_Batch_Init(&batch);
+    for (i = 0; i < TEST_DECAY; i++)
+    {
+        memset(&ref[i], 0, sizeof(sat_t));
+        ref[i].tle = tle;
+        ref[i].tle.bstar = -0.1 * (i + 1);
+        select_ephemeris(&ref[i]);
+        ref[i].jul_epoch = Julian_Date_of_Epoch(ref[i].tle.epoch);
+        bat[i] = ref[i];
+        SGP4_Batch_Add(&batch, &bat[i]);
+    }
+    for (j = 0; j < TEST_STEPS; j++)
+    {
+        jul_utc = ref[0].jul_epoch + j * 120.0 / xmnpda;
+        SGP4_Batch(&batch, jul_utc);
+
+        for (i = 0; i < TEST_DECAY; i++)
+        {
+            SGP4(&ref[i], (jul_utc - ref[i].jul_epoch) * xmnpda);
+            if (isnan(ref[i].pos.x) != isnan(bat[i].pos.x) ||
+                isnan(ref[i].vel.x) != isnan(bat[i].vel.x))
+            {
+                printf("SAT %2d  t: %7.1f  decayed: %.3e, batch: %.3e\n", i,
+                       j * 120.0, ref[i].pos.x, bat[i].pos.x);
+                fail++;
+            }
+        }
+    }
+    SGP4_Batch_Free(&batch);
+
+    printf("\n%d of %d comparisons outside tolerance\n", fail,
+           (2 * TEST_SATS + TEST_DECAY) * TEST_STEPS);
+
+    return fail ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2008  Alexandru Csete.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the
+          Free Software Foundation, Inc.,
+      59 Temple Place, Suite 330,
+      Boston, MA  02111-1307
+      USA
+*/
+/*
+ * Unit test for the reentrant propagator: several threads propagate
+ * the same element sets at the same time, each with its own state, and
+ * must get exactly the same results as a single thread.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <glib.h>
+#include "sgp4sdp4.h"
+
+#define TEST_SATS    4
+#define TEST_THREADS 8
+#define TEST_ROUNDS  50
+#define TEST_STEPS   200
+
+/* element sets shared by all threads */
+sgpsdp_elset_t  elsets[TEST_SATS];
+const char     *names[TEST_SATS] = {
+    "SGP4", "SDP4", "SDP4 12h resonant", "SDP4 synchronous"
+};
+
+/* reference results from a single thread */
+sgpsdp_state_t  expected[TEST_SATS][TEST_STEPS];
+
+/* time since epoch for each step; jumps back and forth across the
+   epoch so that the resonance integrator has to restart */
+static double step_time(int step)
+{
+    return ((step * 37) % TEST_STEPS - TEST_STEPS / 4) * 97.0;
+}
+
+/* propagate every satellite through all the steps using a fresh state */
+static void propagate(sgpsdp_state_t out[TEST_SATS][TEST_STEPS])
+{
+    sgpsdp_state_t  state;
+    int             i, j;
+
+    for (i = 0; i < TEST_SATS; i++)
+    {
+        Initialize_State(&state);
+
+        for (j = 0; j < TEST_STEPS; j++)
+        {
+            if (elsets[i].flags & DEEP_SPACE_EPHEM_FLAG)
+                SDP4_r(&elsets[i], step_time(j), &state);
+            else
+                SGP4_r(&elsets[i], step_time(j), &state);
+
+            /* only the output is compared, the rest is a cache */
+            memset(&out[i][j], 0, sizeof(sgpsdp_state_t));
+            out[i][j].pos = state.pos;
+            out[i][j].vel = state.vel;
+            out[i][j].phase = state.phase;
+            out[i][j].omegao1 = state.omegao1;
+            out[i][j].xincl1 = state.xincl1;
+            out[i][j].xnodeo1 = state.xnodeo1;
+        }
+    }
+}
+
+/* thread function; returns the number of mismatches */
+static gpointer worker(gpointer data)
+{
+    sgpsdp_state_t (*result)[TEST_STEPS];
+    long            errors = 0;
+    int             r;
+
+    (void)data;
+
+    result = malloc(sizeof(expected));
+    for (r = 0; r < TEST_ROUNDS; r++)
+    {
+        propagate(result);
+        if (memcmp(result, expected, sizeof(expected)))
+            errors++;
+    }
+    free(result);
+
+    return (gpointer) errors;
+}
+
+static int read_tle(const char *file, tle_t * tle)
+{
+    FILE           *fp;
+    char            tle_str[3][80];
+    int             i;
+
+    fp = fopen(file, "r");
+    if (fp == NULL)
+    {
+        printf("Could not open %s\n", file);
+        return 1;
+    }
+    for (i = 0; i < 3; i++)
+    {
+        if (fgets(tle_str[i], 80, fp) == NULL)
+        {
+            printf("Error reading TLE line %d of %s\n", i + 1, file);
+            fclose(fp);
+            return 1;
+        }
+    }
+    fclose(fp);
+
+    if (Get_Next_Tle_Set(tle_str, tle) != 1)
+    {
+        printf("Could not read TLE data from %s\n", file);
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    GThread        *threads[TEST_THREADS];
+    sat_t           sat;
+    tle_t           tle[TEST_SATS];
+    long            errors = 0;
+    int             i;
+
+    if (read_tle("test-001.tle", &tle[0]) || read_tle("test-002.tle", &tle[1]))
+        return 1;
+
+    /* Molniya type orbit, exercises the 12 hour resonance terms */
+    tle[2] = tle[1];
+    tle[2].xno = 2.00563;
+    tle[2].eo = 0.7200;
+    tle[2].xincl = 63.4;
+
+    /* geostationary orbit, exercises the synchronous resonance terms */
+    tle[3] = tle[1];
+    tle[3].xno = 1.00271;
+    tle[3].eo = 0.0002;
+    tle[3].xincl = 0.05;
+
+    for (i = 0; i < TEST_SATS; i++)
+    {
+        memset(&sat, 0, sizeof(sat_t));
+        sat.tle = tle[i];
+        select_ephemeris(&sat);
+        elsets[i] = sat.elset;
+        printf("%-18s  DEEP_SPACE: %d  RESONANCE: %d  SYNCHRONOUS: %d\n",
+               names[i], (elsets[i].flags & DEEP_SPACE_EPHEM_FLAG) != 0,
+               (elsets[i].flags & RESONANCE_FLAG) != 0,
+               (elsets[i].flags & SYNCHRONOUS_FLAG) != 0);
+    }
+
+    propagate(expected);
+
+    for (i = 0; i < TEST_THREADS; i++)
+        threads[i] = g_thread_new("test-004", worker, NULL);
+
+    for (i = 0; i < TEST_THREADS; i++)
+        errors += (long)g_thread_join(threads[i]);
+
+    printf("\n%d threads x %d rounds x %d satellites x %d steps\n",
+           TEST_THREADS, TEST_ROUNDS, TEST_SATS, TEST_STEPS);
+    printf("%ld of %d rounds differ from the single thread result\n",
+           errors, TEST_THREADS * TEST_ROUNDS);
+
+    return errors ? 1 : 0;
+}
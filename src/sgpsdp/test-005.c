@@ -0,0 +1,203 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2008  Alexandru Csete.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the
+          Free Software Foundation, Inc.,
+      59 Temple Place, Suite 330,
+      Boston, MA  02111-1307
+      USA
+*/
+/*
+ * Unit test for the Chebyshev ephemeris: Cheb_Propagate() must stay
+ * within CHEB_POS_TOL and CHEB_VEL_TOL of SGP4()/SDP4() while the time
+ * runs forwards, backwards and jumps around, like it does with the time
+ * controller. A fit that fails must be remembered for its window.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "sgp4sdp4.h"
+
+#define TEST_SATS  4
+#define TEST_STEPS 2000
+
+const char     *names[TEST_SATS] = {
+    "SGP4", "SDP4", "SDP4 12h resonant", "SDP4 synchronous"
+};
+
+/* time since epoch for each step: two days forward in 1 minute steps,
+   one day backwards in 5 minute steps, then scattered over a week */
+static double step_time(int step)
+{
+    if (step < 1000)
+        return step * 2.88;
+    if (step < 1500)
+        return 2880.0 - (step - 1000) * 2.88;
+    return ((step * 37) % 500) * 20.16 - 2880.0;
+}
+
+static int read_tle(const char *file, tle_t * tle)
+{
+    FILE           *fp;
+    char            tle_str[3][80];
+    int             i;
+
+    fp = fopen(file, "r");
+    if (fp == NULL)
+    {
+        printf("Could not open %s\n", file);
+        return 1;
+    }
+    for (i = 0; i < 3; i++)
+    {
+        if (fgets(tle_str[i], 80, fp) == NULL)
+        {
+            printf("Error reading TLE line %d of %s\n", i + 1, file);
+            fclose(fp);
+            return 1;
+        }
+    }
+    fclose(fp);
+
+    if (Get_Next_Tle_Set(tle_str, tle) != 1)
+    {
+        printf("Could not read TLE data from %s\n", file);
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    cheb_ephem_t   *eph;
+    sat_t           sat;
+    tle_t           tle[TEST_SATS];
+    vector_t        pos, vel;
+    double          phase, dp, dv, dph, maxdp, maxdv;
+    int             i, j, fail = 0;
+
+    if (read_tle("test-001.tle", &tle[0]) || read_tle("test-002.tle", &tle[1]))
+        return 1;
+
+    /* Molniya type orbit, fast motion around perigee */
+    tle[2] = tle[1];
+    tle[2].xno = 2.00563;
+    tle[2].eo = 0.7200;
+    tle[2].xincl = 63.4;
+
+    /* geostationary orbit */
+    tle[3] = tle[1];
+    tle[3].xno = 1.00271;
+    tle[3].eo = 0.0002;
+    tle[3].xincl = 0.05;
+
+    eph = malloc(sizeof(cheb_ephem_t));
+
+    for (i = 0; i < TEST_SATS; i++)
+    {
+        memset(&sat, 0, sizeof(sat_t));
+        sat.tle = tle[i];
+        select_ephemeris(&sat);
+        Cheb_Init(eph);
+        maxdp = 0.0;
+        maxdv = 0.0;
+
+        for (j = 0; j < TEST_STEPS; j++)
+        {
+            if (Cheb_Propagate(eph, &sat.elset, step_time(j), &pos, &vel,
+                               &phase))
+            {
+                printf("%s: no fit at t = %.2f\n", names[i], step_time(j));
+                fail++;
+                continue;
+            }
+
+            /* the ephemeris uses the lunar-solar periodics at the exact
+               time instead of the ones from up to 30 minutes before */
+            sat.state.savtsn = 1E20;
+
+            if (sat.flags & DEEP_SPACE_EPHEM_FLAG)
+                SDP4(&sat, step_time(j));
+            else
+                SGP4(&sat, step_time(j));
+
+            dp = sqrt(pow(sat.pos.x - pos.x, 2) + pow(sat.pos.y - pos.y, 2) +
+                      pow(sat.pos.z - pos.z, 2));
+            dv = sqrt(pow(sat.vel.x - vel.x, 2) + pow(sat.vel.y - vel.y, 2) +
+                      pow(sat.vel.z - vel.z, 2));
+            dph = fabs(sat.phase - phase);
+            dph = dph > pi ? twopi - dph : dph;
+            maxdp = dp > maxdp ? dp : maxdp;
+            maxdv = dv > maxdv ? dv : maxdv;
+
+            if (dp > CHEB_POS_TOL || dv > CHEB_VEL_TOL || dph > 1.0E-5)
+            {
+                printf("%s  t: %8.2f  dpos: %.3e  dvel: %.3e  "
+                       "dphase: %.3e\n", names[i], step_time(j), dp, dv, dph);
+                fail++;
+            }
+        }
+
+        printf("%-18s  segment: %7.2f min  max dpos: %7.3f m  "
+               "max dvel: %7.3f mm/s\n", names[i], eph->len,
+               maxdp * xkmper * 1000.0,
+               maxdv * xkmper * 1.0E6 / secday * xmnpda);
+    }
+
+    /* negative drag term; the eccentricity exceeds 1 after ~3.6 days */
+    memset(&sat, 0, sizeof(sat_t));
+    sat.tle = tle[0];
+    sat.tle.bstar = -0.5;
+    select_ephemeris(&sat);
+    Cheb_Init(eph);
+    if (Cheb_Propagate(eph, &sat.elset, 0.0, &pos, &vel, &phase) ||
+        !Cheb_Propagate(eph, &sat.elset, 5300.0, &pos, &vel, &phase) ||
+        eph->fail_t0 > 5300.0 || eph->fail_t1 <= 5300.0)
+    {
+        printf("decayed: fit failure not recorded\n");
+        fail++;
+    }
+    else
+    {
+        /* no new fit inside the failed window, which would overwrite
+           the propagator state */
+        eph->state.pos.x = 1.0;
+        if (!Cheb_Propagate(eph, &sat.elset, 0.5 * (eph->fail_t0 +
+                                                    eph->fail_t1), &pos,
+                            &vel, &phase) || eph->state.pos.x != 1.0 ||
+            Cheb_Propagate(eph, &sat.elset, 1.0, &pos, &vel, &phase))
+        {
+            printf("decayed: failed window not used\n");
+            fail++;
+        }
+    }
+
+    free(eph);
+
+    printf("\n%d of %d comparisons outside tolerance\n", fail,
+           TEST_SATS * TEST_STEPS);
+
+    return fail ? 1 : 0;
+}
@@ -0,0 +1,203 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2008  Alexandru Csete.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the
+          Free Software Foundation, Inc.,
+      59 Temple Place, Suite 330,
+      Boston, MA  02111-1307
+      USA
+*/
+/*
+ * Unit test for Propagate_Series and Step_Frame_Time: a series of equally
+ * spaced times, forwards and backwards, must agree with SGP4()/SDP4() and
+ * Set_Frame_Time() for each time.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "sgp4sdp4.h"
+
+#define TEST_SATS  32
+#define TEST_STEPS 500
+
+char            tle_str[3][80];
+sat_t           ref[TEST_SATS];
+sgpsdp_point_t  out[TEST_STEPS];
+
+static int read_tle(const char *file, tle_t * tle)
+{
+    FILE           *fp;
+    int             i;
+
+    fp = fopen(file, "r");
+    if (fp == NULL)
+    {
+        printf("Could not open %s\n", file);
+        return 1;
+    }
+    for (i = 0; i < 3; i++)
+    {
+        if (fgets(tle_str[i], 80, fp) == NULL)
+        {
+            printf("Error reading TLE line %d of %s\n", i + 1, file);
+            fclose(fp);
+            return 1;
+        }
+    }
+    fclose(fp);
+
+    if (Get_Next_Tle_Set(tle_str, tle) != 1)
+    {
+        printf("Could not read TLE data from %s\n", file);
+        return 1;
+    }
+
+    return 0;
+}
+
+/* compare the frames of a series of times; returns the number of errors */
+static int test_frames(double start, double step)
+{
+    obs_frame_t     frame, exact;
+    geodetic_t      geodetic;
+    double          d, maxd = 0.0;
+    int             k, fail = 0;
+
+    geodetic.lat = Radians(55.7);
+    geodetic.lon = Radians(12.6);
+    geodetic.alt = 0.02;
+    geodetic.theta = 0;
+
+    Initialize_Frame(&frame, &geodetic);
+    Initialize_Frame(&exact, &geodetic);
+    Set_Frame_Time(&frame, start);
+    Set_Frame_Step(&frame, step);
+
+    for (k = 1; k < TEST_STEPS; k++)
+    {
+        Step_Frame_Time(&frame, start + k * step);
+        Set_Frame_Time(&exact, start + k * step);
+
+        d = sqrt(pow(frame.obs_pos.x - exact.obs_pos.x, 2) +
+                 pow(frame.obs_pos.y - exact.obs_pos.y, 2) +
+                 pow(frame.obs_pos.z - exact.obs_pos.z, 2));
+        maxd = d > maxd ? d : maxd;
+
+        /* 1 m, after TEST_STEPS steps without Set_Frame_Time() */
+        if (d > 1.0E-3 || fabs(frame.thetag - exact.thetag) > 1.0E-6)
+        {
+            printf("FRAME  step: %8.5f  k: %3d  dpos: %.3e km\n", step, k, d);
+            fail++;
+        }
+    }
+
+    printf("Frame step %8.5f d: max observer delta %.3f mm\n", step,
+           maxd * 1.0E6);
+
+    return fail;
+}
+
+int main(void)
+{
+    tle_t           tle[2];
+    double          tsince, dp, dv, maxdp = 0.0, maxdv = 0.0;
+    int             i, k, n, fail = 0;
+
+    /* step sizes in minutes: ground track, pass details, backwards */
+    static const double steps[] = { 0.504, 0.1, -1.008, 10.0 };
+
+    if (read_tle("test-001.tle", &tle[0]) || read_tle("test-002.tle", &tle[1]))
+        return 1;
+
+    /* a spread of near-earth orbits and a few deep-space ones */
+    for (i = 0; i < TEST_SATS; i++)
+    {
+        memset(&ref[i], 0, sizeof(sat_t));
+        if (i < TEST_SATS - 4)
+        {
+            ref[i].tle = tle[0];
+            ref[i].tle.xno = 14.0 + 2.4 * i / TEST_SATS;
+            ref[i].tle.eo = 0.0005 + 0.02 * (i % 8) / 8.0;
+        }
+        else
+        {
+            ref[i].tle = tle[1];
+            ref[i].tle.xno = 1.0 + 0.5 * (i % 4);
+            ref[i].tle.eo = 0.0002 + 0.3 * (i % 3);
+        }
+        ref[i].tle.xincl = fmod(ref[i].tle.xincl + 7.0 * i, 180.0);
+        ref[i].tle.xnodeo = fmod(ref[i].tle.xnodeo + 37.0 * i, 360.0);
+        ref[i].tle.omegao = fmod(ref[i].tle.omegao + 53.0 * i, 360.0);
+        ref[i].tle.xmo = fmod(ref[i].tle.xmo + 71.0 * i, 360.0);
+        select_ephemeris(&ref[i]);
+    }
+
+    for (n = 0; n < (int)(sizeof(steps) / sizeof(steps[0])); n++)
+    {
+        for (i = 0; i < TEST_SATS; i++)
+        {
+            tsince = 1440.0 * (i % 5) - 720.0;
+            Propagate_Series(&ref[i].elset, &ref[i].state, tsince, steps[n],
+                             TEST_STEPS, out);
+
+            for (k = 0; k < TEST_STEPS; k++)
+            {
+                if (ref[i].flags & DEEP_SPACE_EPHEM_FLAG)
+                    SDP4(&ref[i], tsince + k * steps[n]);
+                else
+                    SGP4(&ref[i], tsince + k * steps[n]);
+
+                dp = sqrt(pow(ref[i].pos.x - out[k].pos.x, 2) +
+                          pow(ref[i].pos.y - out[k].pos.y, 2) +
+                          pow(ref[i].pos.z - out[k].pos.z, 2));
+                dv = sqrt(pow(ref[i].vel.x - out[k].vel.x, 2) +
+                          pow(ref[i].vel.y - out[k].vel.y, 2) +
+                          pow(ref[i].vel.z - out[k].vel.z, 2));
+                maxdp = dp > maxdp ? dp : maxdp;
+                maxdv = dv > maxdv ? dv : maxdv;
+
+                if (dp > SERIES_POS_TOL || dv > SERIES_VEL_TOL ||
+                    fabs(ref[i].phase - out[k].phase) > 1.0E-9)
+                {
+                    printf("SAT %2d  step: %6.3f  k: %3d  dpos: %.3e  "
+                           "dvel: %.3e  dphase: %.3e\n", i, steps[n], k, dp,
+                           dv, fabs(ref[i].phase - out[k].phase));
+                    fail++;
+                }
+            }
+        }
+    }
+
+    printf("Max position delta: %.3e ER (%.3f mm)\n", maxdp,
+           maxdp * xkmper * 1.0E6);
+    printf("Max velocity delta: %.3e ER/min (%.6f mm/s)\n", maxdv,
+           maxdv * xkmper * 1.0E6 / secday * xmnpda);
+
+    for (n = 0; n < (int)(sizeof(steps) / sizeof(steps[0])); n++)
+        fail += test_frames(2458849.5 - 0.3, steps[n] / xmnpda);
+
+    printf("\n%d comparisons outside tolerance\n", fail);
+
+    return fail ? 1 : 0;
+}
@@ -0,0 +1,170 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+
+/*
+ * Unit test for gtk_sat_data_dup_sat: a duplicate of a satellite that has
+ * already been propagated must propagate exactly like the original, both
+ * for near-earth and deep-space satellites.
+ *
+ * Usage: test-sat-data file.tle [file.tle ...]
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "gtk-sat-data.h"
+#include "predict-tools.h"
+#include "qth-data.h"
+#include "sat-log.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+#define TEST_STEPS 200          /* propagation steps per satellite */
+#define TEST_STEP  0.01         /* time between steps in days */
+
+
+/* compare the propagated fields of two satellites; returns 1 if they differ */
+static int sat_differs(const sat_t * a, const sat_t * b)
+{
+    return (a->flags != b->flags) ||
+        (a->pos.x != b->pos.x) || (a->pos.y != b->pos.y) ||
+        (a->pos.z != b->pos.z) ||
+        (a->vel.x != b->vel.x) || (a->vel.y != b->vel.y) ||
+        (a->vel.z != b->vel.z) ||
+        (a->az != b->az) || (a->el != b->el) ||
+        (a->range != b->range) || (a->range_rate != b->range_rate) ||
+        (a->ssplat != b->ssplat) || (a->ssplon != b->ssplon) ||
+        (a->alt != b->alt) || (a->footprint != b->footprint) ||
+        (a->phase != b->phase) || (a->orbit != b->orbit);
+}
+
+/* test the duplicates of the satellites in a file; returns the number of errors */
+static int test_file(const char *fname, qth_t * qth, int *num_sats)
+{
+    FILE           *fp;
+    char            tle_str[3][80];
+    sat_t           sat;
+    sat_t          *dup;
+    int             fail = 0;
+    int             i;
+
+    fp = fopen(fname, "r");
+    if (fp == NULL)
+    {
+        printf("Could not open %s\n", fname);
+        return 1;
+    }
+
+    while (fgets(tle_str[0], 80, fp) != NULL &&
+           fgets(tle_str[1], 80, fp) != NULL &&
+           fgets(tle_str[2], 80, fp) != NULL)
+    {
+        memset(&sat, 0, sizeof(sat_t));
+        if (Get_Next_Tle_Set(tle_str, &sat.tle) != 1)
+            continue;
+
+        sat.name = g_strstrip(g_strdup(sat.tle.sat_name));
+        sat.nickname = g_strdup(sat.name);
+        select_ephemeris(&sat);
+        gtk_sat_data_init_sat(&sat, qth);
+
+        /* leave some propagator state behind before duplicating */
+        predict_calc(&sat, qth, sat.jul_epoch + 1.5);
+
+        dup = gtk_sat_data_dup_sat(&sat);
+        if (dup->name == sat.name || g_strcmp0(dup->name, sat.name) ||
+            dup->nickname == sat.nickname ||
+            g_strcmp0(dup->nickname, sat.nickname))
+        {
+            printf("%s: strings not duplicated\n", sat.name);
+            fail++;
+        }
+        if (dup->tle.xincl != sat.tle.xincl || sat_differs(dup, &sat))
+        {
+            printf("%s: duplicate differs from the original\n", sat.name);
+            fail++;
+        }
+
+        /* forwards and then backwards */
+        for (i = 0; i < 2 * TEST_STEPS; i++)
+        {
+            gdouble         t = (i < TEST_STEPS) ? i : 2 * TEST_STEPS - i;
+
+            t = sat.jul_epoch + 1.5 + t * TEST_STEP;
+            predict_calc(&sat, qth, t);
+            predict_calc(dup, qth, t);
+            if (sat_differs(dup, &sat))
+            {
+                printf("%s: duplicate differs at %.5f (%.3f km)\n",
+                       sat.name, t - sat.jul_epoch,
+                       sqrt((dup->pos.x - sat.pos.x) * (dup->pos.x - sat.pos.x) +
+                            (dup->pos.y - sat.pos.y) * (dup->pos.y - sat.pos.y) +
+                            (dup->pos.z - sat.pos.z) * (dup->pos.z - sat.pos.z)));
+                fail++;
+                break;
+            }
+        }
+
+        gtk_sat_data_free_sat(dup);
+        g_free(sat.name);
+        g_free(sat.nickname);
+        (*num_sats)++;
+    }
+    fclose(fp);
+
+    return fail;
+}
+
+int main(int argc, char **argv)
+{
+    qth_t           qth;
+    int             fail = 0;
+    int             num_sats = 0;
+    int             i;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s file.tle [file.tle ...]\n", argv[0]);
+        return 1;
+    }
+
+    sat_log_set_level(SAT_LOG_LEVEL_ERROR);
+
+    memset(&qth, 0, sizeof(qth_t));
+    qth.lat = 55.7;
+    qth.lon = 12.6;
+    qth.alt = 20;
+
+    for (i = 1; i < argc; i++)
+        fail += test_file(argv[i], &qth, &num_sats);
+
+    printf("%d satellites, %d errors\n", num_sats, fail);
+
+    return fail ? 1 : 0;
+}